@@ -0,0 +1,142 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace openMVG {
+namespace benchmark {
+
+void Benchmark_Registry::Add
+(
+  const std::string & name,
+  const Benchmark_Setup & setup
+)
+{
+  benchmarks_.emplace_back(name, setup);
+}
+
+double Percentile
+(
+  const std::vector<double> & sorted_values,
+  const double p
+)
+{
+  if (sorted_values.empty())
+    return 0.0;
+  const double rank = (p / 100.0) * (sorted_values.size() - 1);
+  const size_t lower = static_cast<size_t>(std::floor(rank));
+  const size_t upper = std::min(lower + 1, sorted_values.size() - 1);
+  const double weight = rank - lower;
+  return sorted_values[lower] * (1.0 - weight) + sorted_values[upper] * weight;
+}
+
+Benchmark_Result Compute_Statistics
+(
+  const std::string & name,
+  std::vector<double> timings
+)
+{
+  Benchmark_Result result;
+  result.name = name;
+  result.repetitions = static_cast<int>(timings.size());
+  if (timings.empty())
+    return result;
+
+  std::sort(timings.begin(), timings.end());
+  result.min = timings.front();
+  result.max = timings.back();
+  result.mean = std::accumulate(timings.cbegin(), timings.cend(), 0.0) / timings.size();
+  double variance = 0.0;
+  for (const double timing : timings)
+    variance += (timing - result.mean) * (timing - result.mean);
+  result.stddev = std::sqrt(variance / timings.size());
+  result.median = Percentile(timings, 50.0);
+  result.p90 = Percentile(timings, 90.0);
+  result.p99 = Percentile(timings, 99.0);
+  return result;
+}
+
+Benchmark_Result Run
+(
+  const std::string & name,
+  const Benchmark_Setup & setup,
+  const Benchmark_Options & options
+)
+{
+  const Benchmark_Case benchmark_case = setup(options.scale);
+
+  for (int i = 0; i < options.warmup; ++i)
+  {
+    if (benchmark_case.reset)
+      benchmark_case.reset();
+    benchmark_case.run();
+  }
+
+  std::vector<double> timings;
+  timings.reserve(options.repetitions);
+  for (int i = 0; i < options.repetitions; ++i)
+  {
+    if (benchmark_case.reset)
+      benchmark_case.reset();
+    const auto start = std::chrono::steady_clock::now();
+    benchmark_case.run();
+    const auto end = std::chrono::steady_clock::now();
+    timings.push_back(
+      std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return Compute_Statistics(name, std::move(timings));
+}
+
+bool Export_JSON
+(
+  const std::vector<Benchmark_Result> & results,
+  const Benchmark_Options & options,
+  const std::string & filename
+)
+{
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open())
+    return false;
+
+  stream
+    << "{\n"
+    << "  \"context\": {\n"
+    << "    \"warmup\": " << options.warmup << ",\n"
+    << "    \"repetitions\": " << options.repetitions << ",\n"
+    << "    \"scale\": " << options.scale << ",\n"
+    << "    \"time_unit\": \"ms\"\n"
+    << "  },\n"
+    << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const Benchmark_Result & result = results[i];
+    stream
+      << (i == 0 ? "\n" : ",\n")
+      << "    {"
+      << "\"name\": \"" << result.name << "\", "
+      << "\"repetitions\": " << result.repetitions << ", "
+      << "\"min\": " << result.min << ", "
+      << "\"max\": " << result.max << ", "
+      << "\"mean\": " << result.mean << ", "
+      << "\"stddev\": " << result.stddev << ", "
+      << "\"median\": " << result.median << ", "
+      << "\"p90\": " << result.p90 << ", "
+      << "\"p99\": " << result.p99 << "}";
+  }
+  stream << "\n  ]\n}\n";
+  return stream.good();
+}
+
+} // namespace benchmark
+} // namespace openMVG
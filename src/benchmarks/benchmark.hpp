@@ -0,0 +1,127 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_BENCHMARKS_BENCHMARK_HPP
+#define OPENMVG_BENCHMARKS_BENCHMARK_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace benchmark {
+
+/**
+* @brief A benchmark case, returned by the benchmark setup function.
+*  - run: the timed workload,
+*  - reset: optional untimed function called before each run
+*    (i.e. to restore a scene modified in place by the workload).
+*/
+struct Benchmark_Case
+{
+  std::function<void()> run;
+  std::function<void()> reset;
+};
+
+/// Build a benchmark case for the given problem scale (1.0 = default size).
+/// Data generation is done in the setup function and is not timed.
+using Benchmark_Setup = std::function<Benchmark_Case(double scale)>;
+
+struct Benchmark_Options
+{
+  int warmup = 2;        // Untimed runs done before the measurements
+  int repetitions = 10;  // Timed runs
+  double scale = 1.0;    // Problem size multiplier
+  std::string filter;    // Run only the benchmarks whose name contains this string
+};
+
+/// Timing statistics of a benchmark (milliseconds)
+struct Benchmark_Result
+{
+  std::string name;
+  int repetitions = 0;
+  double min = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+  double stddev = 0.0;
+  double median = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+};
+
+class Benchmark_Registry
+{
+public:
+  void Add(const std::string & name, const Benchmark_Setup & setup);
+
+  const std::vector<std::pair<std::string, Benchmark_Setup>> & Benchmarks() const
+  {
+    return benchmarks_;
+  }
+
+private:
+  std::vector<std::pair<std::string, Benchmark_Setup>> benchmarks_;
+};
+
+/**
+* @brief Run a benchmark: setup, warmup runs and timed repetitions.
+* @param name benchmark name
+* @param setup benchmark setup function
+* @param options run configuration
+* @return the timing statistics
+*/
+Benchmark_Result Run
+(
+  const std::string & name,
+  const Benchmark_Setup & setup,
+  const Benchmark_Options & options
+);
+
+/// Compute timing statistics from raw timings (milliseconds)
+Benchmark_Result Compute_Statistics
+(
+  const std::string & name,
+  std::vector<double> timings
+);
+
+/// Linear interpolated percentile (p in [0,100]) of sorted values
+double Percentile(const std::vector<double> & sorted_values, double p);
+
+/**
+* @brief Export results in a JSON file (see compare_benchmarks.py)
+* @return true if the file was written
+*/
+bool Export_JSON
+(
+  const std::vector<Benchmark_Result> & results,
+  const Benchmark_Options & options,
+  const std::string & filename
+);
+
+/// Prevent the compiler to discard the computation of a value
+template <typename T>
+inline void Do_Not_Optimize(const T & value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static volatile const void * sink;
+  sink = &value;
+#endif
+}
+
+// Benchmark groups (one per source file)
+void Register_Features_Benchmarks(Benchmark_Registry & registry);
+void Register_Matching_Benchmarks(Benchmark_Registry & registry);
+void Register_Robust_Estimation_Benchmarks(Benchmark_Registry & registry);
+void Register_SfM_Benchmarks(Benchmark_Registry & registry);
+
+} // namespace benchmark
+} // namespace openMVG
+
+#endif // OPENMVG_BENCHMARKS_BENCHMARK_HPP
@@ -0,0 +1,72 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+#include "benchmarks/benchmark_scenes.hpp"
+
+#include "openMVG/features/akaze/image_describer_akaze.hpp"
+#include "openMVG/features/sift/SIFT_Anatomy_Image_Describer.hpp"
+
+#include <cmath>
+#include <memory>
+
+namespace openMVG {
+namespace benchmark {
+
+using namespace openMVG::features;
+
+namespace {
+
+/// Benchmark the Describe call of an Image_describer on a synthetic image.
+/// The image area is proportional to the scale (640x480 at scale 1).
+Benchmark_Setup Describer_Benchmark
+(
+  const std::function<std::shared_ptr<Image_describer>()> & describer_factory
+)
+{
+  return [describer_factory](double scale)
+  {
+    const double side_scale = std::sqrt(scale);
+    const auto image = std::make_shared<image::Image<unsigned char>>(
+      Synthetic_Image(
+        static_cast<int>(Scaled(640, side_scale, 64)),
+        static_cast<int>(Scaled(480, side_scale, 48))));
+    const std::shared_ptr<Image_describer> describer = describer_factory();
+
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [image, describer]
+    {
+      const std::unique_ptr<Regions> regions = describer->Describe(*image);
+      Do_Not_Optimize(regions->RegionCount());
+    };
+    return benchmark_case;
+  };
+}
+
+} // namespace
+
+void Register_Features_Benchmarks(Benchmark_Registry & registry)
+{
+  registry.Add("describer/SIFT_ANATOMY", Describer_Benchmark([]
+  {
+    return std::make_shared<SIFT_Anatomy_Image_describer>();
+  }));
+  registry.Add("describer/AKAZE_MSURF", Describer_Benchmark([]
+  {
+    return std::shared_ptr<Image_describer>(AKAZE_Image_describer::create(
+      AKAZE_Image_describer::Params(AKAZE::Params(), AKAZE_MSURF)));
+  }));
+  registry.Add("describer/AKAZE_MLDB", Describer_Benchmark([]
+  {
+    return std::shared_ptr<Image_describer>(AKAZE_Image_describer::create(
+      AKAZE_Image_describer::Params(AKAZE::Params(), AKAZE_MLDB)));
+  }));
+}
+
+} // namespace benchmark
+} // namespace openMVG
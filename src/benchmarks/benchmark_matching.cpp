@@ -0,0 +1,156 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+#include "benchmarks/benchmark_scenes.hpp"
+
+#include "openMVG/matching/cascade_hasher.hpp"
+#include "openMVG/matching/matcher_brute_force.hpp"
+#include "openMVG/matching/matcher_cascade_hashing.hpp"
+#include "openMVG/matching/matcher_kdtree_flann.hpp"
+
+#include <memory>
+
+namespace openMVG {
+namespace benchmark {
+
+using namespace openMVG::matching;
+
+namespace {
+
+// SIFT like descriptors
+const size_t kDescriptorLength = 128;
+// #descriptors per image at scale 1
+const size_t kDescriptorCount = 2000;
+
+/// Descriptor sets shared by the matching benchmarks
+struct Descriptor_Sets
+{
+  size_t count;
+  std::vector<unsigned char> database, query;
+  std::vector<float> database_float, query_float;
+
+  explicit Descriptor_Sets(double scale)
+    : count(Scaled(kDescriptorCount, scale, 16))
+  {
+    Synthetic_Descriptors(count, kDescriptorLength, database, query);
+    database_float.assign(database.cbegin(), database.cend());
+    query_float.assign(query.cbegin(), query.cend());
+  }
+};
+
+// Select the descriptor set matching the scalar type
+template <typename Scalar> struct Select;
+template <> struct Select<unsigned char>
+{
+  static const std::vector<unsigned char> & database(const Descriptor_Sets & s) { return s.database; }
+  static const std::vector<unsigned char> & query(const Descriptor_Sets & s) { return s.query; }
+};
+template <> struct Select<float>
+{
+  static const std::vector<float> & database(const Descriptor_Sets & s) { return s.database_float; }
+  static const std::vector<float> & query(const Descriptor_Sets & s) { return s.query_float; }
+};
+
+/// Benchmark a 2-NN search of all the query descriptors
+/// (the matching structure is built in the timed section).
+template <typename MatcherT, typename Scalar>
+Benchmark_Setup Array_Matcher_Benchmark()
+{
+  return [](double scale)
+  {
+    const auto sets = std::make_shared<Descriptor_Sets>(scale);
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [sets]
+    {
+      const std::vector<Scalar> & database = Select<Scalar>::database(*sets);
+      const std::vector<Scalar> & query = Select<Scalar>::query(*sets);
+      MatcherT matcher;
+      matcher.Build(database.data(), sets->count, kDescriptorLength);
+      IndMatches indices;
+      std::vector<typename MatcherT::DistanceType> distances;
+      matcher.SearchNeighbours(query.data(), sets->count, &indices, &distances, 2);
+      Do_Not_Optimize(distances.data());
+    };
+    return benchmark_case;
+  };
+}
+
+} // namespace
+
+void Register_Matching_Benchmarks(Benchmark_Registry & registry)
+{
+  registry.Add("matcher/ArrayMatcherBruteForce_L2_uint8",
+    Array_Matcher_Benchmark<ArrayMatcherBruteForce<unsigned char, L2<unsigned char>>, unsigned char>());
+  registry.Add("matcher/ArrayMatcherBruteForce_L2_float",
+    Array_Matcher_Benchmark<ArrayMatcherBruteForce<float, L2<float>>, float>());
+  registry.Add("matcher/ArrayMatcher_Kdtree_Flann_float",
+    Array_Matcher_Benchmark<ArrayMatcher_Kdtree_Flann<float>, float>());
+  registry.Add("matcher/ArrayMatcherCascadeHashing_uint8",
+    Array_Matcher_Benchmark<ArrayMatcherCascadeHashing<unsigned char, L2<unsigned char>>, unsigned char>());
+
+  using BaseMat = Eigen::Matrix<unsigned char, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  // Hashing of one descriptor set
+  registry.Add("cascade_hasher/CreateHashedDescriptions", [](double scale)
+  {
+    const auto sets = std::make_shared<Descriptor_Sets>(scale);
+    const auto hasher = std::make_shared<CascadeHasher>();
+    hasher->Init(kDescriptorLength);
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [sets, hasher]
+    {
+      const Eigen::Map<const BaseMat> descriptors(
+        sets->database.data(), sets->count, kDescriptorLength);
+      const Eigen::VectorXf zero_mean = CascadeHasher::GetZeroMeanDescriptor(descriptors);
+      const HashedDescriptions hashed_descriptions =
+        hasher->CreateHashedDescriptions(descriptors, zero_mean);
+      Do_Not_Optimize(hashed_descriptions.hashed_desc.size());
+    };
+    return benchmark_case;
+  });
+
+  // Matching of two already hashed descriptor sets
+  registry.Add("cascade_hasher/Match_HashedDescriptions", [](double scale)
+  {
+    struct Hashed_Sets
+    {
+      Descriptor_Sets sets;
+      CascadeHasher hasher;
+      HashedDescriptions hashed_database, hashed_query;
+      explicit Hashed_Sets(double scale) : sets(scale) {}
+    };
+    const auto data = std::make_shared<Hashed_Sets>(scale);
+    data->hasher.Init(kDescriptorLength);
+    const Eigen::Map<const BaseMat>
+      database(data->sets.database.data(), data->sets.count, kDescriptorLength),
+      query(data->sets.query.data(), data->sets.count, kDescriptorLength);
+    const Eigen::VectorXf zero_mean = CascadeHasher::GetZeroMeanDescriptor(database);
+    data->hashed_database = data->hasher.CreateHashedDescriptions(database, zero_mean);
+    data->hashed_query = data->hasher.CreateHashedDescriptions(query, zero_mean);
+
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [data]
+    {
+      const Eigen::Map<const BaseMat>
+        database(data->sets.database.data(), data->sets.count, kDescriptorLength),
+        query(data->sets.query.data(), data->sets.count, kDescriptorLength);
+      IndMatches indices;
+      std::vector<int> distances;
+      data->hasher.Match_HashedDescriptions<Eigen::Map<const BaseMat>, int>(
+        data->hashed_query, query,
+        data->hashed_database, database,
+        &indices, &distances);
+      Do_Not_Optimize(distances.data());
+    };
+    return benchmark_case;
+  });
+}
+
+} // namespace benchmark
+} // namespace openMVG
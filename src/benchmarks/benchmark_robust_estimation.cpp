@@ -0,0 +1,582 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+#include "benchmarks/benchmark_scenes.hpp"
+
+#include "openMVG/multiview/conditioning.hpp"
+#include "openMVG/multiview/solver_essential_kernel.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
+#include "openMVG/multiview/solver_resection_p3p_kneip.hpp"
+#include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
+#include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
+#include "openMVG/robust_estimation/robust_fit_batch.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace openMVG {
+namespace benchmark {
+
+using namespace openMVG::robust;
+
+namespace {
+
+// #correspondences at scale 1
+const size_t kPointCount = 1000;
+const double kOutlierRatio = 0.3;
+const double kHighOutlierRatio = 0.7;
+const int kMaxIteration = 1024;
+// #minimal samples fitted by the minimal solver benchmarks at scale 1
+const size_t kMinimalSampleCount = 10000;
+// #correspondences (x kPointCount) and #samples of the NFA scoring benchmarks
+const double kLargePairFactor = 20.0;
+const size_t kScoredSampleCount = 256;
+
+/// Two view correspondences with outliers
+struct Two_View_Data
+{
+  nViewDatasetConfigurator config;
+  Mat2X x1, x2;
+  Mat3 K;
+};
+
+/// Replace a ratio of the second view observations by random points
+/// (the first columns are the outliers)
+void Add_Outliers
+(
+  Two_View_Data & data,
+  std::mt19937 & random_generator,
+  double outlier_ratio = kOutlierRatio
+)
+{
+  std::uniform_real_distribution<double>
+    x_distribution(0, data.config._cx * 2),
+    y_distribution(0, data.config._cy * 2);
+  const Mat2X::Index outlier_count =
+    static_cast<Mat2X::Index>(data.x2.cols() * outlier_ratio);
+  for (Mat2X::Index i = 0; i < outlier_count; ++i)
+  {
+    data.x2.col(i) << x_distribution(random_generator), y_distribution(random_generator);
+  }
+}
+
+/// Two views of a generic 3D scene
+std::shared_ptr<Two_View_Data> Two_View_Scene
+(
+  double scale,
+  double outlier_ratio = kOutlierRatio
+)
+{
+  auto data = std::make_shared<Two_View_Data>();
+  const NViewDataSet dataset =
+    NRealisticCamerasRing(2, Scaled(kPointCount, scale, 32), data->config);
+  std::mt19937 random_generator(0);
+  std::normal_distribution<double> noise(0.0, 0.5);
+  data->x1 = dataset._x[0];
+  data->x2 = dataset._x[1];
+  for (Mat2X::Index i = 0; i < data->x2.cols(); ++i)
+  {
+    data->x1.col(i) += Vec2(noise(random_generator), noise(random_generator));
+    data->x2.col(i) += Vec2(noise(random_generator), noise(random_generator));
+  }
+  Add_Outliers(*data, random_generator, outlier_ratio);
+  data->K = dataset._K[0];
+  return data;
+}
+
+/// Two views of a planar scene
+std::shared_ptr<Two_View_Data> Planar_Scene(double scale)
+{
+  auto data = std::make_shared<Two_View_Data>();
+  const size_t point_count = Scaled(kPointCount, scale, 32);
+  std::mt19937 random_generator(0);
+  std::uniform_real_distribution<double>
+    x_distribution(0, data->config._cx * 2),
+    y_distribution(0, data->config._cy * 2);
+  std::normal_distribution<double> noise(0.0, 0.5);
+
+  Mat3 H;
+  H << 1.1, 0.05, 20.0,
+       -0.03, 0.95, -10.0,
+       1e-5, 2e-5, 1.0;
+  data->x1.resize(2, point_count);
+  data->x2.resize(2, point_count);
+  for (size_t i = 0; i < point_count; ++i)
+  {
+    const Vec2 x1(x_distribution(random_generator), y_distribution(random_generator));
+    const Vec3 x2 = H * x1.homogeneous();
+    data->x1.col(i) = x1;
+    data->x2.col(i) = x2.hnormalized() + Vec2(noise(random_generator), noise(random_generator));
+  }
+  Add_Outliers(*data, random_generator);
+  data->K = Mat3::Identity();
+  return data;
+}
+
+/// Quality ranking of the correspondences of a scene (i.e. as if sorted by
+///  descriptor distance): the inliers tend to be better ranked
+std::vector<uint32_t> Quality_Order
+(
+  const Two_View_Data & data,
+  double outlier_ratio
+)
+{
+  const uint32_t count = data.x1.cols();
+  const uint32_t outlier_count = static_cast<uint32_t>(count * outlier_ratio);
+  std::mt19937 random_generator(0);
+  std::uniform_real_distribution<double> distance(0.0, 1.0);
+  std::vector<std::pair<double, uint32_t>> scores(count);
+  for (uint32_t i = 0; i < count; ++i)
+    scores[i] = {distance(random_generator) + ((i < outlier_count) ? 0.5 : 0.0), i};
+  std::sort(scores.begin(), scores.end());
+  std::vector<uint32_t> order(count);
+  for (uint32_t i = 0; i < count; ++i)
+    order[i] = scores[i].second;
+  return order;
+}
+
+/// Benchmark an ACRANSAC call on a kernel built once in the setup
+template <typename KernelT>
+Benchmark_Case ACRANSAC_Case
+(
+  const std::shared_ptr<KernelT> & kernel,
+  const ACRANSAC_Scheduling & scheduling = ACRANSAC_Scheduling(),
+  double precision = std::numeric_limits<double>::infinity()
+)
+{
+  Benchmark_Case benchmark_case;
+  benchmark_case.run = [kernel, scheduling, precision]
+  {
+    std::vector<uint32_t> vec_inliers;
+    typename KernelT::Model model;
+    const std::pair<double, double> ac_ransac_output =
+      ACRANSAC(*kernel, vec_inliers, scheduling, kMaxIteration, &model, precision);
+    Do_Not_Optimize(ac_ransac_output);
+  };
+  return benchmark_case;
+}
+
+/// NFA scoring as done before the partial selection (full sort of the
+///  residuals, inliers listed for every better model), used as a reference
+template <typename KernelT>
+class Reference_NFA_Scoring
+{
+public:
+  Reference_NFA_Scoring
+  (
+    const KernelT & kernel,
+    double max_threshold,
+    bool b_quantified
+  ):
+    kernel_(kernel), max_threshold_(max_threshold), b_quantified_(b_quantified)
+  {
+    loge0_ = log10((double)KernelT::MAX_MODELS * (kernel.NumSamples() - KernelT::MINIMUM_SAMPLES));
+    acransac_nfa_internal::makelogcombi(KernelT::MINIMUM_SAMPLES, kernel.NumSamples(), logc_k_, logc_n_);
+  }
+
+  bool ComputeNFA_and_inliers
+  (
+    const std::vector<double> & residuals,
+    std::vector<uint32_t> & inliers,
+    std::pair<double,double> & nfa_threshold
+  )
+  {
+    const uint32_t n = kernel_.NumSamples();
+    const auto logalpha = [this](double residual)
+    {
+      return kernel_.logalpha0() + kernel_.multError() *
+        log10(residual + std::numeric_limits<float>::epsilon());
+    };
+    if (b_quantified_)
+    {
+      const int nBins = 20;
+      Histogram<double> histo(0.0f, max_threshold_, nBins);
+      histo.Add(residuals.cbegin(), residuals.cend());
+      std::pair<double,double> best_nfa(std::numeric_limits<double>::infinity(), 0.0);
+      unsigned int cumulative_count = 0;
+      const std::vector<size_t> & frequencies = histo.GetHist();
+      const std::vector<double> residual_val = histo.GetXbinsValue();
+      for (int bin = 0; bin < nBins; ++bin)
+      {
+        cumulative_count += frequencies[bin];
+        if (cumulative_count > KernelT::MINIMUM_SAMPLES
+            && residual_val[bin] > std::numeric_limits<float>::epsilon())
+        {
+          const double nfa = loge0_
+            + logalpha(residual_val[bin]) * (double)(cumulative_count - KernelT::MINIMUM_SAMPLES)
+            + logc_n_[cumulative_count] + logc_k_[cumulative_count];
+          if (nfa < best_nfa.first && nfa < 0)
+            best_nfa = {nfa, residual_val[bin]};
+        }
+      }
+      if (best_nfa.first < nfa_threshold.first)
+      {
+        nfa_threshold = best_nfa;
+        inliers.clear();
+        for (uint32_t index = 0; index < n; ++index)
+          if (residuals[index] <= nfa_threshold.second)
+            inliers.push_back(index);
+        return inliers.size() > KernelT::MINIMUM_SAMPLES;
+      }
+    }
+    else
+    {
+      sorted_residuals_.clear();
+      for (uint32_t i = 0; i < n; ++i)
+        sorted_residuals_.emplace_back(residuals[i], i);
+      std::sort(sorted_residuals_.begin(), sorted_residuals_.end());
+      std::pair<double, uint32_t> best_nfa(std::numeric_limits<double>::infinity(), KernelT::MINIMUM_SAMPLES);
+      for (uint32_t k = KernelT::MINIMUM_SAMPLES + 1;
+           k <= n && sorted_residuals_[k-1].first <= max_threshold_; ++k)
+      {
+        const double nfa = loge0_
+          + logalpha(sorted_residuals_[k-1].first) * (double)(k - KernelT::MINIMUM_SAMPLES)
+          + logc_n_[k] + logc_k_[k];
+        if (nfa < best_nfa.first)
+          best_nfa = {nfa, k};
+      }
+      if (best_nfa.first < nfa_threshold.first)
+      {
+        nfa_threshold = {best_nfa.first, sorted_residuals_[best_nfa.second-1].first};
+        inliers.resize(best_nfa.second);
+        for (uint32_t i = 0; i < best_nfa.second; ++i)
+          inliers[i] = sorted_residuals_[i].second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  const KernelT & kernel_;
+  const double max_threshold_;
+  const bool b_quantified_;
+  double loge0_;
+  std::vector<float> logc_n_, logc_k_;
+  std::vector<std::pair<double,uint32_t>> sorted_residuals_;
+};
+
+/// Residuals of the hypotheses scored by ACRANSAC on a large pair
+///  (models fitted on uniform samples: mostly wrong hypotheses)
+template <typename KernelT>
+struct NFA_Scoring_Data
+{
+  std::shared_ptr<Two_View_Data> scene;
+  std::unique_ptr<KernelT> kernel;
+  std::vector<std::vector<double>> hypothesis_residuals;
+};
+
+template <typename KernelT>
+std::shared_ptr<NFA_Scoring_Data<KernelT>> Score_Uniform_Samples(double scale)
+{
+  auto data = std::make_shared<NFA_Scoring_Data<KernelT>>();
+  data->scene = Two_View_Scene(kLargePairFactor * scale);
+  const int w = data->scene->config._cx * 2, h = data->scene->config._cy * 2;
+  data->kernel.reset(new KernelT(data->scene->x1, w, h, data->scene->x2, w, h, true));
+
+  std::mt19937 random_generator(0);
+  std::vector<uint32_t> sample;
+  std::vector<typename KernelT::Model> models;
+  for (size_t i = 0; i < kScoredSampleCount; ++i)
+  {
+    UniformSample(KernelT::MINIMUM_SAMPLES, data->kernel->NumSamples(), random_generator, &sample);
+    models.clear();
+    data->kernel->Fit(sample, &models);
+    for (const auto & model : models)
+    {
+      data->hypothesis_residuals.emplace_back();
+      data->kernel->Errors(model, data->hypothesis_residuals.back());
+    }
+  }
+  return data;
+}
+
+/// Benchmark the NFA scoring of all the hypotheses and the inliers listing
+///  of the best one (exhaustive or quantified mode)
+template <typename KernelT>
+Benchmark_Case NFA_Scoring_Case
+(
+  const std::shared_ptr<NFA_Scoring_Data<KernelT>> & data,
+  double precision,
+  bool b_reference
+)
+{
+  Benchmark_Case benchmark_case;
+  const double max_threshold = (precision == std::numeric_limits<double>::infinity()) ?
+    precision :
+    precision * Square(data->kernel->normalizer2()(0,0));
+  const bool b_quantified = (precision != std::numeric_limits<double>::infinity());
+  benchmark_case.run = [data, max_threshold, b_quantified, b_reference]
+  {
+    std::pair<double, double> nfa_threshold(std::numeric_limits<double>::infinity(), 0.0);
+    std::vector<uint32_t> inliers;
+    if (b_reference)
+    {
+      Reference_NFA_Scoring<KernelT> nfa_scoring(*data->kernel, max_threshold, b_quantified);
+      std::vector<double> model_residuals;
+      for (const std::vector<double> & residuals : data->hypothesis_residuals)
+      {
+        model_residuals = residuals;
+        nfa_scoring.ComputeNFA_and_inliers(model_residuals, inliers, nfa_threshold);
+      }
+    }
+    else
+    {
+      acransac_nfa_internal::NFA_Interface<KernelT> nfa_interface(
+        *data->kernel, max_threshold, b_quantified);
+      for (const std::vector<double> & residuals : data->hypothesis_residuals)
+      {
+        nfa_interface.residuals() = residuals;
+        nfa_interface.ComputeNFA(nfa_threshold);
+      }
+      nfa_interface.Inliers(inliers);
+    }
+    Do_Not_Optimize(inliers.size());
+  };
+  return benchmark_case;
+}
+
+/// Minimal samples drawn over the data of a kernel
+///  (the kernel keeps references to the data)
+template <typename KernelT>
+struct Minimal_Sample_Data
+{
+  Mat x1, x2;
+  std::unique_ptr<KernelT> kernel;
+  std::vector<uint32_t> samples; // concatenated minimal samples
+};
+
+template <typename KernelT>
+void Draw_Minimal_Samples
+(
+  Minimal_Sample_Data<KernelT> & data,
+  double scale
+)
+{
+  const uint32_t sample_count = Scaled(kMinimalSampleCount, scale, 100);
+  std::mt19937 random_generator(0);
+  std::vector<uint32_t> all_samples(data.kernel->NumSamples()), sample;
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+  for (uint32_t i = 0; i < sample_count; ++i)
+  {
+    UniformSample(KernelT::MINIMUM_SAMPLES, random_generator, &all_samples, &sample);
+    data.samples.insert(data.samples.end(), sample.cbegin(), sample.cend());
+  }
+}
+
+/// Benchmark the fitting of all the minimal samples, one by one or by batch
+template <typename KernelT>
+Benchmark_Case Minimal_Solver_Case
+(
+  const std::shared_ptr<Minimal_Sample_Data<KernelT>> & data,
+  bool b_batch
+)
+{
+  Benchmark_Case benchmark_case;
+  if (b_batch)
+  {
+    auto batch = std::make_shared<Batch_Models<typename KernelT::Model>>();
+    benchmark_case.run = [data, batch]
+    {
+      FitBatch(*data->kernel, data->samples, *batch);
+      Do_Not_Optimize(batch->models.size());
+    };
+  }
+  else
+  {
+    benchmark_case.run = [data]
+    {
+      std::vector<uint32_t> sample(KernelT::MINIMUM_SAMPLES);
+      std::vector<typename KernelT::Model> models;
+      size_t model_count = 0;
+      for (size_t i = 0; i < data->samples.size(); i += KernelT::MINIMUM_SAMPLES)
+      {
+        std::copy(data->samples.cbegin() + i,
+                  data->samples.cbegin() + i + KernelT::MINIMUM_SAMPLES,
+                  sample.begin());
+        models.clear();
+        data->kernel->Fit(sample, &models);
+        model_count += models.size();
+      }
+      Do_Not_Optimize(model_count);
+    };
+  }
+  return benchmark_case;
+}
+
+/// Calibrated two view correspondences (5pt essential matrix solver)
+std::shared_ptr<Minimal_Sample_Data<essential::kernel::FivePointKernel>>
+Essential_5pt_Samples(double scale)
+{
+  auto data = std::make_shared<Minimal_Sample_Data<essential::kernel::FivePointKernel>>();
+  const auto scene = Two_View_Scene(scale);
+  data->x1 = scene->x1;
+  data->x2 = scene->x2;
+  data->kernel.reset(new essential::kernel::FivePointKernel(
+    data->x1, data->x2, scene->K, scene->K));
+  Draw_Minimal_Samples(*data, scale);
+  return data;
+}
+
+/// Two view correspondences (8pt fundamental matrix solver)
+std::shared_ptr<Minimal_Sample_Data<fundamental::kernel::NormalizedEightPointKernel>>
+Fundamental_8pt_Samples(double scale)
+{
+  auto data = std::make_shared<Minimal_Sample_Data<fundamental::kernel::NormalizedEightPointKernel>>();
+  const auto scene = Two_View_Scene(scale);
+  data->x1 = scene->x1;
+  data->x2 = scene->x2;
+  data->kernel.reset(new fundamental::kernel::NormalizedEightPointKernel(data->x1, data->x2));
+  Draw_Minimal_Samples(*data, scale);
+  return data;
+}
+
+/// Bearing vectors and 3D points (P3P solver)
+std::shared_ptr<Minimal_Sample_Data<euclidean_resection::PoseResectionKernel_P3P_Kneip>>
+P3P_Samples(double scale)
+{
+  auto data = std::make_shared<Minimal_Sample_Data<euclidean_resection::PoseResectionKernel_P3P_Kneip>>();
+  nViewDatasetConfigurator config;
+  const NViewDataSet dataset =
+    NRealisticCamerasRing(1, Scaled(kPointCount, scale, 32), config);
+  data->x1 = (dataset._K[0].inverse() * dataset._x[0].colwise().homogeneous()).colwise().normalized();
+  data->x2 = dataset._X;
+  data->kernel.reset(new euclidean_resection::PoseResectionKernel_P3P_Kneip(data->x1, data->x2));
+  Draw_Minimal_Samples(*data, scale);
+  return data;
+}
+
+} // namespace
+
+void Register_Robust_Estimation_Benchmarks(Benchmark_Registry & registry)
+{
+  registry.Add("acransac/fundamental_7pt", [](double scale)
+  {
+    using KernelType =
+      ACKernelAdaptor<
+        openMVG::fundamental::kernel::SevenPointSolver,
+        openMVG::fundamental::kernel::EpipolarDistanceError,
+        UnnormalizerT,
+        Mat3>;
+    const auto data = Two_View_Scene(scale);
+    const int w = data->config._cx * 2, h = data->config._cy * 2;
+    return ACRANSAC_Case(std::make_shared<KernelType>(
+      data->x1, w, h, data->x2, w, h, true));
+  });
+
+  registry.Add("acransac/homography_4pt", [](double scale)
+  {
+    using KernelType =
+      ACKernelAdaptor<
+        openMVG::homography::kernel::FourPointSolver,
+        openMVG::homography::kernel::AsymmetricError,
+        UnnormalizerI,
+        Mat3>;
+    const auto data = Planar_Scene(scale);
+    const int w = data->config._cx * 2, h = data->config._cy * 2;
+    return ACRANSAC_Case(std::make_shared<KernelType>(
+      data->x1, w, h, data->x2, w, h, false));
+  });
+
+  registry.Add("acransac/essential_5pt", [](double scale)
+  {
+    using KernelType =
+      ACKernelAdaptorEssential<
+        openMVG::essential::kernel::FivePointSolver,
+        openMVG::fundamental::kernel::EpipolarDistanceError,
+        Mat3>;
+    const auto data = Two_View_Scene(scale);
+    const int w = data->config._cx * 2, h = data->config._cy * 2;
+    const Mat3 K_inverse = data->K.inverse();
+    const Mat3X
+      bearing1 = (K_inverse * data->x1.colwise().homogeneous()).colwise().normalized(),
+      bearing2 = (K_inverse * data->x2.colwise().homogeneous()).colwise().normalized();
+    return ACRANSAC_Case(std::make_shared<KernelType>(
+      data->x1, bearing1, w, h,
+      data->x2, bearing2, w, h,
+      data->K, data->K));
+  });
+
+  // Geometric filtering of a pair with many outliers (as in main_ComputeMatches:
+  //  4 pixels precision upper bound), with and without PROSAC + SPRT
+  for (const bool b_scheduling : {false, true})
+  {
+    const std::string name = b_scheduling ?
+      "acransac/fundamental_7pt_outliers70_prosac_sprt" :
+      "acransac/fundamental_7pt_outliers70";
+    registry.Add(name, [b_scheduling](double scale)
+    {
+      using KernelType =
+        ACKernelAdaptor<
+          openMVG::fundamental::kernel::SevenPointSolver,
+          openMVG::fundamental::kernel::EpipolarDistanceError,
+          UnnormalizerT,
+          Mat3>;
+      const auto data = Two_View_Scene(scale, kHighOutlierRatio);
+      const int w = data->config._cx * 2, h = data->config._cy * 2;
+      ACRANSAC_Scheduling scheduling;
+      if (b_scheduling)
+      {
+        scheduling.quality_order = Quality_Order(*data, kHighOutlierRatio);
+        scheduling.b_sprt = true;
+      }
+      return ACRANSAC_Case(std::make_shared<KernelType>(
+        data->x1, w, h, data->x2, w, h, true), scheduling, Square(4.0));
+    });
+  }
+
+  // NFA scoring of the hypotheses of a 20k correspondences pair,
+  //  against the previous scoring (full sort, inliers listed on every better model)
+  for (const bool b_reference : {false, true})
+  {
+    using KernelType =
+      ACKernelAdaptor<
+        openMVG::fundamental::kernel::SevenPointSolver,
+        openMVG::fundamental::kernel::EpipolarDistanceError,
+        UnnormalizerT,
+        Mat3>;
+    const std::string suffix = b_reference ? "_reference" : "";
+    registry.Add("acransac/nfa_scoring_exhaustive" + suffix, [b_reference](double scale)
+    {
+      return NFA_Scoring_Case(Score_Uniform_Samples<KernelType>(scale),
+        std::numeric_limits<double>::infinity(), b_reference);
+    });
+    registry.Add("acransac/nfa_scoring_quantified" + suffix, [b_reference](double scale)
+    {
+      return NFA_Scoring_Case(Score_Uniform_Samples<KernelType>(scale),
+        Square(4.0), b_reference);
+    });
+  }
+
+  for (const bool b_batch : {false, true})
+  {
+    const std::string suffix = b_batch ? "_batch" : "";
+    registry.Add("minimal_solvers/essential_5pt" + suffix, [b_batch](double scale)
+    {
+      return Minimal_Solver_Case(Essential_5pt_Samples(scale), b_batch);
+    });
+    registry.Add("minimal_solvers/fundamental_8pt" + suffix, [b_batch](double scale)
+    {
+      return Minimal_Solver_Case(Fundamental_8pt_Samples(scale), b_batch);
+    });
+    registry.Add("minimal_solvers/p3p_kneip" + suffix, [b_batch](double scale)
+    {
+      return Minimal_Solver_Case(P3P_Samples(scale), b_batch);
+    });
+  }
+}
+
+} // namespace benchmark
+} // namespace openMVG
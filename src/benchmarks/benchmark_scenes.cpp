@@ -0,0 +1,165 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark_scenes.hpp"
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/image/image_drawing.hpp"
+#include "openMVG/image/image_filtering.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace openMVG {
+namespace benchmark {
+
+using namespace openMVG::image;
+using namespace openMVG::sfm;
+
+size_t Scaled
+(
+  const size_t value,
+  const double scale,
+  const size_t min_value
+)
+{
+  return std::max(min_value, static_cast<size_t>(std::round(value * scale)));
+}
+
+Image<unsigned char> Synthetic_Image
+(
+  const int width,
+  const int height,
+  const unsigned int seed
+)
+{
+  std::mt19937 random_generator(seed);
+  std::uniform_int_distribution<int> x_distribution(0, width - 1);
+  std::uniform_int_distribution<int> y_distribution(0, height - 1);
+  std::uniform_int_distribution<int> radius_distribution(2, 24);
+  std::uniform_int_distribution<int> color_distribution(0, 255);
+
+  Image<float> canvas(width, height, true, 127.f);
+  const int disk_count = width * height / 400;
+  for (int i = 0; i < disk_count; ++i)
+  {
+    FilledCircle(
+      x_distribution(random_generator),
+      y_distribution(random_generator),
+      radius_distribution(random_generator),
+      static_cast<float>(color_distribution(random_generator)),
+      &canvas);
+  }
+
+  Image<float> blurred;
+  ImageGaussianFilter(canvas, 1.5, blurred);
+
+  Image<unsigned char> image(width, height);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      image(y, x) = static_cast<unsigned char>(
+        std::min(255.f, std::max(0.f, blurred(y, x))));
+  return image;
+}
+
+void Synthetic_Descriptors
+(
+  const size_t count,
+  const size_t dimension,
+  std::vector<unsigned char> & database,
+  std::vector<unsigned char> & query,
+  const unsigned int seed
+)
+{
+  std::mt19937 random_generator(seed);
+  std::uniform_int_distribution<int> value_distribution(0, 255);
+  std::normal_distribution<float> noise_distribution(0.f, 8.f);
+
+  database.resize(count * dimension);
+  query.resize(count * dimension);
+  for (size_t i = 0; i < database.size(); ++i)
+  {
+    database[i] = static_cast<unsigned char>(value_distribution(random_generator));
+    const float noisy = database[i] + noise_distribution(random_generator);
+    query[i] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, noisy)));
+  }
+  // Shuffle the query set, so the i-th query is not the i-th database entry
+  std::vector<size_t> permutation(count);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::shuffle(permutation.begin(), permutation.end(), random_generator);
+  std::vector<unsigned char> shuffled(query.size());
+  for (size_t i = 0; i < count; ++i)
+    std::copy_n(query.cbegin() + permutation[i] * dimension, dimension,
+                shuffled.begin() + i * dimension);
+  query.swap(shuffled);
+}
+
+matching::PairWiseMatches Synthetic_Matches
+(
+  const NViewDataSet & dataset,
+  const size_t pair_window
+)
+{
+  matching::PairWiseMatches matches;
+  for (IndexT i = 0; i < dataset._n; ++i)
+  {
+    for (IndexT j = i + 1; j < std::min<size_t>(dataset._n, i + 1 + pair_window); ++j)
+    {
+      matching::IndMatches & pair_matches = matches[{i, j}];
+      pair_matches.reserve(dataset._x[i].cols());
+      for (Mat2X::Index k = 0; k < dataset._x[i].cols(); ++k)
+        pair_matches.emplace_back(k, k);
+    }
+  }
+  return matches;
+}
+
+SfM_Data Synthetic_SfM_Data
+(
+  const NViewDataSet & dataset,
+  const nViewDatasetConfigurator & config,
+  const double noise_stddev,
+  const unsigned int seed
+)
+{
+  std::mt19937 random_generator(seed);
+  std::normal_distribution<double> noise_distribution(0.0, noise_stddev);
+
+  SfM_Data sfm_data;
+  const IndexT view_count = static_cast<IndexT>(dataset._n);
+  for (IndexT i = 0; i < view_count; ++i)
+  {
+    sfm_data.views[i] = std::make_shared<View>
+      ("", i, 0, i, config._cx * 2, config._cy * 2);
+    sfm_data.poses[i] = geometry::Pose3(dataset._R[i], dataset._C[i]);
+  }
+  sfm_data.intrinsics[0] = std::make_shared<cameras::Pinhole_Intrinsic>
+    (config._cx * 2, config._cy * 2, config._fx, config._cx, config._cy);
+
+  for (Mat3X::Index i = 0; i < dataset._X.cols(); ++i)
+  {
+    Landmark landmark;
+    landmark.X = dataset._X.col(i)
+      + Vec3(noise_distribution(random_generator),
+             noise_distribution(random_generator),
+             noise_distribution(random_generator)) / 100.0;
+    for (IndexT j = 0; j < view_count; ++j)
+    {
+      const Vec2 pt = dataset._x[j].col(i)
+        + Vec2(noise_distribution(random_generator), noise_distribution(random_generator));
+      landmark.obs[j] = Observation(pt, i);
+    }
+    sfm_data.structure[i] = landmark;
+  }
+  return sfm_data;
+}
+
+} // namespace benchmark
+} // namespace openMVG
@@ -0,0 +1,78 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_BENCHMARKS_BENCHMARK_SCENES_HPP
+#define OPENMVG_BENCHMARKS_BENCHMARK_SCENES_HPP
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include <vector>
+
+// Deterministic synthetic data used by the benchmarks.
+// All the generators are seeded, so two runs work on the same data.
+
+namespace openMVG {
+namespace benchmark {
+
+/// Scale a problem size, keeping at least min_value elements
+size_t Scaled(size_t value, double scale, size_t min_value = 1);
+
+/// Textured image made of blurred random disks (features friendly)
+image::Image<unsigned char> Synthetic_Image
+(
+  int width,
+  int height,
+  unsigned int seed = 0
+);
+
+/**
+* @brief Random descriptors and a noisy copy of them (the query set).
+* @param[in] count #descriptors
+* @param[in] dimension descriptor length
+* @param[out] database the random descriptors (count x dimension)
+* @param[out] query the perturbed descriptors (count x dimension)
+*/
+void Synthetic_Descriptors
+(
+  size_t count,
+  size_t dimension,
+  std::vector<unsigned char> & database,
+  std::vector<unsigned char> & query,
+  unsigned int seed = 0
+);
+
+/// Pairwise matches of all the view pairs of a dataset (i.e. ground truth matches)
+matching::PairWiseMatches Synthetic_Matches
+(
+  const NViewDataSet & dataset,
+  size_t pair_window
+);
+
+/**
+* @brief Translate a synthetic dataset into a SfM_Data scene
+*  (shared pinhole intrinsic, all the points seen by all the views).
+* @param dataset the synthetic dataset
+* @param config the dataset camera configuration
+* @param noise_stddev gaussian noise added to the observations (pixels)
+*  and to the structure (world unit / 100)
+*/
+sfm::SfM_Data Synthetic_SfM_Data
+(
+  const NViewDataSet & dataset,
+  const nViewDatasetConfigurator & config,
+  double noise_stddev,
+  unsigned int seed = 0
+);
+
+} // namespace benchmark
+} // namespace openMVG
+
+#endif // OPENMVG_BENCHMARKS_BENCHMARK_SCENES_HPP
@@ -0,0 +1,134 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+#include "benchmarks/benchmark_scenes.hpp"
+
+#include "openMVG/multiview/triangulation_nview.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/tracks/tracks.hpp"
+
+#include <memory>
+
+namespace openMVG {
+namespace benchmark {
+
+using namespace openMVG::sfm;
+
+namespace {
+
+// Scene size at scale 1
+const size_t kViewCount = 16;
+const size_t kPointCount = 1000;
+
+} // namespace
+
+void Register_SfM_Benchmarks(Benchmark_Registry & registry)
+{
+  // Track building from the matches of the 4 next views of each view
+  registry.Add("tracks/TracksBuilder", [](double scale)
+  {
+    const NViewDataSet dataset = NRealisticCamerasRing(
+      Scaled(kViewCount, scale, 3), Scaled(kPointCount * 4, scale, 16));
+    const auto matches = std::make_shared<matching::PairWiseMatches>(
+      Synthetic_Matches(dataset, 4));
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [matches]
+    {
+      tracks::TracksBuilder tracks_builder;
+      tracks_builder.Build(*matches);
+      tracks_builder.Filter();
+      tracks::STLMAPTracks map_tracks;
+      tracks_builder.ExportToSTL(map_tracks);
+      Do_Not_Optimize(map_tracks.size());
+    };
+    return benchmark_case;
+  });
+
+  // Linear N-view triangulation of all the points
+  registry.Add("triangulation/TriangulateNView", [](double scale)
+  {
+    const auto dataset = std::make_shared<NViewDataSet>(NRealisticCamerasRing(
+      Scaled(kViewCount, scale, 2), Scaled(kPointCount, scale, 16)));
+    auto Ps = std::make_shared<std::vector<Mat34>>();
+    for (size_t i = 0; i < dataset->_n; ++i)
+      Ps->push_back(dataset->P(i));
+
+    Benchmark_Case benchmark_case;
+    benchmark_case.run = [dataset, Ps]
+    {
+      Mat3X x(3, dataset->_n);
+      Vec4 X;
+      for (Mat3X::Index j = 0; j < dataset->_X.cols(); ++j)
+      {
+        for (size_t i = 0; i < dataset->_n; ++i)
+          x.col(i) = dataset->_x[i].col(j).homogeneous();
+        TriangulateNView(x, *Ps, &X);
+        Do_Not_Optimize(X);
+      }
+    };
+    return benchmark_case;
+  });
+
+  // Robust triangulation of a SfM_Data scene (the structure is restored before each run)
+  registry.Add("triangulation/SfM_Data_Structure_Computation_Robust", [](double scale)
+  {
+    const nViewDatasetConfigurator config;
+    const NViewDataSet dataset = NRealisticCamerasRing(
+      Scaled(kViewCount, scale, 3), Scaled(kPointCount, scale, 16), config);
+    const auto initial_scene = std::make_shared<SfM_Data>(
+      Synthetic_SfM_Data(dataset, config, 0.5));
+    const auto scene = std::make_shared<SfM_Data>();
+
+    Benchmark_Case benchmark_case;
+    benchmark_case.reset = [initial_scene, scene]
+    {
+      *scene = *initial_scene;
+    };
+    benchmark_case.run = [scene]
+    {
+      const SfM_Data_Structure_Computation_Robust structure_estimator;
+      structure_estimator.triangulate(*scene);
+      Do_Not_Optimize(scene->structure.size());
+    };
+    return benchmark_case;
+  });
+
+  // Bundle adjustment of a noisy scene (the scene is restored before each run)
+  registry.Add("bundle_adjustment/Bundle_Adjustment_Ceres", [](double scale)
+  {
+    const nViewDatasetConfigurator config;
+    const NViewDataSet dataset = NRealisticCamerasRing(
+      Scaled(kViewCount, scale, 3), Scaled(kPointCount, scale, 16), config);
+    const auto initial_scene = std::make_shared<SfM_Data>(
+      Synthetic_SfM_Data(dataset, config, 0.5));
+    const auto scene = std::make_shared<SfM_Data>();
+
+    Benchmark_Case benchmark_case;
+    benchmark_case.reset = [initial_scene, scene]
+    {
+      *scene = *initial_scene;
+    };
+    benchmark_case.run = [scene]
+    {
+      Bundle_Adjustment_Ceres bundle_adjustment_obj(
+        Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+      const bool b_adjusted = bundle_adjustment_obj.Adjust(*scene,
+        Optimize_Options(
+          cameras::Intrinsic_Parameter_Type::ADJUST_ALL,
+          Extrinsic_Parameter_Type::ADJUST_ALL,
+          Structure_Parameter_Type::ADJUST_ALL));
+      Do_Not_Optimize(b_adjusted);
+    };
+    return benchmark_case;
+  });
+}
+
+} // namespace benchmark
+} // namespace openMVG
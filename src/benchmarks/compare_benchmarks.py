@@ -0,0 +1,65 @@
+#!/usr/bin/python
+#! -*- encoding: utf-8 -*-
+
+# This file is part of OpenMVG (Open Multiple View Geometry) C++ library.
+#
+# Compare two openMVG_benchmarks result files and flag the slowdowns.
+#
+# usage : python compare_benchmarks.py baseline.json contender.json [--threshold 0.1] [--metric median]
+#
+# A benchmark is flagged as SLOWER if its contender time is greater than
+# (1 + threshold) * baseline time. The script returns 1 if a slowdown is found.
+
+import argparse
+import json
+import sys
+
+def load_results(filename):
+  with open(filename) as f:
+    data = json.load(f)
+  return data.get("context", {}), dict((b["name"], b) for b in data["benchmarks"])
+
+def main():
+  parser = argparse.ArgumentParser(description="Compare two openMVG_benchmarks result files.")
+  parser.add_argument("baseline", help="reference JSON result file")
+  parser.add_argument("contender", help="JSON result file to compare to the baseline")
+  parser.add_argument("--threshold", type=float, default=0.1,
+                      help="relative time increase considered as a slowdown (default: 0.1)")
+  parser.add_argument("--metric", default="median",
+                      choices=["min", "mean", "median", "p90", "p99"],
+                      help="compared timing statistic (default: median)")
+  args = parser.parse_args()
+
+  baseline_context, baseline = load_results(args.baseline)
+  contender_context, contender = load_results(args.contender)
+
+  if baseline_context.get("scale") != contender_context.get("scale"):
+    print("Warning: the result files were computed with different scales (%s vs %s)"
+          % (baseline_context.get("scale"), contender_context.get("scale")))
+
+  print("%-56s %12s %12s %9s" % ("name", "baseline", "contender", "change"))
+  slowdowns = []
+  for name in sorted(set(baseline) | set(contender)):
+    if name not in baseline or name not in contender:
+      print("%-56s %s" % (name, "only in baseline" if name in baseline else "only in contender"))
+      continue
+    old = baseline[name][args.metric]
+    new = contender[name][args.metric]
+    change = (new - old) / old if old > 0 else 0.0
+    status = ""
+    if change > args.threshold:
+      status = "SLOWER"
+      slowdowns.append(name)
+    elif change < -args.threshold:
+      status = "faster"
+    print("%-56s %12.3f %12.3f %+8.1f%% %s" % (name, old, new, 100.0 * change, status))
+
+  if slowdowns:
+    print("\n%d slowdown(s) greater than %.1f%% (%s):" % (len(slowdowns), 100.0 * args.threshold, args.metric))
+    for name in slowdowns:
+      print("  " + name)
+    return 1
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main())
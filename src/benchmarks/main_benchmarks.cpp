@@ -0,0 +1,109 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "benchmarks/benchmark.hpp"
+
+#include "third_party/cmdLine/cmdLine.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace openMVG::benchmark;
+
+// Run the openMVG micro and macro benchmarks on synthetic data.
+// Use compare_benchmarks.py to compare two JSON result files.
+int main(int argc, char **argv)
+{
+  CmdLine cmd;
+
+  Benchmark_Options options;
+  std::string sOutputFile = "";
+  bool bList = false;
+
+  cmd.add( make_option('o', sOutputFile, "output_file") );
+  cmd.add( make_option('w', options.warmup, "warmup") );
+  cmd.add( make_option('r', options.repetitions, "repetitions") );
+  cmd.add( make_option('s', options.scale, "scale") );
+  cmd.add( make_option('f', options.filter, "filter") );
+  cmd.add( make_switch('l', "list") );
+
+  try {
+    cmd.process(argc, argv);
+  } catch (const std::string& s) {
+    std::cerr << "Usage: " << argv[0] << '\n'
+    << "[Optional]\n"
+    << "[-o|--output_file] JSON file where the results will be stored\n"
+    << "[-w|--warmup] #untimed runs before the measurements (default: 2)\n"
+    << "[-r|--repetitions] #timed runs (default: 10)\n"
+    << "[-s|--scale] problem size multiplier (default: 1.0)\n"
+    << "[-f|--filter] run only the benchmarks whose name contains this string\n"
+    << "[-l|--list] list the available benchmarks\n"
+    << std::endl;
+
+    std::cerr << s << std::endl;
+    return EXIT_FAILURE;
+  }
+  bList = cmd.used('l');
+
+  if (options.repetitions < 1 || options.warmup < 0 || options.scale <= 0.0)
+  {
+    std::cerr << "Invalid repetitions, warmup or scale value." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Benchmark_Registry registry;
+  Register_Features_Benchmarks(registry);
+  Register_Matching_Benchmarks(registry);
+  Register_Robust_Estimation_Benchmarks(registry);
+  Register_SfM_Benchmarks(registry);
+
+  if (bList)
+  {
+    for (const auto & benchmark : registry.Benchmarks())
+      std::cout << benchmark.first << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout
+    << "Benchmarks (warmup: " << options.warmup
+    << ", repetitions: " << options.repetitions
+    << ", scale: " << options.scale << ")\n"
+    << std::left << std::setw(56) << "name" << std::right
+    << std::setw(12) << "median(ms)" << std::setw(12) << "p90(ms)"
+    << std::setw(12) << "min(ms)" << std::setw(12) << "stddev" << std::endl;
+
+  std::vector<Benchmark_Result> results;
+  for (const auto & benchmark : registry.Benchmarks())
+  {
+    if (!options.filter.empty() &&
+        benchmark.first.find(options.filter) == std::string::npos)
+      continue;
+
+    const Benchmark_Result result = Run(benchmark.first, benchmark.second, options);
+    std::cout
+      << std::left << std::setw(56) << result.name << std::right
+      << std::fixed << std::setprecision(3)
+      << std::setw(12) << result.median << std::setw(12) << result.p90
+      << std::setw(12) << result.min << std::setw(12) << result.stddev << std::endl;
+    results.push_back(result);
+  }
+
+  if (!sOutputFile.empty())
+  {
+    if (!Export_JSON(results, options, sOutputFile))
+    {
+      std::cerr << "Cannot write the result file: " << sOutputFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Results saved to: " << sOutputFile << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,260 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORT_MAP_HPP
+#define OPENMVG_CAMERAS_CAMERA_UNDISTORT_MAP_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/pixel_types.hpp"
+#include "openMVG/image/sample.hpp"
+
+namespace openMVG
+{
+namespace cameras
+{
+
+namespace internal
+{
+// Number of unsigned char channels of a pixel type (0 for the other pixel types)
+template <typename T> struct UChar_Channels : std::integral_constant<int, 0> {};
+template <> struct UChar_Channels<unsigned char> : std::integral_constant<int, 1> {};
+template <> struct UChar_Channels<image::Rgb<unsigned char>> : std::integral_constant<int, 3> {};
+template <> struct UChar_Channels<image::Rgba<unsigned char>> : std::integral_constant<int, 4> {};
+} // namespace internal
+
+/**
+* @brief Precomputed undistortion remap table of a camera.
+*
+* UndistortImage calls the (virtual and sometimes iterative) get_d_pixel
+* function for every pixel of every image. Since the views that share an
+* intrinsic share the same mapping, this class computes it once and stores for
+* each undistorted pixel the offset of its top-left source pixel and its
+* bilinear weights in 8 bit fixed point.
+* Applying the map to an 8 bit image is then done with integer arithmetic only
+* (the result matches UndistortImage up to the weight quantization).
+*/
+class UndistortionMap
+{
+public:
+
+  UndistortionMap() = default;
+
+  /**
+  * @brief Build the map of a camera for the images of the given size
+  * @param cam Intrinsic parameter used to undistort the images
+  * @param width Image width
+  * @param height Image height
+  */
+  UndistortionMap
+  (
+    const IntrinsicBase * cam,
+    int width,
+    int height
+  )
+  {
+    Build(cam, width, height);
+  }
+
+  /**
+  * @brief Build the map of a camera for the images of the given size
+  * @param cam Intrinsic parameter used to undistort the images
+  * @param width Image width
+  * @param height Image height
+  * @return false if the map cannot be built (image smaller than 2x2)
+  */
+  bool Build
+  (
+    const IntrinsicBase * cam,
+    int width,
+    int height
+  )
+  {
+    entries_.clear();
+    width_ = height_ = 0;
+    if (!cam || width < 2 || height < 2)
+      return false;
+
+    width_ = width;
+    height_ = height;
+    entries_.resize(static_cast<size_t>(width) * height);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for ( int j = 0; j < height; ++j )
+    {
+      Entry * entry = &entries_[static_cast<size_t>(j) * width];
+      for ( int i = 0; i < width; ++i, ++entry )
+      {
+        // compute coordinates with distortion
+        const Vec2 disto_pix = cam->get_d_pixel( Vec2( i, j ) );
+        const double x = disto_pix( 0 ), y = disto_pix( 1 );
+        // keep the pixel if it is in the image domain (same test as UndistortImage)
+        if ( !std::isfinite( x ) || !std::isfinite( y ) ||
+             x <= -1.0 || y <= -1.0 || x >= width || y >= height )
+        {
+          entry->offset = -1;
+          continue;
+        }
+        // Top-left pixel of the bilinear neighborhood and its weights.
+        // On the image border the neighborhood is shifted inside the image
+        // with a full weight on the valid pixel, so the 4 reads are always valid
+        // (it gives the same result as the weight normalization of the sampler).
+        int x0 = static_cast<int>( std::floor( x ) ), y0 = static_cast<int>( std::floor( y ) );
+        int wx = static_cast<int>( ( x - x0 ) * kWeightOne + 0.5 );
+        int wy = static_cast<int>( ( y - y0 ) * kWeightOne + 0.5 );
+        if ( x0 < 0 ) { x0 = 0; wx = 0; }
+        if ( y0 < 0 ) { y0 = 0; wy = 0; }
+        if ( x0 >= width - 1 ) { x0 = width - 2; wx = kWeightOne; }
+        if ( y0 >= height - 1 ) { y0 = height - 2; wy = kWeightOne; }
+        entry->offset = y0 * width + x0;
+        entry->wx = static_cast<uint16_t>( wx );
+        entry->wy = static_cast<uint16_t>( wy );
+      }
+    }
+    return true;
+  }
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+
+  /**
+  * @brief Undistort an image with the precomputed map
+  * @param imageIn Input image
+  * @param[out] image_ud Output undistorted image
+  * @param fillcolor color used to fill pixels where no input pixel is found
+  * @return false if the image size does not correspond to the map size
+  */
+  template <typename Image>
+  bool Apply
+  (
+    const Image & imageIn,
+    Image & image_ud,
+    typename Image::Tpixel fillcolor = typename Image::Tpixel( 0 )
+  ) const
+  {
+    using Pixel = typename Image::Tpixel;
+    if ( imageIn.Width() != width_ || imageIn.Height() != height_ || entries_.empty() )
+      return false;
+
+    image_ud.resize( width_, height_, false );
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for ( int j = 0; j < height_; ++j )
+    {
+      ApplyRow( imageIn, j, &image_ud( j, 0 ), fillcolor,
+        std::integral_constant<bool, internal::UChar_Channels<Pixel>::value != 0>() );
+    }
+    return true;
+  }
+
+private:
+
+  static const int kWeightBits = 8;
+  static const int kWeightOne = 1 << kWeightBits;
+
+  struct Entry
+  {
+    int32_t offset; // Index of the top-left source pixel (-1 if outside)
+    uint16_t wx, wy; // Horizontal and vertical weights of the right/bottom pixels
+  };
+
+  /// Fixed point bilinear sampling of a row (unsigned char channels)
+  template <typename Image>
+  void ApplyRow
+  (
+    const Image & imageIn,
+    int row,
+    typename Image::Tpixel * out,
+    const typename Image::Tpixel & fillcolor,
+    std::true_type
+  ) const
+  {
+    using Pixel = typename Image::Tpixel;
+    const int channels = internal::UChar_Channels<Pixel>::value;
+    const unsigned char * src = reinterpret_cast<const unsigned char*>( imageIn.data() );
+    unsigned char * dst = reinterpret_cast<unsigned char*>( out );
+    const unsigned char * fill = reinterpret_cast<const unsigned char*>( &fillcolor );
+    const size_t stride = static_cast<size_t>( width_ ) * channels;
+    const Entry * entry = &entries_[static_cast<size_t>( row ) * width_];
+    for ( int i = 0; i < width_; ++i, ++entry, dst += channels )
+    {
+      if ( entry->offset < 0 )
+      {
+        for ( int c = 0; c < channels; ++c )
+          dst[c] = fill[c];
+        continue;
+      }
+      const uint32_t
+        wx = entry->wx, wy = entry->wy,
+        w00 = ( kWeightOne - wx ) * ( kWeightOne - wy ),
+        w01 = wx * ( kWeightOne - wy ),
+        w10 = ( kWeightOne - wx ) * wy,
+        w11 = wx * wy;
+      const unsigned char * p0 = src + static_cast<size_t>( entry->offset ) * channels;
+      const unsigned char * p1 = p0 + stride;
+      for ( int c = 0; c < channels; ++c )
+      {
+        const uint32_t value =
+          w00 * p0[c] + w01 * p0[c + channels] +
+          w10 * p1[c] + w11 * p1[c + channels];
+        dst[c] = static_cast<unsigned char>(
+          ( value + ( 1u << ( 2 * kWeightBits - 1 ) ) ) >> ( 2 * kWeightBits ) );
+      }
+    }
+  }
+
+  /// Generic bilinear sampling of a row (other pixel types)
+  template <typename Image>
+  void ApplyRow
+  (
+    const Image & imageIn,
+    int row,
+    typename Image::Tpixel * out,
+    const typename Image::Tpixel & fillcolor,
+    std::false_type
+  ) const
+  {
+    using Pixel = typename Image::Tpixel;
+    using RealPixel = image::RealPixel<Pixel>;
+    const Entry * entry = &entries_[static_cast<size_t>( row ) * width_];
+    for ( int i = 0; i < width_; ++i, ++entry, ++out )
+    {
+      if ( entry->offset < 0 )
+      {
+        *out = fillcolor;
+        continue;
+      }
+      const int x0 = entry->offset % width_, y0 = entry->offset / width_;
+      const double
+        wx = entry->wx / static_cast<double>( kWeightOne ),
+        wy = entry->wy / static_cast<double>( kWeightOne );
+      const typename RealPixel::real_type value =
+        RealPixel::convert_to_real( imageIn( y0, x0 ) ) * ( ( 1.0 - wx ) * ( 1.0 - wy ) ) +
+        RealPixel::convert_to_real( imageIn( y0, x0 + 1 ) ) * ( wx * ( 1.0 - wy ) ) +
+        RealPixel::convert_to_real( imageIn( y0 + 1, x0 ) ) * ( ( 1.0 - wx ) * wy ) +
+        RealPixel::convert_to_real( imageIn( y0 + 1, x0 + 1 ) ) * ( wx * wy );
+      *out = RealPixel::convert_from_real( value );
+    }
+  }
+
+  int width_ = 0;
+  int height_ = 0;
+  std::vector<Entry> entries_;
+};
+
+} // namespace cameras
+} // namespace openMVG
+
+#endif // #ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORT_MAP_HPP
@@ -0,0 +1,126 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole_Brown.hpp"
+#include "openMVG/cameras/Camera_undistort_image.hpp"
+#include "openMVG/cameras/Camera_undistort_map.hpp"
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::image;
+
+namespace {
+
+const int kWidth = 160;
+const int kHeight = 120;
+
+// Smooth synthetic pattern (the fixed point weights are exact up to 1/256)
+double Pattern(int x, int y, int channel)
+{
+  return 127.5 + 120.0 * std::sin(0.11 * x + 0.7 * channel) * std::cos(0.07 * y);
+}
+
+} // namespace
+
+TEST(UndistortionMap, Gray_RGB_Match_UndistortImage) {
+
+  const Pinhole_Intrinsic_Brown_T2 cam(kWidth, kHeight, 150, kWidth / 2., kHeight / 2.,
+    // K1, K2, K3, T1, T2
+    -0.254, 0.114, 0.006, 0.001, -0.001);
+
+  Image<unsigned char> gray(kWidth, kHeight);
+  Image<RGBColor> rgb(kWidth, kHeight);
+  for (int y = 0; y < kHeight; ++y)
+    for (int x = 0; x < kWidth; ++x)
+    {
+      gray(y, x) = static_cast<unsigned char>(Pattern(x, y, 0));
+      rgb(y, x) = RGBColor(
+        static_cast<unsigned char>(Pattern(x, y, 0)),
+        static_cast<unsigned char>(Pattern(x, y, 1)),
+        static_cast<unsigned char>(Pattern(x, y, 2)));
+    }
+
+  const UndistortionMap undistortion_map(&cam, kWidth, kHeight);
+  EXPECT_EQ(kWidth, undistortion_map.Width());
+  EXPECT_EQ(kHeight, undistortion_map.Height());
+
+  // Gray image
+  {
+    Image<unsigned char> expected, undistorted;
+    UndistortImage(gray, &cam, expected, 0);
+    EXPECT_TRUE(undistortion_map.Apply(gray, undistorted, 0));
+    EXPECT_EQ(expected.Width(), undistorted.Width());
+    EXPECT_EQ(expected.Height(), undistorted.Height());
+    int max_difference = 0;
+    for (int y = 0; y < kHeight; ++y)
+      for (int x = 0; x < kWidth; ++x)
+        max_difference = std::max(max_difference,
+          std::abs(static_cast<int>(expected(y, x)) - static_cast<int>(undistorted(y, x))));
+    EXPECT_TRUE(max_difference <= 2);
+  }
+
+  // RGB image
+  {
+    Image<RGBColor> expected, undistorted;
+    UndistortImage(rgb, &cam, expected, BLACK);
+    EXPECT_TRUE(undistortion_map.Apply(rgb, undistorted, BLACK));
+    int max_difference = 0;
+    for (int y = 0; y < kHeight; ++y)
+      for (int x = 0; x < kWidth; ++x)
+        for (int c = 0; c < 3; ++c)
+          max_difference = std::max(max_difference,
+            std::abs(static_cast<int>(expected(y, x)(c)) - static_cast<int>(undistorted(y, x)(c))));
+    EXPECT_TRUE(max_difference <= 2);
+  }
+}
+
+TEST(UndistortionMap, Float_Generic_Path) {
+
+  const Pinhole_Intrinsic_Brown_T2 cam(kWidth, kHeight, 150, kWidth / 2., kHeight / 2.,
+    -0.254, 0.114, 0.006, 0.001, -0.001);
+
+  Image<float> image(kWidth, kHeight);
+  for (int y = 0; y < kHeight; ++y)
+    for (int x = 0; x < kWidth; ++x)
+      image(y, x) = static_cast<float>(Pattern(x, y, 0));
+
+  Image<float> expected, undistorted;
+  UndistortImage(image, &cam, expected, -1.f);
+  const UndistortionMap undistortion_map(&cam, kWidth, kHeight);
+  EXPECT_TRUE(undistortion_map.Apply(image, undistorted, -1.f));
+  for (int y = 0; y < kHeight; ++y)
+    for (int x = 0; x < kWidth; ++x)
+    {
+      // Same valid domain and close values
+      EXPECT_EQ(expected(y, x) == -1.f, undistorted(y, x) == -1.f);
+      EXPECT_NEAR(expected(y, x), undistorted(y, x), 1.0);
+    }
+}
+
+TEST(UndistortionMap, Size_Mismatch) {
+
+  const Pinhole_Intrinsic_Brown_T2 cam(kWidth, kHeight, 150, kWidth / 2., kHeight / 2.,
+    -0.254, 0.114, 0.006, 0.001, -0.001);
+  const UndistortionMap undistortion_map(&cam, kWidth, kHeight);
+
+  const Image<unsigned char> image(kWidth / 2, kHeight / 2);
+  Image<unsigned char> undistorted;
+  EXPECT_FALSE(undistortion_map.Apply(image, undistorted));
+
+  UndistortionMap empty_map;
+  EXPECT_FALSE(empty_map.Apply(image, undistorted));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -257,6 +257,93 @@ struct ConstraintBuilder_GainOffset
   const std::vector<size_t> & _vec_indexToFix;
 };
 
+/// Stack the gain & offset problems of several color channels into one block
+///  diagonal linear program. The channel blocks share no variable and the sum of
+///  the channel gamma variables is minimized, so each block of the solution is
+///  an optimal solution of its channel problem and a single solve is required.
+/// The variables of the channel c start at c * ChannelParameterCount().
+struct ConstraintBuilder_GainOffset_Channels
+{
+  ConstraintBuilder_GainOffset_Channels(
+    const std::vector<std::vector<relativeColorHistogramEdge>> & vec_relativeHistogramsPerChannel,
+    const std::vector<size_t> & vec_indexToFix):
+    _vec_relativePerChannel(vec_relativeHistogramsPerChannel),
+    _vec_indexToFix(vec_indexToFix)
+  {
+  }
+
+  /// Setup the stacked constraints in the LP_Constraints object.
+  bool Build(linearProgramming::LP_Constraints_Sparse & constraint)
+  {
+    std::vector<linearProgramming::LP_Constraints_Sparse> vec_channelConstraint(
+      _vec_relativePerChannel.size());
+    size_t nbRows = 0, nbParams = 0, nbNonZeros = 0;
+    for (size_t c = 0; c < _vec_relativePerChannel.size(); ++c)
+    {
+      ConstraintBuilder_GainOffset cstBuilder(_vec_relativePerChannel[c], _vec_indexToFix);
+      if (!cstBuilder.Build(vec_channelConstraint[c]))
+        return false;
+      if (c > 0 && vec_channelConstraint[c].nbParams_ != vec_channelConstraint[0].nbParams_)
+        return false;
+      nbRows += vec_channelConstraint[c].constraint_mat_.rows();
+      nbParams += vec_channelConstraint[c].nbParams_;
+      nbNonZeros += vec_channelConstraint[c].constraint_mat_.nonZeros();
+    }
+
+    std::vector<Eigen::Triplet<double>> vec_triplets;
+    vec_triplets.reserve(nbNonZeros);
+    constraint.constraint_objective_.resize(nbRows);
+    constraint.vec_sign_.clear();
+    constraint.vec_bounds_.clear();
+    constraint.vec_cost_.clear();
+    size_t rowOffset = 0, colOffset = 0;
+    for (const linearProgramming::LP_Constraints_Sparse & channel : vec_channelConstraint)
+    {
+      const sRMat & A = channel.constraint_mat_;
+      for (int i = 0; i < A.rows(); ++i)
+      {
+        for (sRMat::InnerIterator it(A, i); it; ++it)
+          vec_triplets.emplace_back(rowOffset + i, colOffset + it.col(), it.value());
+      }
+      constraint.constraint_objective_.segment(rowOffset, A.rows()) = channel.constraint_objective_;
+      constraint.vec_sign_.insert(constraint.vec_sign_.end(),
+        channel.vec_sign_.begin(), channel.vec_sign_.end());
+      constraint.vec_bounds_.insert(constraint.vec_bounds_.end(),
+        channel.vec_bounds_.begin(), channel.vec_bounds_.end());
+      constraint.vec_cost_.insert(constraint.vec_cost_.end(),
+        channel.vec_cost_.begin(), channel.vec_cost_.end());
+      rowOffset += A.rows();
+      colOffset += channel.nbParams_;
+    }
+    constraint.constraint_mat_.resize(nbRows, nbParams);
+    constraint.constraint_mat_.setFromTriplets(vec_triplets.begin(), vec_triplets.end());
+
+    // it's a minimization problem over the sum of the gamma variables
+    constraint.bminimize_ = true;
+    constraint.nbParams_ = nbParams;
+    return true;
+  }
+
+  /// Number of variables of a channel block
+  size_t ChannelParameterCount() const
+  {
+    std::set<size_t> countSet;
+    if (!_vec_relativePerChannel.empty())
+    {
+      for (const relativeColorHistogramEdge & edge : _vec_relativePerChannel[0])
+      {
+        countSet.insert(edge.I);
+        countSet.insert(edge.J);
+      }
+    }
+    return countSet.size() * 2 + 1;
+  }
+
+  // Internal data
+  const std::vector<std::vector<relativeColorHistogramEdge>> & _vec_relativePerChannel;
+  const std::vector<size_t> & _vec_indexToFix;
+};
+
 
 } // namespace lInfinity
 } // namespace openMVG
@@ -195,6 +195,72 @@ TEST(ColorHarmonisation, Offset_gain) {
   htmlFileStream << _htmlDocStream.getDoc();
 }
 
+// The three color channels solved as one block diagonal linear program must
+//  give the solutions of the per channel linear programs
+TEST(ColorHarmonisation, Stacked_channels) {
+
+  Histogram<double> histo_ref( 0, 256, 255);
+  Histogram<double> histo_offset( 0, 256, 255);
+  Histogram<double> histo_gain( 0, 256, 255);
+  for (size_t i=0; i < 10000; i++)
+  {
+    const double val = normal_distribution(127, 10)();
+    histo_ref.Add(val);
+    histo_offset.Add(val + 20);
+    histo_gain.Add((val-127) * 2.0 + 127);
+  }
+
+  //-- One problem per channel with the same graph (3 images)
+  std::vector<std::vector<relativeColorHistogramEdge>> vec_relativeHistograms(3);
+  vec_relativeHistograms[0].push_back(relativeColorHistogramEdge(0,1, histo_ref.GetHist(), histo_offset.GetHist()));
+  vec_relativeHistograms[0].push_back(relativeColorHistogramEdge(1,2, histo_offset.GetHist(), histo_ref.GetHist()));
+  vec_relativeHistograms[1].push_back(relativeColorHistogramEdge(0,1, histo_ref.GetHist(), histo_gain.GetHist()));
+  vec_relativeHistograms[1].push_back(relativeColorHistogramEdge(1,2, histo_gain.GetHist(), histo_gain.GetHist()));
+  vec_relativeHistograms[2].push_back(relativeColorHistogramEdge(0,1, histo_ref.GetHist(), histo_ref.GetHist()));
+  vec_relativeHistograms[2].push_back(relativeColorHistogramEdge(1,2, histo_ref.GetHist(), histo_offset.GetHist()));
+  const std::vector<size_t> vec_indexToFix(1,0);
+
+  ConstraintBuilder_GainOffset_Channels stackedBuilder(vec_relativeHistograms, vec_indexToFix);
+  const size_t nbChannelParams = stackedBuilder.ChannelParameterCount();
+  EXPECT_EQ(static_cast<size_t>(3 * 2 + 1), nbChannelParams);
+
+  LP_Constraints_Sparse stackedConstraint;
+  EXPECT_TRUE(stackedBuilder.Build(stackedConstraint));
+  EXPECT_EQ(static_cast<int>(3 * nbChannelParams), stackedConstraint.nbParams_);
+
+  std::vector<double> vec_stackedSolution(3 * nbChannelParams);
+  {
+    OSI_CLP_SolverWrapper lpSolver(vec_stackedSolution.size());
+    EXPECT_TRUE(lpSolver.setup(stackedConstraint));
+    EXPECT_TRUE(lpSolver.solve());
+    lpSolver.getSolution(vec_stackedSolution);
+  }
+
+  size_t rowOffset = 0;
+  for (size_t c = 0; c < 3; ++c)
+  {
+    ConstraintBuilder_GainOffset cstBuilder(vec_relativeHistograms[c], vec_indexToFix);
+    LP_Constraints_Sparse constraint;
+    cstBuilder.Build(constraint);
+
+    // The channel block of the stacked problem is the channel problem
+    const sRMat block = stackedConstraint.constraint_mat_.block(
+      rowOffset, c * nbChannelParams, constraint.constraint_mat_.rows(), nbChannelParams);
+    EXPECT_NEAR(0.0, (Mat(block) - Mat(constraint.constraint_mat_)).norm(), 1e-12);
+    rowOffset += constraint.constraint_mat_.rows();
+
+    std::vector<double> vec_solution(nbChannelParams);
+    OSI_CLP_SolverWrapper lpSolver(vec_solution.size());
+    lpSolver.setup(constraint);
+    lpSolver.solve();
+    lpSolver.getSolution(vec_solution);
+
+    // Same optimal L infinity fitting error
+    EXPECT_NEAR(vec_solution.back(), vec_stackedSolution[(c + 1) * nbChannelParams - 1], 1e-6);
+  }
+  EXPECT_EQ(rowOffset, static_cast<size_t>(stackedConstraint.constraint_mat_.rows()));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -9,10 +9,12 @@
 #ifndef OPENMVG_COLOR_HARMONIZATION_SELECTION_VLDSEGMENT_HPP
 #define OPENMVG_COLOR_HARMONIZATION_SELECTION_VLDSEGMENT_HPP
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "openMVG/color_harmonization/selection_interface.hpp"
+#include "openMVG/image/image_io.hpp"
 #include "openMVG/matching/kvld/kvld.h"
 #include "openMVG/matching/kvld/kvld_draw.h"
 
@@ -26,16 +28,18 @@ class commonDataByPair_VLDSegment  : public commonDataByPair
                                const std::string & sRightImage,
                                const std::vector<matching::IndMatch>& vec_PutativeMatches,
                                const std::vector<features::SIOPointFeature >& vec_featsL,
-                               const std::vector<features::SIOPointFeature >& vec_featsR):
+                               const std::vector<features::SIOPointFeature >& vec_featsR,
+                               ImageScaleCache * scaleCache = nullptr):
            commonDataByPair( sLeftImage, sRightImage ),
            _vec_featsL( vec_featsL ), _vec_featsR( vec_featsR ),
-           _vec_PutativeMatches( vec_PutativeMatches )
+           _vec_PutativeMatches( vec_PutativeMatches ),
+           _scaleCache( scaleCache )
   {}
 
   ~commonDataByPair_VLDSegment() override = default;
 
   /**
-   * Put masks to white, images are conserved
+   * Draw the K-VLD consistent segments in the masks
    *
    * \param[out] maskLeft Mask of the left image (initialized to corresponding image size).
    * \param[out] maskRight  Mask of the right image (initialized to corresponding image size).
@@ -46,14 +50,16 @@ class commonDataByPair_VLDSegment  : public commonDataByPair
     image::Image<unsigned char> & maskLeft,
     image::Image<unsigned char> & maskRight ) override
   {
-    std::vector<matching::IndMatch> vec_KVLDMatches;
-
-    image::Image<unsigned char> imageL, imageR;
-    image::ReadImage( _sLeftImage.c_str(), &imageL );
-    image::ReadImage( _sRightImage.c_str(), &imageR );
-
-    image::Image<float> imgA ( imageL.GetMat().cast<float>() );
-    image::Image<float> imgB(imageR.GetMat().cast<float>());
+    // Pyramids of scale images (built once for all the KVLD iterations,
+    //  and shared with the other pairs of the images if a cache is provided)
+    const std::shared_ptr<const ImageScale> scaleL = getImageScale( _sLeftImage );
+    const std::shared_ptr<const ImageScale> scaleR = getImageScale( _sRightImage );
+    if (!scaleL || !scaleR)
+    {
+      maskLeft.fill( 0 );
+      maskRight.fill( 0 );
+      return false;
+    }
 
     std::vector<Pair> matchesFiltered, matchesPair;
 
@@ -76,7 +82,7 @@ class commonDataByPair_VLDSegment  : public commonDataByPair
       it_num < 5 &&
       kvldparameters.inlierRate >
       KVLD(
-        imgA, imgB,
+        *scaleL, *scaleR,
         _vec_featsL, _vec_featsR,
         matchesPair, matchesFiltered,
         vec_score, E, valide, kvldparameters ) )
@@ -109,10 +115,33 @@ class commonDataByPair_VLDSegment  : public commonDataByPair
   }
 
 private:
+
+  /// Pyramid of scale images of an image (read from the cache if any)
+  std::shared_ptr<const ImageScale> getImageScale( const std::string & sImage ) const
+  {
+    const auto loader = [&sImage]( image::Image<float> & image )
+    {
+      image::Image<unsigned char> imageGray;
+      if (!image::ReadImage( sImage.c_str(), &imageGray ))
+        return false;
+      image = image::Image<float>( imageGray.GetMat().cast<float>() );
+      return true;
+    };
+    if (_scaleCache)
+      return _scaleCache->get( sImage, loader );
+
+    image::Image<float> image;
+    if (!loader( image ))
+      return nullptr;
+    return std::make_shared<ImageScale>( image );
+  }
+
   // Left and Right features
   std::vector<features::SIOPointFeature > _vec_featsL, _vec_featsR;
   // Left and Right corresponding index (putatives matches)
   std::vector<matching::IndMatch> _vec_PutativeMatches;
+  // Optional cache of the pyramids of scale images
+  ImageScaleCache * _scaleCache;
 };
 
 }  // namespace color_harmonization
@@ -9,7 +9,10 @@
 #ifndef OPENMVG_COLOR_HARMONIZATION_SELECTION_INTERFACE_HPP
 #define OPENMVG_COLOR_HARMONIZATION_SELECTION_INTERFACE_HPP
 
+#include <algorithm>
+#include <array>
 #include <string>
+#include <vector>
 
 #include "openMVG/image/image_container.hpp"
 #include "third_party/histogram/histogram.hpp"
@@ -65,6 +68,66 @@ public:
     }
   }
 
+  /// Selected pixels of a mask stored as runs of consecutive pixels of a row:
+  ///  (row, first column, last column + 1)
+  using MaskRuns = std::vector<std::array<int, 3>>;
+
+  /**
+   * Run-length encode a mask (a compact storage of the mask until the image is decoded)
+   *
+   * \param[in] mask Binary image to determine acceptable zones
+   * \param[out] runs The runs of non zero pixels of the mask
+   */
+  static void computeMaskRuns(
+    const image::Image<unsigned char>& mask,
+    MaskRuns & runs )
+  {
+    runs.clear();
+    for (int j = 0; j < mask.Height(); ++j )
+    {
+      int i = 0;
+      while (i < mask.Width() )
+      {
+        while (i < mask.Width() && mask( j, i ) == 0 )
+          ++i;
+        const int first = i;
+        while (i < mask.Width() && mask( j, i ) != 0 )
+          ++i;
+        if (i > first )
+          runs.push_back( {{j, first, i}} );
+      }
+    }
+  }
+
+  /**
+   * Compute the histograms of the three color channels of the masked data in a single pass
+   *
+   * \param[in] runs Run-length encoded mask (c.f. computeMaskRuns)
+   * \param[in] image Image with RGB or LAB type
+   * \param[out] histos Histograms of the channels 0, 1 and 2.
+   *
+   */
+  template<typename ImageType>
+  static void computeHistos(
+    Histogram<double> histos[ 3 ],
+    const MaskRuns & runs,
+    const image::Image< ImageType >& image )
+  {
+    for (const auto & run : runs )
+    {
+      if (run[ 0 ] >= image.Height() )
+        break;
+      const int end = std::min( run[ 2 ], image.Width() );
+      for (int i = run[ 1 ]; i < end; ++i )
+      {
+        const ImageType & pixel = image( run[ 0 ], i );
+        histos[ 0 ].Add( pixel( 0 ) );
+        histos[ 1 ].Add( pixel( 1 ) );
+        histos[ 2 ].Add( pixel( 2 ) );
+      }
+    }
+  }
+
   const std::string & getLeftImage()const{ return _sLeftImage; }
   const std::string & getRightImage()const{ return _sRightImage; }
 
@@ -0,0 +1,71 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/color_harmonization/selection_interface.hpp"
+#include "openMVG/image/image_drawing.hpp"
+#include "openMVG/image/pixel_types.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdlib>
+
+using namespace openMVG;
+using namespace openMVG::color_harmonization;
+using namespace openMVG::image;
+
+TEST(Selection, MaskRuns_Histograms)
+{
+  const int w = 64, h = 48;
+  Image<RGBColor> image(w, h);
+  std::srand(0);
+  for (int j = 0; j < h; ++j)
+    for (int i = 0; i < w; ++i)
+      image(j, i) = RGBColor(std::rand() % 256, std::rand() % 256, std::rand() % 256);
+
+  Image<unsigned char> mask(w, h);
+  mask.fill(0);
+  FilledCircle(20, 20, 10, (unsigned char)255, &mask);
+  FilledCircle(50, 30, 8, (unsigned char)255, &mask);
+  mask.row(h - 1).fill(255); // run that ends on the border
+
+  commonDataByPair::MaskRuns runs;
+  commonDataByPair::computeMaskRuns(mask, runs);
+
+  // The runs cover exactly the selected pixels
+  int selected = 0;
+  for (int j = 0; j < h; ++j)
+    for (int i = 0; i < w; ++i)
+      selected += mask(j, i) != 0;
+  int covered = 0;
+  for (const auto & run : runs)
+  {
+    EXPECT_TRUE(run[1] < run[2]);
+    for (int i = run[1]; i < run[2]; ++i)
+      EXPECT_TRUE(mask(run[0], i) != 0);
+    covered += run[2] - run[1];
+  }
+  EXPECT_EQ(selected, covered);
+
+  // The single pass histograms are the per channel masked histograms
+  Histogram<double> histos[3] = {
+    Histogram<double>(0.0, 255.0, 256),
+    Histogram<double>(0.0, 255.0, 256),
+    Histogram<double>(0.0, 255.0, 256)};
+  commonDataByPair::computeHistos(histos, runs, image);
+  for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
+  {
+    Histogram<double> histo(0.0, 255.0, 256);
+    commonDataByPair::computeHisto(histo, mask, channelIndex, image);
+    EXPECT_TRUE(histo.GetHist() == histos[channelIndex].GetHist());
+    EXPECT_EQ(histo.GetOverflow(), histos[channelIndex].GetOverflow());
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -9,6 +9,8 @@
 #ifndef OPENMVG_EXIF_EXIF_IO_EASYEXIF_HPP
 #define OPENMVG_EXIF_EXIF_IO_EASYEXIF_HPP
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <limits>
 #include <sstream>
@@ -74,17 +76,36 @@ class Exif_IO_EasyExif : public Exif_IO
     */
     bool open( const std::string & sFileName ) override
     {
-      // Read the file into a buffer
+      bHaveExifInfo_ = false;
       FILE *fp = fopen( sFileName.c_str(), "rb" );
       if ( !fp )
       {
         return false;
       }
+
+      // Read only the APP1 EXIF segment (located before the image data)
+      std::vector<unsigned char> buf;
+      const ESegment_Status status = readExifSegment( fp, buf );
+      if ( status == EXIF_SEGMENT_FOUND )
+      {
+        fclose( fp );
+        exifInfo_.clear();
+        bHaveExifInfo_ =
+          ( exifInfo_.parseFromEXIFSegment( &buf[0], static_cast<unsigned>( buf.size() ) ) == PARSE_EXIF_SUCCESS );
+        return bHaveExifInfo_;
+      }
+      if ( status == EXIF_SEGMENT_MISSING )
+      {
+        fclose( fp );
+        return false;
+      }
+
+      // The marker structure is not valid: scan the whole file
       fseek( fp, 0, SEEK_END );
       unsigned long fsize = ftell( fp );
       rewind( fp );
-      std::vector<unsigned char> buf( fsize );
-      if ( fread( &buf[0], 1, fsize, fp ) != fsize )
+      buf.resize( fsize );
+      if ( fsize == 0 || fread( &buf[0], 1, fsize, fp ) != fsize )
       {
         fclose( fp );
         return false;
@@ -310,6 +331,87 @@ class Exif_IO_EasyExif : public Exif_IO
 
   private:
 
+    enum ESegment_Status
+    {
+      EXIF_SEGMENT_FOUND,
+      EXIF_SEGMENT_MISSING,
+      EXIF_SEGMENT_UNKNOWN_LAYOUT
+    };
+
+    /**
+    * @brief Walk the JPEG markers up to the APP1 EXIF segment
+    * @param fp File opened at its beginning
+    * @param[out] segment The EXIF segment (starting with "Exif\0\0")
+    * @retval EXIF_SEGMENT_FOUND if the segment was read
+    * @retval EXIF_SEGMENT_MISSING if the file is not a JPEG file or has no EXIF segment
+    * @retval EXIF_SEGMENT_UNKNOWN_LAYOUT if the marker structure cannot be followed
+    */
+    static ESegment_Status readExifSegment
+    (
+      FILE * fp,
+      std::vector<unsigned char> & segment
+    )
+    {
+      unsigned char header[4];
+      if ( fread( header, 1, 2, fp ) != 2 || header[0] != 0xFF || header[1] != 0xD8 )
+      {
+        return EXIF_SEGMENT_MISSING;
+      }
+      while ( true )
+      {
+        int marker = fgetc( fp );
+        if ( marker != 0xFF )
+        {
+          return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+        }
+        // Skip the fill bytes
+        while ( marker == 0xFF )
+        {
+          marker = fgetc( fp );
+        }
+        if ( marker == EOF )
+        {
+          return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+        }
+        // Standalone markers
+        if ( marker == 0x01 || ( marker >= 0xD0 && marker <= 0xD7 ) )
+        {
+          continue;
+        }
+        // Start of scan or end of image: the metadata segments are over
+        if ( marker == 0xDA || marker == 0xD9 )
+        {
+          return EXIF_SEGMENT_MISSING;
+        }
+        if ( fread( header, 1, 2, fp ) != 2 )
+        {
+          return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+        }
+        const unsigned length = ( static_cast<unsigned>( header[0] ) << 8 ) | header[1];
+        if ( length < 2 )
+        {
+          return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+        }
+        if ( marker == 0xE1 && length >= 16 )
+        {
+          segment.resize( length - 2 );
+          if ( fread( &segment[0], 1, segment.size(), fp ) != segment.size() )
+          {
+            return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+          }
+          // APP1 is also used by XMP: keep looking if this is not the EXIF segment
+          if ( std::equal( segment.begin(), segment.begin() + 6, "Exif\0\0" ) )
+          {
+            return EXIF_SEGMENT_FOUND;
+          }
+        }
+        else if ( fseek( fp, length - 2, SEEK_CUR ) != 0 )
+        {
+          return EXIF_SEGMENT_UNKNOWN_LAYOUT;
+        }
+      }
+    }
+
     /// Internal data storing all exif data
     easyexif::EXIFInfo exifInfo_;
 
@@ -104,8 +104,8 @@ AKAZE_Image_describer_LIOP::Describe_AKAZE_LIOP
   regions->Features().resize(kpts.size());
   regions->Descriptors().resize(kpts.size());
 
-  // Init LIOP extractor
-  LIOP::Liop_Descriptor_Extractor liop_extractor;
+  // Rescaled features used for the LIOP patch extraction
+  std::vector<SIOPointFeature> liop_features(kpts.size());
 
   #ifdef OPENMVG_USE_OPENMP
   #pragma omp parallel for
@@ -126,14 +126,18 @@ AKAZE_Image_describer_LIOP::Describe_AKAZE_LIOP
     // Compute LIOP descriptor (do not need rotation computation, since
     //  LIOP descriptor is rotation invariant).
     // Rescale for LIOP patch extraction
-    const SIOPointFeature fp =
+    liop_features[i] =
       SIOPointFeature(ptAkaze.x, ptAkaze.y, ptAkaze.size/2.0, ptAkaze.angle);
+  }
 
-    float desc[144];
-    liop_extractor.extract(image, fp, desc);
+  // Compute the LIOP descriptors of all the features
+  const LIOP::Liop_Descriptor_Extractor liop_extractor;
+  std::vector<float> descs;
+  liop_extractor.extract(image, liop_features, descs);
+  for (int i = 0; i<static_cast<int>(kpts.size()); ++i) {
     for (int j = 0; j<144; ++j)
       regions->Descriptors()[i][j] =
-        static_cast<unsigned char>(desc[j]*255.f+.5f);
+        static_cast<unsigned char>(descs[i*144+j]*255.f+.5f);
   }
   return regions;
 }
@@ -0,0 +1,316 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/component_tree.hpp"
+#include "openMVG/image/image_container.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace openMVG
+{
+namespace features
+{
+namespace
+{
+  const unsigned int NONE = std::numeric_limits<unsigned int>::max();
+
+  inline unsigned int zfindroot
+  (
+    std::vector<unsigned int> & zpar,
+    unsigned int p
+  )
+  {
+    unsigned int r = p;
+    while (zpar[r] != r)
+      r = zpar[r];
+    while (zpar[p] != r)
+    {
+      const unsigned int next = zpar[p];
+      zpar[p] = r;
+      p = next;
+    }
+    return r;
+  }
+} // namespace
+
+void Component_Tree::Build
+(
+  const image::Image<unsigned char> & ima,
+  const std::array<unsigned char, 256> & level_rank,
+  const bool b_8_connectivity,
+  const int band_height
+)
+{
+  const int w = ima.Width();
+  const int h = ima.Height();
+  const unsigned int pixel_count = w * h;
+  const int band_rows = std::max(band_height, 1);
+  const int band_count = (h + band_rows - 1) / band_rows;
+
+  ranks_.resize(pixel_count);
+  sorted_pixels_.resize(pixel_count);
+  parent_.resize(pixel_count);
+  attributes_.resize(pixel_count);
+  if (pixel_count == 0)
+    return;
+
+  //-- Counting sort of the pixels by rank
+  //--------------------------------------------------------------------------
+  // The pixels of a band with a given rank are contiguous in the sorted array:
+  //  [band_first[band][rank], band_first[band][rank] + band_size[band][rank])
+  std::vector<std::array<unsigned int, 256>> band_first(band_count), band_size(band_count);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int band = 0; band < band_count; ++band)
+  {
+    std::array<unsigned int, 256> & histogram = band_size[band];
+    histogram.fill(0);
+    const unsigned int last = std::min(h, (band + 1) * band_rows) * w;
+    for (unsigned int p = band * band_rows * w; p < last; ++p)
+    {
+      ranks_[p] = level_rank[ima[p]];
+      ++histogram[ranks_[p]];
+    }
+  }
+  unsigned int offset = 0;
+  for (int rank = 0; rank < 256; ++rank)
+  {
+    for (int band = 0; band < band_count; ++band)
+    {
+      band_first[band][rank] = offset;
+      offset += band_size[band][rank];
+    }
+  }
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int band = 0; band < band_count; ++band)
+  {
+    std::array<unsigned int, 256> position = band_first[band];
+    const unsigned int last = std::min(h, (band + 1) * band_rows) * w;
+    for (unsigned int p = band * band_rows * w; p < last; ++p)
+      sorted_pixels_[position[ranks_[p]]++] = p;
+  }
+
+  //-- Trees of the bands: union-find [Berger 2007 ICIP] + rank
+  // and incremental computation of the attributes
+  //--------------------------------------------------------------------------
+  std::vector<int> offsets_x = {0, 0, -1, 1};
+  std::vector<int> offsets_y = {-1, 1, 0, 0};
+  if (b_8_connectivity)
+  {
+    offsets_x.insert(offsets_x.end(), {-1, 1, -1, 1});
+    offsets_y.insert(offsets_y.end(), {-1, -1, 1, 1});
+  }
+
+  std::vector<unsigned int> zpar(pixel_count);
+  std::vector<unsigned int> root(pixel_count);
+  std::vector<unsigned char> union_rank(pixel_count);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int band = 0; band < band_count; ++band)
+  {
+    const int y_first = band * band_rows;
+    const int y_last = std::min(h, y_first + band_rows);
+    for (unsigned int p = y_first * w; p < static_cast<unsigned int>(y_last * w); ++p)
+    {
+      zpar[p] = NONE; // not processed yet
+      union_rank[p] = 0;
+    }
+
+    // Process the pixels from the highest rank to the lowest one
+    for (int rank = 255; rank >= 0; --rank)
+    {
+      const unsigned int first = band_first[band][rank];
+      for (unsigned int i = first + band_size[band][rank]; i-- > first; )
+      {
+        const unsigned int p = sorted_pixels_[i];
+        const int px = p % w;
+        const int py = p / w;
+        // make set
+        {
+          parent_[p] = p;
+          zpar[p] = p;
+          root[p] = p;
+          attributes_[p].init(1, px, py);
+        }
+
+        unsigned int x = p; // zpar of p
+        for (size_t k = 0; k < offsets_x.size(); ++k)
+        {
+          const int qx = px + offsets_x[k];
+          const int qy = py + offsets_y[k];
+          if (qx < 0 || qx >= w || qy < y_first || qy >= y_last)
+            continue;
+          const unsigned int q = qy * w + qx;
+          if (zpar[q] == NONE)
+            continue;
+          const unsigned int r = zfindroot(zpar, q);
+          if (r != x)
+          { // make union
+            parent_[root[r]] = p;
+            //accumulate information
+            attributes_[p] += attributes_[root[r]];
+
+            if (union_rank[x] < union_rank[r])
+            {
+              //we merge p to r
+              zpar[x] = r;
+              root[r] = p;
+              x = r;
+            } else
+            if (union_rank[r] < union_rank[p])
+            {
+              // merge r to p
+              zpar[r] = p;
+            } else
+            {
+              // same height
+              zpar[r] = p;
+              union_rank[p] += 1;
+            }
+          }
+        }
+      }
+    }
+
+    // canonization
+    for (int rank = 0; rank < 256; ++rank)
+    {
+      const unsigned int first = band_first[band][rank];
+      for (unsigned int i = first; i < first + band_size[band][rank]; ++i)
+      {
+        const unsigned int p = sorted_pixels_[i];
+        const unsigned int q = parent_[p];
+        if (ranks_[parent_[q]] == ranks_[q])
+          parent_[p] = parent_[q];
+      }
+    }
+  }
+  zpar = std::vector<unsigned int>();
+  root = std::vector<unsigned int>();
+  union_rank = std::vector<unsigned char>();
+
+  //-- Merge the band trees along the band borders [Wilkinson 2008 PAMI]
+  // (the band pairs of a merge round are processed concurrently)
+  //--------------------------------------------------------------------------
+  for (int step = 1; step < band_count; step *= 2)
+  {
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int band = step; band < band_count; band += 2 * step)
+    {
+      // Connect the first row of the band to the last row of the previous band
+      const int y = band * band_rows;
+      for (int x = 0; x < w; ++x)
+      {
+        const unsigned int q = y * w + x;
+        Connect(q - w, q);
+        if (b_8_connectivity)
+        {
+          if (x > 0)
+            Connect(q - w - 1, q);
+          if (x < w - 1)
+            Connect(q - w + 1, q);
+        }
+      }
+    }
+  }
+
+  //-- Final canonization
+  //--------------------------------------------------------------------------
+  if (band_count > 1)
+  {
+    std::vector<unsigned int> canonical(pixel_count);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int p = 0; p < static_cast<int>(pixel_count); ++p)
+    {
+      unsigned int r = p;
+      while (parent_[r] != r && ranks_[parent_[r]] == ranks_[r])
+        r = parent_[r];
+      canonical[p] = r;
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int p = 0; p < static_cast<int>(pixel_count); ++p)
+    {
+      if (canonical[p] != static_cast<unsigned int>(p))
+        parent_[p] = canonical[p];
+      else
+      if (parent_[p] != static_cast<unsigned int>(p))
+        parent_[p] = canonical[parent_[p]];
+    }
+  }
+}
+
+unsigned int Component_Tree::LevelRoot(unsigned int p)
+{
+  unsigned int r = p;
+  while (parent_[r] != r && ranks_[parent_[r]] == ranks_[r])
+    r = parent_[r];
+  while (p != r)
+  {
+    const unsigned int next = parent_[p];
+    parent_[p] = r;
+    p = next;
+  }
+  return r;
+}
+
+void Component_Tree::Connect(const unsigned int p, const unsigned int q)
+{
+  unsigned int x = LevelRoot(p);
+  unsigned int y = LevelRoot(q);
+  if (ranks_[x] < ranks_[y])
+    std::swap(x, y);
+
+  // Merge the branches of x and y from the leaves to the root:
+  // the attributes of the nodes of a branch are increased by the attributes
+  // of the node of the other branch that becomes their child (carry)
+  Attribute carry;
+  while (x != y && y != NONE)
+  {
+    const unsigned int z = (parent_[x] == x) ? NONE : LevelRoot(parent_[x]);
+    if (z != NONE && ranks_[z] >= ranks_[y])
+    {
+      attributes_[x] += carry;
+      x = z;
+    }
+    else
+    {
+      const Attribute old = attributes_[x];
+      attributes_[x] += carry;
+      parent_[x] = y;
+      carry = old;
+      x = y;
+      y = z;
+    }
+  }
+  if (y == NONE)
+  {
+    // Propagate the carry up to the root
+    while (true)
+    {
+      attributes_[x] += carry;
+      if (parent_[x] == x)
+        break;
+      x = LevelRoot(parent_[x]);
+    }
+  }
+}
+
+} // namespace features
+} // namespace openMVG
@@ -0,0 +1,141 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_COMPONENT_TREE_HPP
+#define OPENMVG_FEATURES_COMPONENT_TREE_HPP
+
+#include <array>
+#include <vector>
+
+namespace openMVG { namespace image { template <typename T> class Image; } }
+
+//------------------
+//-- Bibliography --
+//------------------
+//- [1] "Building the component tree in quasi-linear time"
+//- Authors: Christophe Berger, Thierry Géraud, Roland Levillain, Nicolas Widynski, Anthony Baillard, Emmanuel Bertin
+//- Date: 2007
+//- Conference: ICIP
+//- [2] "Concurrent Computation of Attribute Filters on Shared Memory Parallel Machines"
+//- Authors: Michael H.F. Wilkinson, Hui Gao, Wim H. Hesselink, Jan-Eppo Jonker, Arnold Meijster
+//- Date: 2008
+//- Journal: PAMI
+
+namespace openMVG
+{
+namespace features
+{
+
+/**
+* @brief Component tree (Max-tree or Min-tree) of an 8 bit image.
+*
+* The gray levels are ordered by a rank: a node of the tree is a connected
+* component of the pixels that have a rank larger or equal to the rank of the
+* node, the root of the tree has the lowest rank.
+* Each pixel points to the canonical pixel of its node and the canonical pixel
+* of a node points to the canonical pixel of its parent node (the canonical
+* pixel of the root points to itself).
+*
+* The tree is built in parallel:
+* - the pixels are sorted by rank with a counting sort,
+* - the trees of horizontal bands of the image are built concurrently by
+*   union-find [1],
+* - the band trees are merged along the band borders [2].
+* The tree does not depend on the band height (only the choice of the
+* canonical pixels does).
+*/
+class Component_Tree
+{
+public:
+
+  /// Area and geometric moments of a component
+  struct Attribute
+  {
+    unsigned int area = 0;
+    double sum_x = 0;
+    double sum_y = 0;
+    double sum_xy = 0;
+    double sum_xx = 0;
+    double sum_yy = 0;
+
+    Attribute& operator += (const Attribute & rhs)
+    {
+      area   += rhs.area;
+      sum_x  += rhs.sum_x;
+      sum_xx += rhs.sum_xx;
+      sum_xy += rhs.sum_xy;
+      sum_y  += rhs.sum_y;
+      sum_yy += rhs.sum_yy;
+      return *this;
+    }
+
+    void init
+    (
+      unsigned int area,
+      double x,
+      double y
+    )
+    {
+      this->area = area;
+      sum_x = x;
+      sum_y = y;
+      sum_xy = x * y;
+      sum_xx = x * x;
+      sum_yy = y * y;
+    }
+  };
+
+  /**
+  * @brief Build the component tree of an image
+  * @param ima Input image
+  * @param level_rank Rank of each gray level (the root has the lowest rank)
+  * @param b_8_connectivity Use 8 or 4 connectivity
+  * @param band_height Height of the image bands processed concurrently
+  */
+  void Build
+  (
+    const image::Image<unsigned char> & ima,
+    const std::array<unsigned char, 256> & level_rank,
+    const bool b_8_connectivity = false,
+    const int band_height = 256
+  );
+
+  /// Pixel indexes sorted by increasing rank (the pixels of a rank are sorted
+  /// by increasing index)
+  const std::vector<unsigned int> & SortedPixels() const { return sorted_pixels_; }
+
+  /// Parent of each pixel
+  const std::vector<unsigned int> & Parents() const { return parent_; }
+
+  /// Attributes of the components (valid for the canonical pixels)
+  const std::vector<Attribute> & Attributes() const { return attributes_; }
+
+  /// Return true if the pixel is the canonical pixel of its node
+  bool IsCanonical(const unsigned int p) const
+  {
+    return parent_[p] == p || ranks_[parent_[p]] != ranks_[p];
+  }
+
+private:
+
+  /// Canonical pixel of the node of p (with path compression)
+  unsigned int LevelRoot(unsigned int p);
+
+  /// Merge the trees of two neighbor pixels and update the attributes [2]
+  void Connect(const unsigned int p, const unsigned int q);
+
+  std::vector<unsigned char> ranks_;        // Rank of each pixel
+  std::vector<unsigned int> sorted_pixels_; // Pixels sorted by rank
+  std::vector<unsigned int> parent_;        // Parent of each pixel
+  std::vector<Attribute> attributes_;       // Attributes of each node
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_COMPONENT_TREE_HPP
@@ -0,0 +1,112 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/component_tree.hpp"
+#include "openMVG/image/image_container.hpp"
+
+#include "testing/testing.h"
+
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::features;
+
+// Max-tree rank: the root is the darkest level
+std::array<unsigned char, 256> MaxTreeRank()
+{
+  std::array<unsigned char, 256> level_rank;
+  for (int level = 0; level < 256; ++level)
+    level_rank[level] = static_cast<unsigned char>(level);
+  return level_rank;
+}
+
+// Canonical pixel of the node of a pixel
+unsigned int NodeOf(const Component_Tree & tree, const unsigned int p)
+{
+  return tree.IsCanonical(p) ? p : tree.Parents()[p];
+}
+
+TEST(Component_Tree, Nested_Blocks)
+{
+  image::Image<unsigned char> image(60, 40, true, 0);
+  image.block<30,40>(5,10).setConstant(50);   // rows, cols
+  image.block<10,10>(10,15).setConstant(200);
+  image.block<10,10>(20,35).setConstant(200);
+
+  Component_Tree tree;
+  tree.Build(image, MaxTreeRank(), false, 7);
+
+  const std::vector<Component_Tree::Attribute> & attributes = tree.Attributes();
+  const unsigned int root = NodeOf(tree, 0);
+  EXPECT_EQ(60 * 40, attributes[root].area);
+  EXPECT_EQ(root, tree.Parents()[root]);
+
+  // The two bright blocks are two leaves of the node of the 50 level block
+  const unsigned int leaf0 = NodeOf(tree, 12 * 60 + 17);
+  const unsigned int leaf1 = NodeOf(tree, 22 * 60 + 37);
+  EXPECT_TRUE(leaf0 != leaf1);
+  EXPECT_EQ(100, attributes[leaf0].area);
+  EXPECT_EQ(100, attributes[leaf1].area);
+  EXPECT_NEAR(19.5, attributes[leaf0].sum_x / attributes[leaf0].area, 1e-9);
+  EXPECT_NEAR(14.5, attributes[leaf0].sum_y / attributes[leaf0].area, 1e-9);
+
+  const unsigned int block = tree.Parents()[leaf0];
+  EXPECT_EQ(block, tree.Parents()[leaf1]);
+  EXPECT_EQ(block, NodeOf(tree, 6 * 60 + 11));
+  EXPECT_EQ(30 * 40, attributes[block].area);
+  EXPECT_EQ(root, tree.Parents()[block]);
+}
+
+TEST(Component_Tree, Band_Height_Invariance)
+{
+  // Random image with plateaus
+  std::mt19937 gen(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> level(0, 7);
+  image::Image<unsigned char> image(97, 83);
+  for (int i = 0; i < image.Height(); ++i)
+    for (int j = 0; j < image.Width(); ++j)
+      image(i, j) = static_cast<unsigned char>(level(gen) * 30);
+
+  for (const bool b_8_connectivity : {false, true})
+  {
+    Component_Tree reference;
+    reference.Build(image, MaxTreeRank(), b_8_connectivity, image.Height());
+
+    for (const int band_height : {1, 2, 5, 16, 40})
+    {
+      Component_Tree tree;
+      tree.Build(image, MaxTreeRank(), b_8_connectivity, band_height);
+
+      EXPECT_TRUE(reference.SortedPixels() == tree.SortedPixels());
+      // Same nodes (compared by their area, moments and parent node)
+      for (unsigned int p = 0; p < image.Width() * image.Height(); ++p)
+      {
+        const unsigned int ref_node = NodeOf(reference, p);
+        const unsigned int node = NodeOf(tree, p);
+        const Component_Tree::Attribute & ref_attribute = reference.Attributes()[ref_node];
+        const Component_Tree::Attribute & attribute = tree.Attributes()[node];
+        EXPECT_EQ(ref_attribute.area, attribute.area);
+        EXPECT_EQ(ref_attribute.sum_x, attribute.sum_x);
+        EXPECT_EQ(ref_attribute.sum_yy, attribute.sum_yy);
+        EXPECT_EQ(ref_attribute.sum_xy, attribute.sum_xy);
+        EXPECT_EQ(image[ref_node], image[node]);
+        EXPECT_EQ(
+          reference.Attributes()[reference.Parents()[ref_node]].area,
+          tree.Attributes()[tree.Parents()[node]].area);
+        // A pixel points to the canonical pixel of its node
+        EXPECT_TRUE(tree.IsCanonical(tree.Parents()[p]));
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
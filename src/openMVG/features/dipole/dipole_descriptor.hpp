@@ -118,86 +118,151 @@ namespace features
     dataMap.block<12,1>(8,0) = dipoleF2.normalized();
   }
 
-  // Pick an angular smoothed dipole
+  /// Sampling offsets of an angular smoothed dipole.
+  /// They depend only on the scale and the angle of the dipole, so they are
+  /// computed once for all the points that share the same sampling pattern.
+  struct ASDipole_Pattern
+  {
+    // Offsets of the 3 samples (the direction and its two half subdivisions)
+    // of the 12 directions of the dipole circles (x then y)
+    double f1[12][3][2];       // first order dipole circle (radius lambda1)
+    double f2_outer[12][3][2]; // second order outer circle (radius lambda1+lambda2)
+    double f2_inner[12][3][2]; // second order inner circle (radius lambda1-lambda2)
+
+    ASDipole_Pattern
+    (
+      float scale,
+      float angle
+    )
+    {
+      const float lambda1 = scale;
+      const float lambda2 = lambda1 / 2.0f;
+      const float angleSubdiv = 2.0f * M_PI / 12.0f;
+
+      for (int i = 0; i < 12; ++i)
+      {
+        //-- First order dipole:
+        f1[i][0][0] = lambda1 * std::cos(angle + i * angleSubdiv);
+        f1[i][0][1] = lambda1 * std::sin(angle + i * angleSubdiv);
+        f1[i][1][0] = lambda1 * std::cos(angle + i * angleSubdiv - angleSubdiv/2.0);
+        f1[i][1][1] = lambda1 * std::sin(angle + i * angleSubdiv - angleSubdiv/2.0);
+        f1[i][2][0] = lambda1 * std::cos(angle + i * angleSubdiv + angleSubdiv/2.0);
+        f1[i][2][1] = lambda1 * std::sin(angle + i * angleSubdiv + angleSubdiv/2.0);
+
+        //-- Second order dipole:
+        const double angleSample = i * angleSubdiv;
+        const double angles[3] =
+        {
+          angle + angleSample,
+          angle + angleSample - angleSubdiv/2.0,
+          angle + angleSample + angleSubdiv/2.0
+        };
+        for (int j = 0; j < 3; ++j)
+        {
+          f2_outer[i][j][0] = (lambda1 + lambda2) * std::cos(angles[j]);
+          f2_outer[i][j][1] = (lambda1 + lambda2) * std::sin(angles[j]);
+          f2_inner[i][j][0] = (lambda1 - lambda2) * std::cos(angles[j]);
+          f2_inner[i][j][1] = (lambda1 - lambda2) * std::sin(angles[j]);
+        }
+      }
+    }
+  };
+
+  // Pick an angular smoothed dipole with a precomputed sampling pattern
   template<typename Real>
   void PickASDipole
   (
     const image::Image<Real> & image,
     float x,
     float y,
-    float scale,
-    float angle,
+    const ASDipole_Pattern & pattern,
     float * data)
   {
     const image::Sampler2d<image::SamplerLinear> sampler;
     // Setup the rotation center.
     const float & cx = x, & cy = y;
-
-    const float lambda1 = scale;
-    const float lambda2 = lambda1 / 2.0f;
-    const float angleSubdiv = 2.0f * M_PI / 12.0f;
+    // Mean of the 3 bilinear samples of a direction
+    const auto sample = [&](const double (&offsets)[3][2])
+    {
+      return
+        (sampler(image, cy + offsets[0][1], cx + offsets[0][0]) +
+         sampler(image, cy + offsets[1][1], cx + offsets[1][0]) +
+         sampler(image, cy + offsets[2][1], cx + offsets[2][0])) / 3.0f;
+    };
 
     //-- First order dipole:
-    Vecf dipoleF1(12);
+    Eigen::Matrix<float, 12, 1> dipoleF1;
     for (int i = 0; i < 12; ++i)
-    {
-      const float xi = cx + lambda1 * std::cos(angle + i * angleSubdiv);
-      const float yi = cy + lambda1 * std::sin(angle + i * angleSubdiv);
-      const float xi0 = cx + lambda1 * std::cos(angle + i * angleSubdiv - angleSubdiv/2.0);
-      const float yi0 = cy + lambda1 * std::sin(angle + i * angleSubdiv - angleSubdiv/2.0);
-      const float xi3 = cx + lambda1 * std::cos(angle + i * angleSubdiv + angleSubdiv/2.0);
-      const float yi3 = cy + lambda1 * std::sin(angle + i * angleSubdiv + angleSubdiv/2.0);
-      // Bilinear interpolation
-      dipoleF1(i) =
-        (sampler(image, yi, xi) +
-         sampler(image, yi0, xi0) +
-         sampler(image, yi3, xi3))/3.0f;
-    }
-    Matf A(8,12);
-    A <<  0, 0, 0, 1, 0, 0, 0, 0, 0,-1, 0, 0,
-          0,-1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0,
-          0, 0, 0, 0, 0,-1, 0, 0, 0, 0, 0, 1,
-          0, 0, 0, 0, 1, 0, 0,-1, 0, 0, 0, 0,
-          0, 0, 0, 0, 0, 0, 1, 0, 0,-1, 0, 0,
-          0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0,-1,
-          0,-1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0,
-          1, 0, 0,-1, 0, 0, 0, 0, 0, 0, 0, 0;
+      dipoleF1(i) = sample(pattern.f1[i]);
 
     //-- Second order dipole:
-    Vecf dipoleF2(12);
+    Eigen::Matrix<float, 12, 1> dipoleF2;
     for (int i = 0; i < 12; ++i)
-    {
-      const double angleSample = i * angleSubdiv;
-      const float xi = cx + (lambda1 + lambda2) * std::cos(angle + angleSample);
-      const float yi = cy + (lambda1 + lambda2) * std::sin(angle + angleSample);
-      const float xi0 = cx + (lambda1 + lambda2) * std::cos(angle + angleSample - angleSubdiv/2.0);
-      const float yi0 = cy + (lambda1 + lambda2) * std::sin(angle + angleSample - angleSubdiv/2.0);
-      const float xi3 = cx + (lambda1 + lambda2) * std::cos(angle + angleSample + angleSubdiv/2.0);
-      const float yi3 = cy + (lambda1 + lambda2) * std::sin(angle + angleSample + angleSubdiv/2.0);
-
-      const float xii = cx + (lambda1 - lambda2) * std::cos(angle + angleSample);
-      const float yii = cy + (lambda1 - lambda2) * std::sin(angle + angleSample);
-      const float xii0 = cx + (lambda1 - lambda2) * std::cos(angle + angleSample - angleSubdiv/2.0);
-      const float yii0 = cy + (lambda1 - lambda2) * std::sin(angle + angleSample - angleSubdiv/2.0);
-      const float xii3 = cx + (lambda1 - lambda2) * std::cos(angle + angleSample + angleSubdiv/2.0);
-      const float yii3 = cy + (lambda1 - lambda2) * std::sin(angle + angleSample + angleSubdiv/2.0);
+      dipoleF2(i) = sample(pattern.f2_outer[i]) - sample(pattern.f2_inner[i]);
+
+    // First order dipole differences (A * dipoleF1, with a sparse A matrix)
+    Eigen::Matrix<float, 8, 1> dipoleDiffF1;
+    dipoleDiffF1 <<
+      dipoleF1(3) - dipoleF1(9),
+      dipoleF1(7) - dipoleF1(1),
+      dipoleF1(11) - dipoleF1(5),
+      dipoleF1(4) - dipoleF1(7),
+      dipoleF1(6) - dipoleF1(9),
+      dipoleF1(8) - dipoleF1(11),
+      dipoleF1(10) - dipoleF1(1),
+      dipoleF1(0) - dipoleF1(3);
 
-      // Bilinear interpolation
-      dipoleF2(i) =
-        (sampler(image, yi, xi)   +
-         sampler(image, yi0, xi0) +
-         sampler(image, yi3, xi3)) /3.0f
-        -
-       (sampler(image, yii, xii)   +
-        sampler(image, yii0, xii0) +
-        sampler(image, yii3, xii3)) /3.0f;
-    }
     // Normalize to be affine luminance invariant (a*I(x,y)+b).
     Map<Vecf> dataMap( data, 20);
-    dataMap.block<8,1>(0,0) = (A * dipoleF1).normalized();
+    dataMap.block<8,1>(0,0) = dipoleDiffF1.normalized();
     dataMap.block<12,1>(8,0) = dipoleF2.normalized();
   }
 
+  // Pick an angular smoothed dipole
+  template<typename Real>
+  void PickASDipole
+  (
+    const image::Image<Real> & image,
+    float x,
+    float y,
+    float scale,
+    float angle,
+    float * data)
+  {
+    PickASDipole(image, x, y, ASDipole_Pattern(scale, angle), data);
+  }
+
+  /**
+  * @brief Pick the angular smoothed dipoles of a set of points that share the
+  *  same scale and angle (the sampling pattern is computed once and the points
+  *  are described in parallel)
+  * @param image Input image
+  * @param points Input points (any type with x() and y() accessors)
+  * @param scale Scale of the dipoles
+  * @param angle Angle of the dipoles (in radians)
+  * @param data Output array (must be allocated to points.size() * stride values)
+  * @param stride Offset between two descriptors in data (>= 20)
+  */
+  template<typename Real, typename PointsT>
+  void PickASDipoles
+  (
+    const image::Image<Real> & image,
+    const PointsT & points,
+    float scale,
+    float angle,
+    float * data,
+    size_t stride = 20)
+  {
+    const ASDipole_Pattern pattern(scale, angle);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < static_cast<int>(points.size()); ++i)
+    {
+      PickASDipole(image, points[i].x(), points[i].y(), pattern, data + i * stride);
+    }
+  }
+
    /**
     ** @brief Compute DIPOLE descriptor for a given interest point
     ** @param Li Input image
@@ -0,0 +1,183 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_FEATURE_GRID_HPP
+#define OPENMVG_FEATURES_FEATURE_GRID_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace features {
+
+/**
+* @brief Uniform grid index of 2D feature positions.
+*
+* The features are bucketed in square cells by a counting sort: the features
+* of a cell are contiguous in Order() (sorted by cell, then by feature index).
+* A window query only visits the cells that overlap the window, so a local
+* search costs O(features in the window) instead of O(all features).
+*/
+class Feature_Grid
+{
+public:
+
+  Feature_Grid() = default;
+
+  /**
+  * @brief Build the grid index
+  * @param features The features (any type with x() and y() accessors)
+  * @param cell_size Width and height of the cells (in pixels)
+  */
+  template <typename FeaturesT>
+  Feature_Grid
+  (
+    const FeaturesT & features,
+    const float cell_size
+  )
+  {
+    Build(features, cell_size);
+  }
+
+  template <typename FeaturesT>
+  void Build
+  (
+    const FeaturesT & features,
+    const float cell_size
+  )
+  {
+    cell_size_ = std::max(cell_size, 1.f);
+    order_.clear();
+    cell_offsets_.assign(1, 0);
+    cols_ = rows_ = 0;
+    if (features.empty())
+      return;
+
+    // Bounds of the feature positions
+    origin_ << features[0].x(), features[0].y();
+    Vec2f upper = origin_;
+    for (const auto & feature : features)
+    {
+      origin_ = origin_.cwiseMin(Vec2f(feature.x(), feature.y()));
+      upper = upper.cwiseMax(Vec2f(feature.x(), feature.y()));
+    }
+    cols_ = static_cast<int>((upper.x() - origin_.x()) / cell_size_) + 1;
+    rows_ = static_cast<int>((upper.y() - origin_.y()) / cell_size_) + 1;
+
+    // Counting sort of the features by cell
+    std::vector<uint32_t> feature_cells(features.size());
+    cell_offsets_.assign(static_cast<size_t>(cols_) * rows_ + 1, 0);
+    for (size_t i = 0; i < features.size(); ++i)
+    {
+      feature_cells[i] = static_cast<uint32_t>(
+        CellRow(features[i].y()) * cols_ + CellCol(features[i].x()));
+      ++cell_offsets_[feature_cells[i] + 1];
+    }
+    for (size_t i = 1; i < cell_offsets_.size(); ++i)
+      cell_offsets_[i] += cell_offsets_[i - 1];
+    order_.resize(features.size());
+    std::vector<uint32_t> fill_position(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (size_t i = 0; i < features.size(); ++i)
+      order_[fill_position[feature_cells[i]]++] = static_cast<uint32_t>(i);
+  }
+
+  /// Feature indexes sorted by cell
+  const std::vector<uint32_t> & Order() const { return order_; }
+
+  /// Range [first, last) in Order() of the features of a cell
+  void CellRange(int col, int row, uint32_t & first, uint32_t & last) const
+  {
+    const size_t cell = static_cast<size_t>(row) * cols_ + col;
+    first = cell_offsets_[cell];
+    last = cell_offsets_[cell + 1];
+  }
+
+  /// Top left corner of the first cell
+  const Vec2f & Origin() const { return origin_; }
+  int Cols() const { return cols_; }
+  int Rows() const { return rows_; }
+  float CellSize() const { return cell_size_; }
+
+  /**
+  * @brief Call a functor on the features of the cells that overlap a window
+  *  (the features outside of the window but in its cells are visited too).
+  * @param x0 Left bound of the window
+  * @param y0 Top bound of the window
+  * @param x1 Right bound of the window
+  * @param y1 Bottom bound of the window
+  * @param functor Called as functor(position_in_order, feature_index)
+  */
+  template <typename Functor>
+  void ForEachInWindow
+  (
+    const float x0, const float y0,
+    const float x1, const float y1,
+    Functor && functor
+  ) const
+  {
+    if (order_.empty() || x1 < x0 || y1 < y0
+        || x1 < origin_.x() || x0 >= origin_.x() + cols_ * cell_size_
+        || y1 < origin_.y() || y0 >= origin_.y() + rows_ * cell_size_)
+      return;
+    const int col0 = CellCol(x0), col1 = CellCol(x1);
+    const int row0 = CellRow(y0), row1 = CellRow(y1);
+    for (int row = row0; row <= row1; ++row)
+    {
+      // The cells of a row range are contiguous in Order()
+      const uint32_t first = cell_offsets_[static_cast<size_t>(row) * cols_ + col0];
+      const uint32_t last = cell_offsets_[static_cast<size_t>(row) * cols_ + col1 + 1];
+      for (uint32_t k = first; k < last; ++k)
+        functor(k, order_[k]);
+    }
+  }
+
+  /// Call a functor on the features of the cells that overlap the square
+  /// window of half size radius centered on (x, y)
+  template <typename Functor>
+  void ForEachInRadius
+  (
+    const float x, const float y,
+    const float radius,
+    Functor && functor
+  ) const
+  {
+    ForEachInWindow(x - radius, y - radius, x + radius, y + radius,
+      std::forward<Functor>(functor));
+  }
+
+private:
+
+  int CellCol(const float x) const
+  {
+    const float col = std::floor((x - origin_.x()) / cell_size_);
+    return static_cast<int>(std::min(std::max(col, 0.f), static_cast<float>(cols_ - 1)));
+  }
+
+  int CellRow(const float y) const
+  {
+    const float row = std::floor((y - origin_.y()) / cell_size_);
+    return static_cast<int>(std::min(std::max(row, 0.f), static_cast<float>(rows_ - 1)));
+  }
+
+  float cell_size_ = 1.f;
+  Vec2f origin_ = Vec2f::Zero();
+  int cols_ = 0;
+  int rows_ = 0;
+  std::vector<uint32_t> order_;        // Feature indexes sorted by cell
+  std::vector<uint32_t> cell_offsets_; // Size: cell count + 1
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_FEATURE_GRID_HPP
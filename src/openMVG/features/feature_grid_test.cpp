@@ -0,0 +1,75 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/feature.hpp"
+#include "openMVG/features/feature_container.hpp"
+#include "openMVG/features/feature_grid.hpp"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::features;
+
+TEST(Feature_Grid, Empty)
+{
+  const PointFeatures features;
+  const Feature_Grid grid(features, 10.f);
+  size_t visited = 0;
+  grid.ForEachInRadius(0.f, 0.f, 100.f, [&](uint32_t, uint32_t){ ++visited; });
+  EXPECT_EQ(0, visited);
+  EXPECT_EQ(0, grid.Order().size());
+}
+
+TEST(Feature_Grid, RadiusQuery)
+{
+  std::mt19937 gen(std::mt19937::default_seed);
+  std::uniform_real_distribution<float> coord(0.f, 640.f);
+  PointFeatures features;
+  for (int i = 0; i < 2000; ++i)
+    features.emplace_back(coord(gen), coord(gen) * 0.75f);
+
+  const float radius = 25.f;
+  const Feature_Grid grid(features, radius);
+
+  // Order is a permutation of the feature indexes
+  std::vector<uint32_t> order = grid.Order();
+  std::sort(order.begin(), order.end());
+  for (size_t i = 0; i < order.size(); ++i)
+    EXPECT_EQ(i, order[i]);
+
+  // The window query visits all the features in the radius (compared to a brute force search)
+  for (int q = 0; q < 100; ++q)
+  {
+    const Vec2f center(coord(gen) * 1.2f - 64.f, coord(gen) - 64.f);
+    std::vector<uint32_t> found;
+    grid.ForEachInRadius(center.x(), center.y(), radius,
+      [&](const uint32_t k, const uint32_t j)
+      {
+        EXPECT_EQ(grid.Order()[k], j);
+        if ((features[j].coords() - center).norm() <= radius)
+          found.push_back(j);
+      });
+    std::sort(found.begin(), found.end());
+
+    std::vector<uint32_t> expected;
+    for (size_t j = 0; j < features.size(); ++j)
+    {
+      if ((features[j].coords() - center).norm() <= radius)
+        expected.push_back(j);
+    }
+    CHECK(found == expected);
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -23,6 +23,8 @@
 #include "openMVG/image/image_filtering.hpp"
 #include "openMVG/image/sample.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 
 namespace openMVG {
@@ -30,19 +32,19 @@ namespace features{
 namespace LIOP    {
 
 const int MAX_PIXEL_NUM  = 1681;
-const int MAX_SAMPLE_NUM = 10;
 const int LIOP_NUM = 4;
 const int REGION_NUM = 6;
 
-Liop_Descriptor_Extractor::Liop_Descriptor_Extractor()
-{
-  GeneratePatternMap( m_LiopPatternMap, m_LiopPosWeight, LIOP_NUM);
-}
+// Patch geometry
+const int SCALE_PATCH_WIDTH = 31;
+const int OUT_PATCH_WIDTH = SCALE_PATCH_WIDTH+6;
+const int OUT_RADIUS = OUT_PATCH_WIDTH/2;
+const int IN_RADIUS = SCALE_PATCH_WIDTH/2;
+
+static_assert(LIOP_NUM == 4, "The ordering code and the sorting network assume 4 neighbors");
 
 struct Pixel{
-  float x, y; // position
   float f_gray; // color value
-  float weight;
   int l_pattern;
 };
 
@@ -51,77 +53,118 @@ inline bool fGrayComp(const Pixel & p1, const Pixel & p2)
   return p1.f_gray < p2.f_gray;
 }
 
-bool BilinearInterpolation_BorderCheck(
-  float& val,
-  float x, float y,
-  const image::Image<float> & image,
-  const image::Image<unsigned char> & flagImage)
+inline void CompareExchange(float* dst, int* idx, int i, int j)
 {
-  val = 0.0f;
-  if (!(x >= 0 && y >= 0 && x<=image.Width()-1 && y<=image.Height()-1))
-    return false;
-
-  const int x1 = (int)x;
-  const int y1 = (int)y;
-
-  int x2, y2;
-  if (x1 == image.Width()-1)
-    x2  = x1;
-  else
-    x2 = x1+1;
-
-  if (y1 == image.Height()-1 )
-    y2 = y1;
-  else
-    y2 = y1+1;
-
-  const int step = image.Width();
-  const float* data = image.data();
-
-  const int flag_step = flagImage.Width();
-  const unsigned char* flag_data = flagImage.data();
-
-  if (flag_data[y1*flag_step+x1] == 0 ||
-     flag_data[y1*flag_step+x2] == 0 ||
-     flag_data[y2*flag_step+x1] == 0 ||
-     flag_data[y2*flag_step+x2] == 0)
-    return false;
+  if (dst[j] < dst[i])
+  {
+    std::swap(dst[i], dst[j]);
+    std::swap(idx[i], idx[j]);
+  }
+}
 
-  val =
-    (x2 - x) * (y2 - y) * data[y1*step+x1] +
-    (x - x1) * (y2 - y) * data[y1*step+x2] +
-    (x2 - x) * (y - y1) * data[y2*step+x1] +
-    (x - x1) * (y - y1) * data[y2*step+x2];
-  return true;
+/// Base 4 code of the neighbor indexes sorted by non descending intensity.
+/// The sorting network performs the comparisons of an exchange sort, so
+/// equal intensities are ordered as in the reference implementation.
+inline int OrderingCode(const float* src)
+{
+  float dst[LIOP_NUM] = {src[0], src[1], src[2], src[3]};
+  int idx[LIOP_NUM] = {0, 1, 2, 3};
+  CompareExchange(dst, idx, 0, 1);
+  CompareExchange(dst, idx, 0, 2);
+  CompareExchange(dst, idx, 0, 3);
+  CompareExchange(dst, idx, 1, 2);
+  CompareExchange(dst, idx, 1, 3);
+  CompareExchange(dst, idx, 2, 3);
+  return (idx[0] << 6) | (idx[1] << 4) | (idx[2] << 2) | idx[3];
 }
 
-//non descend
-void SortGray(float* dst, int* idx, float* src, int len)
+struct Liop_Descriptor_Extractor::Patch_Buffers
 {
-  int i, j;
+  image::Image<float> outPatch;
+  image::Image<float> blurredPatch;
+  image::Image<unsigned char> flagPatch;
+
+  Patch_Buffers():
+    outPatch(OUT_PATCH_WIDTH, OUT_PATCH_WIDTH, true, 0),
+    blurredPatch(OUT_PATCH_WIDTH, OUT_PATCH_WIDTH, true, 0),
+    flagPatch(OUT_PATCH_WIDTH, OUT_PATCH_WIDTH, true, 0)
+  {
+  }
+};
 
-  for (i=0; i<len; ++i)
+Liop_Descriptor_Extractor::Liop_Descriptor_Extractor()
+{
+  GeneratePatternMap( m_LiopPatternMap, m_LiopPosWeight, LIOP_NUM);
+
+  // Pattern of each ordering code
+  m_LiopPatternTable.fill(0);
+  for (int code = 0; code < 256; ++code)
   {
-    dst[i] = src[i];
-    idx[i] = i;
+    int key = 0;
+    for (int k=0; k<LIOP_NUM; ++k)
+    {
+      const int idx = (code >> (2*(LIOP_NUM-k-1))) & 3;
+      key += (idx+1)* m_LiopPosWeight[LIOP_NUM-k-1];
+    }
+    std::map<int, unsigned char>::const_iterator iter = m_LiopPatternMap.find(key);
+    if (iter != m_LiopPatternMap.end())
+      m_LiopPatternTable[code] = iter->second;
   }
 
-  for (i=0; i<len; ++i)
+  // Sampling of the neighbors of the inner patch pixels
+  // (the neighbor positions do not depend on the feature)
+  const float inRadius2 = float(IN_RADIUS*IN_RADIUS);
+  const int lsRadius = 6;
+  const float theta = 2.0f*M_PI/(float)LIOP_NUM;
+
+  for (int y=-IN_RADIUS; y<=IN_RADIUS; ++y)
   {
-    float temp = dst[i];
-    int tempIdx = idx[i];
-    for (j=i+1; j<len; ++j)
+    for (int x=-IN_RADIUS; x<=IN_RADIUS; ++x)
     {
-      if (dst[j]<temp)
+      float dis2 = (float)(x*x + y*y);
+      if (dis2 > inRadius2)
+        continue;
+
+      const float nDirX = static_cast<float>(x);
+      const float nDirY = static_cast<float>(y);
+      float nOri = atan2(nDirY, nDirX);
+      if (std::abs(nOri - M_PI) < std::numeric_limits<float>::epsilon()) //[-M_PI, M_PI)
       {
-        temp = dst[j];
-        dst[j] = dst[i];
-        dst[i] = temp;
+        nOri = static_cast<float>(-M_PI);
+      }
 
-        tempIdx = idx[j];
-        idx[j] = idx[i];
-        idx[i] = tempIdx;
+      Neighbor_Sampling sampling;
+      sampling.center = (y+OUT_RADIUS)*OUT_PATCH_WIDTH + x+OUT_RADIUS;
+      bool isInPatch = true;
+      for (int k=0; k<LIOP_NUM; k++)
+      {
+        const float deltaX = lsRadius * cos(nOri+k*theta);
+        const float deltaY = lsRadius * sin(nOri+k*theta);
+
+        const float sampleX = x+deltaX+OUT_RADIUS;
+        const float sampleY = y+deltaY+OUT_RADIUS;
+        if (!(sampleX >= 0 && sampleY >= 0 &&
+              sampleX <= OUT_PATCH_WIDTH-1 && sampleY <= OUT_PATCH_WIDTH-1))
+        {
+          isInPatch = false;
+          break;
+        }
+        // Bilinear interpolation
+        const int x1 = (int)sampleX;
+        const int y1 = (int)sampleY;
+        const int x2 = (x1 == OUT_PATCH_WIDTH-1) ? x1 : x1+1;
+        const int y2 = (y1 == OUT_PATCH_WIDTH-1) ? y1 : y1+1;
+        sampling.corners[k][0] = y1*OUT_PATCH_WIDTH+x1;
+        sampling.corners[k][1] = y1*OUT_PATCH_WIDTH+x2;
+        sampling.corners[k][2] = y2*OUT_PATCH_WIDTH+x1;
+        sampling.corners[k][3] = y2*OUT_PATCH_WIDTH+x2;
+        sampling.weights[k][0] = (x2 - sampleX) * (y2 - sampleY);
+        sampling.weights[k][1] = (sampleX - x1) * (y2 - sampleY);
+        sampling.weights[k][2] = (x2 - sampleX) * (sampleY - y1);
+        sampling.weights[k][3] = (sampleX - x1) * (sampleY - y1);
       }
+      if (isInPatch)
+        m_NeighborSamplings.push_back(sampling);
     }
   }
 }
@@ -176,90 +219,48 @@ void ThreshNorm(float* des, int dim, float illuThresh)
 }
 
 void Liop_Descriptor_Extractor::CreateLIOP_GOrder(
-  const image::Image<float> & outPatch,
-  const image::Image<unsigned char> & flagPatch,
-  const int inRadius,
+  const float * out_data,
+  const unsigned char * flag_data,
   float desc[144]) const
 {
-  const float* out_data = outPatch.data();
-  const int out_step = outPatch.Width();
-  const unsigned char* flag_data = flagPatch.data();
-  const int flag_step = flagPatch.Width();
-
-  const float inRadius2 = float(inRadius*inRadius);
-  const int outRadius = outPatch.Width() / 2;
-
-  const int lsRadius = 6;
-  const float theta = 2.0f*M_PI/(float)LIOP_NUM;
-
   Pixel pixel[MAX_PIXEL_NUM];
   int pixelCount = 0;
-  int idx[MAX_SAMPLE_NUM];
-  float dst[MAX_SAMPLE_NUM];
-  float src[MAX_SAMPLE_NUM];
+  float src[LIOP_NUM];
 
-  for (int y=-inRadius; y<=inRadius; ++y)
+  for (const Neighbor_Sampling & sampling : m_NeighborSamplings)
   {
-    for (int x=-inRadius; x<=inRadius; ++x)
-    {
-      float dis2 = (float)(x*x + y*y);
-      if (dis2 > inRadius2)
-        continue;
-
-      const float cur_gray = out_data [(y+outRadius)*out_step +x+outRadius];
-      const unsigned char cur_flag = flag_data[(y+outRadius)*flag_step+x+outRadius];
-      if (cur_flag == 0)
-        continue;
-
-      const float nDirX = static_cast<float>(x);
-      const float nDirY = static_cast<float>(y);
-      float nOri = atan2(nDirY, nDirX);
-      if (std::abs(nOri - M_PI) < std::numeric_limits<float>::epsilon()) //[-M_PI, M_PI)
-      {
-        nOri = static_cast<float>(-M_PI);
-      }
-
-      bool isInBound = true;
-      for (int k=0; k<LIOP_NUM; k++)
-      {
-        const float deltaX = lsRadius * cos(nOri+k*theta);
-        const float deltaY = lsRadius * sin(nOri+k*theta);
-
-        const float sampleX = x+deltaX+outRadius;
-        const float sampleY = y+deltaY+outRadius;
-        float gray;
-
-        if (!BilinearInterpolation_BorderCheck(gray, sampleX, sampleY, outPatch, flagPatch))
-        {
-          isInBound = false;
-          break;
-        }
-        src[k] = gray;
-      }
+    if (flag_data[sampling.center] == 0)
+      continue;
 
-      if (!isInBound)
+    bool isInBound = true;
+    for (int k=0; k<LIOP_NUM; k++)
+    {
+      const int * corners = sampling.corners[k];
+      if (flag_data[corners[0]] == 0 ||
+          flag_data[corners[1]] == 0 ||
+          flag_data[corners[2]] == 0 ||
+          flag_data[corners[3]] == 0)
       {
-        continue;
+        isInBound = false;
+        break;
       }
+      const float * weights = sampling.weights[k];
+      src[k] =
+        weights[0] * out_data[corners[0]] +
+        weights[1] * out_data[corners[1]] +
+        weights[2] * out_data[corners[2]] +
+        weights[3] * out_data[corners[3]];
+    }
 
-      int key = 0;
-      SortGray(dst, idx, src, LIOP_NUM);
-      for (int k=0; k<LIOP_NUM; ++k)
-      {
-        key += (idx[k]+1)* m_LiopPosWeight[LIOP_NUM-k-1];
-      }
-      std::map<int, unsigned char>::const_iterator iter = m_LiopPatternMap.find(key);
-      if (iter != m_LiopPatternMap.end())
-      {
-        Pixel pix;
-        pix.x = x;
-        pix.y = y;
-        pix.f_gray = cur_gray;
-        pix.weight = 1;
-        pix.l_pattern = iter->second;
-        pixel[pixelCount++] = pix;
-      }
+    if (!isInBound)
+    {
+      continue;
     }
+
+    Pixel pix;
+    pix.f_gray = out_data[sampling.center];
+    pix.l_pattern = m_LiopPatternTable[OrderingCode(src)];
+    pixel[pixelCount++] = pix;
   }
 
   std::sort(pixel, pixel+pixelCount, fGrayComp);  //sort by gray
@@ -287,7 +288,7 @@ void Liop_Descriptor_Extractor::CreateLIOP_GOrder(
         }
 
         const int id = regionId*l_patternWidth+pixel[curId].l_pattern;
-        desc[id] += pixel[curId].weight;
+        desc[id] += 1.f;
         ++curId;
       }
 
@@ -297,7 +298,7 @@ void Liop_Descriptor_Extractor::CreateLIOP_GOrder(
           break;
 
         const int id = regionId*l_patternWidth+pixel[curId].l_pattern;
-        desc[id] += pixel[curId].weight;
+        desc[id] += 1.f;
         ++curId;
       }
     }
@@ -309,34 +310,31 @@ void Liop_Descriptor_Extractor::CreateLIOP_GOrder(
 void Liop_Descriptor_Extractor::extract(
   const image::Image<unsigned char> & I,
   const SIOPointFeature & feat,
-  float desc[144])
+  Patch_Buffers & buffers,
+  float desc[144]) const
 {
   memset(desc, 0, sizeof(float)*144);
 
   //a. extract the local patch
-  const int scalePatchWidth = 31;
-
-  const int outPatchWidth = scalePatchWidth+6;
-  const int outRadius = outPatchWidth/2;
-  const int outRadius2 = outRadius*outRadius;
+  const int outRadius2 = OUT_RADIUS*OUT_RADIUS;
   const float scale = feat.scale();
 
-  image::Image<float> outPatch(outPatchWidth,outPatchWidth, true, 0);
-  image::Image<unsigned char> flagPatch(outPatchWidth, outPatchWidth, true, 0);
+  buffers.outPatch.fill(0);
+  buffers.flagPatch.fill(0);
 
   const image::Sampler2d<image::SamplerLinear> sampler;
 
   // pointer alias
-  unsigned char * flagPatch_data = flagPatch.data();
-  float * outPatch_data = outPatch.data();
+  unsigned char * flagPatch_data = buffers.flagPatch.data();
+  float * outPatch_data = buffers.outPatch.data();
 
-  for (int y=-outRadius; y<=outRadius; ++y)
+  for (int y=-OUT_RADIUS; y<=OUT_RADIUS; ++y)
   {
     const float ys = y*scale+feat.y();
     if (ys<0 || ys>I.Height()-1)
       continue;
 
-    for (int x=-outRadius; x<=outRadius; ++x)
+    for (int x=-OUT_RADIUS; x<=OUT_RADIUS; ++x)
     {
       const float dis2 = (float)(x*x + y*y);
       if (dis2 > outRadius2)
@@ -346,15 +344,45 @@ void Liop_Descriptor_Extractor::extract(
       if (xs<0 || xs>I.Width()-1)
         continue;
 
-      outPatch_data[(y+outRadius)*outPatchWidth+x+outRadius] = sampler(I, ys, xs);
-      flagPatch_data[(y+outRadius)*outPatchWidth+x+outRadius] = 1;
+      outPatch_data[(y+OUT_RADIUS)*OUT_PATCH_WIDTH+x+OUT_RADIUS] = sampler(I, ys, xs);
+      flagPatch_data[(y+OUT_RADIUS)*OUT_PATCH_WIDTH+x+OUT_RADIUS] = 1;
     }
   }
-  image::ImageGaussianFilter(image::Image<float>(outPatch), 1.2, outPatch);
+  image::ImageGaussianFilter(buffers.outPatch, 1.2, buffers.blurredPatch);
 
   //b. creation of the LIOP ordering
-  const int inRadius = scalePatchWidth/2;
-  CreateLIOP_GOrder(outPatch, flagPatch, inRadius, desc);
+  CreateLIOP_GOrder(buffers.blurredPatch.data(), flagPatch_data, desc);
+}
+
+void Liop_Descriptor_Extractor::extract(
+  const image::Image<unsigned char> & I,
+  const SIOPointFeature & feat,
+  float desc[144]) const
+{
+  Patch_Buffers buffers;
+  extract(I, feat, buffers, desc);
+}
+
+void Liop_Descriptor_Extractor::extract(
+  const image::Image<unsigned char> & I,
+  const std::vector<SIOPointFeature> & feats,
+  std::vector<float> & descs) const
+{
+  descs.resize(feats.size() * 144);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // Buffers of each thread
+    Patch_Buffers buffers;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i = 0; i < static_cast<int>(feats.size()); ++i)
+    {
+      extract(I, feats[i], buffers, &descs[i * 144]);
+    }
+  }
 }
 
 template<typename T>
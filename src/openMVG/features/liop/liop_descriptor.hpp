@@ -24,6 +24,7 @@
 namespace openMVG { namespace features { class SIOPointFeature; } }
 namespace openMVG { namespace image { template <typename T> class Image; } }
 
+#include <array>
 #include <map>
 #include <vector>
 
@@ -36,21 +37,56 @@ class Liop_Descriptor_Extractor
 private:
   std::map<int, unsigned char> m_LiopPatternMap;
   std::vector<int> m_LiopPosWeight;
-public:
 
-  Liop_Descriptor_Extractor();
+  /// Pattern id of each intensity ordering of the LIOP_NUM neighbors
+  /// (indexed by the base 4 code of the sorted neighbor indexes)
+  std::array<unsigned char, 256> m_LiopPatternTable;
+
+  /// Precomputed sampling of the LIOP neighbors of an inner patch pixel
+  /// (only the pixels whose neighbors are inside the patch are listed)
+  struct Neighbor_Sampling
+  {
+    int center;          // Index of the inner pixel in the patch
+    int corners[4][4];   // Bilinear corners of each neighbor (patch indexes)
+    float weights[4][4]; // Bilinear weights of each neighbor
+  };
+  std::vector<Neighbor_Sampling> m_NeighborSamplings;
+
+  /// Buffers used to describe a feature (reused across features)
+  struct Patch_Buffers;
 
   void extract(
     const image::Image<unsigned char> & I,
     const SIOPointFeature & feat,
-    float desc[144]);
+    Patch_Buffers & buffers,
+    float desc[144]) const;
 
   void CreateLIOP_GOrder(
-    const image::Image<float> & outPatch,
-    const image::Image<unsigned char> & flagPatch,
-    const int inRadius,
+    const float * outPatch,
+    const unsigned char * flagPatch,
     float desc[144]) const;
 
+public:
+
+  Liop_Descriptor_Extractor();
+
+  void extract(
+    const image::Image<unsigned char> & I,
+    const SIOPointFeature & feat,
+    float desc[144]) const;
+
+  /**
+  * @brief Compute the descriptors of all the features of an image
+  *  (the features are described in parallel)
+  * @param I Input image
+  * @param feats The features to describe
+  * @param[out] descs The descriptors (144 values per feature)
+  */
+  void extract(
+    const image::Image<unsigned char> & I,
+    const std::vector<SIOPointFeature> & feats,
+    std::vector<float> & descs) const;
+
   void GeneratePatternMap(
     std::map<int,unsigned char> & pattern_map,
     std::vector<int> & pos_weight,
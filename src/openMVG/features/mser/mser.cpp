@@ -7,10 +7,11 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/features/mser/mser.hpp"
+#include "openMVG/features/component_tree.hpp"
 #include "openMVG/features/mser/mser_region.hpp"
 #include "openMVG/image/image_container.hpp"
 
-#include <iostream>
+#include <array>
 #include <stack>
 
 namespace openMVG
@@ -24,154 +25,6 @@ namespace openMVG
       const int MSERExtractor::MSER_8_CONNECTIVITY = 1;
 
 
-      // Ordering of neighboring
-      /*
-          3     2     1
-          4           0
-          5     6     7
-      */
-      enum PixelNeighborsDirection
-      {
-        PIXEL_RIGHT = 0 ,
-        PIXEL_TOP_RIGHT    = 1 ,
-        PIXEL_TOP = 2 ,
-        PIXEL_TOP_LEFT = 3 ,
-        PIXEL_LEFT = 4 ,
-        PIXEL_BOTTOM_LEFT = 5 ,
-        PIXEL_BOTTOM = 6 ,
-        PIXEL_BOTTOM_RIGHT = 7
-      };
-
-
-      /**
-      * @brief Given preceding direction used to search a pixel, get the next pixel direction
-      * @param dir Preceding direction
-      * @param neighboring_type Kind of connectivity used (MSER_4_CONNECTIVITY or MSER_8_CONNECTIVITY)
-      */
-      static inline PixelNeighborsDirection NextDirection( const PixelNeighborsDirection dir , const int neighboring_type )
-      {
-        if (neighboring_type == MSERExtractor::MSER_4_CONNECTIVITY )
-        {
-          // Assuming dir is even
-          return PixelNeighborsDirection( ( static_cast<int>( dir ) + 2 ) );
-        }
-        else // neighboring_type == MSERExtractor::MSER_8_CONNECTIVITY
-        {
-          return PixelNeighborsDirection( ( static_cast<int>( dir ) + 1 ) );
-        }
-      }
-
-      /**
-      * @brief Indicate if pixel is inside the image range
-      * @param x X-coord of the tested pixel
-      * @param y Y-coord of the tested pixel
-      * @param img_width Width of the image
-      * @param img_height Height of the image
-      * @retval true if the pixel is inside the image
-      * @retval false if the pixel is outside the image
-      */
-      static inline bool ValidPixel( const int x , const int y ,
-                                     const int img_width , const int img_height )
-      {
-        return x >= 0 && y >= 0 && x < img_width && y < img_height;
-      }
-
-      /*
-      * Given a pixel and image dimension, retrieve its neighbor
-      * If neighbor is out of the image range, return (-1,-1) coord
-      * @param x Input x pixel coord
-      * @param y Input y pixel coord
-      * @param dir Neighbor direction to retrieve
-      * @param img_width Width of the image
-      * @param img_height Height of the image
-      * @param[out] nx Neighbor x pixel coord
-      * @param[out] ny Neighbor y pixel coord
-      * @return true if input params are all good | false if dir is incorrect
-      */
-      static inline bool GetNeighbor( const int x , const int y ,
-                                      const PixelNeighborsDirection dir ,
-                                      const int img_width , const int img_height ,
-                                      int & nx , int & ny )
-      {
-        nx = x;
-        ny = y;
-
-        switch (dir)
-        {
-        case PIXEL_TOP_LEFT :
-        {
-          nx -= 1;
-          ny -= 1;
-          break;
-        }
-        case PIXEL_TOP :
-        {
-          ny -= 1;
-          break;
-        }
-        case PIXEL_TOP_RIGHT :
-        {
-          nx += 1;
-          ny -= 1;
-          break;
-        }
-        case PIXEL_LEFT :
-        {
-          nx -= 1;
-          break;
-        }
-        case PIXEL_RIGHT:
-        {
-          nx += 1;
-          break;
-        }
-        case PIXEL_BOTTOM_LEFT:
-        {
-          nx -= 1;
-          ny += 1;
-          break;
-        }
-        case PIXEL_BOTTOM :
-        {
-          ny += 1;
-          break;
-        }
-        case PIXEL_BOTTOM_RIGHT :
-        {
-          nx += 1;
-          ny += 1;
-          break;
-        }
-        default:
-        {
-          std::cerr << "Unhandled pixel direction" << std::endl;
-          return false;
-        }
-        }
-
-        if (! ValidPixel( nx , ny , img_width , img_height ) )
-        {
-          nx = -1;
-          ny = -1;
-        }
-        return true;
-      }
-
-      /**
-      * @brief Pixel info (for easy manipulation)
-      */
-      struct PixelStackElt
-      {
-        // Position of the processed pixel
-        int pix_x;
-        int pix_y;
-        // Level of the processed pixel
-        int pix_level;
-        // Current neighhobor to process
-        PixelNeighborsDirection edge_index;
-      };
-
-
       /**
       * @brief MSER extractor feature
       * @param delta Distance between levels used to check stability (area(i) - area(i - delta) ) / area( i ) )
@@ -206,166 +59,212 @@ namespace openMVG
         const int minRegArea = img.Width() * img.Height() * m_minimum_area;
         const int maxRegArea = img.Width() * img.Height() * m_maximum_area;
 
-        // List of processed pixels (maybe we can use a more efficient structure)
-        std::vector<std::vector<bool >> processed;
-        processed.resize( img.Width() );
-        for (int i = 0; i < img.Width(); ++i )
+        if (img.Width() == 0 || img.Height() == 0 )
         {
-          processed[ i ].resize( img.Height() );
-          std::fill( processed[ i ].begin() , processed[ i ].end() , false );
+          return;
         }
 
-        // Holds the boundary of given grayscale value (boundary[0] -> pixels in the boundary with 0 grayscale value)
-        std::vector<PixelStackElt> boundary[ 256 ];
-
-        // List of regions computed so far (not only valid MSER regions)
-        std::vector<MSERRegion *> regionStack;
-
-        // Push en empty region
-        regionStack.push_back( new MSERRegion );
-
-        // Start processing from top left pixel
-        PixelStackElt cur_pix;
-        cur_pix.pix_x = 0;
-        cur_pix.pix_y = 0;
-        cur_pix.pix_level = img( 0 , 0 );
-        cur_pix.edge_index = PIXEL_RIGHT;
-
-        processed[ cur_pix.pix_x ][ cur_pix.pix_y ] = true;
-
-        regionStack.push_back( new MSERRegion( cur_pix.pix_level , cur_pix.pix_x , cur_pix.pix_y ) );
-
-        int priority = 256;
-
-        // Start process
-        while (1)
+        // Build the component tree of the dark regions (the root is the brightest level)
+        std::array<unsigned char, 256> level_rank;
+        for (int level = 0; level < 256; ++level )
         {
-          bool restart = false;
+          level_rank[ level ] = static_cast<unsigned char>( 255 - level );
+        }
+        Component_Tree tree;
+        tree.Build( img , level_rank , m_connectivity == MSER_8_CONNECTIVITY );
+        const std::vector<unsigned int> & parents = tree.Parents();
+        const std::vector<Component_Tree::Attribute> & attributes = tree.Attributes();
+
+        // List the regions (nodes of the tree) from the root to the leaves
+        std::vector<unsigned int> node_pixel;
+        std::vector<unsigned int> node_index( parents.size() );
+        for (const unsigned int p : tree.SortedPixels() )
+        {
+          if (tree.IsCanonical( p ) )
+          {
+            node_index[ p ] = node_pixel.size();
+            node_pixel.push_back( p );
+          }
+        }
+        const int node_count = static_cast<int>( node_pixel.size() );
 
-          // Process neighboring to see if there's something to search with lower grayscale level
-          for ( PixelNeighborsDirection curDir = cur_pix.edge_index;
-                curDir <= PIXEL_BOTTOM_RIGHT;
-                curDir = NextDirection( curDir , m_connectivity ) )
+        std::vector<int> node_parent( node_count ); // -1 for the root
+        std::vector<int> node_level( node_count );
+        std::vector<int> node_area( node_count );
+        std::vector<int> child_offsets( node_count + 1 , 0 );
+        for (int i = 0; i < node_count; ++i )
+        {
+          const unsigned int p = node_pixel[ i ];
+          node_parent[ i ] = ( parents[ p ] == p ) ? -1 : static_cast<int>( node_index[ parents[ p ] ] );
+          node_level[ i ] = img[ p ];
+          node_area[ i ] = static_cast<int>( attributes[ p ].area );
+          if (node_parent[ i ] != -1 )
           {
-            int nx , ny;
-            GetNeighbor( cur_pix.pix_x , cur_pix.pix_y , curDir , img.Width() , img.Height() , nx , ny );
+            ++child_offsets[ node_parent[ i ] + 1 ];
+          }
+        }
+        node_index = std::vector<unsigned int>();
 
-            // Pixel was not processed before
-            if (ValidPixel( nx , ny , img.Width() , img.Height() ) && ! processed[ nx ][ ny ] )
+        // Children list of each region: [child_offsets[i], child_offsets[i+1]) in children
+        for (int i = 0; i < node_count; ++i )
+        {
+          child_offsets[ i + 1 ] += child_offsets[ i ];
+        }
+        std::vector<int> children( child_offsets[ node_count ] );
+        {
+          std::vector<int> position( child_offsets.begin() , child_offsets.end() - 1 );
+          for (int i = 0; i < node_count; ++i )
+          {
+            if (node_parent[ i ] != -1 )
             {
-              const int nLevel = img( ny , nx );
-              processed[ nx ][ ny ] = true;
-
-              // Info of the neighboring pixel
-              PixelStackElt n_elt;
-              n_elt.pix_x = nx;
-              n_elt.pix_y = ny;
-              n_elt.pix_level = nLevel;
-              n_elt.edge_index = PIXEL_RIGHT;
-
-              // Now look from which pixel do we have to continue
-              if (nLevel >= cur_pix.pix_level )
-              {
-                // Continue from the same pixel
-                boundary[ nLevel ].push_back( n_elt );
-
-                // Store the lowest value so far
-                priority = std::min( nLevel , priority );
-              }
-              else
-              {
-                // Go on with the neighboring pixel (go down)
-                cur_pix.edge_index = NextDirection( curDir , m_connectivity ); // Next time we have to process the next boundary pixel
-                boundary[ cur_pix.pix_level ].push_back( cur_pix );
-
-                // Store the lowest value so far
-                priority = std::min( cur_pix.pix_level , priority );
-
-                // Push the next pixel to process
-                cur_pix = n_elt;
-                restart = true;
-                break;
-              }
+              children[ position[ node_parent[ i ] ]++ ] = i;
             }
           }
-          // Do we have to restart from a new pixel ?
-          if (restart )
+        }
+
+        // Compute the variation of the regions:
+        // (area(ref) - area) / area, with ref the upmost region with level no more than level + delta
+        std::vector<double> variation( node_count );
+        std::vector<int> reference( node_count );
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp parallel for
+#endif
+        for (int i = 0; i < node_count; ++i )
+        {
+          int ref = i;
+          while (node_parent[ ref ] != -1 && ( node_level[ node_parent[ ref ] ] <= ( node_level[ i ] + m_delta ) ))
           {
-            // If so it's that because we found a lower grayscale value so let's start a new region
-            regionStack.push_back( new MSERRegion( cur_pix.pix_level , cur_pix.pix_x , cur_pix.pix_y ) );
-            continue;
+            ref = node_parent[ ref ]; // Climb hierarchy
           }
+          reference[ i ] = ref;
+          variation[ i ] = static_cast<double>( node_area[ ref ] - node_area[ i ] ) / static_cast<double>( node_area[ i ] );
+        }
 
-          // We have process all the neighboring pixels, current pixel is the lowest we have found so far
-          // now process the current pixel
-          regionStack.back()->AppendPixel( cur_pix.pix_x , cur_pix.pix_y );
-
-          // End of the process : we have no boundary region, compute MSER from graph
-          if (priority == 256 )
+        // Check the stability of the regions
+        std::vector<char> is_stable( node_count , 0 );
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp parallel for
+#endif
+        for (int i = 0; i < node_count; ++i )
+        {
+          const bool stable =
+            // Hierarchy MSER criterion: less variation than its reference
+            variation[ i ] <= variation[ reference[ i ] ] &&
+            // Basic MSER criterion
+            ( ( variation[ i ] <= m_max_variation ) && ( node_area[ i ] >= minRegArea ) && ( node_area[ i ] <= maxRegArea ) );
+          if (! stable )
           {
-            regionStack.back()->ComputeMSER( m_delta , minRegArea , maxRegArea , m_max_variation , m_min_diversity , regions );
-            break;
+            continue;
           }
-
-          PixelStackElt next_pix = boundary[ priority ].back();
-          boundary[ priority ].pop_back();
-
-          // Get the next pixel level
-          while (boundary[ priority ].empty() && ( priority < 256 ))
+          // A leaf or a region with a child that has more variation is stable
+          if (child_offsets[ i ] == child_offsets[ i + 1 ] )
           {
-            ++priority;
+            is_stable[ i ] = 1;
           }
-
-          // Clear the stack
-          const int newLevel = next_pix.pix_level;
-
-          // Process the current stack of pixels if the next processing pixel is not at the same curent level
-          if (newLevel != cur_pix.pix_level )
+          for (int k = child_offsets[ i ]; k < child_offsets[ i + 1 ]; ++k )
           {
-            // Try to merge the regions to fomr a tree
-            ProcessStack( newLevel , next_pix.pix_x , next_pix.pix_y , regionStack );
+            if (variation[ i ] < variation[ children[ k ] ] )
+            {
+              is_stable[ i ] = 1;
+              break;
+            }
           }
-
-          // Update next pixel for processing
-          cur_pix = next_pix;
         }
 
-        // Clear region stack created so far
-        for (size_t i = 0; i < regionStack.size(); ++i )
+        // Diversity criterion on the children: the regions inside a stable region
+        // with an area larger than area * ( 1 - minDiversity ) must be less stable
+        std::vector<char> children_criteria( node_count , 1 );
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < node_count; ++i )
         {
-          delete regionStack[ i ];
+          if (! is_stable[ i ] )
+          {
+            continue;
+          }
+          const int max_children_area = static_cast<int>( static_cast<double>( node_area[ i ] ) * ( 1.0 - m_min_diversity ) + 0.5 );
+          if (node_area[ i ] <= max_children_area )
+          {
+            continue;
+          }
+          std::stack<int> to_check;
+          for (int k = child_offsets[ i ]; k < child_offsets[ i + 1 ]; ++k )
+          {
+            to_check.push( children[ k ] );
+          }
+          while (! to_check.empty() )
+          {
+            const int cur = to_check.top();
+            to_check.pop();
+            // Small enough -> that's enough to decide
+            if (node_area[ cur ] <= max_children_area )
+            {
+              continue;
+            }
+            // It's stable and with less variation
+            if (is_stable[ cur ] && ( variation[ cur ] < variation[ i ] ) )
+            {
+              children_criteria[ i ] = 0;
+              break;
+            }
+            for (int k = child_offsets[ cur ]; k < child_offsets[ cur + 1 ]; ++k )
+            {
+              to_check.push( children[ k ] );
+            }
+          }
         }
-      }
 
-      /**
-      * Try to merge region with same level
-      * @param nextLevel Level used to limit search
-      * @param pixel_x X-coord of the base of the merged region
-      * @param pixel_y Y-coord of the base of the merged region
-      */
-      void MSERExtractor::ProcessStack( const int nextLevel , const int pixel_x , const int pixel_y , std::vector<MSERRegion * > & regionStack ) const
-      {
-        do
+        // Export the regions from the root to the leaves
+        // (a region is discarded if one of its exported parents is more stable)
+        for (int i = 0; i < node_count; ++i )
         {
-          MSERRegion * top = regionStack.back();
-          regionStack.pop_back();
+          if (! is_stable[ i ] )
+          {
+            continue;
+          }
 
-          if (nextLevel < regionStack.back()->m_level )
+          // 1 - Parent must have minimum size
+          const int minimum_parent_area = static_cast<int>( static_cast<double>( node_area[ i ] ) / ( 1.0 - m_min_diversity ) + 0.5 );
+          int cur_parent = i;
+          while (node_parent[ cur_parent ] != -1 && ( node_area[ node_parent[ cur_parent ] ] < minimum_parent_area ))
           {
-            regionStack.push_back( new MSERRegion( nextLevel , pixel_x , pixel_y ) );
+            cur_parent = node_parent[ cur_parent ];
 
-            regionStack.back()->MergeRegion( top );
-            return;
+            // 2 - Parent must have move diversity than its children
+            // If not it's more stable than this region
+            if (is_stable[ cur_parent ] && ( variation[ cur_parent ] <= variation[ i ] ) )
+            {
+              is_stable[ i ] = 0;
+              break;
+            }
           }
 
-          regionStack.back()->MergeRegion( top );
-
+          // If it's still stable, check children area
+          if (is_stable[ i ] && ! children_criteria[ i ] )
+          {
+            is_stable[ i ] = 0;
+          }
 
+          // If it successfully pass all the test, add the region
+          if (is_stable[ i ] )
+          {
+            const unsigned int p = node_pixel[ i ];
+            const Component_Tree::Attribute & attribute = attributes[ p ];
+            MSERRegion region( node_level[ i ] , p % img.Width() , p / img.Width() );
+            region.m_is_stable = true;
+            region.m_variation = variation[ i ];
+            region.m_area = node_area[ i ];
+            region.m_moment_x = attribute.sum_x;
+            region.m_moment_y = attribute.sum_y;
+            region.m_moment_x2 = attribute.sum_xx;
+            region.m_moment_y2 = attribute.sum_yy;
+            region.m_moment_xy = attribute.sum_xy;
+            regions.push_back( region );
+          }
         }
-        while (nextLevel > regionStack.back()->m_level);
       }
 
-
     } // namespace MSER
   } // namespace features
 } // namespace openMVG
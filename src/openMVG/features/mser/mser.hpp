@@ -13,7 +13,8 @@
 namespace openMVG { namespace image { template <typename T> class Image; } }
 
 /**
-* @note Implementation based of the D. Nister method : "Linear Time Maximally Stable Extremal Regions" [1]
+* @note The region hierarchy is the component tree of the image (built in parallel, see features::Component_Tree)
+*  and the stability criteria follow the D. Nister method : "Linear Time Maximally Stable Extremal Regions" [1]
 */
 //------------------
 //-- Bibliography --
@@ -88,14 +89,6 @@ namespace openMVG
 
       private:
 
-        /**
-        * Try to merge region with same level
-        * @param nextLevel Level used to limit search
-        * @param pixel_x X-coord of the base of the merged region
-        * @param pixel_y Y-coord of the base of the merged region
-        */
-        void ProcessStack( const int nextLevel , const int pixel_x , const int pixel_y , std::vector<MSERRegion * > & regionStack ) const;
-
         int m_delta; // Maximum level distance to check stability
         double m_minimum_area; // Minimum area (relative to the image) of the valid regions
         double m_maximum_area; // Maximum area (relative to the image) of the valid regions
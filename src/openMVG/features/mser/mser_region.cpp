@@ -25,10 +25,7 @@ namespace openMVG
       * @param base_y Base pixel of the region in y-coordinate
       */
       MSERRegion::MSERRegion( const int region_level , const int base_x , const int base_y )
-        : m_parent( nullptr ) ,
-          m_child( nullptr ) ,
-          m_sister( nullptr ) ,
-          m_is_stable( false ) ,
+        : m_is_stable( false ) ,
           m_variation( std::numeric_limits<double>::infinity() ) ,
           m_level( region_level ) ,
           m_base_x( base_x ) ,
@@ -180,228 +177,6 @@ namespace openMVG
         }
       }
 
-      /**
-       * @brief Add a new pixel in the region
-       * @param x X-Coord of the pixel to append
-       * @param y Y-Coord of the pixel to append
-       */
-      void MSERRegion::AppendPixel( const int x , const int y )
-      {
-        // One more pixel -> area is growing (what a deduction !)
-        ++m_area;
-
-        // update geometric moments
-        m_moment_x += static_cast<double>( x );
-        m_moment_y += static_cast<double>( y );
-
-        m_moment_x2 += static_cast<double>( x * x );
-        m_moment_y2 += static_cast<double>( y * y );
-
-        m_moment_xy += static_cast<double>( x * y );
-      }
-
-      /**
-      * @brief Add a new child to this region (append infos and make connectivity)
-      * @param child Region to append
-      */
-      void MSERRegion::MergeRegion( MSERRegion * child )
-      {
-        // Update area
-        m_area += child->m_area;
-
-        // Update moments
-        m_moment_x += child->m_moment_x;
-        m_moment_y += child->m_moment_y;
-        m_moment_x2 += child->m_moment_x2;
-        m_moment_y2 += child->m_moment_y2;
-        m_moment_xy += child->m_moment_xy;
-
-        // Enque child in the linked child list
-        child->m_sister = m_child;
-        m_child = child;
-
-        // Update child parent
-        child->m_parent = this;
-      }
-
-
-      /**
-      * @brief Compute MSER stability , compress parent path, and check if the region (and its children) is stable
-      * @param delta distance (in level) to the other region to compute stability (stability is not made up to delta level)
-      * @param minimumArea Minimum area to be accepted as stable
-      * @param maximumArea Maximum area to be accepted as stable
-      * @param maxVariation Maximum variation (difference between parent area and region area) to be accepted as stable
-      */
-      void MSERRegion::ComputeStability( const int delta , const int minimumArea , const int maximumArea , const double maxVariation )
-      {
-        // Found the upmost region with region no more than delta (ie: reference for stability)
-        MSERRegion * ref = this;
-
-        while (ref->m_parent && ( ref->m_parent->m_level <= ( m_level + delta ) ))
-        {
-          ref = ref->m_parent; // Climb hierarchy
-        }
-
-        // Compute variation between the reference region and the current region
-        m_variation = static_cast<double>( ref->m_area - m_area ) / static_cast<double>( m_area );
-
-        // Ensure the region could be qualified as stable
-        const bool stable =
-          // Hierarchy MSER criterion
-          ( ( ref == nullptr ) || m_variation <= ref->m_variation ) && // Top level region or less variation than its parent
-          // Basic MSER criterion
-          ( ( m_variation <= maxVariation ) && ( m_area >= minimumArea ) && ( m_area <= maximumArea ) );
-
-        // Process the children and check at least one child is stable
-        MSERRegion * cur_child = m_child;
-        if (! cur_child )
-        {
-          if (stable )
-          {
-            m_is_stable = true;
-          }
-        }
-        else
-        {
-          // Process child list
-          while (cur_child != nullptr)
-          {
-            cur_child->ComputeStability( delta , minimumArea , maximumArea , maxVariation );
-
-            // At least one child is stable -> the region is stable
-            if (stable && ( m_variation < cur_child->m_variation ))
-            {
-              m_is_stable = true;
-            }
-
-            cur_child = cur_child->m_sister;
-          }
-        }
-      }
-
-      /**
-      * @brief check criteria on the whole region
-      * @param variation Minimum variation to validate the criteria
-      * @param area Maximum area to validate the criteria
-      * @return true if it as minimum variation and maximum area (on the whole region, ie: region and its child)
-      */
-      bool MSERRegion::CheckCriteria( const double variation , const int area ) const
-      {
-        // Has minimum area -> that's enough to decide
-        if (m_area <= area )
-        {
-          return true;
-        }
-
-        // It's stable and with enough variation
-        if (m_is_stable && ( m_variation < variation ) )
-        {
-          return false;
-        }
-
-        MSERRegion * cur_child = m_child;
-        while (cur_child != nullptr)
-        {
-          if (! cur_child->CheckCriteria( variation , area ) )
-          {
-            return false;
-          }
-
-          cur_child = cur_child->m_sister;
-        }
-
-        // Every child pass the criteria
-        return true;
-      }
-
-      /**
-      * Cut all reference to any region in the hierarchy
-      */
-      void MSERRegion::Isolate( )
-      {
-        m_parent = nullptr;
-        m_child = nullptr;
-        m_sister = nullptr;
-      }
-
-
-      /**
-      * @brief Export region and it's children if it validate the MSER diversity criterion
-      * @param minDiversity Minimum diversity to validate the region
-      * @param[out] regions Region that validate the criterion
-      */
-      void MSERRegion::Export( const double minDiversity , std::vector<MSERRegion> & regions )
-      {
-        // Only export if it's stable
-        if (m_is_stable )
-        {
-          // But don't export only if it's stable !
-          // Need to check the hierarchy if parent is more stable than this region
-
-          // 1 - Parent must have minimum size
-          const int minimum_parent_area = static_cast<int>( static_cast<double>( m_area ) / ( 1.0 - minDiversity ) + 0.5 );
-
-          MSERRegion * cur_parent = this;
-          while (cur_parent->m_parent != nullptr && ( cur_parent->m_parent->m_area < minimum_parent_area ))
-          {
-            cur_parent = cur_parent->m_parent;
-
-            // 2 - Parent must have move diversity than its children
-            // If not it's more stable than this region
-            if (cur_parent->m_is_stable && ( cur_parent->m_variation <= m_variation ) )
-            {
-              m_is_stable = false;
-              break;
-            }
-          }
-
-          // If it's still stable, check children area
-          if (m_is_stable )
-          {
-            const int max_children_area = static_cast<int>( static_cast<double>( m_area ) * ( 1.0 - minDiversity ) + 0.5 );
-            if (! CheckCriteria( m_variation , max_children_area ) )
-            {
-              // Does'nt pass stability criteria
-              m_is_stable = false;
-            }
-          }
-
-          // If it successfully pass all the test, add the region
-          if (m_is_stable )
-          {
-            // Make a copy
-            regions.push_back( *this );
-            regions.back().Isolate();
-          }
-        }
-
-        // Try to export the child regions
-        MSERRegion * cur_child = m_child;
-        while (cur_child != nullptr)
-        {
-          cur_child->Export( minDiversity , regions );
-          cur_child = cur_child->m_sister;
-        }
-
-      }
-
-      /**
-      * @brief Compute valid MSER regions from a given region
-      * @param delta distance (in level) to the other region to compute stability (stability is not made up to delta level)
-      * @param minimumArea Minimum area to be accepted as stable
-      * @param maximumArea Maximum area to be accepted as stable
-      * @param maxVariation Maximum variation (difference between parent area and region area) to be accepted as stable
-      * @param minDiversity Minimum diversity to validate the region
-      * @param[out] regions Region that validate the criterion
-      */
-      void MSERRegion::ComputeMSER( const int delta , const int minArea , const int maxArea , const double maxVariation , const double minDiversity , std::vector<MSERRegion> & regions )
-      {
-        // Compute MSER stability stats on all the hierarchy
-        ComputeStability( delta , minArea , maxArea , maxVariation );
-        // Export regions that pass all MSER stability checks (region and its direct hierarchy)
-        Export( minDiversity , regions );
-      }
-
     }
 
   }
@@ -65,11 +65,6 @@ namespace MSER
 
       private:
 
-      // Connectivity
-      MSERRegion *m_parent; // Pointer to the parent region
-      MSERRegion *m_child;  // Pointer to the first child of the region
-      MSERRegion *m_sister; // Pointer to the next region (at the same level)
-
       // MSER statistics
       bool   m_is_stable;
       double m_variation; // Variation between parent area and this area
@@ -86,59 +81,6 @@ namespace MSER
       double m_moment_y;  // int_{Region} Y
       double m_moment_y2; // int_{Region} Y * Y
       double m_moment_xy; // int_{Region} X * Y
-
-      /**
-        * Cut all reference to any region in the hierarchy
-        */
-      void Isolate( void );
-
-      /**
-        * @brief Add a new pixel in the region
-        * @param x X-Coord of the pixel to append
-        * @param y Y-Coord of the pixel to append
-        */
-      void AppendPixel( const int x, const int y );
-
-      /**
-        * @brief Add a new child to this region (append infos and make connectivity)
-        * @param child Region to append
-        */
-      void MergeRegion( MSERRegion *child );
-
-      /**
-        * @brief Compute MSER stability , compress parent path, and check if the region (and its children) is stable
-        * @param delta distance (in level) to the other region to compute stability (stability is not made up to delta level)
-        * @param minimumArea Minimum area to be accepted as stable
-        * @param maximumArea Maximum area to be accepted as stable
-        * @param maxVariation Maximum variation (difference between parent area and region area) to be accepted as stable
-        */
-      void ComputeStability( const int delta, const int minimumArea, const int maximumArea, const double maxVariation );
-
-      /**
-        * @brief check criteria on the whole region
-        * @param variation Minimum variation to validate the criteria
-        * @param area Maximum area to validate the criteria
-        * @return true if it as minimum variation and maximum area (on the whole region, ie: region and its child)
-        */
-      bool CheckCriteria( const double variation, const int area ) const;
-
-      /**
-        * @brief Export region and its children if it validate the MSER diversity criterion
-        * @param minDiversity Minimum diversity to validate the region
-        * @param[out] regions Region that validate the criterion
-        */
-      void Export( const double minDiversity, std::vector<MSERRegion> &regions );
-
-      /**
-        * @brief Compute valid MSER regions from a given region
-        * @param delta distance (in level) to the other region to compute stability (stability is not made up to delta level)
-        * @param minimumArea Minimum area to be accepted as stable
-        * @param maximumArea Maximum area to be accepted as stable
-        * @param maxVariation Maximum variation (difference between parent area and region area) to be accepted as stable
-        * @param minDiversity Minimum diversity to validate the region
-        * @param[out] regions Region that validate the criterion
-        */
-      void ComputeMSER( const int delta, const int minArea, const int maxArea, const double maxVariation, const double minDiversity, std::vector<MSERRegion> &regions );
     };
 
 } // namespace MSER
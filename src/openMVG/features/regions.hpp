@@ -58,6 +58,9 @@ public:
   /// Return the number of defined regions
   virtual size_t RegionCount() const = 0;
 
+  /// Return the memory used by the regions and their descriptors (in bytes)
+  virtual size_t MemorySize() const = 0;
+
   /// Return a pointer to the first value of the descriptor array
   // Used to avoid complex template imbrication
   virtual const void * DescriptorRawData() const = 0;
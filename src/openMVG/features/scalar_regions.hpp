@@ -81,6 +81,12 @@ public:
   /// Return the number of defined regions
   size_t RegionCount() const override {return vec_feats_.size();}
 
+  size_t MemorySize() const override
+  {
+    return vec_feats_.capacity() * sizeof(FeatureT)
+      + vec_descs_.capacity() * sizeof(DescriptorT);
+  }
+
   /// Mutable and non-mutable FeatureT getters.
   inline FeatsT & Features() { return vec_feats_; }
   inline const FeatsT & Features() const { return vec_feats_; }
@@ -8,10 +8,11 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/features/tbmr/tbmr.hpp"
+#include "openMVG/features/component_tree.hpp"
 #include "openMVG/features/feature.hpp"
 #include "openMVG/image/image_container.hpp"
 
-#include <numeric>
+#include <array>
 
 namespace openMVG
 {
@@ -19,82 +20,6 @@ namespace features
 {
 namespace tbmr
 {
-  namespace internal
-  {
-    static
-    inline
-    unsigned int
-    zfindroot(image::Image<unsigned int>& parent, unsigned int p)
-    {
-      if (parent[p] == p)
-        return p;
-      else
-        return parent[p] = zfindroot(parent, parent[p]);
-    }
-  }
-
-  template <typename I, typename BinaryFunction = std::less<I>>
-  std::vector<unsigned int>
-  pixel_indexes_ordering
-  (
-    const image::Image<I>& input,
-    BinaryFunction cmp = BinaryFunction ()
-  )
-  {
-    const unsigned int pixel_count = input.Width()*input.Height();
-    std::vector<unsigned int> v(pixel_count);
-    std::iota(v.begin(), v.end(), 0);
-    std::sort(v.begin(), v.begin() + pixel_count,
-      [&input, cmp](unsigned int x, unsigned int y)
-      { return cmp(input[x], input[y]); }
-    );
-    return v;
-  }
-
-  std::vector<Vec2i>
-  wrt_delta_index
-  (
-  )
-  {
-    return { { 0,-1 }, {0,1}, {-1, 0}, {1,0} };
-  }
-
-  //for incremental computation of region information
-  struct attribute{
-    unsigned int area = 0;
-    double sum_x = 0;
-    double sum_y = 0;
-    double sum_xy = 0;
-    double sum_xx = 0;
-    double sum_yy = 0;
-
-    attribute& operator += (const attribute & rhs)
-    {
-      area   += rhs.area;
-      sum_x  += rhs.sum_x;
-      sum_xx += rhs.sum_xx;
-      sum_xy += rhs.sum_xy;
-      sum_y  += rhs.sum_y;
-      sum_yy += rhs.sum_yy;
-      return *this;
-    }
-
-    void init
-    (
-      unsigned int area,
-      double x,
-      double y
-    )
-    {
-      this->area = area;
-      sum_x = x;
-      sum_y = y;
-      sum_xy = x * y;
-      sum_xx = x * x;
-      sum_yy = y * y;
-     }
-  };
-
   // Template instantiation for WHITE features
   template
   void Extract_tbmr
@@ -127,81 +52,29 @@ namespace tbmr
     const double maximumRelativeSize
   )
   {
-    //construct the Max/Min-tree based on union-find [Berger 2007 ICIP] + rank
+    //construct the Max/Min-tree (tiled union-find [Berger 2007 ICIP] + rank)
     //and compute incrementally the moments information during tree construction
     //--------------------------------------------------------------------------
 
-    //sort the pixels in the order defined by cmp
-    const std::vector<unsigned int> S = pixel_indexes_ordering(ima, cmp);
-
-    std::vector<unsigned int> parent(ima.Width() * ima.Height());
-    std::vector<unsigned int> root(ima.Width() * ima.Height());
-    std::vector<unsigned int> rank(ima.Width() * ima.Height(), 0);
-    std::vector<bool> dejaVu(ima.Width() * ima.Height(), false);
-    std::vector<attribute> imaAttribute(ima.Width() * ima.Height());
-    image::Image<unsigned int> zpar(ima.Width(), ima.Height());
-
-    const std::vector<Vec2i> offsets(wrt_delta_index());
-
-    for (int i = S.size()-1; i >= 0; --i)
+    // rank of the gray levels in the order defined by cmp
+    std::array<unsigned char, 256> level_rank;
+    for (int level = 0; level < 256; ++level)
     {
-      const unsigned int p = S[i];
-      // make set
-      {
-        parent[p] = p;
-        zpar[p] = p;
-        root[p] = p;
-        dejaVu[p] = true;
-        imaAttribute[p].init(1, p % ima.Width(), p/ima.Width());
-      }
+      int rank = 0;
+      for (int other = 0; other < 256; ++other)
+        rank += cmp(static_cast<unsigned char>(other), static_cast<unsigned char>(level));
+      level_rank[level] = static_cast<unsigned char>(rank);
+    }
 
-      unsigned int x = p; // zpar of p
-      for (unsigned int k = 0; k < offsets.size(); ++k)
-      {
-        const Vec2i point_p (p % ima.Width(), p / ima.Width());
-        const Vec2i point_q = point_p + offsets[k];
-        const unsigned int q = point_q[1] * ima.Width() + point_q[0];
-        if (ima.Contains(point_q[1],point_q[0]) && dejaVu[q])
-        {
-          const unsigned int r = internal::zfindroot(zpar, q);
-          if (r != x)
-          { // make union
-            parent[root[r]] = p;
-            //accumulate information
-            imaAttribute[p] += imaAttribute[root[r]];
+    Component_Tree tree;
+    tree.Build(ima, level_rank);
 
-            if (rank[x] < rank[r])
-            {
-              //we merge p to r
-              zpar[x] = r;
-              root[r] = p;
-              x = r;
-            } else
-            if (rank[r] < rank[p])
-            {
-              // merge r to p
-              zpar[r] = p;
-            } else
-            {
-              // same height
-              zpar[r] = p;
-              rank[p] += 1;
-            }
-          }
-        }
-      }
-    }
+    const std::vector<unsigned int> & S = tree.SortedPixels();
+    const std::vector<unsigned int> & parent = tree.Parents();
+    const std::vector<Component_Tree::Attribute> & imaAttribute = tree.Attributes();
     //end of Min/Max-tree construction
     //--------------------------------------------------------------------------
 
-    // canonization
-    for (unsigned int p: S)
-    {
-      const unsigned int q = parent[p];
-      if (ima[parent[q]] == ima[q])
-        parent[p] = parent[q];
-    }
-
     //TBMRs extraction
 
     /* small variant of the given algorithm in the paper. For each
@@ -215,15 +88,14 @@ namespace tbmr
 
     //--------------------------------------------------------------------------
     std::vector<unsigned int> numSons(ima.Width() * ima.Height(), 0);
-    std::vector<unsigned int> vecNodes(imaAttribute[S[0]].area);
-    unsigned int numNodes = 0;
+    std::vector<unsigned int> vecNodes;
 
     //leaf to root propagation to select the canonized nodes
     for (int i = S.size()-1; i >= 0; --i)
     {
       const unsigned int p = S[i];
-      if (parent[p] == p || ima[p] != ima[parent[p]]) {
-        vecNodes[numNodes++] = p;
+      if (tree.IsCanonical(p)) {
+        vecNodes.push_back(p);
         if (imaAttribute[p].area >= minimumSize)
           ++numSons[parent[p]];
       }
@@ -243,7 +115,7 @@ namespace tbmr
     const unsigned int maxArea = maximumRelativeSize * S.size();
     unsigned int numTbmrs = 0;
 
-    std::vector<unsigned int> vecTbmrs(numNodes);
+    std::vector<unsigned int> vecTbmrs(vecNodes.size());
     for (const unsigned p : vecNodes)
     {
       if (numSons[p] == 1 && !isSeen[p] && imaAttribute[p].area <= maxArea)
@@ -151,6 +151,100 @@ Vec3 ecef_to_lla
   return Vec3(R2D(lat), R2D(lon), alt);
 }
 
+/**
+ ** Batch conversion of WGS84 lat,lon,alt data to ECEF data
+ ** (the trigonometric functions are evaluated on whole arrays)
+ ** @param lla Latitude (degree), longitude (degree) and altitude as columns
+ ** @return ECEF corresponding coordinates (one column per input column)
+ **/
+inline Mat3X lla_to_ecef
+(
+  const Mat3X & lla
+)
+{
+  const Eigen::ArrayXd lat = lla.row(0).transpose().array() * (M_PI / 180.0);
+  const Eigen::ArrayXd lon = lla.row(1).transpose().array() * (M_PI / 180.0);
+  const Eigen::ArrayXd alt = lla.row(2).transpose().array();
+  const Eigen::ArrayXd clat = lat.cos();
+  const Eigen::ArrayXd slat = lat.sin();
+
+  const double a2 = Square(WGS84_A);
+  const double b2 = Square(WGS84_B);
+
+  const Eigen::ArrayXd L = (a2 * clat.square() + b2 * slat.square()).rsqrt();
+  const Eigen::ArrayXd r = (a2 * L + alt) * clat;
+
+  Mat3X ecef(3, lla.cols());
+  ecef.row(0) = (r * lon.cos()).transpose().matrix();
+  ecef.row(1) = (r * lon.sin()).transpose().matrix();
+  ecef.row(2) = ((b2 * L + alt) * slat).transpose().matrix();
+  return ecef;
+}
+
+/**
+ ** Batch conversion of WGS84 lat,lon,alt data to UTM data
+ ** (the points are converted in parallel)
+ ** @param lla Latitude (degree), longitude (degree) and altitude as columns
+ ** @return UTM corresponding coordinates (one column per input column)
+ **/
+inline Mat3X lla_to_utm
+(
+  const Mat3X & lla
+)
+{
+  Mat3X utm(3, lla.cols());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int>(lla.cols()); ++i)
+  {
+    utm.col(i) = lla_to_utm(lla(0, i), lla(1, i), lla(2, i));
+  }
+  return utm;
+}
+
+/**
+ ** Batch conversion of ECEF (XYZ) to lat,lon,alt values for the WGS84 ellipsoid
+ ** (the trigonometric functions are evaluated on whole arrays)
+ ** @param ecef ECEF coordinates as columns
+ ** @return LLA corresponding coordinates (one column per input column)
+ **/
+inline Mat3X ecef_to_lla
+(
+  const Mat3X & ecef
+)
+{
+  const double e2 = WGS84_E * WGS84_E;
+  const double b = sqrt(WGS84_A*WGS84_A*(1-e2));
+  const double ep2 = (WGS84_A*WGS84_A-b*b)/(b*b);
+  const Eigen::ArrayXd x = ecef.row(0).transpose().array();
+  const Eigen::ArrayXd y = ecef.row(1).transpose().array();
+  const Eigen::ArrayXd z = ecef.row(2).transpose().array();
+  const Eigen::ArrayXd p = (x.square() + y.square()).sqrt();
+
+  Eigen::ArrayXd th(p.size()), lon(p.size());
+  for (int i = 0; i < static_cast<int>(p.size()); ++i)
+  {
+    th(i) = atan2(WGS84_A*z(i), b*p(i));
+    lon(i) = atan2(y(i), x(i));
+  }
+  const Eigen::ArrayXd num = z + ep2*b*th.sin().cube();
+  const Eigen::ArrayXd den = p - e2*WGS84_A*th.cos().cube();
+  Eigen::ArrayXd lat(p.size());
+  for (int i = 0; i < static_cast<int>(p.size()); ++i)
+  {
+    lat(i) = atan2(num(i), den(i));
+  }
+  const Eigen::ArrayXd slat = lat.sin();
+  const Eigen::ArrayXd N = WGS84_A * (1-e2*slat.square()).rsqrt();
+
+  Mat3X lla(3, ecef.cols());
+  lla.row(0) = (lat * (180.0 / M_PI)).transpose().matrix();
+  lla.row(1) = (lon * (180.0 / M_PI)).transpose().matrix();
+  lla.row(2) = (p/lat.cos()-N).transpose().matrix();
+  return lla;
+}
+
 } // namespace geodesy
 } // namespace openMVG
 
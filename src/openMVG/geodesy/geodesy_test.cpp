@@ -35,6 +35,26 @@ TEST(GEODESY, LLA_TO_UTM)
   EXPECT_NEAR(alt, utm(2), 1e-6);
 }
 
+TEST(GEODESY, BATCH_CONVERSION)
+{
+  openMVG::Mat3X lla(3, 4);
+  lla <<
+    10,  -45.5, 48.85, 0,
+    20,  170.2, 2.35,  -120,
+    30, -12.0,  1000,  0;
+
+  const openMVG::Mat3X ecef = lla_to_ecef(lla);
+  const openMVG::Mat3X utm = lla_to_utm(lla);
+  const openMVG::Mat3X lla_back = ecef_to_lla(ecef);
+  for (int i = 0; i < lla.cols(); ++i)
+  {
+    const openMVG::Vec3 ecef_i = lla_to_ecef(lla(0, i), lla(1, i), lla(2, i));
+    EXPECT_MATRIX_NEAR(ecef_i, ecef.col(i), 1e-6);
+    EXPECT_MATRIX_NEAR(lla_to_utm(lla(0, i), lla(1, i), lla(2, i)), utm.col(i), 1e-9);
+    EXPECT_MATRIX_NEAR(ecef_to_lla(ecef_i(0), ecef_i(1), ecef_i(2)), lla_back.col(i), 1e-6);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -9,6 +9,13 @@
 
 #include "openMVG/geometry/Similarity3_Kernel.hpp"
 #include "openMVG/geometry/rigid_transformation3D_srt.hpp"
+#include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_ransac_tools.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
 
 namespace openMVG{
 namespace geometry{
@@ -55,6 +62,100 @@ double Similarity3ErrorSquaredMetric::Error
   return (x2 - S(x1)).squaredNorm();
 }
 
+double Similarity3_LMeds
+(
+  const Mat3X & x,
+  const Mat3X & y,
+  Similarity3 * sim,
+  double outlierRatio,
+  double minProba
+)
+{
+  const uint32_t min_samples = Similarity3Solver::MINIMUM_SAMPLES;
+  const uint32_t total_samples = static_cast<uint32_t>(x.cols());
+
+  // Required number of iterations is evaluated from outliers ratio
+  const uint32_t N = (min_samples < total_samples) ?
+    robust::getNumSamples(minProba, outlierRatio, min_samples) : 0;
+
+  // Draw all the samples (same sequence as robust::LeastMedianOfSquares)
+  std::vector<uint32_t> all_samples(total_samples);
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::vector<std::vector<uint32_t>> samples(N, std::vector<uint32_t>(min_samples));
+  for (uint32_t i = 0; i < N; ++i)
+  {
+    robust::UniformSample(min_samples, random_generator, &all_samples, &samples[i]);
+  }
+
+  const uint32_t median_index = uint32_t(total_samples * (1. - outlierRatio));
+  double best_median = std::numeric_limits<double>::max();
+  uint32_t best_hypothesis = N;
+  Similarity3 best_sim;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    Mat3X transformed(3, total_samples);
+    Vec residuals(total_samples);
+    Mat sample_x(3, min_samples), sample_y(3, min_samples);
+    double thread_best_median = std::numeric_limits<double>::max();
+    uint32_t thread_best_hypothesis = N;
+    Similarity3 thread_best_sim;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(N); ++i)
+    {
+      for (uint32_t k = 0; k < min_samples; ++k)
+      {
+        sample_x.col(k) = x.col(samples[i][k]);
+        sample_y.col(k) = y.col(samples[i][k]);
+      }
+      std::vector<Similarity3> models;
+      Similarity3Solver::Solve(sample_x, sample_y, &models);
+
+      for (const auto & model : models)
+      {
+        // Squared residuals of all the points: y - (A * x + b)
+        const Mat3 A = model.scale_ * model.pose_.rotation();
+        const Vec3 b = - A * model.pose_.center();
+        transformed.noalias() = A * x;
+        transformed.colwise() += b;
+        residuals = (y - transformed).colwise().squaredNorm().transpose();
+
+        std::nth_element(residuals.data(), residuals.data() + median_index,
+          residuals.data() + residuals.size());
+        const double median = residuals(median_index);
+
+        // Keep the first hypothesis among the equal medians
+        if (median < thread_best_median ||
+            (median == thread_best_median && static_cast<uint32_t>(i) < thread_best_hypothesis))
+        {
+          thread_best_median = median;
+          thread_best_hypothesis = i;
+          thread_best_sim = model;
+        }
+      }
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    {
+      if (thread_best_median < best_median ||
+          (thread_best_median == best_median && thread_best_hypothesis < best_hypothesis))
+      {
+        best_median = thread_best_median;
+        best_hypothesis = thread_best_hypothesis;
+        best_sim = thread_best_sim;
+      }
+    }
+  }
+
+  if (sim && best_hypothesis < N)
+    *sim = best_sim;
+  return best_median;
+}
 
 } // namespace kernel
 } // namespace geometry
@@ -70,6 +70,32 @@ using Similarity3_Kernel = two_view::kernel::Kernel
     Similarity3                     // The model type
   >;
 
+/**
+* @brief Robust 3D similarity estimation by Least Median of Squares.
+*
+* The hypotheses are drawn upfront (with the same random sequence as
+* robust::LeastMedianOfSquares) and are fitted and scored in parallel. The
+* residuals of a hypothesis are computed on all the points at once from the
+* affine form of the similarity.
+* The result is the one of robust::LeastMedianOfSquares on a Similarity3_Kernel.
+*
+* @param x Source points (3xN)
+* @param y Target points (3xN)
+* @param[out] sim The similarity with the lowest median residual (y = sim(x))
+* @param outlierRatio Expected outlier ratio (the median is taken at the 1-outlierRatio quantile)
+* @param minProba Probability to draw at least one outlier free sample
+* @return The best median of the squared residuals
+*  (std::numeric_limits<double>::max() if no hypothesis was scored)
+*/
+double Similarity3_LMeds
+(
+  const Mat3X & x,
+  const Mat3X & y,
+  Similarity3 * sim,
+  double outlierRatio = 0.5,
+  double minProba = 0.99
+);
+
 } // namespace kernel
 } // namespace geometry
 } // namespace openMVG
@@ -0,0 +1,63 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/Similarity3_Kernel.hpp"
+#include "openMVG/robust_estimation/robust_estimator_LMeds.hpp"
+
+#include "CppUnitLite/TestHarness.h"
+#include "testing/testing.h"
+
+using namespace openMVG;
+using namespace openMVG::geometry;
+
+TEST(Similarity3_Kernel, LMeds_Outliers)
+{
+  const int nbPoints = 200;
+  const Mat3X x1 = Mat3X::Random(3, nbPoints) * 10.;
+
+  const Mat3 rot = (Eigen::AngleAxis<double>(.2, Vec3::UnitX())
+      * Eigen::AngleAxis<double>(.3, Vec3::UnitY())
+      * Eigen::AngleAxis<double>(.6, Vec3::UnitZ())).toRotationMatrix();
+  const Similarity3 sim_gt(Pose3(rot, Vec3(1., -2., 3.)), 2.5);
+
+  // 30% of the target points are outliers
+  Mat3X x2 = sim_gt(x1);
+  for (int i = 0; i < nbPoints; i += 3)
+    x2.col(i) += Vec3::Random() * 50.;
+
+  Similarity3 sim;
+  const double median = kernel::Similarity3_LMeds(x1, x2, &sim);
+  EXPECT_NEAR(0.0, median, 1e-8);
+  EXPECT_NEAR(sim_gt.scale_, sim.scale_, 1e-8);
+  EXPECT_MATRIX_NEAR(sim_gt.pose_.rotation(), sim.pose_.rotation(), 1e-8);
+  EXPECT_MATRIX_NEAR(sim_gt.pose_.center(), sim.pose_.center(), 1e-8);
+
+  // Same result as the generic LMeds estimator
+  Similarity3 sim_lmeds;
+  // The kernel keeps references to its (dynamic size) point matrices
+  const Mat x1_mat = x1, x2_mat = x2;
+  const kernel::Similarity3_Kernel kernel(x1_mat, x2_mat);
+  const double median_lmeds = robust::LeastMedianOfSquares(kernel, &sim_lmeds);
+  EXPECT_NEAR(median_lmeds, median, 1e-8);
+  EXPECT_NEAR(sim_lmeds.scale_, sim.scale_, 1e-8);
+  EXPECT_MATRIX_NEAR(sim_lmeds.pose_.center(), sim.pose_.center(), 1e-8);
+}
+
+TEST(Similarity3_Kernel, LMeds_NotEnoughPoints)
+{
+  const Mat3X x1 = Mat3X::Random(3, 3);
+  Similarity3 sim(Pose3(Mat3::Identity(), Vec3(1., 2., 3.)), 2.);
+  EXPECT_EQ(std::numeric_limits<double>::max(),
+    kernel::Similarity3_LMeds(x1, x1, &sim));
+  // The similarity is not modified
+  EXPECT_NEAR(2., sim.scale_, 1e-15);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,170 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/aabb_tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace openMVG
+{
+namespace geometry
+{
+
+namespace
+{
+// Maximal number of boxes in a leaf
+const uint32_t kLeafSize = 4;
+} // namespace
+
+AABB::AABB()
+  : min(Vec3::Constant(std::numeric_limits<double>::infinity())),
+    max(Vec3::Constant(-std::numeric_limits<double>::infinity()))
+{
+}
+
+AABB::AABB(const Vec3 & min, const Vec3 & max)
+  : min(min), max(max)
+{
+}
+
+void AABB::extend(const Vec3 & point)
+{
+  min = min.cwiseMin(point);
+  max = max.cwiseMax(point);
+}
+
+void AABB::extend(const AABB & box)
+{
+  min = min.cwiseMin(box.min);
+  max = max.cwiseMax(box.max);
+}
+
+bool AABB::overlap(const AABB & box) const
+{
+  return (min.array() <= box.max.array()).all() &&
+         (box.min.array() <= max.array()).all();
+}
+
+Vec3 AABB::key_point() const
+{
+  Vec3 point;
+  for (int i = 0; i < 3; ++i)
+  {
+    const bool b_min = std::isfinite(min(i)), b_max = std::isfinite(max(i));
+    point(i) = (b_min && b_max) ? (min(i) + max(i)) / 2.0 :
+      (b_min ? min(i) : (b_max ? max(i) : 0.0));
+  }
+  return point;
+}
+
+AABB_Tree::AABB_Tree(const std::vector<AABB> & boxes)
+  : boxes_(boxes)
+{
+  indices_.resize(boxes_.size());
+  std::iota(indices_.begin(), indices_.end(), 0);
+  if (!boxes_.empty())
+  {
+    nodes_.reserve(2 * (boxes_.size() / kLeafSize + 1));
+    build(0, static_cast<uint32_t>(boxes_.size()));
+  }
+}
+
+uint32_t AABB_Tree::build(uint32_t begin, uint32_t end)
+{
+  const uint32_t node_id = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+  {
+    Node & node = nodes_.back();
+    node.begin = begin;
+    node.end = end;
+    for (uint32_t i = begin; i < end; ++i)
+      node.box.extend(boxes_[indices_[i]]);
+  }
+  if (end - begin <= kLeafSize)
+    return node_id;
+
+  // Median split along the largest extent of the box key points
+  AABB key_bounds;
+  for (uint32_t i = begin; i < end; ++i)
+    key_bounds.extend(boxes_[indices_[i]].key_point());
+  int axis = 0;
+  (key_bounds.max - key_bounds.min).maxCoeff(&axis);
+  const uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element(indices_.begin() + begin, indices_.begin() + middle,
+    indices_.begin() + end,
+    [&](uint32_t a, uint32_t b)
+    {
+      return boxes_[a].key_point()(axis) < boxes_[b].key_point()(axis);
+    });
+
+  const uint32_t left = build(begin, middle);
+  const uint32_t right = build(middle, end);
+  // The node reference can be invalidated by the children insertion
+  nodes_[node_id].left = left;
+  nodes_[node_id].right = right;
+  return node_id;
+}
+
+void AABB_Tree::query(const AABB & box, std::vector<uint32_t> & indices) const
+{
+  indices.clear();
+  if (nodes_.empty())
+    return;
+
+  std::vector<uint32_t> stack(1, 0);
+  while (!stack.empty())
+  {
+    const Node & node = nodes_[stack.back()];
+    stack.pop_back();
+    if (!node.box.overlap(box))
+      continue;
+    if (node.is_leaf())
+    {
+      for (uint32_t i = node.begin; i < node.end; ++i)
+      {
+        if (boxes_[indices_[i]].overlap(box))
+          indices.push_back(indices_[i]);
+      }
+    }
+    else
+    {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> AABB_Tree::overlapping_pairs() const
+{
+  std::vector<std::vector<uint32_t>> overlaps(boxes_.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(boxes_.size()); ++i)
+  {
+    query(boxes_[i], overlaps[i]);
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  for (uint32_t i = 0; i < overlaps.size(); ++i)
+  {
+    for (const uint32_t j : overlaps[i])
+    {
+      if (i < j)
+        pairs.emplace_back(i, j);
+    }
+  }
+  return pairs;
+}
+
+} // namespace geometry
+} // namespace openMVG
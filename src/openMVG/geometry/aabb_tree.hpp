@@ -0,0 +1,98 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_GEOMETRY_AABB_TREE_HPP
+#define OPENMVG_GEOMETRY_AABB_TREE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+namespace openMVG
+{
+namespace geometry
+{
+
+/**
+* @brief Axis aligned bounding box
+* Bounds can be infinite (i.e. bounding box of an infinite frustum).
+*/
+struct AABB
+{
+  Vec3 min, max;
+
+  /// Empty box
+  AABB();
+
+  AABB(const Vec3 & min, const Vec3 & max);
+
+  /// Grow the box to contain the point
+  void extend(const Vec3 & point);
+
+  /// Grow the box to contain the box
+  void extend(const AABB & box);
+
+  /// Tell if the two boxes share some volume (touching boxes overlap)
+  bool overlap(const AABB & box) const;
+
+  /// Representative point of the box (finite even for an infinite box)
+  Vec3 key_point() const;
+};
+
+/**
+* @brief Bounding volume hierarchy of axis aligned boxes.
+* It is used as a broad phase to list the boxes that can overlap, before
+*  running an exact (and costly) intersection test on the candidates.
+*/
+class AABB_Tree
+{
+public:
+
+  /// Build the hierarchy (the box indices are the positions in the array)
+  explicit AABB_Tree(const std::vector<AABB> & boxes);
+
+  /**
+  * @brief List the boxes that overlap a query box
+  * @param box The query box
+  * @param[out] indices Sorted indices of the overlapping boxes
+  */
+  void query(const AABB & box, std::vector<uint32_t> & indices) const;
+
+  /**
+  * @brief List all the pairs (i < j) of overlapping boxes
+  * @return The sorted overlapping pairs
+  */
+  std::vector<std::pair<uint32_t, uint32_t>> overlapping_pairs() const;
+
+  /// Number of indexed boxes
+  size_t size() const { return boxes_.size(); }
+
+private:
+
+  struct Node
+  {
+    AABB box;
+    // Leaf: range [begin, end) of indices_, Inner node: children ids
+    uint32_t begin, end;
+    int32_t left = -1, right = -1;
+    bool is_leaf() const { return left < 0; }
+  };
+
+  uint32_t build(uint32_t begin, uint32_t end);
+
+  std::vector<AABB> boxes_;
+  std::vector<uint32_t> indices_;
+  std::vector<Node> nodes_;
+};
+
+} // namespace geometry
+} // namespace openMVG
+
+#endif // OPENMVG_GEOMETRY_AABB_TREE_HPP
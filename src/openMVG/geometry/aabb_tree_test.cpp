@@ -0,0 +1,117 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/aabb_tree.hpp"
+#include "openMVG/geometry/frustum.hpp"
+
+#include "testing/testing.h"
+
+#include <limits>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::geometry;
+
+namespace {
+
+// Random boxes, some of them are infinite along some axis
+std::vector<AABB> Random_Boxes(size_t count)
+{
+  std::mt19937 random_generator(0);
+  std::uniform_real_distribution<double> position(-100.0, 100.0), size(0.0, 10.0);
+  std::uniform_int_distribution<int> infinite(0, 19);
+  const double infinity = std::numeric_limits<double>::infinity();
+  std::vector<AABB> boxes;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const Vec3 min(position(random_generator), position(random_generator), position(random_generator));
+    AABB box(min, min + Vec3(size(random_generator), size(random_generator), size(random_generator)));
+    if (infinite(random_generator) == 0)
+      box.max(infinite(random_generator) % 3) = infinity;
+    if (infinite(random_generator) == 0)
+      box.min(infinite(random_generator) % 3) = -infinity;
+    boxes.push_back(box);
+  }
+  return boxes;
+}
+
+} // namespace
+
+TEST(AABB, Overlap) {
+  const AABB a(Vec3(0, 0, 0), Vec3(1, 1, 1));
+  EXPECT_TRUE(a.overlap(AABB(Vec3(0.5, 0.5, 0.5), Vec3(2, 2, 2))));
+  EXPECT_TRUE(a.overlap(AABB(Vec3(1, 1, 1), Vec3(2, 2, 2)))); // touching
+  EXPECT_FALSE(a.overlap(AABB(Vec3(1.5, 0, 0), Vec3(2, 1, 1))));
+  EXPECT_FALSE(a.overlap(AABB())); // empty box
+
+  const double infinity = std::numeric_limits<double>::infinity();
+  const AABB infinite_box(Vec3(-infinity, 5, -infinity), Vec3(infinity, 6, infinity));
+  EXPECT_FALSE(a.overlap(infinite_box));
+  EXPECT_TRUE(AABB(Vec3(100, 5.5, -100), Vec3(101, 7, -99)).overlap(infinite_box));
+}
+
+TEST(AABB_Tree, Query_Same_As_Exhaustive) {
+  const std::vector<AABB> boxes = Random_Boxes(500);
+  const AABB_Tree tree(boxes);
+  EXPECT_EQ(boxes.size(), tree.size());
+
+  std::vector<std::pair<uint32_t, uint32_t>> expected_pairs;
+  for (uint32_t i = 0; i < boxes.size(); ++i)
+  {
+    std::vector<uint32_t> expected, found;
+    for (uint32_t j = 0; j < boxes.size(); ++j)
+    {
+      if (boxes[i].overlap(boxes[j]))
+      {
+        expected.push_back(j);
+        if (i < j)
+          expected_pairs.emplace_back(i, j);
+      }
+    }
+    tree.query(boxes[i], found);
+    EXPECT_TRUE(expected == found);
+  }
+  EXPECT_TRUE(expected_pairs == tree.overlapping_pairs());
+}
+
+TEST(AABB_Tree, Empty) {
+  const AABB_Tree tree(std::vector<AABB>{});
+  std::vector<uint32_t> found;
+  tree.query(AABB(Vec3::Zero(), Vec3::Ones()), found);
+  EXPECT_TRUE(found.empty());
+  EXPECT_TRUE(tree.overlapping_pairs().empty());
+}
+
+TEST(Frustum, Bounding_Box) {
+  Mat3 K;
+  K << 500, 0, 320,
+       0, 500, 240,
+       0, 0, 1;
+  const Vec3 C(1, 2, 3);
+
+  // Truncated frustum: the box contains the frustum points
+  const Frustum truncated(640, 480, K, Mat3::Identity(), C, 0.1, 10.0);
+  const AABB box = truncated.bounding_box();
+  for (const Vec3 & point : truncated.frustum_points())
+    EXPECT_TRUE(box.overlap(AABB(point, point)));
+  EXPECT_NEAR(3.1, box.min(2), 1e-8);
+  EXPECT_NEAR(13.0, box.max(2), 1e-8);
+
+  // Infinite frustum looking along +Z
+  const Frustum infinite(640, 480, K, Mat3::Identity(), C);
+  const AABB infinite_box = infinite.bounding_box();
+  EXPECT_NEAR(3.0, infinite_box.min(2), 1e-8);
+  EXPECT_TRUE(std::isinf(infinite_box.max(2)));
+  EXPECT_TRUE(std::isinf(infinite_box.min(0)) && std::isinf(infinite_box.max(0)));
+  EXPECT_TRUE(infinite_box.overlap(AABB(Vec3(1000, 1000, 1000), Vec3(1001, 1001, 1001))));
+  EXPECT_FALSE(infinite_box.overlap(AABB(Vec3(0, 0, -2), Vec3(1, 1, -1))));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
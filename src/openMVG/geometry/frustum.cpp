@@ -10,6 +10,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace openMVG{
 namespace geometry{
@@ -139,6 +140,34 @@ const std::vector<Vec3> & Frustum::frustum_points() const
   return points;
 }
 
+AABB Frustum::bounding_box() const
+{
+  AABB box;
+  if (isInfinite())
+  {
+    // The frustum goes to infinity along the directions of its 4 rays
+    box.extend(cones[0]);
+    const double infinity = std::numeric_limits<double>::infinity();
+    for (int i = 1; i < 5; ++i)
+    {
+      const Vec3 direction = cones[i] - cones[0];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        if (direction(axis) < 0.0)
+          box.min(axis) = -infinity;
+        else if (direction(axis) > 0.0)
+          box.max(axis) = infinity;
+      }
+    }
+  }
+  else
+  {
+    for (const Vec3 & point : points)
+      box.extend(point);
+  }
+  return box;
+}
+
 bool Frustum::export_Ply
 (
   const Frustum & frustum,
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 
+#include "openMVG/geometry/aabb_tree.hpp"
 #include "openMVG/geometry/half_space_intersection.hpp"
 
 namespace openMVG
@@ -129,6 +130,12 @@ struct Frustum : public HalfPlaneObject
   */
   const std::vector<Vec3> & frustum_points() const;
 
+  /**
+  * @brief Return the axis aligned bounding box of the frustum
+  * @note The bounds are infinite along the viewing rays of an infinite frustum
+  */
+  AABB bounding_box() const;
+
   /**
   * @brief Export the Frustum as a PLY file (infinite frustum as exported as a normalized cone)
   * @return true if the file can be saved on disk
@@ -8,7 +8,9 @@
 
 #include "openMVG/image/image_io.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 
@@ -252,11 +254,11 @@ int ReadPng(const char *filename,
   return res;
 }
 
-int ReadPngStream(FILE *file,
-                  std::vector<unsigned char> * ptr,
-                  int * w,
-                  int * h,
-                  int * depth)  {
+// Open a PNG stream and register the transformations to 8 bit data.
+// On success the PNG structures must be released with png_destroy_read_struct.
+static bool OpenPngStream(FILE *file,
+                          png_structp * png_ptr_out,
+                          png_infop * info_ptr_out) {
 
   // first check the eight byte PNG signature
   png_byte  pbSig[8];
@@ -264,7 +266,7 @@ int ReadPngStream(FILE *file,
   (void) readcnt;
   if (png_sig_cmp(pbSig, 0, 8))
   {
-    return 0;
+    return false;
   }
 
   // create the two png(-info) structures
@@ -273,14 +275,14 @@ int ReadPngStream(FILE *file,
     (png_error_ptr)nullptr, (png_error_ptr)nullptr);
   if (!png_ptr)
   {
-    return 0;
+    return false;
   }
   png_infop info_ptr = nullptr;
   info_ptr = png_create_info_struct(png_ptr);
   if (!info_ptr)
   {
     png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-    return 0;
+    return false;
   }
 
   // initialize the png structure
@@ -318,8 +320,28 @@ int ReadPngStream(FILE *file,
 
   png_read_update_info(png_ptr, info_ptr);
 
-  // get again width, height and the new bit-depth and color-type
+  *png_ptr_out = png_ptr;
+  *info_ptr_out = info_ptr;
+  return true;
+}
+
+int ReadPngStream(FILE *file,
+                  std::vector<unsigned char> * ptr,
+                  int * w,
+                  int * h,
+                  int * depth)  {
 
+  png_structp png_ptr = nullptr;
+  png_infop info_ptr = nullptr;
+  if (!OpenPngStream(file, &png_ptr, &info_ptr))
+  {
+    return 0;
+  }
+
+  // get again width, height and the new bit-depth and color-type
+  png_uint_32 wPNG, hPNG;
+  int                 iBitDepth;
+  int                 iColorType;
   png_get_IHDR(png_ptr, info_ptr, &wPNG, &hPNG, &iBitDepth,
     &iColorType, nullptr, nullptr, nullptr);
 
@@ -441,11 +463,11 @@ int ReadPnm(const char * filename,
 // Comment handling as per the description provided at
 //   http://netpbm.sourceforge.net/doc/pgm.html
 // and http://netpbm.sourceforge.net/doc/pbm.html
-int ReadPnmStream(FILE *file,
-                  std::vector<unsigned char> * array,
-                  int * w,
-                  int * h,
-                  int * depth) {
+// Parse the PNM header (the stream is left at the beginning of the pixel data)
+static int ReadPnmHeaderStream(FILE *file,
+                               int * w,
+                               int * h,
+                               int * depth) {
 
   const int NUM_VALUES = 3;
   const int INT_BUFFER_SIZE = 256;
@@ -506,12 +528,24 @@ int ReadPnmStream(FILE *file,
       return 0;
     }
   }
-
-  // Read pixels.
-  (*array).resize( values[1] * values[0] * (*depth));
   *w = values[0];
   *h = values[1];
-  res = fread( &(*array)[0], 1, array->size(), file);
+  return 1;
+}
+
+int ReadPnmStream(FILE *file,
+                  std::vector<unsigned char> * array,
+                  int * w,
+                  int * h,
+                  int * depth) {
+
+  if (!ReadPnmHeaderStream(file, w, h, depth)) {
+    return 0;
+  }
+
+  // Read pixels.
+  (*array).resize( (*h) * (*w) * (*depth));
+  const size_t res = fread( &(*array)[0], 1, array->size(), file);
   if (res != array->size()) {
     return 0;
   }
@@ -630,6 +664,304 @@ int WriteTiff(const char * filename,
   return 1;
 }
 
+//--
+// Region (window) reading
+//--
+
+// Copy a window of a raw interleaved image
+static void CropRawImage(const std::vector<unsigned char> & image,
+                         int width,
+                         int depth,
+                         int x,
+                         int y,
+                         int w,
+                         int h,
+                         std::vector<unsigned char> * ptr) {
+  ptr->resize(static_cast<size_t>(w) * h * depth);
+  const size_t row_bytes = static_cast<size_t>(w) * depth;
+  for (int r = 0; r < h; ++r) {
+    std::memcpy(&(*ptr)[r * row_bytes],
+      &image[(static_cast<size_t>(y + r) * width + x) * depth], row_bytes);
+  }
+}
+
+// Check that the window is inside an image of the given size
+static bool IsRegionValid(int width, int height, int x, int y, int w, int h) {
+  return x >= 0 && y >= 0 && w > 0 && h > 0 &&
+    static_cast<int64_t>(x) + w <= width && static_cast<int64_t>(y) + h <= height;
+}
+
+// Full decode followed by a crop (used for the layouts that cannot be read partially)
+static int ReadImageRegionFromFullImage(const char * filename,
+                                        int x,
+                                        int y,
+                                        int w,
+                                        int h,
+                                        std::vector<unsigned char> * ptr,
+                                        int * depth) {
+  std::vector<unsigned char> image;
+  int width, height;
+  if (!ReadImage(filename, &image, &width, &height, depth) ||
+      !IsRegionValid(width, height, x, y, w, h))
+    return 0;
+  CropRawImage(image, width, *depth, x, y, w, h, ptr);
+  return 1;
+}
+
+int ReadImageRegion(const char * filename,
+                    int x,
+                    int y,
+                    int w,
+                    int h,
+                    std::vector<unsigned char> * ptr,
+                    int * depth) {
+  const Format f = GetFormat(filename);
+
+  switch (f) {
+    case Pnm:
+      return ReadPnmRegion(filename, x, y, w, h, ptr, depth);
+    case Png:
+      return ReadPngRegion(filename, x, y, w, h, ptr, depth);
+    case Jpg:
+      return ReadJpgRegion(filename, x, y, w, h, ptr, depth);
+    case Tiff:
+      return ReadTiffRegion(filename, x, y, w, h, ptr, depth);
+    default:
+      return 0;
+  };
+}
+
+int ReadJpgRegion(const char * filename,
+                  int x,
+                  int y,
+                  int w,
+                  int h,
+                  std::vector<unsigned char> * ptr,
+                  int * depth) {
+  FILE *file = fopen(filename, "rb");
+  if (!file) {
+    std::cerr << "Error: Couldn't open " << filename << " fopen returned 0";
+    return 0;
+  }
+
+  jpeg_decompress_struct cinfo;
+  struct my_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = &jpeg_error;
+  std::vector<unsigned char> row;
+
+  if (setjmp(jerr.setjmp_buffer)) {
+    std::cerr << "Error JPG: Failed to decompress.";
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+    return 0;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, file);
+  jpeg_read_header(&cinfo, TRUE);
+  jpeg_start_decompress(&cinfo);
+
+  if (!IsRegionValid(cinfo.output_width, cinfo.output_height, x, y, w, h)) {
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+    return 0;
+  }
+
+  *depth = cinfo.output_components;
+  const size_t row_bytes = static_cast<size_t>(w) * (*depth);
+  ptr->resize(h * row_bytes);
+
+  // The scanlines are decoded in sequence: the rows above the window go
+  // through a single row buffer and the decoding stops after the last row.
+  row.resize(static_cast<size_t>(cinfo.output_width) * cinfo.output_components);
+  while (cinfo.output_scanline < static_cast<JDIMENSION>(y + h)) {
+    const int line = cinfo.output_scanline;
+    JSAMPROW scanline[1] = { &row[0] };
+    jpeg_read_scanlines(&cinfo, scanline, 1);
+    if (line >= y) {
+      std::memcpy(&(*ptr)[(line - y) * row_bytes], &row[x * (*depth)], row_bytes);
+    }
+  }
+
+  jpeg_abort_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  fclose(file);
+  return 1;
+}
+
+int ReadPngRegion(const char * filename,
+                  int x,
+                  int y,
+                  int w,
+                  int h,
+                  std::vector<unsigned char> * ptr,
+                  int * depth) {
+  FILE *file = fopen(filename, "rb");
+  if (!file) {
+    std::cerr << "Error: Couldn't open " << filename << " fopen returned 0";
+    return 0;
+  }
+
+  png_structp png_ptr = nullptr;
+  png_infop info_ptr = nullptr;
+  if (!OpenPngStream(file, &png_ptr, &info_ptr)) {
+    fclose(file);
+    return 0;
+  }
+
+  const int width = png_get_image_width(png_ptr, info_ptr);
+  const int height = png_get_image_height(png_ptr, info_ptr);
+  if (!IsRegionValid(width, height, x, y, w, h)) {
+    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    fclose(file);
+    return 0;
+  }
+
+  // Interlaced images cannot be streamed by rows
+  if (png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE) {
+    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    fclose(file);
+    return ReadImageRegionFromFullImage(filename, x, y, w, h, ptr, depth);
+  }
+
+  *depth = png_get_channels(png_ptr, info_ptr);
+  const size_t row_bytes = static_cast<size_t>(w) * (*depth);
+  ptr->resize(h * row_bytes);
+
+  // Read the rows one by one and stop after the last row of the window
+  std::vector<png_byte> row(png_get_rowbytes(png_ptr, info_ptr));
+  for (int r = 0; r < y + h; ++r) {
+    png_read_row(png_ptr, &row[0], nullptr);
+    if (r >= y) {
+      std::memcpy(&(*ptr)[(r - y) * row_bytes], &row[x * (*depth)], row_bytes);
+    }
+  }
+
+  png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+  fclose(file);
+  return 1;
+}
+
+int ReadPnmRegion(const char * filename,
+                  int x,
+                  int y,
+                  int w,
+                  int h,
+                  std::vector<unsigned char> * ptr,
+                  int * depth) {
+  FILE *file = fopen(filename, "rb");
+  if (!file) {
+    std::cerr << "Error: Couldn't open " << filename << " fopen returned 0";
+    return 0;
+  }
+
+  int width, height;
+  if (!ReadPnmHeaderStream(file, &width, &height, depth) ||
+      !IsRegionValid(width, height, x, y, w, h)) {
+    fclose(file);
+    return 0;
+  }
+
+  // The raw pixel rows are read directly at their offset
+  const long data_offset = ftell(file);
+  const size_t row_bytes = static_cast<size_t>(w) * (*depth);
+  ptr->resize(h * row_bytes);
+  for (int r = 0; r < h; ++r) {
+    const long offset = data_offset +
+      static_cast<long>((static_cast<size_t>(y + r) * width + x) * (*depth));
+    if (fseek(file, offset, SEEK_SET) != 0 ||
+        fread(&(*ptr)[r * row_bytes], 1, row_bytes, file) != row_bytes) {
+      fclose(file);
+      return 0;
+    }
+  }
+  fclose(file);
+  return 1;
+}
+
+int ReadTiffRegion(const char * filename,
+                   int x,
+                   int y,
+                   int w,
+                   int h,
+                   std::vector<unsigned char> * ptr,
+                   int * depth) {
+  TIFF* tiff = TIFFOpen(filename, "r");
+  if (!tiff) {
+    std::cerr << "Error: Couldn't open " << filename << " fopen returned 0";
+    return 0;
+  }
+  uint32 width = 0, height = 0;
+  uint16 bps = 8, spp = 1, planar = PLANARCONFIG_CONTIG;
+
+  TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+  TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+  TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &bps);
+  TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLESPERPIXEL, &spp);
+  TIFFGetFieldDefaulted(tiff, TIFFTAG_PLANARCONFIG, &planar);
+  *depth = bps * spp / 8;
+
+  if (!IsRegionValid(width, height, x, y, w, h)) {
+    TIFFClose(tiff);
+    return 0;
+  }
+
+  // RGBA images are decoded by the RGBA interface in ReadTiff, and the
+  // layouts that are not 8 bit interleaved data are not handled here.
+  if (*depth == 4 || bps != 8 || planar != PLANARCONFIG_CONTIG) {
+    TIFFClose(tiff);
+    return ReadImageRegionFromFullImage(filename, x, y, w, h, ptr, depth);
+  }
+
+  const int d = *depth;
+  const size_t row_bytes = static_cast<size_t>(w) * d;
+  ptr->resize(h * row_bytes);
+
+  bool bOk = true;
+  if (TIFFIsTiled(tiff)) {
+    // Decode only the tiles that intersect the window
+    uint32 tile_width = 0, tile_height = 0;
+    TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &tile_width);
+    TIFFGetField(tiff, TIFFTAG_TILELENGTH, &tile_height);
+    std::vector<unsigned char> tile(TIFFTileSize(tiff));
+    for (int ty = (y / tile_height) * tile_height; bOk && ty < y + h; ty += tile_height) {
+      for (int tx = (x / tile_width) * tile_width; bOk && tx < x + w; tx += tile_width) {
+        if (TIFFReadTile(tiff, &tile[0], tx, ty, 0, 0) < 0) {
+          bOk = false;
+          break;
+        }
+        const int c0 = std::max(tx, x), c1 = std::min<int>(tx + tile_width, x + w);
+        const int r0 = std::max(ty, y), r1 = std::min<int>(ty + tile_height, y + h);
+        for (int r = r0; r < r1; ++r) {
+          std::memcpy(&(*ptr)[(r - y) * row_bytes + (c0 - x) * d],
+            &tile[(static_cast<size_t>(r - ty) * tile_width + (c0 - tx)) * d],
+            static_cast<size_t>(c1 - c0) * d);
+        }
+      }
+    }
+  } else {
+    // Decode only the strips that intersect the window
+    uint32 rows_per_strip = height;
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+    rows_per_strip = std::min(rows_per_strip, height);
+    std::vector<unsigned char> strip(TIFFStripSize(tiff));
+    for (int sy = (y / rows_per_strip) * rows_per_strip; sy < y + h; sy += rows_per_strip) {
+      if (TIFFReadEncodedStrip(tiff, TIFFComputeStrip(tiff, sy, 0), &strip[0], (tsize_t)-1) < 0) {
+        bOk = false;
+        break;
+      }
+      const int r0 = std::max(sy, y), r1 = std::min<int>(sy + rows_per_strip, y + h);
+      for (int r = r0; r < r1; ++r) {
+        std::memcpy(&(*ptr)[(r - y) * row_bytes],
+          &strip[(static_cast<size_t>(r - sy) * width + x) * d], row_bytes);
+      }
+    }
+  }
+  TIFFClose(tiff);
+  return bOk ? 1 : 0;
+}
+
 bool ReadImageHeader(const char * filename, ImageHeader * imgheader)
 {
   const Format f = GetFormat(filename);
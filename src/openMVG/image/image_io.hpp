@@ -84,6 +84,38 @@ int WriteImage( const char * path , const Image<T>& image );
 */
 int ReadImage( const char * path, std::vector<unsigned char> * image , int * w, int * h, int * depth );
 
+/**
+* @brief Load a window of an image<T> without decoding the whole image when the format allows it
+* @param path Input path of the image to load
+* @param x Left column of the window
+* @param y Top row of the window
+* @param w Width of the window
+* @param h Height of the window
+* @param[out] image Output image (of size w x h)
+* @retval 1 If loading is correct
+* @retval 0 If there was an error during load operation or if the window is not inside the image
+*/
+template<typename T>
+int ReadImageRegion( const char * path, int x, int y, int w, int h, Image<T> * image );
+
+/**
+* @brief Unsigned char specialization of the window loading
+* - JPEG: the scanlines are decoded up to the last row of the window,
+* - PNG: the rows are streamed up to the last row of the window (interlaced files are fully decoded),
+* - PNM: the rows of the window are read at their file offset,
+* - TIFF: only the tiles or the strips that intersect the window are decoded.
+* @param path Input path of the image to load
+* @param x Left column of the window
+* @param y Top row of the window
+* @param w Width of the window
+* @param h Height of the window
+* @param[out] image Output image data (w x h x depth)
+* @param[out] depth Depth of the image
+* @retval 1 If loading is correct
+* @retval 0 If there was an error during load operation or if the window is not inside the image
+*/
+int ReadImageRegion( const char * path, int x, int y, int w, int h, std::vector<unsigned char> * image, int * depth );
+
 /**
 * @brief Unsigned char specialization
 * @param path Output path of the image to save
@@ -123,6 +155,13 @@ int ReadPng( const char * path , std::vector<unsigned char> * array , int * w, i
 */
 int ReadPngStream( FILE * stream , std::vector<unsigned char> * array , int * w, int * h, int * depth );
 
+/**
+* @brief Read a window of a PNG file (see ReadImageRegion)
+* @retval 0 if there was an error during read operation
+* @return non nul value if read operation is valid
+*/
+int ReadPngRegion( const char * path , int x, int y, int w, int h, std::vector<unsigned char> * array , int * depth );
+
 
 /**
 * @brief Write PNG file to a file
@@ -175,6 +214,13 @@ int ReadJpg( const char * path , std::vector<unsigned char> * array, int * w, in
 */
 int ReadJpgStream( FILE * stream , std::vector<unsigned char> * array, int * w, int * h, int * depth );
 
+/**
+* @brief Read a window of a JPEG file (see ReadImageRegion)
+* @retval 0 if there is an error during read operation
+* @return non nul value if read operation is valid
+*/
+int ReadJpgRegion( const char * path , int x, int y, int w, int h, std::vector<unsigned char> * array, int * depth );
+
 /**
 * @brief Write JPEG file
 * @param path Output image path
@@ -243,6 +289,13 @@ int ReadPnm( const char * path , std::vector<unsigned char> * array, int * w, in
 */
 int ReadPnmStream( FILE * stream , std::vector<unsigned char> * array, int * w, int * h, int * depth );
 
+/**
+* @brief Read a window of a PNM/PGM file (see ReadImageRegion)
+* @retval 0 if there was an error during read operation
+* @return non nul value if read operation is valid
+*/
+int ReadPnmRegion( const char * path , int x, int y, int w, int h, std::vector<unsigned char> * array, int * depth );
+
 /**
 * @brief Write PNM/PGM from to a file
 * @param[in] path Output image path
@@ -282,6 +335,13 @@ int WritePnmStream( FILE *,  const std::vector<unsigned char>& array, int w, int
 */
 int ReadTiff( const char * path , std::vector<unsigned char> * array, int * w, int * h, int * depth );
 
+/**
+* @brief Read a window of a TIFF file (see ReadImageRegion)
+* @retval 0 if there was an error during read operation
+* @return non nul value if read operation is valid
+*/
+int ReadTiffRegion( const char * path , int x, int y, int w, int h, std::vector<unsigned char> * array, int * depth );
+
 /**
 * @brief write TIFF image to a file
 * @param path Output file path
@@ -357,24 +417,29 @@ bool Read_TIFF_ImageHeader( const char * path , ImageHeader * hdr );
 
 
 /**
-* @brief Generic Image read from file
-* @param[in] path Input image path
-* @param[out] im Ouput image
-* @retval 0 if there was an errir during read operation
-* @retval 1 if read is correct
-*/
-template<>
-inline int ReadImage( const char * path, Image<unsigned char> * im )
+* @brief Convert a raw interleaved array to an image
+* @param ptr Input image data
+* @param w Image width
+* @param h Image height
+* @param depth Depth of the input data
+* @param[out] im Output image
+* @retval false if the depth cannot be converted to the image pixel type
+*/
+inline bool RawArrayToImage
+(
+  std::vector<unsigned char> & ptr,
+  int w,
+  int h,
+  int depth,
+  Image<unsigned char> * im
+)
 {
-  std::vector<unsigned char> ptr;
-  int w, h, depth;
-  const int res = ReadImage( path, &ptr, &w, &h, &depth );
-  if ( res == 1 && depth == 1 )
+  if ( depth == 1 )
   {
     //convert raw array to Image
     ( *im ) = Eigen::Map<Image<unsigned char>::Base>( &ptr[0], h, w );
   }
-  else if ( res == 1 && depth == 3 )
+  else if ( depth == 3 )
   {
     //-- Must convert RGB to gray
     RGBColor * ptrCol = reinterpret_cast<RGBColor*>( &ptr[0] );
@@ -383,7 +448,7 @@ inline int ReadImage( const char * path, Image<unsigned char> * im )
     //convert RGB to gray
     ConvertPixelType( rgbColIm, im );
   }
-  else if ( res == 1 && depth == 4 )
+  else if ( depth == 4 )
   {
     //-- Must convert RGBA to gray
     RGBAColor * ptrCol = reinterpret_cast<RGBAColor*>( &ptr[0] );
@@ -392,34 +457,30 @@ inline int ReadImage( const char * path, Image<unsigned char> * im )
     //convert RGBA to gray
     ConvertPixelType( rgbaColIm, im );
   }
-  else if ( depth != 1 )
+  else
   {
-    return 0;
+    return false;
   }
-  return res;
+  return true;
 }
 
-
-/**
-* @brief Generic Image read from file (overload for RGBColor)
-* @param[in] path Input image path
-* @param[out] im Ouput image
-* @retval 0 if there was an errir during read operation
-* @retval 1 if read is correct
-*/
-template<>
-inline int ReadImage( const char * path, Image<RGBColor> * im )
+/// Convert a raw interleaved array to an image (overload for RGBColor)
+inline bool RawArrayToImage
+(
+  std::vector<unsigned char> & ptr,
+  int w,
+  int h,
+  int depth,
+  Image<RGBColor> * im
+)
 {
-  std::vector<unsigned char> ptr;
-  int w, h, depth;
-  const int res = ReadImage( path, &ptr, &w, &h, &depth );
-  if ( res == 1 && depth == 3 )
+  if ( depth == 3 )
   {
     RGBColor * ptrCol = reinterpret_cast<RGBColor*>( &ptr[0] );
     //convert raw array to Image
     ( *im ) = Eigen::Map<Image<RGBColor>::Base>( ptrCol, h, w );
   }
-  else if ( res == 1 && depth == 4 )
+  else if ( depth == 4 )
   {
     //-- Must convert RGBA to RGB
     RGBAColor * ptrCol = reinterpret_cast<RGBAColor*>( &ptr[0] );
@@ -430,33 +491,71 @@ inline int ReadImage( const char * path, Image<RGBColor> * im )
   }
   else
   {
-    return 0;
+    return false;
   }
-  return res;
+  return true;
+}
+
+/// Convert a raw interleaved array to an image (overload for RGBAColor)
+inline bool RawArrayToImage
+(
+  std::vector<unsigned char> & ptr,
+  int w,
+  int h,
+  int depth,
+  Image<RGBAColor> * im
+)
+{
+  if ( depth != 4 )
+  {
+    return false;
+  }
+  RGBAColor * ptrCol = reinterpret_cast<RGBAColor*>( &ptr[0] );
+  //convert raw array to Image
+  ( *im ) = Eigen::Map<Image<RGBAColor>::Base>( ptrCol, h, w );
+  return true;
 }
 
 /**
-* @brief Generic Image read from file (overload for RGBAColor)
+* @brief Generic Image read from file (unsigned char, RGBColor and RGBAColor)
 * @param[in] path Input image path
 * @param[out] im Ouput image
 * @retval 0 if there was an errir during read operation
 * @retval 1 if read is correct
 */
-template<>
-inline int ReadImage( const char * path, Image<RGBAColor> * im )
+template<typename T>
+inline int ReadImage( const char * path, Image<T> * im )
 {
   std::vector<unsigned char> ptr;
   int w, h, depth;
   const int res = ReadImage( path, &ptr, &w, &h, &depth );
-  if ( depth != 4 )
+  if ( res != 1 || !RawArrayToImage( ptr, w, h, depth, im ) )
   {
     return 0;
   }
-  if ( res == 1 )
+  return res;
+}
+
+/**
+* @brief Generic Image window read from file (unsigned char, RGBColor and RGBAColor)
+* @param[in] path Input image path
+* @param x Left column of the window
+* @param y Top row of the window
+* @param w Width of the window
+* @param h Height of the window
+* @param[out] im Ouput image
+* @retval 0 if there was an error during read operation
+* @retval 1 if read is correct
+*/
+template<typename T>
+inline int ReadImageRegion( const char * path, int x, int y, int w, int h, Image<T> * im )
+{
+  std::vector<unsigned char> ptr;
+  int depth;
+  const int res = ReadImageRegion( path, x, y, w, h, &ptr, &depth );
+  if ( res != 1 || !RawArrayToImage( ptr, w, h, depth, im ) )
   {
-    RGBAColor * ptrCol = reinterpret_cast<RGBAColor*>( &ptr[0] );
-    //convert raw array to Image
-    ( *im ) = Eigen::Map<Image<RGBAColor>::Base>( ptrCol, h, w );
+    return 0;
   }
   return res;
 }
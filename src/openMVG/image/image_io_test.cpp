@@ -8,6 +8,8 @@
 
 
 #include "openMVG/image/image_io.hpp"
+#include "openMVG/image/image_tiled.hpp"
+#include "openMVG/image/sample.hpp"
 
 #include "testing/testing.h"
 
@@ -260,6 +262,86 @@ TEST(ImageHeader, AllFormats) {
   }
 }
 
+// Gradient image (every pixel has a distinct value up to the 8 bit wrap)
+Image<RGBColor> create_gradient_image(int width, int height)
+{
+  Image<RGBColor> image(width, height);
+  for (int j = 0; j < height; ++j)
+    for (int i = 0; i < width; ++i)
+      image(j, i) = RGBColor(i * 7 + j, j * 3, (i + j * 11) % 256);
+  return image;
+}
+
+TEST(ImageIOTest, ReadRegion_AllFormats) {
+
+  // jpg is lossy, so the window is compared to the full decoded image
+  const std::vector<std::string> ext_Type = {"jpg", "png", "tif", "ppm"};
+  const Image<RGBColor> image = create_gradient_image(50, 40);
+  for (size_t i=0; i < ext_Type.size(); ++i)
+  {
+    const std::string filename = "img_region." + ext_Type[i];
+    std::cout << "Testing:" << filename << std::endl;
+    EXPECT_TRUE(WriteImage(filename.c_str(), image));
+
+    Image<RGBColor> full_image;
+    EXPECT_TRUE(ReadImage(filename.c_str(), &full_image));
+
+    // RGB window
+    Image<RGBColor> region;
+    EXPECT_TRUE(ReadImageRegion(filename.c_str(), 13, 17, 20, 19, &region));
+    EXPECT_EQ(20, region.Width());
+    EXPECT_EQ(19, region.Height());
+    EXPECT_TRUE(region.GetMat() == full_image.GetMat().block(17, 13, 19, 20));
+
+    // Gray conversion of a window that touches the image border
+    Image<unsigned char> gray_region, gray_image;
+    EXPECT_TRUE(ReadImage(filename.c_str(), &gray_image));
+    EXPECT_TRUE(ReadImageRegion(filename.c_str(), 30, 0, 20, 40, &gray_region));
+    EXPECT_TRUE(gray_region.GetMat() == gray_image.GetMat().block(0, 30, 40, 20));
+
+    // Windows outside the image are rejected
+    EXPECT_FALSE(ReadImageRegion(filename.c_str(), 40, 0, 20, 10, &region));
+    EXPECT_FALSE(ReadImageRegion(filename.c_str(), -1, 0, 20, 10, &region));
+    EXPECT_FALSE(ReadImageRegion(filename.c_str(), 0, 0, 0, 10, &region));
+    remove(filename.c_str());
+  }
+}
+
+TEST(ImageIOTest, TiledImage) {
+  const Image<RGBColor> image = create_gradient_image(50, 40);
+  const std::string filename = "img_tiled.png";
+  EXPECT_TRUE(WriteImage(filename.c_str(), image));
+
+  // 16x16 tiles, 4 tiles in the cache
+  Tiled_Image<RGBColor> tiled_image(filename, 16, 4);
+  EXPECT_TRUE(tiled_image.IsValid());
+  EXPECT_EQ(50, tiled_image.Width());
+  EXPECT_EQ(40, tiled_image.Height());
+  EXPECT_EQ(4, tiled_image.TilesX());
+  EXPECT_EQ(3, tiled_image.TilesY());
+  EXPECT_TRUE(tiled_image.Contains(39, 49));
+  EXPECT_FALSE(tiled_image.Contains(40, 0));
+
+  // Pixel access on every tile (including the cropped border tiles)
+  bool bSame = true;
+  for (int j = 0; j < image.Height(); ++j)
+    for (int i = 0; i < image.Width(); ++i)
+      bSame &= tiled_image(j, i) == image(j, i);
+  EXPECT_TRUE(bSame);
+  EXPECT_EQ(4, tiled_image.CachedTileCount());
+
+  // Window across several tiles
+  Image<RGBColor> region;
+  EXPECT_TRUE(tiled_image.ReadRegion(10, 5, 35, 30, &region));
+  EXPECT_TRUE(region.GetMat() == image.GetMat().block(5, 10, 30, 35));
+  EXPECT_FALSE(tiled_image.ReadRegion(10, 5, 45, 30, &region));
+
+  // The samplers work on the tiled view
+  const Sampler2d<SamplerLinear> sampler;
+  EXPECT_TRUE(sampler(tiled_image, 15.5f, 31.25f) == sampler(image, 15.5f, 31.25f));
+  remove(filename.c_str());
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
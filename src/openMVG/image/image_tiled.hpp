@@ -0,0 +1,201 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_IMAGE_IMAGE_TILED_HPP
+#define OPENMVG_IMAGE_IMAGE_TILED_HPP
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/image_io.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace openMVG
+{
+namespace image
+{
+
+/**
+* @brief Read only tiled view of an image file.
+*
+* The image is split in square tiles that are decoded on demand with
+* ReadImageRegion (only the needed rows, strips or tiles are read from the file)
+* and kept in a LRU cache of bounded size.
+* It exposes the same read interface as Image<T> (Width, Height, Depth,
+* Contains, operator()(y, x)), so the algorithms written on this interface
+* (i.e. Sampler2d) work on either a full Image or a Tiled_Image.
+*
+* The tile access is thread safe.
+* For bulk processing, prefer GetTile or ReadRegion to the per pixel access.
+*/
+template <typename T>
+class Tiled_Image
+{
+public:
+
+  using Tpixel = T;
+  using Tile = Image<T>;
+
+  /**
+  * @brief Open an image file
+  * @param path Image file path
+  * @param tile_size Width and height of the tiles
+  * @param max_cached_tiles Maximal number of tiles kept in memory
+  */
+  Tiled_Image
+  (
+    const std::string & path,
+    int tile_size = 256,
+    size_t max_cached_tiles = 64
+  )
+    : path_( path ),
+      tile_size_( std::max( 1, tile_size ) ),
+      max_cached_tiles_( std::max<size_t>( 1, max_cached_tiles ) )
+  {
+    ImageHeader header;
+    if ( ReadImageHeader( path_.c_str(), &header ) )
+    {
+      width_ = header.width;
+      height_ = header.height;
+    }
+  }
+
+  /// Return true if the image header could be read
+  bool IsValid() const { return width_ > 0 && height_ > 0; }
+
+  inline int Width() const { return width_; }
+  inline int Height() const { return height_; }
+  inline int Depth() const { return sizeof( Tpixel ); }
+  inline int TileSize() const { return tile_size_; }
+  inline int TilesX() const { return ( width_ + tile_size_ - 1 ) / tile_size_; }
+  inline int TilesY() const { return ( height_ + tile_size_ - 1 ) / tile_size_; }
+
+  inline bool Contains( int y, int x ) const
+  {
+    return 0 <= x && x < width_ && 0 <= y && y < height_;
+  }
+
+  /**
+  * @brief Get a tile (decoded on the first access)
+  * @param tile_x Tile column index
+  * @param tile_y Tile row index
+  * @return The tile (border tiles are cropped to the image size) or nullptr on read error
+  */
+  std::shared_ptr<const Tile> GetTile( int tile_x, int tile_y ) const
+  {
+    const uint64_t key = ( static_cast<uint64_t>( tile_y ) << 32 ) | static_cast<uint32_t>( tile_x );
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      auto it = cache_index_.find( key );
+      if ( it != cache_index_.end() )
+      {
+        // Move the tile at the front of the LRU list
+        lru_.splice( lru_.begin(), lru_, it->second );
+        return it->second->second;
+      }
+    }
+
+    // Decode the tile outside the lock
+    const int x = tile_x * tile_size_, y = tile_y * tile_size_;
+    if ( !Contains( y, x ) )
+      return nullptr;
+    auto tile = std::make_shared<Tile>();
+    if ( !ReadImageRegion( path_.c_str(), x, y,
+           std::min( tile_size_, width_ - x ), std::min( tile_size_, height_ - y ),
+           tile.get() ) )
+      return nullptr;
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    auto it = cache_index_.find( key );
+    if ( it != cache_index_.end() ) // Decoded concurrently by another thread
+    {
+      lru_.splice( lru_.begin(), lru_, it->second );
+      return it->second->second;
+    }
+    lru_.emplace_front( key, tile );
+    cache_index_[key] = lru_.begin();
+    while ( lru_.size() > max_cached_tiles_ )
+    {
+      cache_index_.erase( lru_.back().first );
+      lru_.pop_back();
+    }
+    return tile;
+  }
+
+  /// Return the value of a pixel (the pixel must be inside the image)
+  inline T operator()( int y, int x ) const
+  {
+    const std::shared_ptr<const Tile> tile = GetTile( x / tile_size_, y / tile_size_ );
+    return tile ? ( *tile )( y % tile_size_, x % tile_size_ ) : T( 0 );
+  }
+
+  /**
+  * @brief Copy a window of the image (assembled from the cached tiles)
+  * @param x Left column of the window
+  * @param y Top row of the window
+  * @param w Width of the window
+  * @param h Height of the window
+  * @param[out] region Output window
+  * @return false if the window is not inside the image or on read error
+  */
+  bool ReadRegion( int x, int y, int w, int h, Image<T> * region ) const
+  {
+    if ( w <= 0 || h <= 0 || !Contains( y, x ) || !Contains( y + h - 1, x + w - 1 ) )
+      return false;
+    region->resize( w, h, false );
+    for ( int tile_y = y / tile_size_; tile_y <= ( y + h - 1 ) / tile_size_; ++tile_y )
+    {
+      for ( int tile_x = x / tile_size_; tile_x <= ( x + w - 1 ) / tile_size_; ++tile_x )
+      {
+        const std::shared_ptr<const Tile> tile = GetTile( tile_x, tile_y );
+        if ( !tile )
+          return false;
+        // Intersection of the tile and the window (in image coordinates)
+        const int x0 = std::max( x, tile_x * tile_size_ );
+        const int y0 = std::max( y, tile_y * tile_size_ );
+        const int x1 = std::min( x + w, tile_x * tile_size_ + tile->Width() );
+        const int y1 = std::min( y + h, tile_y * tile_size_ + tile->Height() );
+        region->block( y0 - y, x0 - x, y1 - y0, x1 - x0 ) =
+          tile->block( y0 - tile_y * tile_size_, x0 - tile_x * tile_size_, y1 - y0, x1 - x0 );
+      }
+    }
+    return true;
+  }
+
+  /// Number of tiles currently in the cache
+  size_t CachedTileCount() const
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return lru_.size();
+  }
+
+private:
+
+  using Cache_Entry = std::pair<uint64_t, std::shared_ptr<const Tile>>;
+
+  std::string path_;
+  int width_ = 0;
+  int height_ = 0;
+  int tile_size_;
+  size_t max_cached_tiles_;
+
+  mutable std::mutex mutex_;
+  mutable std::list<Cache_Entry> lru_; // Most recently used first
+  mutable std::unordered_map<uint64_t, typename std::list<Cache_Entry>::iterator> cache_index_;
+};
+
+} // namespace image
+} // namespace openMVG
+
+#endif // OPENMVG_IMAGE_IMAGE_TILED_HPP
@@ -486,14 +486,16 @@ struct Sampler2d
 
     /**
      ** Sample image at a specified position
-     ** @param src Input image
+     ** @param src Input image (Image<T> or any image type with the same read
+     **  interface, i.e. Tiled_Image<T>)
      ** @param y Y-coordinate of sampling
      ** @param x X-coordinate of sampling
      ** @return Sampled value
      **/
-    template <typename T>
-    T operator()( const Image<T> & src , const float y , const float x ) const
+    template <typename ImageT>
+    typename ImageT::Tpixel operator()( const ImageT & src , const float y , const float x ) const
     {
+      using T = typename ImageT::Tpixel;
       const int im_width = src.Width();
       const int im_height = src.Height();
 
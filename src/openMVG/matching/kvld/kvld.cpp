@@ -9,14 +9,20 @@
 #include "openMVG/matching/kvld/kvld.h"
 #include "openMVG/image/image_container.hpp"
 #include "openMVG/features/feature.hpp"
+#include "openMVG/features/feature_grid.hpp"
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <iterator>
 
 using namespace openMVG;
 using namespace openMVG::image;
 
+// Number of matches whose gvld-consistencies are evaluated concurrently by KVLD
+static const int kvld_block_size = 64;
+
 ImageScale::ImageScale( const Image<float>& I, double r )
 {
   IntegralImages inter( I );
@@ -96,6 +102,50 @@ int ImageScale::getIndex( const double r )const
   }
 }
 
+
+std::shared_ptr<const ImageScale> ImageScaleCache::get(
+  const std::string & key,
+  const std::function<bool( Image<float>& )> & loader )
+{
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    for (auto it = entries_.begin(); it != entries_.end(); ++it )
+    {
+      if (it->first == key )
+      {
+        entries_.splice( entries_.begin(), entries_, it );
+        return entries_.front().second;
+      }
+    }
+  }
+
+  // Build the pyramid outside of the lock
+  Image<float> I;
+  if (!loader( I ) )
+    return nullptr;
+  const std::shared_ptr<const ImageScale> series = std::make_shared<ImageScale>( I );
+
+  std::lock_guard<std::mutex> lock( mutex_ );
+  entries_.emplace_front( key, series );
+  // Release the least recently used pyramids (or a duplicate built concurrently)
+  for (auto it = std::next( entries_.begin() ); it != entries_.end(); )
+  {
+    if (it->first == key )
+      it = entries_.erase( it );
+    else
+      ++it;
+  }
+  while (entries_.size() > max_size_ )
+    entries_.pop_back();
+  return series;
+}
+
+size_t ImageScaleCache::size() const
+{
+  std::lock_guard<std::mutex> lock( mutex_ );
+  return entries_.size();
+}
+
 template<typename T>
 VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
 {
@@ -130,6 +180,7 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
   const int h = m.Height();
   const float r = float( radius / ratio );
   const float sigma2 = r * r;
+  const double gaussian_factor = -1.0 / ( 4.5 * sigma2 );
   //======calculating the descriptor=====//
 
   double statistic[ binNum ];
@@ -142,29 +193,39 @@ VLD::VLD( const ImageScale& series, T const& P1, T const& P2 ) : contrast( 0.0 )
     xi /= float( ratio );
     yi /= float( ratio );
 
-    for (int y = int( yi - r ); y <= int( yi + r + 0.5 ); y++ )
+    // The sampling window is clamped to the pixels that have a gradient (1 pixel away from the border)
+    // and the samples are read row by row
+    const int x_begin = std::max( int( xi - r ), 1 );
+    const int x_end   = std::min( int( xi + r + 0.5 ), w - 2 );
+    const int y_begin = std::max( int( yi - r ), 1 );
+    const int y_end   = std::min( int( yi + r + 0.5 ), h - 2 );
+    for (int y = y_begin; y <= y_end; y++ )
     {
-      for (int x = int( xi - r ); x <= int( xi + r + 0.5 ); x++ )
+      const float dy2 = ( float( y ) - yi ) * ( float( y ) - yi );
+      if (dy2 > sigma2 )
+        continue;
+      const float * ang_row = &ang( y, 0 );
+      const float * m_row = &m( y, 0 );
+      for (int x = x_begin; x <= x_end; x++ )
       {
-        const float d = point_distance( xi, yi, float( x ), float( y ) );
-        if (d <= r && inside( w, h, x, y, 1 ) )
+        const float d2 = ( float( x ) - xi ) * ( float( x ) - xi ) + dy2;
+        if (d2 <= sigma2 )
         {
           //================angle and magnitude==========================//
-          double angle;
-          if (ang( y, x ) >= 0 )
-            angle = ang( y, x ) - mainAngle;//relative angle
-          else angle = 0.0;
-
-          //cout<<angle<<endl;
-          while (angle < 0)
-            angle += 2 * PI_;
-          while (angle >= 2 * PI_)
-            angle -= 2 * PI_;
+          double angle = 0.0;
+          if (ang_row[ x ] >= 0 )
+          {
+            angle = ang_row[ x ] - mainAngle;//relative angle in ]-2PI, 2PI[
+            if (angle < 0 )
+              angle += 2 * PI_;
+            if (angle >= 2 * PI_ )
+              angle -= 2 * PI_;
+          }
 
           //===============principle angle==============================//
           const int index = int( angle * binNum / ( 2 * PI_ ) + 0.5 );
 
-          double Gweight = exp( -d * d / 4.5 / sigma2 ) * ( m( y, x ) );
+          const double Gweight = exp( d2 * gaussian_factor ) * ( m_row[ x ] );
           if (index < binNum )
             statistic[ index ] += Gweight;
           else // possible since the 0.5
@@ -205,42 +266,93 @@ float KVLD( const Image<float>& I1,
             std::vector<bool>& valide,
             KvldParameters& kvldParameters )
 {
-  matchesFiltered.clear();
-  score.clear();
-  ImageScale Chaine1( I1 );
-  ImageScale Chaine2( I2 );
+  const ImageScale Chaine1( I1 );
+  const ImageScale Chaine2( I2 );
 
   std::cout << "Image scale-space complete..." << std::endl;
 
-  const float range1 = getRange( I1, std::min( F1.size(), matches.size() ), kvldParameters.inlierRate );
-  const float range2 = getRange( I2, std::min( F2.size(), matches.size() ), kvldParameters.inlierRate );
+  return KVLD( Chaine1, Chaine2, F1, F2, matches, matchesFiltered, score, E, valide, kvldParameters );
+}
 
-  const size_t size = matches.size();
+float KVLD( const ImageScale& Chaine1,
+            const ImageScale& Chaine2,
+            const std::vector<features::SIOPointFeature> & F1,
+            const std::vector<features::SIOPointFeature> & F2,
+            const std::vector<Pair>& matches,
+            std::vector<Pair>& matchesFiltered,
+            std::vector<double>& score,
+            openMVG::Mat& E,
+            std::vector<bool>& valide,
+            KvldParameters& kvldParameters )
+{
+  matchesFiltered.clear();
+  score.clear();
+
+  const float range1 = getRange( Chaine1.angles[ 0 ], std::min( F1.size(), matches.size() ), kvldParameters.inlierRate );
+  const float range2 = getRange( Chaine2.angles[ 0 ], std::min( F2.size(), matches.size() ), kvldParameters.inlierRate );
 
-  //================distance map construction, foruse of selecting neighbors===============//
-  std::cout << "computing distance maps" << std::endl;
+  const int size = static_cast<int>( matches.size() );
 
-  const bool bPrecomputedDist = false;
+  //================neighbor lists construction, for use of selecting neighbors===============//
+  // it2 is a neighbor of it1 if their points are farther than min_dist in both images, and closer than
+  // range1 in the first image or than range2 in the second image.
+  // The candidates are found with a grid of the matched points of each image instead of testing all the pairs.
+  std::cout << "computing neighbor lists" << std::endl;
 
-  openMVG::Matf dist1, dist2;
-  if (bPrecomputedDist )
+  std::vector<openMVG::Vec2f> points1( size ), points2( size );
+  for (int it = 0; it < size; it++ )
   {
-    dist1 = openMVG::Matf::Zero( F1.size(), F1.size() );
-    dist2 = openMVG::Matf::Zero( F2.size(), F2.size() );
+    points1[ it ] << F1[ matches[ it ].first ].x(), F1[ matches[ it ].first ].y();
+    points2[ it ] << F2[ matches[ it ].second ].x(), F2[ matches[ it ].second ].y();
+  }
+  const features::Feature_Grid grid1( points1, range1 );
+  const features::Feature_Grid grid2( points2, range2 );
 
-    for (size_t a1 = 0; a1 < F1.size(); ++a1 )
-      for (size_t a2 = a1; a2 < F1.size(); ++a2 )
-        dist1( a1, a2 ) = dist1( a2, a1 ) = point_distance( F1[ a1 ], F1[ a2 ] );
+  // neighbors: sorted neighbors of each match
+  // duplicates: sorted following matches that share a point (index or position) with a match
+  std::vector<std::vector<uint32_t>> neighbors( size ), duplicates( size );
+#ifdef OPENMVG_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int it1 = 0; it1 < size; it1++ )
+  {
+    const size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+
+    std::vector<uint32_t> candidates;
+    const auto add_candidate = [&]( uint32_t, uint32_t it2 ) { candidates.push_back( it2 ); };
+    grid1.ForEachInRadius( points1[ it1 ].x(), points1[ it1 ].y(), range1, add_candidate );
+    grid2.ForEachInRadius( points2[ it1 ].x(), points2[ it1 ].y(), range2, add_candidate );
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+    for (const uint32_t it2 : candidates )
+    {
+      const size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
+      const float d1 = point_distance( F1[ a1 ], F1[ a2 ] );
+      const float d2 = point_distance( F2[ b1 ], F2[ b2 ] );
+      if (d1 > min_dist && d2 > min_dist && ( d1 < range1 || d2 < range2 ) )
+        neighbors[ it1 ].push_back( it2 );
+    }
 
-    for (size_t b1 = 0; b1 < F2.size(); ++b1 )
-      for (size_t b2 = b1; b2 < F2.size(); ++b2 )
-        dist2( b1, b2 ) = dist2( b2, b1 ) = point_distance( F2[ b1 ], F2[ b2 ] );
+    // Matches with the same point share the cell of this point
+    candidates.clear();
+    grid1.ForEachInRadius( points1[ it1 ].x(), points1[ it1 ].y(), 0.f, add_candidate );
+    grid2.ForEachInRadius( points2[ it1 ].x(), points2[ it1 ].y(), 0.f, add_candidate );
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+    for (const uint32_t it2 : candidates )
+    {
+      if (int( it2 ) > it1 &&
+          ( matches[ it2 ].first == a1 || matches[ it2 ].second == b1 ||
+            points1[ it2 ] == points1[ it1 ] || points2[ it2 ] == points2[ it1 ] ) )
+        duplicates[ it1 ].push_back( it2 );
+    }
   }
 
   std::fill( valide.begin(), valide.end(), true );
   std::vector<double> scoretable( size, 0.0 );
   std::vector<size_t> result( size, 0 );
-
+  // consistencies: (neighbor, gvld-consistency) of the following neighbors of the matches of a block, in the scan order
+  std::vector<std::vector<std::pair<uint32_t, float>>> consistencies( kvld_block_size );
 
 //============main iteration formatch verification==========//
 //    cout<<"main iteration";
@@ -253,62 +365,77 @@ float KVLD( const Image<float>& I1,
     std::fill( scoretable.begin(), scoretable.end(), 0.0 );
     std::fill( result.begin(), result.end(), 0 );
     //========substep 1: search foreach match its neighbors and verify if they are gvld-consistent ============//
-    for (size_t it1 = 0; it1 < size - 1; it1++ )
+    // The matches are processed by blocks. The unknown gvld-consistencies of the matches of a block are evaluated
+    // in parallel: the following neighbors of a match are visited in order until enough consistent ones are found
+    // to reach max_connection (the most that the sequential scan can use, knowing the connections of the previous
+    // blocks). The block is then scanned sequentially to update E and the scores as a pair by pair scan would do.
+    for (int block_begin = 0; block_begin < size; block_begin += kvld_block_size )
     {
-      if (valide[ it1 ] )
+      const int block_end = std::min( size, block_begin + kvld_block_size );
+#ifdef OPENMVG_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int it1 = block_begin; it1 < block_end; it1++ )
       {
-        size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
-
-        for (size_t it2 = it1 + 1; it2 < size; it2++ )
-          if (valide[ it2 ])
-          {
+        std::vector<std::pair<uint32_t, float>> & row_consistencies = consistencies[ it1 - block_begin ];
+        row_consistencies.clear();
+        if (!valide[ it1 ] )
+          continue;
+        const size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
+        // The scan stops at the first consistent neighbor if max_connection is already reached
+        const size_t needed = result[ it1 ] < max_connection ? max_connection - result[ it1 ] : 1;
+        size_t consistent_count = 0;
+        const auto first_following = std::upper_bound( neighbors[ it1 ].begin(), neighbors[ it1 ].end(), uint32_t( it1 ) );
+        for (auto it = first_following; it != neighbors[ it1 ].end() && consistent_count < needed; ++it )
+        {
+          const uint32_t it2 = *it;
+          if (!valide[ it2 ] )
+            continue;
+          float value = float( E( it1, it2 ) );
+          if (value == -1 )
+          { // E is unknown
+            value = -2;
             const size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
-
-            bool bOk = false;
-            if (bPrecomputedDist )
-              bOk = ( dist1( a1, a2 ) > min_dist && dist2( b1, b2 ) > min_dist
-                 && ( dist1( a1, a2 ) < range1   || dist2( b1, b2 ) < range2 ) );
-            else
-              bOk = ( point_distance( F1[ a1 ], F1[ a2 ] ) > min_dist && point_distance( F2[ b1 ], F2[ b2 ] ) > min_dist &&
-                    ( point_distance( F1[ a1 ], F1[ a2 ] ) < range1   || point_distance( F2[ b1 ], F2[ b2 ] ) < range2 ) );
-            if (bOk )
+            if (!kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
             {
-              if (E( it1, it2 ) == -1 )
-              { //update E ifunknow
-                E( it1, it2 ) = -2;
-                E( it2, it1 ) = -2;
-
-                if (!kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
-                {
-                  VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
-                  VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
-                  //vld1.test();
-                  double error = vld1.difference( vld2 );
-                  //cout<<endl<<it1<<" "<<it2<<" "<<dist1(a1,a2)<<" "<< dist2(b1,b2)<<" "<<error<<endl;
-                  if (error < juge )
-                  {
-                    E( it1, it2 ) = ( float ) error;
-                    E( it2, it1 ) = ( float ) error;
-                    //cout<<E(it2,it1)<<endl;
-                  }
-                }
-              }
-              if (E( it1, it2 ) >= 0 )
-              {
-                result[ it1 ] += 1;
-                result[ it2 ] += 1;
-                scoretable[ it1 ] += double( E( it1, it2 ) );
-                scoretable[ it2 ] += double( E( it1, it2 ) );
-                if (result[ it1 ] >= max_connection )
-                  break;
-              }
+              const VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
+              const VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
+              const double error = vld1.difference( vld2 );
+              if (error < juge )
+                value = ( float ) error;
             }
           }
+          if (value >= 0 )
+            ++consistent_count;
+          row_consistencies.emplace_back( it2, value );
+        }
+      }
+
+      for (int it1 = block_begin; it1 < block_end; it1++ )
+      {
+        for (const auto & consistency : consistencies[ it1 - block_begin ] )
+        {
+          const uint32_t it2 = consistency.first;
+          if (E( it1, it2 ) == -1 )
+          { //update E if unknown
+            E( it1, it2 ) = consistency.second;
+            E( it2, it1 ) = consistency.second;
+          }
+          if (E( it1, it2 ) >= 0 )
+          {
+            result[ it1 ] += 1;
+            result[ it2 ] += 1;
+            scoretable[ it1 ] += double( E( it1, it2 ) );
+            scoretable[ it2 ] += double( E( it1, it2 ) );
+            if (result[ it1 ] >= max_connection )
+              break;
+          }
+        }
       }
     }
 
     //========substep 2: remove false matches by K gvld-consistency criteria ============//
-    for (size_t it = 0; it < size; it++ )
+    for (int it = 0; it < size; it++ )
     {
       if (valide[ it ] && result[ it ] < kvldParameters.K )
       {
@@ -318,12 +445,12 @@ float KVLD( const Image<float>& I1,
     }
     //========substep 3: remove multiple matches to a same point by keeping the one with the best average gvld-consistency score ============//
     if (uniqueMatch )
-      for (size_t it1 = 0; it1 < size - 1; it1++ )
+      for (int it1 = 0; it1 < size; it1++ )
         if (valide[ it1 ]) {
           size_t a1 = matches[ it1 ].first;
           size_t b1 = matches[ it1 ].second;
 
-          for (size_t it2 = it1 + 1; it2 < size; it2++ )
+          for (const uint32_t it2 : duplicates[ it1 ] )
             if (valide[ it2 ] )
             {
               size_t a2 = matches[ it2 ].first;
@@ -366,59 +493,51 @@ float KVLD( const Image<float>& I1,
     //========substep 4: ifgeometric verification is set, re-score matches by geometric-consistency, and remove poorly scored ones ============================//
     if (uniqueMatch && kvldParameters.geometry )
     {
-      for (size_t i = 0; i < size; i++ )
-        scoretable[ i ]=0;
+      std::fill( scoretable.begin(), scoretable.end(), 0.0 );
 
-      std::vector<bool> switching;
-      for (size_t i = 0; i < size; i++ )
-        switching.push_back( false );
+      std::vector<char> switching( size, false );
 
-      for (size_t it1 = 0; it1 < size; it1++ )
+#ifdef OPENMVG_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int it1 = 0; it1 < size; it1++ )
       {
         if (valide[ it1 ] )
         {
           size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
           float index = 0.0f;
           int good_index = 0;
-          for (size_t it2 = 0; it2 < size; it2++ )
+          for (const uint32_t it2 : neighbors[ it1 ] )
           {
-            if (it1 != it2 && valide[ it2 ] )
+            if (valide[ it2 ] )
             {
               size_t a2 = matches[ it2 ].first;
               size_t b2 = matches[ it2 ].second;
 
-              bool bOk = false;
-              if (bPrecomputedDist )
-                bOk = ( dist1( a1, a2 ) > min_dist && dist2( b1, b2 ) > min_dist &&
-                      ( dist1( a1, a2 ) < range1   || dist2( b1, b2 ) < range2 ) );
-              else
-                bOk = ( point_distance( F1[ a1 ], F1[ a2 ] ) > min_dist && point_distance( F2[ b1 ], F2[ b2 ] ) > min_dist &&
-                      ( point_distance( F1[ a1 ], F1[ a2 ] ) < range1   || point_distance( F2[ b1 ], F2[ b2 ] ) < range2 ) );
-              if (bOk )
-              {
-                float d = consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] );
-                scoretable[ it1 ] += d;
-                index += 1;
-                if (d < distance_thres )
-                  good_index++;
-              }
+              float d = consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] );
+              scoretable[ it1 ] += d;
+              index += 1;
+              if (d < distance_thres )
+                good_index++;
             }
           }
           scoretable[ it1 ] /= index;
           if (good_index < 0.3f * float( index ) && scoretable[ it1 ] > 1.2 )
           {
             switching[ it1 ] = true;
-            change = true;
           }
         }
       }
-      for (size_t it1 = 0; it1 < size; it1++ )
+      for (int it1 = 0; it1 < size; it1++ )
         if (switching[ it1 ] )
+        {
           valide[ it1 ] = false;
+          change = true;
+        }
     }
   }
   //=============== generating output list ===================//
-  for (size_t it = 0; it < size; it++ )
+  for (int it = 0; it < size; it++ )
     if (valide[ it ] )
     {
       matchesFiltered.push_back( matches[ it ] );
@@ -10,7 +10,13 @@
 #define OPENMVG_MATCHING_KVLD_H
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "openMVG/numeric/eigen_alias_definition.hpp"
@@ -61,6 +67,9 @@ struct ImageScale
   ImageScale(const openMVG::image::Image<float>& I, double r = 5.0);
   int getIndex( const double r )const;
 
+  int Width() const { return angles.empty() ? 0 : angles[ 0 ].Width(); }
+  int Height() const { return angles.empty() ? 0 : angles[ 0 ].Height(); }
+
 private:
   void GradAndNorm(
     const openMVG::image::Image<float>& I,
@@ -68,6 +77,31 @@ private:
     openMVG::image::Image<float>& m);
 };
 
+//====== Cache of pyramids of scale images ======//
+// An image is usually matched with several other images: its pyramid of scale images is built once
+// and shared by all its pairs. Only the max_size most recently used pyramids are kept in memory.
+//
+// get: return the pyramid of the image identified by key, built from the image provided by the loader
+//      on a cache miss (nullptr if the loader fails)
+class ImageScaleCache
+{
+public:
+  explicit ImageScaleCache( size_t max_size = 4 ): max_size_( std::max( max_size, size_t( 1 ) ) ){}
+
+  std::shared_ptr<const ImageScale> get(
+    const std::string & key,
+    const std::function<bool( openMVG::image::Image<float>& )> & loader );
+
+  size_t size() const;
+
+private:
+  using Entry = std::pair<std::string, std::shared_ptr<const ImageScale>>;
+
+  const size_t max_size_;
+  mutable std::mutex mutex_;
+  std::list<Entry> entries_; // most recently used first
+};
+
 //====== VLD structures ======//
 class VLD
 {
@@ -181,4 +215,17 @@ float KVLD(const openMVG::image::Image<float>& I1,
   std::vector<bool>& valide,
   KvldParameters& kvldParameters );
 
+//Same as above, with the pyramids of scale images of I1 and I2 provided by the caller:
+// they can be shared by the successive KVLD calls of a pair and by the pairs of an image (c.f. ImageScaleCache).
+float KVLD(const ImageScale& Chaine1,
+  const ImageScale& Chaine2,
+  const std::vector<openMVG::features::SIOPointFeature> & F1,
+  const std::vector<openMVG::features::SIOPointFeature> & F2,
+  const std::vector<openMVG::Pair>& matches,
+  std::vector<openMVG::Pair>& matchesFiltered,
+  std::vector<double>& score,
+  openMVG::Mat& E,
+  std::vector<bool>& valide,
+  KvldParameters& kvldParameters );
+
 #endif // OPENMVG_MATCHING_KVLD_H
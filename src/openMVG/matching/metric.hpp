@@ -103,7 +103,7 @@ struct L2<float>
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
     #ifdef OPENMVG_USE_AVX2
-    if (size == 128)
+    if (size % 8 == 0) // i.e. SIFT (128) or padded dipole (24) descriptors
     {
       return L2_AVX2(a, b, size);
     }
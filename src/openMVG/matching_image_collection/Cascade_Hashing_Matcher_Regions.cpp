@@ -13,10 +13,13 @@
 #include "openMVG/matching/matching_filters.hpp"
 #include "openMVG/matching/indMatchDecoratorXY.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/types.hpp"
 
 #include "third_party/progress/progress.hpp"
 
+#include <iterator>
+
 namespace openMVG {
 namespace matching_image_collection {
 
@@ -44,6 +47,7 @@ void Match
   C_Progress * my_progress_bar
 )
 {
+  OPENMVG_PROFILE_ZONE("putative_matching");
   if (!my_progress_bar)
     my_progress_bar = &C_Progress::dummy();
   my_progress_bar->restart(pairs.size(), "\n- Matching -\n");
@@ -110,6 +114,7 @@ void Match
     std::set<IndexT>::const_iterator iter = used_index.begin();
     std::advance(iter, i);
     const IndexT I = *iter;
+    OPENMVG_PROFILE_ZONE("hash_descriptions");
     const std::shared_ptr<features::Regions> regionsI = regions_provider.get(I);
     const ScalarT * tabI =
       reinterpret_cast<const ScalarT*>(regionsI->DescriptorRawData());
@@ -126,12 +131,21 @@ void Match
   }
 
   // Perform matching between all the pairs
-  for (const auto & pairs : map_Pairs)
+  for (auto pairs_it = map_Pairs.cbegin(); pairs_it != map_Pairs.cend(); ++pairs_it)
   {
     if (my_progress_bar->hasBeenCanceled())
       break;
-    const IndexT I = pairs.first;
-    const std::vector<IndexT> & indexToCompare = pairs.second;
+    const IndexT I = pairs_it->first;
+    const std::vector<IndexT> & indexToCompare = pairs_it->second;
+
+    // Let the regions provider load the views of the next batch while this one is matched
+    const auto next_pairs_it = std::next(pairs_it);
+    if (next_pairs_it != map_Pairs.cend())
+    {
+      std::vector<IndexT> next_views(1, next_pairs_it->first);
+      next_views.insert(next_views.end(), next_pairs_it->second.begin(), next_pairs_it->second.end());
+      regions_provider.prefetch(next_views);
+    }
 
     const std::shared_ptr<features::Regions> regionsI = regions_provider.get(I);
     if (regionsI->RegionCount() == 0)
@@ -162,6 +176,7 @@ void Match
         continue;
       }
 
+      OPENMVG_PROFILE_ZONE("match_pair");
       // Matrix representation of the query input data;
       const ScalarT * tabJ = reinterpret_cast<const ScalarT*>(regionsJ->DescriptorRawData());
       Eigen::Map<BaseMat> mat_J( (ScalarT*)tabJ, regionsJ->RegionCount(), dimension);
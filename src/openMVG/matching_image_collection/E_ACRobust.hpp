@@ -37,8 +37,10 @@ struct GeometricFilter_EMatrix_AC
 {
   GeometricFilter_EMatrix_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
-    : m_dPrecision(dPrecision), m_stIteration(iteration), m_E(Mat3::Identity()),
+    size_t iteration = 1024,
+    bool bProsacSprt = false)
+    : m_dPrecision(dPrecision), m_stIteration(iteration), m_bProsacSprt(bProsacSprt),
+      m_E(Mat3::Identity()),
       m_dPrecision_robust(std::numeric_limits<double>::infinity()){}
 
   /// Robust fitting of the ESSENTIAL matrix
@@ -111,8 +113,14 @@ struct GeometricFilter_EMatrix_AC
     // Robustly estimate the Essential matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
+    // Optional PROSAC (descriptor distance ordering, needs a Regions_Provider) & SPRT scheduling
+    openMVG::robust::ACRANSAC_Scheduling scheduling;
+    if (m_bProsacSprt)
+    {
+      ProsacSprt_Scheduling(pairIndex, vec_PutativeMatches, regions_provider, scheduling);
+    }
     const auto ACRansacOut =
-      openMVG::robust::ACRANSAC(kernel, vec_inliers, m_stIteration, &m_E, upper_bound_precision);
+      openMVG::robust::ACRANSAC(kernel, vec_inliers, scheduling, m_stIteration, &m_E, upper_bound_precision);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)  {
       m_dPrecision_robust = ACRansacOut.first;
@@ -171,10 +179,8 @@ struct GeometricFilter_EMatrix_AC
         regionsI = regions_provider->get(iIndex),
         regionsJ = regions_provider->get(jIndex);
 
-      geometry_aware::GuidedMatching
-        <Mat3,
-        openMVG::fundamental::kernel::EpipolarDistanceError>(
-        //openMVG::fundamental::kernel::SymmetricEpipolarDistanceError>(
+      geometry_aware::GuidedMatching_Fundamental_Grid
+        <openMVG::fundamental::kernel::EpipolarDistanceError>(
         F,
         cam_I, *regionsI,
         cam_J, *regionsJ,
@@ -186,6 +192,7 @@ struct GeometricFilter_EMatrix_AC
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   size_t m_stIteration; //maximal number of iteration for robust estimation
+  bool m_bProsacSprt;   //use the PROSAC sampling & SPRT model verification
   //
   //-- Stored data
   Mat3 m_E;
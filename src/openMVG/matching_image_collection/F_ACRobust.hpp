@@ -31,8 +31,10 @@ struct GeometricFilter_FMatrix_AC
 {
   GeometricFilter_FMatrix_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
-    : m_dPrecision(dPrecision), m_stIteration(iteration), m_F(Mat3::Identity()),
+    size_t iteration = 1024,
+    bool bProsacSprt = false)
+    : m_dPrecision(dPrecision), m_stIteration(iteration), m_bProsacSprt(bProsacSprt),
+      m_F(Mat3::Identity()),
       m_dPrecision_robust(std::numeric_limits<double>::infinity()){}
 
   /// Robust fitting of the FUNDAMENTAL matrix
@@ -79,8 +81,14 @@ struct GeometricFilter_FMatrix_AC
     // Robustly estimate the Fundamental matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
+    // Optional PROSAC (descriptor distance ordering, needs a Regions_Provider) & SPRT scheduling
+    ACRANSAC_Scheduling scheduling;
+    if (m_bProsacSprt)
+    {
+      ProsacSprt_Scheduling(pairIndex, vec_PutativeMatches, regions_provider, scheduling);
+    }
     const std::pair<double,double> ACRansacOut =
-      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_F, upper_bound_precision);
+      ACRANSAC(kernel, vec_inliers, scheduling, m_stIteration, &m_F, upper_bound_precision);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)  {
       m_dPrecision_robust = ACRansacOut.first;
@@ -128,10 +136,8 @@ struct GeometricFilter_FMatrix_AC
         regionsJ = regions_provider->get(jIndex);
 
       // Check the features correspondences that agree in the geometric and photometric domain
-      geometry_aware::GuidedMatching
-        <Mat3,
-        openMVG::fundamental::kernel::EpipolarDistanceError>(
-        //openMVG::fundamental::kernel::SymmetricEpipolarDistanceError>(
+      geometry_aware::GuidedMatching_Fundamental_Grid
+        <openMVG::fundamental::kernel::EpipolarDistanceError>(
         m_F,
         cam_I, *regionsI,
         cam_J, *regionsJ,
@@ -143,6 +149,7 @@ struct GeometricFilter_FMatrix_AC
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   size_t m_stIteration; //maximal number of iteration for robust estimation
+  bool m_bProsacSprt;   //use the PROSAC sampling & SPRT model verification
   //
   //-- Stored data
   Mat3 m_F;
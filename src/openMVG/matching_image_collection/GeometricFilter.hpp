@@ -15,6 +15,7 @@
 
 #include "openMVG/features/feature.hpp"
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/system/profiler.hpp"
 
 #include "third_party/progress/progress_display.hpp"
 
@@ -72,6 +73,7 @@ void ImageCollectionGeometricFilter::Robust_model_estimation
   C_Progress * my_progress_bar
 )
 {
+  OPENMVG_PROFILE_ZONE("geometric_filtering");
   if (!my_progress_bar)
     my_progress_bar = &C_Progress::dummy();
   my_progress_bar->restart( putative_matches.size(), "\n- Geometric filtering -\n" );
@@ -91,6 +93,7 @@ void ImageCollectionGeometricFilter::Robust_model_estimation
 
     //-- Apply the geometric filter (robust model estimation)
     {
+      OPENMVG_PROFILE_ZONE("filter_pair");
       IndMatches putative_inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
       if (geometricFilter.Robust_estimation(
@@ -102,6 +105,7 @@ void ImageCollectionGeometricFilter::Robust_model_estimation
       {
         if (b_guided_matching)
         {
+          OPENMVG_PROFILE_ZONE("guided_matching");
           IndMatches guided_geometric_inliers;
           geometricFilter.Geometry_guided_matching(
             sfm_data_,
@@ -11,11 +11,15 @@
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 #include "openMVG/features/feature.hpp"
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_view.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 
+#include <algorithm>
+#include <utility>
+
 namespace openMVG {
 namespace matching_image_collection {
 
@@ -123,5 +127,55 @@ void MatchesPairToMat
     x_I, x_J);
 }
 
+void MatchesQualityOrder
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider,
+  std::vector<uint32_t> & quality_order
+)
+{
+  const std::shared_ptr<features::Regions>
+    regionsI = regions_provider->get(pairIndex.first),
+    regionsJ = regions_provider->get(pairIndex.second);
+
+  std::vector<std::pair<double, uint32_t>> distances(putativeMatches.size());
+  for (size_t i = 0; i < putativeMatches.size(); ++i)
+  {
+    distances[i] = {
+      regionsI->SquaredDescriptorDistance(putativeMatches[i].i_, regionsJ.get(), putativeMatches[i].j_),
+      static_cast<uint32_t>(i)};
+  }
+  std::sort(distances.begin(), distances.end());
+
+  quality_order.resize(distances.size());
+  for (size_t i = 0; i < distances.size(); ++i)
+    quality_order[i] = distances[i].second;
+}
+
+void ProsacSprt_Scheduling
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider,
+  robust::ACRANSAC_Scheduling & scheduling
+)
+{
+  MatchesQualityOrder(pairIndex, putativeMatches, regions_provider, scheduling.quality_order);
+  scheduling.b_sprt = true;
+}
+
+void ProsacSprt_Scheduling
+(
+  const Pair,
+  const matching::IndMatches &,
+  const std::shared_ptr<sfm::Features_Provider> &,
+  robust::ACRANSAC_Scheduling & scheduling
+)
+{
+  scheduling.quality_order.clear();
+  scheduling.b_sprt = true;
+}
+
 } //namespace matching_image_collection
 } // namespace openMVG
@@ -14,6 +14,7 @@
 #include <openMVG/numeric/eigen_alias_definition.hpp>
 
 namespace openMVG { namespace cameras { struct IntrinsicBase; } }
+namespace openMVG { namespace robust { struct ACRANSAC_Scheduling; } }
 namespace openMVG { namespace sfm { struct Regions_Provider; } }
 namespace openMVG { namespace sfm { struct Features_Provider; } }
 namespace openMVG { namespace sfm { struct SfM_Data; } }
@@ -82,6 +83,53 @@ void MatchesPairToMat
   Mat2X & x_J
 );
 
+/**
+* @brief Rank the matches of the pair pairIndex by increasing descriptor distance
+*  (match quality order used by the PROSAC sampling)
+* @param[in] pairIndex Pair of the matches
+* @param[in] putativeMatches Matches of the 'pairIndex' pair
+* @param[in] regions_provider Interface that provides the regions descriptors
+* @param[out] quality_order Match indexes sorted by decreasing quality
+*/
+void MatchesQualityOrder
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider,
+  std::vector<uint32_t> & quality_order
+);
+
+/**
+* @brief Configure the PROSAC & SPRT scheduling of the ACRANSAC estimation of a pair:
+*  the samples are drawn from the matches ranked by descriptor distance and the
+*  hypotheses are rejected early by the SPRT
+* @param[in] pairIndex Pair of the matches
+* @param[in] putativeMatches Matches of the 'pairIndex' pair
+* @param[in] regions_provider Interface that provides the regions descriptors
+* @param[out] scheduling The ACRANSAC hypothesis scheduling
+*/
+void ProsacSprt_Scheduling
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider,
+  robust::ACRANSAC_Scheduling & scheduling
+);
+
+/**
+* @brief Configure the SPRT scheduling of the ACRANSAC estimation of a pair.
+* The Features_Provider does not store the descriptors, so the matches cannot be
+*  ranked for the PROSAC sampling: only the SPRT early rejection is used.
+* @param[out] scheduling The ACRANSAC hypothesis scheduling
+*/
+void ProsacSprt_Scheduling
+(
+  const Pair,
+  const matching::IndMatches &,
+  const std::shared_ptr<sfm::Features_Provider> &,
+  robust::ACRANSAC_Scheduling & scheduling
+);
+
 } //namespace matching_image_collection
 } // namespace openMVG
 
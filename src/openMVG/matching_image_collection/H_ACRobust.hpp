@@ -35,8 +35,10 @@ struct GeometricFilter_HMatrix_AC
 {
   GeometricFilter_HMatrix_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
-    : m_dPrecision(dPrecision), m_stIteration(iteration), m_H(Mat3::Identity()),
+    size_t iteration = 1024,
+    bool bProsacSprt = false)
+    : m_dPrecision(dPrecision), m_stIteration(iteration), m_bProsacSprt(bProsacSprt),
+      m_H(Mat3::Identity()),
       m_dPrecision_robust(std::numeric_limits<double>::infinity()){}
 
   /// Robust fitting of the HOMOGRAPHY matrix
@@ -83,8 +85,14 @@ struct GeometricFilter_HMatrix_AC
     // Robustly estimate the Homography matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
+    // Optional PROSAC (descriptor distance ordering, needs a Regions_Provider) & SPRT scheduling
+    ACRANSAC_Scheduling scheduling;
+    if (m_bProsacSprt)
+    {
+      ProsacSprt_Scheduling(pairIndex, vec_PutativeMatches, regions_provider, scheduling);
+    }
     const std::pair<double,double> ACRansacOut =
-      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_H, upper_bound_precision);
+      ACRANSAC(kernel, vec_inliers, scheduling, m_stIteration, &m_H, upper_bound_precision);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)  {
       m_dPrecision_robust = ACRansacOut.first;
@@ -175,8 +183,8 @@ struct GeometricFilter_HMatrix_AC
       else
       {
         // Filtering based on region positions and regions descriptors
-        geometry_aware::GuidedMatching
-          <Mat3, openMVG::homography::kernel::AsymmetricError>(
+        geometry_aware::GuidedMatching_Homography_Grid
+          <openMVG::homography::kernel::AsymmetricError>(
           m_H,
           cam_I, *regionsI,
           cam_J, *regionsJ,
@@ -189,6 +197,7 @@ struct GeometricFilter_HMatrix_AC
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   size_t m_stIteration; //maximal number of iteration for robust estimation
+  bool m_bProsacSprt;   //use the PROSAC sampling & SPRT model verification
   //
   //-- Stored data
   Mat3 m_H;
@@ -10,9 +10,13 @@
 #include "openMVG/matching_image_collection/Matcher.hpp"
 #include "openMVG/matching/regions_matcher.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
+#include "openMVG/system/profiler.hpp"
 
 #include "third_party/progress/progress.hpp"
 
+#include <iterator>
+#include <vector>
+
 namespace openMVG {
 namespace matching_image_collection {
 
@@ -32,6 +36,7 @@ void Matcher_Regions::Match(
   PairWiseMatchesContainer & map_PutativesMatches,
   C_Progress * my_progress_bar)const
 {
+  OPENMVG_PROFILE_ZONE("putative_matching");
   if (!my_progress_bar)
     my_progress_bar = &C_Progress::dummy();
 #ifdef OPENMVG_USE_OPENMP
@@ -51,12 +56,21 @@ void Matcher_Regions::Match(
   }
 
   // Perform matching between all the pairs
-  for (const auto & pairs : map_Pairs)
+  for (auto pairs_it = map_Pairs.cbegin(); pairs_it != map_Pairs.cend(); ++pairs_it)
   {
     if (my_progress_bar->hasBeenCanceled())
       continue;
-    const IndexT I = pairs.first;
-    const auto & indexToCompare = pairs.second;
+    const IndexT I = pairs_it->first;
+    const auto & indexToCompare = pairs_it->second;
+
+    // Let the regions provider load the views of the next batch while this one is matched
+    const auto next_pairs_it = std::next(pairs_it);
+    if (next_pairs_it != map_Pairs.cend())
+    {
+      std::vector<IndexT> next_views(1, next_pairs_it->first);
+      next_views.insert(next_views.end(), next_pairs_it->second.begin(), next_pairs_it->second.end());
+      regions_provider->prefetch(next_views);
+    }
 
     const std::shared_ptr<features::Regions> regionsI = regions_provider->get(I);
     if (regionsI->RegionCount() == 0)
@@ -83,6 +97,7 @@ void Matcher_Regions::Match(
         continue;
       }
 
+      OPENMVG_PROFILE_ZONE("match_pair");
       IndMatches vec_putatives_matches;
       matcher.Match(f_dist_ratio_, *regionsJ.get(), vec_putatives_matches);
 
@@ -34,16 +34,17 @@
 
 namespace openMVG {
 
-Mat FivePointsNullspaceBasis(const Mat3X &x1, const Mat3X &x2) {
-  Mat epipolar_constraint = Eigen::Matrix<double,9, 9>::Constant(0.0);
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasis(const Mat3X &x1, const Mat3X &x2) {
+  using Mat9 = Eigen::Matrix<double, 9, 9>;
+  Mat9 epipolar_constraint = Mat9::Zero();
   fundamental::kernel::EncodeEpipolarEquation(x1, x2, &epipolar_constraint);
-  Eigen::SelfAdjointEigenSolver<Mat> solver
+  Eigen::SelfAdjointEigenSolver<Mat9> solver
     (epipolar_constraint.transpose() * epipolar_constraint);
   return solver.eigenvectors().leftCols<4>();
 }
 
-Vec o1(const Vec &a, const Vec &b) {
-  Vec res = Vec::Zero(20);
+Vec20 o1(const Vec20 &a, const Vec20 &b) {
+  Vec20 res = Vec20::Zero();
 
   res(coef_xx) = a(coef_x) * b(coef_x);
   res(coef_xy) = a(coef_x) * b(coef_y)
@@ -65,8 +66,8 @@ Vec o1(const Vec &a, const Vec &b) {
   return res;
 }
 
-Vec o2(const Vec &a, const Vec &b) {
-  Vec res(20);
+Vec20 o2(const Vec20 &a, const Vec20 &b) {
+  Vec20 res;
 
   res(coef_xxx) = a(coef_xx) * b(coef_x);
   res(coef_xxy) = a(coef_xx) * b(coef_y)
@@ -112,12 +113,16 @@ Vec o2(const Vec &a, const Vec &b) {
   return res;
 }
 
-Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
+Eigen::Matrix<double, 10, 20> FivePointsPolynomialConstraints
+(
+  const Eigen::Matrix<double, 9, 4> &E_basis
+)
+{
   // Build the polynomial form of E (equation (8) in Stewenius et al. [1])
-  Vec E[3][3];
+  Vec20 E[3][3];
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      E[i][j] = Vec::Zero(20);
+      E[i][j] = Vec20::Zero();
       E[i][j](coef_x) = E_basis(3 * i + j, 0);
       E[i][j](coef_y) = E_basis(3 * i + j, 1);
       E[i][j](coef_z) = E_basis(3 * i + j, 2);
@@ -126,7 +131,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // The constraint matrix.
-  Mat M(10, 20);
+  Eigen::Matrix<double, 10, 20> M;
   int mrow = 0;
 
   // Determinant constraint det(E) = 0; equation (19) of Nister [2].
@@ -136,7 +141,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
 
   // Cubic singular values constraint.
   // Equation (20).
-  Vec EET[3][3];
+  Vec20 EET[3][3];
   for (int i = 0; i < 3; ++i) {    // Since EET is symmetric, we only compute
     for (int j = 0; j < 3; ++j) {  // its upper triangular part.
       if (i <= j) {
@@ -150,8 +155,8 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // Equation (21).
-  Vec (&L)[3][3] = EET;
-  const Vec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
+  Vec20 (&L)[3][3] = EET;
+  const Vec20 trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
   for (const int i : {0,1,2}) {
     L[i][i] -= trace;
   }
@@ -159,7 +164,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   // Equation (23).
   for (const int i : {0,1,2}) {
     for (const int j : {0,1,2}) {
-      Vec LEij = o2(L[i][0], E[0][j])
+      const Vec20 LEij = o2(L[i][0], E[0][j])
                + o2(L[i][1], E[1][j])
                + o2(L[i][2], E[2][j]);
       M.row(mrow++) = LEij;
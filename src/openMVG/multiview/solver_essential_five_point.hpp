@@ -49,6 +49,9 @@
 namespace openMVG
 {
 
+/// Polynomial of degree 3 in x, y, z (coefficients ordered as the coef_ enum)
+using Vec20 = Eigen::Matrix<double, 20, 1>;
+
 /**
  * @brief Computes the relative pose of two calibrated cameras from 5 correspondences.
  *
@@ -65,7 +68,7 @@ void FivePointsRelativePose( const Mat3X &x1, const Mat3X &x2,
 * @param x2 Corresponding bearing vectors in second camera
 * @return Nullspace that maps x1 points to x2 points
 */
-Mat FivePointsNullspaceBasis( const Mat3X &x1, const Mat3X &x2 );
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasis( const Mat3X &x1, const Mat3X &x2 );
 
 /**
 * @brief Multiply two polynomials of degree 1.
@@ -85,7 +88,7 @@ Mat FivePointsNullspaceBasis( const Mat3X &x1, const Mat3X &x2 );
 * @note Ordering is defined as follow:
 * [xxx xxy xyy yyy xxz xyz yyz xzz yzz zzz xx xy yy xz yz zz x y z 1]
 */
-Vec o1( const Vec &a, const Vec &b );
+Vec20 o1( const Vec20 &a, const Vec20 &b );
 
 /**
 * @brief Multiply two polynomials of degree 2
@@ -95,14 +98,17 @@ Vec o1( const Vec &a, const Vec &b );
 * @note Ordering is defined as follow :
 * [xxx xxy xyy yyy xxz xyz yyz xzz yzz zzz xx xy yy xz yz zz x y z 1]
 */
-Vec o2( const Vec &a, const Vec &b );
+Vec20 o2( const Vec20 &a, const Vec20 &b );
 
 /**
 * Builds the polynomial constraint matrix M.
 * @param E_basis Basis essential matrix
 * @return polynomial constraint associated to the essential matrix
 */
-Mat FivePointsPolynomialConstraints( const Mat &E_basis );
+Eigen::Matrix<double, 10, 20> FivePointsPolynomialConstraints
+(
+  const Eigen::Matrix<double, 9, 4> &E_basis
+);
 
 // In the following code, polynomials are expressed as vectors containing
 // their coeficients in the basis of monomials:
@@ -51,7 +51,7 @@ void SevenPointSolver::Solve
     using Mat9 = Eigen::Matrix<double, 9, 9>;
     // In the minimal solution use fixed sized matrix to let Eigen and the
     //  compiler doing the maximum of optimization.
-    Mat9 epipolar_constraint = Mat::Zero(9,9);
+    Mat9 epipolar_constraint = Mat9::Zero();
     EncodeEpipolarEquation(x1.colwise().homogeneous(),
                            x2.colwise().homogeneous(),
                            &epipolar_constraint);
@@ -123,7 +123,7 @@ void EightPointSolver::Solve
     using Mat9 = Eigen::Matrix<double, 9, 9>;
     // In the minimal solution use fixed sized matrix to let Eigen and the
     //  compiler doing the maximum of optimization.
-    Mat9 epipolar_constraint = Mat::Zero(9,9);
+    Mat9 epipolar_constraint = Mat9::Zero();
     EncodeEpipolarEquation(x1.colwise().homogeneous(),
                            x2.colwise().homogeneous(),
                            &epipolar_constraint);
@@ -39,11 +39,9 @@ inline bool compute_P3P_Poses
 (
   const Mat3 & featureVectors,
   const Mat3 & worldPoints,
-  Mat & solutions
+  Eigen::Matrix<double, 3, 16> & solutions
 )
 {
-  solutions = Mat(3, 4*4);
-
   // Extraction of world points
 
   Vec3 P1 = worldPoints.col(0);
@@ -226,7 +224,7 @@ void P3PSolver_Kneip::Solve
   assert(3 == pt3D.rows());
   assert(bearing_vectors.cols() == pt3D.cols());
 
-  Mat solutions = Mat(3, 4*4);
+  Eigen::Matrix<double, 3, 16> solutions;
   if (compute_P3P_Poses( bearing_vectors, pt3D, solutions))
   {
     Mat3 R;
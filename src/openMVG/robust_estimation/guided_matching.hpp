@@ -10,12 +10,19 @@
 #define OPENMVG_ROBUST_ESTIMATION_GUIDED_MATCHING_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/features/feature_grid.hpp"
 #include "openMVG/features/regions.hpp"
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/matching/metric.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
 #include "openMVG/numeric/numeric.h"
 
 namespace openMVG{
@@ -390,6 +397,370 @@ void GuidedMatching_Fundamental_Fast(
   }
 }
 
+/// Grid search area of the right features that can be compatible with a left
+/// feature for a fundamental matrix:
+///  the cells that overlap the band of half width sqrt(errorTh) around the
+///  epipolar line of the left feature in the right image.
+/// Valid for an error that is the squared distance of the right point to
+///  the epipolar line (EpipolarDistanceError).
+struct Epipolar_Band_Search
+{
+  Epipolar_Band_Search(const Mat3 & F, double errorTh)
+    : F_(F), radius_(std::sqrt(errorTh))
+  { }
+
+  double Radius() const { return radius_; }
+
+  // Call functor(j) for the right features j of the search area of xL
+  template <typename Functor>
+  void operator()
+  (
+    const features::Feature_Grid & grid,
+    const Vec2 & xL,
+    Functor && functor
+  ) const
+  {
+    const Vec3 line = F_ * xL.homogeneous();
+    const double norm = line.head<2>().norm();
+    if (!(norm > 0.) || !line.allFinite())
+      return;
+    const double a = line(0) / norm, b = line(1) / norm, c = line(2) / norm;
+    // A one pixel margin handles the rounding of the float grid positions
+    const double half_width = radius_ + 1.;
+    const double cell_size = grid.CellSize();
+    const auto visit = [&](const uint32_t, const uint32_t j) { functor(j); };
+    if (std::abs(b) >= std::abs(a))
+    {
+      // Mostly horizontal line: visit the band cells column by column
+      const double h = half_width / std::abs(b);
+      for (int col = 0; col < grid.Cols(); ++col)
+      {
+        const double x0 = grid.Origin().x() + col * cell_size;
+        const double x1 = x0 + cell_size;
+        const double y0 = -(a * x0 + c) / b, y1 = -(a * x1 + c) / b;
+        grid.ForEachInWindow(
+          x0 + cell_size / 4., std::min(y0, y1) - h,
+          x1 - cell_size / 4., std::max(y0, y1) + h, visit);
+      }
+    }
+    else
+    {
+      // Mostly vertical line: visit the band cells row by row
+      const double w = half_width / std::abs(a);
+      for (int row = 0; row < grid.Rows(); ++row)
+      {
+        const double y0 = grid.Origin().y() + row * cell_size;
+        const double y1 = y0 + cell_size;
+        const double x0 = -(b * y0 + c) / a, x1 = -(b * y1 + c) / a;
+        grid.ForEachInWindow(
+          std::min(x0, x1) - w, y0 + cell_size / 4.,
+          std::max(x0, x1) + w, y1 - cell_size / 4., visit);
+      }
+    }
+  }
+
+private:
+  const Mat3 F_;
+  const double radius_;
+};
+
+/// Grid search area of the right features that can be compatible with a left
+/// feature for a homography:
+///  the cells that overlap the square window of half size sqrt(errorTh)
+///  around the position predicted by the homography.
+/// Valid for an error that is the squared distance of the right point to
+///  the predicted position (AsymmetricError).
+struct Homography_Window_Search
+{
+  Homography_Window_Search(const Mat3 & H, double errorTh)
+    : H_(H), radius_(std::sqrt(errorTh))
+  { }
+
+  double Radius() const { return radius_; }
+
+  // Call functor(j) for the right features j of the search area of xL
+  template <typename Functor>
+  void operator()
+  (
+    const features::Feature_Grid & grid,
+    const Vec2 & xL,
+    Functor && functor
+  ) const
+  {
+    const Vec2 prediction = (H_ * xL.homogeneous()).hnormalized();
+    if (!prediction.allFinite())
+      return;
+    // A one pixel margin handles the rounding of the float grid positions
+    grid.ForEachInRadius(prediction.x(), prediction.y(), radius_ + 1.,
+      [&](const uint32_t, const uint32_t j) { functor(j); });
+  }
+
+private:
+  const Mat3 H_;
+  const double radius_;
+};
+
+/// Squared distance between the descriptors of two regions containers,
+/// computed on the raw descriptor arrays with the metric of the descriptor type
+/// (avoid one virtual call and one dynamic_cast per descriptor pair).
+template <typename MetricT>
+struct Raw_Descriptor_Distance
+{
+  using T = typename MetricT::ElementType;
+
+  Raw_Descriptor_Distance(const features::Regions & lRegions, const features::Regions & rRegions)
+    : lDescs_(static_cast<const T*>(lRegions.DescriptorRawData())),
+      rDescs_(static_cast<const T*>(rRegions.DescriptorRawData())),
+      length_(lRegions.DescriptorLength())
+  { }
+
+  double operator()(size_t i, size_t j) const
+  {
+    return metric_(lDescs_ + i * length_, rDescs_ + j * length_, length_);
+  }
+
+private:
+  const MetricT metric_ = MetricT();
+  const T * lDescs_;
+  const T * rDescs_;
+  const size_t length_;
+};
+
+// The Hamming distance is squared (as in Binary_Regions)
+template <typename T>
+struct Raw_Descriptor_Distance<matching::Hamming<T>>
+{
+  using MetricT = matching::Hamming<T>;
+
+  Raw_Descriptor_Distance(const features::Regions & lRegions, const features::Regions & rRegions)
+    : lDescs_(static_cast<const T*>(lRegions.DescriptorRawData())),
+      rDescs_(static_cast<const T*>(rRegions.DescriptorRawData())),
+      length_(lRegions.DescriptorLength())
+  { }
+
+  double operator()(size_t i, size_t j) const
+  {
+    const typename MetricT::ResultType descDist =
+      metric_(lDescs_ + i * length_, rDescs_ + j * length_, length_);
+    return descDist * descDist;
+  }
+
+private:
+  const MetricT metric_ = MetricT();
+  const T * lDescs_;
+  const T * rDescs_;
+  const size_t length_;
+};
+
+/// Guided Matching (features + descriptors with distance ratio) on feature
+/// positions, with a grid index of the right features:
+///  the right features are bucketed once in a 2D grid, and each left feature
+///  is only compared to the right features of the cells of its search area.
+///  The left features are processed in parallel.
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg,  // The metric to compute distance to the model
+  typename SearchT,   // The grid search area of a left feature
+  typename DistanceT> // The squared descriptor distance
+void GuidedMatching_Grid(
+  const ModelArg & mod, // The model
+  const SearchT & search,
+  const DistanceT & distance,
+  const std::vector<Vec2> & lRegionsPos, // left feature positions
+  const std::vector<Vec2> & rRegionsPos, // right feature positions
+  double errorTh,       // Maximal authorized error threshold
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  if (lRegionsPos.empty() || rRegionsPos.empty())
+    return;
+
+  // Index the right features: the cells are as large as the search radius,
+  //  and hold a few features on average
+  Vec2 lower = rRegionsPos[0], upper = rRegionsPos[0];
+  for (const Vec2 & pos : rRegionsPos)
+  {
+    lower = lower.cwiseMin(pos);
+    upper = upper.cwiseMax(pos);
+  }
+  const double mean_spacing =
+    std::sqrt((upper - lower).prod() / rRegionsPos.size());
+  const features::Feature_Grid grid(rRegionsPos,
+    static_cast<float>(std::max(2. * search.Radius(), 2. * mean_spacing)));
+
+  std::vector<distanceRatio<double>> dR(lRegionsPos.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<IndexT> candidates;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i = 0; i < static_cast<int>(lRegionsPos.size()); ++i)
+    {
+      // Right features of the search area with a valid geometric error
+      candidates.clear();
+      search(grid, lRegionsPos[i], [&](const uint32_t j)
+      {
+        if (ErrorArg::Error(mod, lRegionsPos[i], rRegionsPos[j]) < errorTh)
+          candidates.push_back(j);
+      });
+      // Same update order as the exhaustive search (in case of equal distances)
+      std::sort(candidates.begin(), candidates.end());
+      for (const IndexT j : candidates)
+      {
+        // Update the corresponding points & distance (if required)
+        dR[i].update(j, distance(i, j));
+      }
+    }
+  }
+
+  // Check distance ratio validity
+  for (size_t i = 0; i < dR.size(); ++i)
+  {
+    if (dR[i].isValid(distRatio))
+    {
+      // save the best corresponding index
+      vec_corresponding_index.push_back(matching::IndMatch(i, dR[i].idx));
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(vec_corresponding_index);
+}
+
+/// Guided Matching (features + descriptors with distance ratio) on regions,
+/// with a grid index of the right features.
+/// Give the same matches as the exhaustive GuidedMatching when the search
+/// area contains all the right features with an error below errorTh.
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg,  // The metric to compute distance to the model
+  typename SearchT>   // The grid search area of a left feature
+void GuidedMatching_Grid(
+  const ModelArg & mod, // The model
+  const SearchT & search,
+  const cameras::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const cameras::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  if (lRegions.RegionCount() == 0 || rRegions.RegionCount() == 0)
+    return;
+
+  // Build region positions arrays (in order to un-distord on-demand point position once)
+  std::vector<Vec2>
+    lRegionsPos(lRegions.RegionCount()),
+    rRegionsPos(rRegions.RegionCount());
+  for (size_t i = 0; i < lRegions.RegionCount(); ++i) {
+    lRegionsPos[i] = camL ? camL->get_ud_pixel(lRegions.GetRegionPosition(i)) : lRegions.GetRegionPosition(i);
+  }
+  for (size_t i = 0; i < rRegions.RegionCount(); ++i) {
+    rRegionsPos[i] = camR ? camR->get_ud_pixel(rRegions.GetRegionPosition(i)) : rRegions.GetRegionPosition(i);
+  }
+
+  // Switch the descriptor type: use the raw descriptor arrays and the metric
+  //  of the descriptor type (vectorized L2 or Hamming)
+  const bool b_same_type =
+    lRegions.IsScalar() == rRegions.IsScalar() &&
+    lRegions.Type_id() == rRegions.Type_id() &&
+    lRegions.DescriptorLength() == rRegions.DescriptorLength();
+  if (b_same_type && lRegions.IsScalar())
+  {
+    if (lRegions.Type_id() == typeid(unsigned char).name())
+    {
+      GuidedMatching_Grid<ModelArg, ErrorArg>(mod, search,
+        Raw_Descriptor_Distance<matching::L2<unsigned char>>(lRegions, rRegions),
+        lRegionsPos, rRegionsPos, errorTh, distRatio, vec_corresponding_index);
+      return;
+    }
+    if (lRegions.Type_id() == typeid(float).name())
+    {
+      GuidedMatching_Grid<ModelArg, ErrorArg>(mod, search,
+        Raw_Descriptor_Distance<matching::L2<float>>(lRegions, rRegions),
+        lRegionsPos, rRegionsPos, errorTh, distRatio, vec_corresponding_index);
+      return;
+    }
+    if (lRegions.Type_id() == typeid(double).name())
+    {
+      GuidedMatching_Grid<ModelArg, ErrorArg>(mod, search,
+        Raw_Descriptor_Distance<matching::L2<double>>(lRegions, rRegions),
+        lRegionsPos, rRegionsPos, errorTh, distRatio, vec_corresponding_index);
+      return;
+    }
+  }
+  else if (b_same_type && lRegions.IsBinary()
+    && lRegions.Type_id() == typeid(unsigned char).name())
+  {
+    GuidedMatching_Grid<ModelArg, ErrorArg>(mod, search,
+      Raw_Descriptor_Distance<matching::Hamming<unsigned char>>(lRegions, rRegions),
+      lRegionsPos, rRegionsPos, errorTh, distRatio, vec_corresponding_index);
+    return;
+  }
+
+  // Unknown descriptor type: use the Regions interface
+  const auto regions_distance = [&](size_t i, size_t j)
+  {
+    return lRegions.SquaredDescriptorDistance(i, &rRegions, j);
+  };
+  GuidedMatching_Grid<ModelArg, ErrorArg>(mod, search, regions_distance,
+    lRegionsPos, rRegionsPos, errorTh, distRatio, vec_corresponding_index);
+}
+
+/// Guided Matching (features + descriptors with distance ratio) with a known
+/// fundamental matrix:
+///  each left feature is only compared to the right features of the grid
+///  cells that overlap a band around its epipolar line.
+///  Give the same matches as GuidedMatching<Mat3, EpipolarDistanceError>.
+template<
+  typename ErrorArg> // The squared distance to the epipolar line in the right image
+void GuidedMatching_Fundamental_Grid(
+  const Mat3 & F,       // The fundamental matrix
+  const cameras::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const cameras::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold (squared pixel distance)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  static_assert(std::is_same<ErrorArg, fundamental::kernel::EpipolarDistanceError>::value,
+    "The epipolar band search requires the squared point to epipolar line distance");
+  GuidedMatching_Grid<Mat3, ErrorArg>(
+    F, Epipolar_Band_Search(F, errorTh),
+    camL, lRegions, camR, rRegions,
+    errorTh, distRatio, vec_corresponding_index);
+}
+
+/// Guided Matching (features + descriptors with distance ratio) with a known
+/// homography:
+///  each left feature is only compared to the right features of the grid
+///  cells that overlap a window around its predicted position.
+///  Give the same matches as GuidedMatching<Mat3, AsymmetricError>.
+template<
+  typename ErrorArg> // The squared distance to the predicted position in the right image
+void GuidedMatching_Homography_Grid(
+  const Mat3 & H,       // The homography
+  const cameras::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const cameras::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold (squared pixel distance)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  static_assert(std::is_same<ErrorArg, homography::kernel::AsymmetricError>::value,
+    "The homography window search requires the squared distance to the predicted position");
+  GuidedMatching_Grid<Mat3, ErrorArg>(
+    H, Homography_Window_Search(H, errorTh),
+    camL, lRegions, camR, rRegions,
+    errorTh, distRatio, vec_corresponding_index);
+}
+
 } // namespace geometry_aware
 } // namespace openMVG
 
@@ -0,0 +1,120 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
+#include "openMVG/robust_estimation/guided_matching.hpp"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::features;
+using namespace openMVG::geometry_aware;
+
+std::mt19937 random_generator(std::mt19937::default_seed);
+
+// Random right features and left features that are their image by a
+//  2D transformation (with noisy positions and descriptors),
+//  and some outliers in both images.
+void MakeRegions
+(
+  const Mat3 & right_to_left,
+  SIFT_Regions & lRegions,
+  SIFT_Regions & rRegions
+)
+{
+  std::uniform_real_distribution<float> x_dist(0.f, 640.f), y_dist(0.f, 480.f);
+  std::normal_distribution<float> position_noise(0.f, 1.f);
+  std::uniform_int_distribution<int> value_dist(0, 255), value_noise(-10, 10);
+
+  const auto random_descriptor = [&]()
+  {
+    SIFT_Regions::DescriptorT desc;
+    for (int k = 0; k < 128; ++k)
+      desc[k] = static_cast<unsigned char>(value_dist(random_generator));
+    return desc;
+  };
+
+  for (int i = 0; i < 2000; ++i)
+  {
+    const Vec2 xR(x_dist(random_generator), y_dist(random_generator));
+    rRegions.Features().emplace_back(xR.x(), xR.y(), 1.f, 0.f);
+    rRegions.Descriptors().push_back(random_descriptor());
+    if (i % 3 == 0)
+      continue;
+    const Vec2 xL = (right_to_left * xR.homogeneous()).hnormalized();
+    lRegions.Features().emplace_back(
+      xL.x() + position_noise(random_generator),
+      xL.y() + position_noise(random_generator), 1.f, 0.f);
+    SIFT_Regions::DescriptorT desc = rRegions.Descriptors().back();
+    for (int k = 0; k < 128; ++k)
+      desc[k] = static_cast<unsigned char>(
+        std::min(255, std::max(0, desc[k] + value_noise(random_generator))));
+    lRegions.Descriptors().push_back(desc);
+  }
+  for (int i = 0; i < 500; ++i)
+  {
+    lRegions.Features().emplace_back(x_dist(random_generator), y_dist(random_generator), 1.f, 0.f);
+    lRegions.Descriptors().push_back(random_descriptor());
+  }
+}
+
+TEST(GuidedMatching_Grid, Homography)
+{
+  Mat3 H;
+  H << 1.1, 0.05, -20.,
+       -0.03, 0.95, 15.,
+       1e-5, -2e-5, 1.;
+
+  SIFT_Regions lRegions, rRegions;
+  MakeRegions(H.inverse(), lRegions, rRegions);
+
+  const double errorTh = Square(10.), distRatio = Square(0.8);
+  matching::IndMatches exhaustive_matches, grid_matches;
+  GuidedMatching<Mat3, homography::kernel::AsymmetricError>(
+    H, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, exhaustive_matches);
+  GuidedMatching_Homography_Grid<homography::kernel::AsymmetricError>(
+    H, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, grid_matches);
+
+  EXPECT_TRUE(exhaustive_matches.size() > 1000);
+  EXPECT_TRUE(exhaustive_matches == grid_matches);
+}
+
+TEST(GuidedMatching_Grid, Fundamental)
+{
+  // Two views of a plane: the homography is compatible with the fundamental
+  //  matrix F = [e]x H (the epipolar lines cover both orientations)
+  Mat3 H;
+  H << 0.9, -0.1, 30.,
+       0.08, 1.05, -10.,
+       -2e-5, 1e-5, 1.;
+  for (const Vec3 & epipole : {Vec3(-2000., 300., 1.), Vec3(320., 5000., 1.), Vec3(700., -400., 1.)})
+  {
+    const Mat3 F = CrossProductMatrix(epipole) * H;
+
+    SIFT_Regions lRegions, rRegions;
+    MakeRegions(H.inverse(), lRegions, rRegions);
+
+    const double errorTh = Square(2.), distRatio = Square(0.8);
+    matching::IndMatches exhaustive_matches, grid_matches;
+    GuidedMatching<Mat3, fundamental::kernel::EpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, exhaustive_matches);
+    GuidedMatching_Fundamental_Grid<fundamental::kernel::EpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, grid_matches);
+
+    EXPECT_TRUE(exhaustive_matches.size() > 1000);
+    EXPECT_TRUE(exhaustive_matches == grid_matches);
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -10,6 +10,7 @@
 #define OPENMVG_ROBUST_ESTIMATION_RAND_SAMPLING_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <random>
 #include <type_traits>
@@ -99,6 +100,89 @@ bool UniformSample
   return true;
 }
 
+/**
+* PROSAC progressive sampling.
+* "Matching with PROSAC - Progressive Sample Consensus"
+*  Ondrej Chum, Jiri Matas. CVPR 2005.
+*
+* The data are ranked by decreasing quality (rank 0 is the best datum).
+* The samples are drawn from the n best ranked data, n growing with the number
+* of drawn samples: the sampling is the same as the uniform sampling once
+* growth_max_samples samples have been drawn.
+* A sample made of the n best ranked data always contains the n-th datum.
+*/
+class Prosac_Sampler
+{
+public:
+  /**
+  * \param[in] num_samples The sample size.
+  * \param[in] total_samples The number of ranked data.
+  * \param[in] growth_max_samples The number of samples (T_N) after which the
+  *  sampling is uniform over all the data.
+  */
+  Prosac_Sampler
+  (
+    const uint32_t num_samples,
+    const uint32_t total_samples,
+    const uint32_t growth_max_samples = 200000
+  ):
+    num_samples_(num_samples),
+    total_samples_(total_samples),
+    n_(num_samples),
+    t_(0),
+    Tn_prime_(1)
+  {
+    // Average number of samples made of the num_samples best data: T_N * C(m,m)/C(N,m)
+    Tn_ = growth_max_samples;
+    for (uint32_t i = 0; i < num_samples; ++i)
+      Tn_ *= static_cast<double>(n_ - i) / (total_samples - i);
+  }
+
+  /**
+  * Draw the next sample.
+  * \param[in] random_generator The random number generator.
+  * \param[out] samples The ranks of the sampled data.
+  */
+  template <class RandomGeneratorT>
+  void Sample
+  (
+    RandomGeneratorT & random_generator,
+    std::vector<uint32_t> * samples
+  )
+  {
+    ++t_;
+    // Grow the sampling set
+    if (t_ == Tn_prime_ && n_ < total_samples_)
+    {
+      const double Tn_plus_1 = Tn_ * (n_ + 1) / (n_ + 1 - num_samples_);
+      Tn_prime_ += static_cast<uint32_t>(std::ceil(Tn_plus_1 - Tn_));
+      Tn_ = Tn_plus_1;
+      ++n_;
+    }
+    if (Tn_prime_ < t_)
+    {
+      // Uniform sample among the n best data
+      UniformSample(num_samples_, n_, random_generator, samples);
+    }
+    else
+    {
+      // The n-th datum and a uniform sample among the n-1 best data
+      UniformSample(num_samples_ - 1, n_ - 1, random_generator, samples);
+      samples->push_back(n_ - 1);
+    }
+  }
+
+  /// Size of the current sampling set (the n best ranked data)
+  uint32_t SamplingSetSize() const { return n_; }
+
+private:
+  uint32_t num_samples_;   // m
+  uint32_t total_samples_; // N
+  uint32_t n_;             // Size of the sampling set
+  uint32_t t_;             // Number of drawn samples
+  uint32_t Tn_prime_;      // Number of samples after which n is increased
+  double Tn_;              // Average number of samples made of the n best data
+};
 
 } // namespace robust
 } // namespace openMVG
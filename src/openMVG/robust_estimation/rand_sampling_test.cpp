@@ -45,6 +45,27 @@ TEST(UniformSampleTestInAVectorOfUniqueElements, NoRepetions) {
   }
 }
 
+TEST(ProsacSampler, ProgressiveSamplingSet) {
+
+  const uint32_t num_samples = 4, total = 200;
+  Prosac_Sampler sampler(num_samples, total, 2000);
+  std::vector<uint32_t> samples;
+  uint32_t previous_set_size = num_samples;
+  for (int i = 0; i < 5000; ++i) {
+    sampler.Sample(random_generator, &samples);
+    // Unique samples among the n best ranked data
+    const std::set<uint32_t> myset(samples.begin(), samples.end());
+    CHECK_EQUAL(num_samples, myset.size());
+    const uint32_t set_size = sampler.SamplingSetSize();
+    EXPECT_TRUE(*myset.rbegin() < set_size);
+    // The sampling set is growing
+    EXPECT_TRUE(previous_set_size <= set_size);
+    previous_set_size = set_size;
+  }
+  // The sampling set contains all the data after the growth
+  CHECK_EQUAL(total, previous_set_size);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
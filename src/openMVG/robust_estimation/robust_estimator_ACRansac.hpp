@@ -35,6 +35,15 @@
 //  Adaptive Structure from Motion with a contrario mode estimation.
 //  In 11th Asian Conference on Computer Vision (ACCV 2012)
 //--
+//  Optional hypothesis scheduling:
+//  [4] Ondrej Chum, Jiri Matas.
+//  Matching with PROSAC - Progressive Sample Consensus.
+//  CVPR 2005.
+//--
+//  [5] Ondrej Chum, Jiri Matas.
+//  Optimal Randomized RANSAC.
+//  PAMI 2008.
+//--
 
 #include <algorithm>
 #include <cmath>
@@ -47,8 +56,14 @@
 #include <vector>
 
 #include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_fit_batch.hpp"
+#include "openMVG/robust_estimation/robust_ransac_tools.hpp"
 #include "third_party/histogram/histogram.hpp"
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace openMVG {
 namespace robust{
 
@@ -132,6 +147,11 @@ public:
     const bool bquantified_nfa_evaluation = false
   ):
     m_residuals(kernel.NumSamples()),
+    m_best_residuals(kernel.NumSamples()),
+    m_best_inlier_count(0),
+    m_best_threshold(0.0),
+    m_bound_nfa(std::numeric_limits<double>::quiet_NaN()),
+    m_bins_by_interval(0.0),
     m_kernel(kernel),
     m_bquantified_nfa_evaluation(bquantified_nfa_evaluation),
     m_max_threshold(dmaxThreshold)
@@ -139,11 +159,33 @@ public:
     // Precompute log combi
     m_loge0 = log10((double)Kernel::MAX_MODELS * (kernel.NumSamples() - Kernel::MINIMUM_SAMPLES));
     makelogcombi(Kernel::MINIMUM_SAMPLES, kernel.NumSamples(), m_logc_k, m_logc_n);
+
+    if (m_bquantified_nfa_evaluation)
+    {
+      // Quantification of the residuals in [0, m_max_threshold]
+      const Histogram<double> histo(0.0f, m_max_threshold, nBins);
+      m_bin_values = histo.GetXbinsValue();
+      m_bins_by_interval = nBins / m_max_threshold;
+      m_bin_counts.resize(nBins);
+    }
+    else
+    {
+      // Groups of consecutive inlier counts k in [MINIMUM_SAMPLES+1, n]
+      //  (of increasing size) used to bound the NFA
+      const uint32_t n = kernel.NumSamples();
+      for (uint32_t k = Kernel::MINIMUM_SAMPLES + 1; k <= n; k += std::max(1u, k / 8))
+        m_bound_first_k.push_back(k);
+      m_bound_first_k.push_back(n + 1);
+    }
   };
 
   std::vector<double> & residuals()
   { return m_residuals;}
 
+  /// residual array of the best model found so far
+  const std::vector<double> & best_residuals() const
+  { return m_best_residuals;}
+
   /**
    * @brief Evaluation of the NFA (Number of False Alarm)
    *  for the given residual distribution.
@@ -151,27 +193,88 @@ public:
    * 1. If an upper bound of the threshold is provided:
    *  - The NFA is estimated by using quantified residual values.
    * 2. No upper bound => m_max_threshold == infinity:
-   *  - The NFA is estimated by using all the residual errors.
+   *  - The NFA is estimated by using the smallest residual errors
+   *    (the residuals that cannot lead to a better NFA are not sorted).
+   *
+   * If a better NFA is found the residuals are kept as the best model ones
+   *  (the inlier indices can be retrieved with Inliers()).
    *
-   * @param[out] inliers inlier indices list (updated if a better NFA is found)
    * @param[in, out] nfa_threshold Found NFA and corresponding error Threshold
    *  (updated if the current estimated NFA is lower than the existing one)
    *  For the first run it can be set to {std::numeric_limits<double>::infinity(), 0.0}
    *
    * @return true if a better NFA is found.
    */
+  bool ComputeNFA
+  (
+    std::pair<double,double> & nfa_threshold
+  );
+
+  /**
+   * @brief Inlier indices of the best model found so far
+   * @param[out] inliers inlier indices list
+   */
+  void Inliers
+  (
+    std::vector<uint32_t> & inliers
+  ) const;
+
+  /**
+   * @brief Evaluation of the NFA (see ComputeNFA)
+   * @param[out] inliers inlier indices list (updated if a better NFA is found)
+   * @param[in, out] nfa_threshold Found NFA and corresponding error Threshold
+   *
+   * @return true if a better NFA is found.
+   */
   bool ComputeNFA_and_inliers
   (
     std::vector<uint32_t> & inliers,
     std::pair<double,double> & nfa_threshold
-  );
+  )
+  {
+    if (!ComputeNFA(nfa_threshold))
+      return false;
+    Inliers(inliers);
+    return true;
+  }
 
 private:
 
+  /// Compute the residual upper bounds under which a datum can be part of
+  ///  a NFA lower than nfa (for each group of inlier counts)
+  void Update_Residual_Bounds(const double nfa);
+
+  /// logalpha value of a residual error
+  double logalpha(const double residual) const
+  {
+    return m_kernel.logalpha0() + m_kernel.multError() *
+      log10(residual + std::numeric_limits<float>::epsilon());
+  }
+
   /// residual array
   std::vector<double> m_residuals;
+  /// residual array of the best model
+  std::vector<double> m_best_residuals;
+  /// inlier count and residual threshold of the best model
+  uint32_t m_best_inlier_count;
+  double m_best_threshold;
+
   /// [residual,index] array -> used in the exhaustive nfa computation mode
   std::vector<std::pair<double,uint32_t>> m_sorted_residuals;
+  /// First inlier count k of the NFA bound groups (exhaustive mode)
+  std::vector<uint32_t> m_bound_first_k;
+  /// Residual upper bounds of the groups (sorted) & matching first k
+  std::vector<std::pair<double,uint32_t>> m_residual_bounds;
+  /// Residual count under each upper bound
+  std::vector<uint32_t> m_bound_counts;
+  /// NFA used to compute the residual upper bounds
+  double m_bound_nfa;
+
+  /// Quantified mode histogram: bin values, residual to bin scale & counts
+  static const int nBins = 20;
+  std::vector<double> m_bin_values;
+  double m_bins_by_interval;
+  std::vector<uint32_t> m_bin_counts;
 
   /// Combinatorial log
   std::vector<float> m_logc_n, m_logc_k;
@@ -186,11 +289,38 @@ private:
   const double m_max_threshold;
 };
 
+template <typename Kernel>
+void
+NFA_Interface<Kernel>::Update_Residual_Bounds
+(
+  const double nfa
+)
+{
+  // NFA(k) < nfa <=> logalpha(r_k) < (nfa - loge0 - logc_n[k] - logc_k[k]) / (k - MINIMUM_SAMPLES)
+  // The largest logalpha bound of the group gives the residual upper bound
+  //  (enlarged to be robust to the rounding errors).
+  m_residual_bounds.clear();
+  for (size_t group = 0; group + 1 < m_bound_first_k.size(); ++group)
+  {
+    double max_logalpha = -std::numeric_limits<double>::infinity();
+    for (uint32_t k = m_bound_first_k[group]; k < m_bound_first_k[group + 1]; ++k)
+    {
+      max_logalpha = std::max(max_logalpha,
+        (nfa - m_loge0 - m_logc_n[k] - m_logc_k[k]) / (double)(k - Kernel::MINIMUM_SAMPLES));
+    }
+    const double residual_bound = std::pow(10.0,
+      (max_logalpha - m_kernel.logalpha0()) / m_kernel.multError()) * (1.0 + 1e-6);
+    m_residual_bounds.emplace_back(residual_bound, m_bound_first_k[group]);
+  }
+  std::sort(m_residual_bounds.begin(), m_residual_bounds.end());
+  m_bound_counts.resize(m_residual_bounds.size() + 1);
+  m_bound_nfa = nfa;
+}
+
 template <typename Kernel>
 bool
-NFA_Interface<Kernel>::ComputeNFA_and_inliers
+NFA_Interface<Kernel>::ComputeNFA
 (
-    std::vector<uint32_t> & inliers,
     /// NFA and residual threshold
     std::pair<double,double> & nfa_threshold
 )
@@ -201,6 +331,7 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
   //    (valuable is an upper bound of the maximal tolerated residual is provided)
   // - An exhaustive computation that evaluate all the possible NFA values
   //    i.e. (for every k from the n value of the datum).
+  const uint32_t n = m_kernel.NumSamples();
   if (m_bquantified_nfa_evaluation)
   {
     // Find the best NFA (Number of False Alarm) score
@@ -208,77 +339,113 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
     // This version avoid:
     //   - to sort explicitly the residual error array,
     //   - to compute the NFA for every sample of the datum.
-    const int nBins = 20;
-    Histogram<double> histo(0.0f, m_max_threshold, nBins);
-    histo.Add(m_residuals.cbegin(), m_residuals.cend());
+    // The out of range residuals are not counted.
+    std::fill(m_bin_counts.begin(), m_bin_counts.end(), 0);
+    for (const double residual : m_residuals)
+    {
+      const double bin = residual * m_bins_by_interval;
+      if (residual >= 0.0 && bin < nBins)
+        ++m_bin_counts[static_cast<int>(bin)];
+    }
 
     // Compute NFA scoring from the cumulative histogram
 
     using nfa_thresholdT = std::pair<double,double>; // NFA and residual threshold
     nfa_thresholdT current_best_nfa(std::numeric_limits<double>::infinity(), 0.0);
     unsigned int cumulative_count = 0;
-    const std::vector<size_t> & frequencies = histo.GetHist();
-    const std::vector<double> residual_val = histo.GetXbinsValue();
     for (int bin = 0; bin < nBins; ++bin)
     {
-      cumulative_count += frequencies[bin];
+      cumulative_count += m_bin_counts[bin];
       if (cumulative_count > Kernel::MINIMUM_SAMPLES
-          && residual_val[bin] > std::numeric_limits<float>::epsilon())
+          && m_bin_values[bin] > std::numeric_limits<float>::epsilon())
       {
-        const double logalpha = m_kernel.logalpha0()
-          + m_kernel.multError() * log10(residual_val[bin]
-          + std::numeric_limits<float>::epsilon());
         const nfa_thresholdT current_nfa( m_loge0
-          + logalpha * (double)(cumulative_count - Kernel::MINIMUM_SAMPLES)
+          + logalpha(m_bin_values[bin]) * (double)(cumulative_count - Kernel::MINIMUM_SAMPLES)
           + m_logc_n[cumulative_count]
-          + m_logc_k[cumulative_count], residual_val[bin]);
+          + m_logc_k[cumulative_count], m_bin_values[bin]);
         // Keep the best NFA iff it is meaningful ( NFA < 0 ) and better than the existing one
         if (current_nfa.first < current_best_nfa.first && current_nfa.first < 0)
           current_best_nfa = current_nfa;
       }
     }
     // If the current NFA is better than the previous
-    // - update the sample inlier index list.
+    // - keep the residuals if the model has enough inliers.
     if (current_best_nfa.first < nfa_threshold.first)
     {
-      nfa_threshold.first = current_best_nfa.first; // NFA score
-      nfa_threshold.second = current_best_nfa.second; // Corresponding threshold
-
-      inliers.clear();
-      for (uint32_t index = 0; index < m_kernel.NumSamples(); ++index)
+      const uint32_t inlier_count = std::count_if(m_residuals.cbegin(), m_residuals.cend(),
+        [&current_best_nfa](double residual) { return residual <= current_best_nfa.second; });
+      if (inlier_count > Kernel::MINIMUM_SAMPLES)
       {
-        if (m_residuals[index] <= nfa_threshold.second)
-          inliers.push_back(index);
+        nfa_threshold = current_best_nfa; // NFA score & corresponding threshold
+        m_best_inlier_count = inlier_count;
+        m_best_threshold = current_best_nfa.second;
+        std::swap(m_residuals, m_best_residuals);
+        return true;
       }
-      return inliers.size() > Kernel::MINIMUM_SAMPLES;
     }
   }
   else // exhaustive computation
   {
-    // Residuals sorting (ascending order while keeping original point indexes)
+    // Partial selection:
+    // A datum can be the k-th inlier of a better NFA only if its residual
+    //  is under the bound of the group of k. The counts of residuals under
+    //  the bounds give the largest k that can lead to a better NFA.
+    // Only the residuals that can be part of a better NFA are sorted.
+    uint32_t max_k = n;
+    double max_residual = std::numeric_limits<double>::infinity();
+    if (nfa_threshold.first < std::numeric_limits<double>::infinity())
+    {
+      if (nfa_threshold.first != m_bound_nfa)
+        Update_Residual_Bounds(nfa_threshold.first);
+
+      std::fill(m_bound_counts.begin(), m_bound_counts.end(), 0);
+      for (const double residual : m_residuals)
+      {
+        ++m_bound_counts[std::distance(m_residual_bounds.cbegin(),
+          std::upper_bound(m_residual_bounds.cbegin(), m_residual_bounds.cend(),
+            std::make_pair(residual, std::numeric_limits<uint32_t>::max())))];
+      }
+      max_k = 0;
+      uint32_t count = 0;
+      for (size_t i = 0; i < m_residual_bounds.size(); ++i)
+      {
+        // #residuals < bound i
+        count += m_bound_counts[i];
+        if (count >= m_residual_bounds[i].second && count > max_k)
+        {
+          max_k = count;
+          max_residual = m_residual_bounds[i].first;
+        }
+      }
+      if (max_k <= Kernel::MINIMUM_SAMPLES)
+        return false;
+    }
+
+    // Residuals selection & sorting (ascending order while keeping original point indexes)
     {
       m_sorted_residuals.clear();
-      m_sorted_residuals.reserve(m_kernel.NumSamples());
-      for (uint32_t i = 0; i < m_kernel.NumSamples(); ++i)
+      for (uint32_t i = 0; i < n; ++i)
       {
-        m_sorted_residuals.emplace_back(m_residuals[i], i);
+        if (m_residuals[i] < max_residual)
+          m_sorted_residuals.emplace_back(m_residuals[i], i);
       }
-      std::sort(m_sorted_residuals.begin(), m_sorted_residuals.end());
+      if (max_k < m_sorted_residuals.size())
+        std::nth_element(m_sorted_residuals.begin(),
+          m_sorted_residuals.begin() + max_k, m_sorted_residuals.end());
+      else
+        max_k = m_sorted_residuals.size();
+      std::sort(m_sorted_residuals.begin(), m_sorted_residuals.begin() + max_k);
     }
 
     // Find best NFA and its index wrt square error threshold in m_sorted_residuals.
     using nfa_indexT = std::pair<double, uint32_t>;
     nfa_indexT current_best_nfa(std::numeric_limits<double>::infinity(), Kernel::MINIMUM_SAMPLES);
-    const size_t n = m_kernel.NumSamples();
     for (size_t k = Kernel::MINIMUM_SAMPLES + 1;
-        k <= n && m_sorted_residuals[k-1].first <= m_max_threshold;
-        ++k) // Compute the NFA for all k in [minimal_sample+1,n]
+        k <= max_k && m_sorted_residuals[k-1].first <= m_max_threshold;
+        ++k) // Compute the NFA for all k in [minimal_sample+1,max_k]
     {
-      const double logalpha = m_kernel.logalpha0()
-        + m_kernel.multError() * log10(m_sorted_residuals[k-1].first
-        + std::numeric_limits<float>::epsilon());
       const nfa_indexT current_nfa( m_loge0
-        + logalpha * (double)(k - Kernel::MINIMUM_SAMPLES)
+        + logalpha(m_sorted_residuals[k-1].first) * (double)(k - Kernel::MINIMUM_SAMPLES)
         + m_logc_n[k]
         + m_logc_k[k], k);
 
@@ -287,24 +454,85 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
     }
 
     // If the current NFA is better than the previous
-    // - update the sample inlier index list.
+    // - keep the residuals.
     if (current_best_nfa.first < nfa_threshold.first)
     {
       nfa_threshold.first = current_best_nfa.first;
       nfa_threshold.second = m_sorted_residuals[current_best_nfa.second-1].first;
-
-      inliers.resize(current_best_nfa.second);
-      for (size_t i =0; i < current_best_nfa.second; ++i)
-      {
-        inliers[i] = m_sorted_residuals[i].second;
-      }
+      m_best_inlier_count = current_best_nfa.second;
+      m_best_threshold = nfa_threshold.second;
+      std::swap(m_residuals, m_best_residuals);
       return true;
     }
   }
   return false;
 }
+
+template <typename Kernel>
+const int NFA_Interface<Kernel>::nBins;
+
+template <typename Kernel>
+void
+NFA_Interface<Kernel>::Inliers
+(
+  std::vector<uint32_t> & inliers
+) const
+{
+  inliers.clear();
+  if (m_best_inlier_count == 0)
+    return;
+  if (m_bquantified_nfa_evaluation)
+  {
+    inliers.reserve(m_best_inlier_count);
+    for (uint32_t index = 0; index < m_kernel.NumSamples(); ++index)
+    {
+      if (m_best_residuals[index] <= m_best_threshold)
+        inliers.push_back(index);
+    }
+  }
+  else
+  {
+    // The inliers are the m_best_inlier_count smallest residuals
+    //  (in ascending order)
+    std::vector<std::pair<double,uint32_t>> sorted_inliers;
+    sorted_inliers.reserve(m_best_inlier_count);
+    for (uint32_t index = 0; index < m_kernel.NumSamples(); ++index)
+    {
+      if (m_best_residuals[index] <= m_best_threshold)
+        sorted_inliers.emplace_back(m_best_residuals[index], index);
+    }
+    std::sort(sorted_inliers.begin(), sorted_inliers.end());
+    sorted_inliers.resize(m_best_inlier_count);
+    inliers.resize(m_best_inlier_count);
+    for (size_t i = 0; i < sorted_inliers.size(); ++i)
+      inliers[i] = sorted_inliers[i].second;
+  }
+}
 }  // namespace acransac_nfa_internal
 
+/// Hypothesis scheduling of ACRANSAC.
+/// The default scheduling draws uniform random samples and scores every
+///  hypothesis on all the data.
+struct ACRANSAC_Scheduling
+{
+  /// Data indexes sorted by decreasing quality (i.e. by increasing descriptor
+  ///  distance for putative matches).
+  /// If not empty, the samples are drawn progressively from the best ranked
+  ///  data (PROSAC [4]) until a meaningful model is found.
+  std::vector<uint32_t> quality_order;
+
+  /// If true, the hypotheses are verified on a growing random subset of the
+  ///  data and rejected early by a SPRT [5] before the NFA scoring.
+  /// A datum is consistent with a hypothesis if its residual is under the
+  ///  precision upper bound (or, without upper bound, under the residual for
+  ///  which the probability of a random consistent datum is sprt_delta).
+  bool b_sprt = false;
+
+  /// Initial probability that a datum is consistent with a bad model
+  ///  (used if no precision upper bound is provided).
+  double sprt_delta = 0.01;
+};
+
 /**
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
  * If an upper bound of the threshold is provided:
@@ -314,6 +542,7 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
  *
  * @param[in] kernel model and metric object
  * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] scheduling sampling and hypothesis verification policy
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
@@ -326,6 +555,7 @@ std::pair<double, double> ACRANSAC
 (
   const Kernel &kernel,
   std::vector<uint32_t> & vec_inliers,
+  const ACRANSAC_Scheduling & scheduling,
   const unsigned int num_max_iteration = 1024,
   typename Kernel::Model * model = nullptr,
   double precision = std::numeric_limits<double>::infinity(),
@@ -377,26 +607,152 @@ std::pair<double, double> ACRANSAC
   // Random number generation
   std::mt19937 random_generator(std::mt19937::default_seed);
 
+  //--
+  // Progressive sampling (PROSAC):
+  //  used while the sampling indices are all the data
+  const bool b_prosac = (scheduling.quality_order.size() == nData);
+  bool b_sampling_all_data = true;
+  Prosac_Sampler prosac_sampler(sizeSample, nData);
+
+  //--
+  // Early rejection (SPRT):
+  //  the data are verified in a fixed random order
+  std::vector<uint32_t> sprt_order;
+  double sprt_threshold = maxThreshold;
+  double sprt_delta = scheduling.sprt_delta;
+  if (scheduling.b_sprt)
+  {
+    sprt_order.resize(nData);
+    std::iota(sprt_order.begin(), sprt_order.end(), 0);
+    std::mt19937 order_generator(std::mt19937::default_seed);
+    std::shuffle(sprt_order.begin(), sprt_order.end(), order_generator);
+    // The probability that a datum is under the residual e for a random model
+    //  is alpha(e): log10(alpha(e)) = logalpha0 + multError * log10(e)
+    if (maxThreshold == std::numeric_limits<double>::infinity())
+      sprt_threshold = std::pow(10.0,
+        (log10(sprt_delta) - kernel.logalpha0()) / kernel.multError());
+    else
+      sprt_delta = std::pow(10.0,
+        kernel.logalpha0() + kernel.multError() * log10(maxThreshold));
+  }
+  SPRT_Test sprt(0.1, sprt_delta);
+  // Delta estimation from the rejected hypotheses
+  size_t sprt_rejected_tested = 0, sprt_rejected_consistent = 0;
+
+  //--
+  // Batch fitting (see FitBatch):
+  //  the uniform samples drawn on all the data do not depend on the previous
+  //  hypotheses, so they are drawn and fitted by batches. If the sampling
+  //  changes before the end of a batch, the random generator is rewound to
+  //  the current sample (the result is the same as fitting one by one).
+  //  A batch gives a few samples to each thread (none if already run in parallel).
+  uint32_t batch_size = 1;
+#ifdef OPENMVG_USE_OPENMP
+  if (!omp_in_parallel())
+    batch_size = 4 * omp_get_max_threads();
+#endif
+  std::vector<uint32_t> batch_samples;
+  Batch_Models<typename Kernel::Model> batch;
+  uint32_t batch_position = 0; // Next sample of the batch
+  bool batch_acransac_mode = bACRansacMode; // Sampling mode of the batch
+  std::mt19937 batch_start_generator; // Generator state at the batch start
+  std::vector<uint32_t> batch_start_index; // Sampling indices at the batch start
+  const auto draw_sample = [&](const bool b_acransac_mode,
+    std::mt19937 & generator, std::vector<uint32_t> & index,
+    std::vector<uint32_t> & sample)
+  {
+    if (b_acransac_mode)
+      UniformSample(sizeSample, generator, &index, &sample);
+    else
+      UniformSample(sizeSample, nData, generator, &sample);
+  };
+
   //--
   // Main estimation loop.
+  std::vector<typename Kernel::Model> vec_models;
   for (unsigned int iter = 0; iter < nIter && iter < num_max_iteration; ++iter)
   {
-    // Get random samples
-    if (bACRansacMode)
-      UniformSample(sizeSample, random_generator, &vec_index, &vec_sample);
+    // Get random samples & fit model(s). Can find up to Kernel::MAX_MODELS solution(s)
+    const bool b_batch = batch_size > 1 && b_sampling_all_data && !b_prosac;
+    if (b_batch)
+    {
+      if (batch_position == batch.SampleCount())
+      {
+        batch_acransac_mode = bACRansacMode;
+        batch_start_generator = random_generator;
+        if (batch_acransac_mode)
+          batch_start_index = vec_index;
+        const uint32_t sample_count = std::min(batch_size,
+          std::min(nIter, num_max_iteration) - iter);
+        batch_samples.clear();
+        for (uint32_t k = 0; k < sample_count; ++k)
+        {
+          draw_sample(batch_acransac_mode, random_generator, vec_index, vec_sample);
+          batch_samples.insert(batch_samples.end(), vec_sample.cbegin(), vec_sample.cend());
+        }
+        FitBatch(kernel, batch_samples, batch);
+        batch_position = 0;
+      }
+      vec_sample.assign(batch_samples.cbegin() + batch_position * sizeSample,
+                        batch_samples.cbegin() + (batch_position + 1) * sizeSample);
+      vec_models.assign(batch.models.cbegin() + batch.offsets[batch_position],
+                        batch.models.cbegin() + batch.offsets[batch_position + 1]);
+      ++batch_position;
+    }
     else
-      UniformSample(sizeSample, nData, random_generator, &vec_sample);
+    {
+      if (b_prosac && b_sampling_all_data)
+      {
+        prosac_sampler.Sample(random_generator, &vec_sample);
+        for (uint32_t & sample : vec_sample)
+          sample = scheduling.quality_order[sample];
+      }
+      else
+        draw_sample(bACRansacMode, random_generator, vec_index, vec_sample);
 
-    // Fit model(s). Can find up to Kernel::MAX_MODELS solution(s)
-    std::vector<typename Kernel::Model> vec_models;
-    kernel.Fit(vec_sample, &vec_models);
+      vec_models.clear();
+      kernel.Fit(vec_sample, &vec_models);
+    }
 
     // Evaluate model(s)
     bool better = false;
     for (const auto& model_it : vec_models)
     {
       // Compute residual values
-      kernel.Errors(model_it, nfa_interface.residuals());
+      if (scheduling.b_sprt)
+      {
+        // Verify the data one by one until the hypothesis is rejected
+        std::vector<double> & residuals = nfa_interface.residuals();
+        sprt.Reset();
+        size_t tested = 0, consistent = 0;
+        bool b_rejected = false;
+        for (const uint32_t index : sprt_order)
+        {
+          residuals[index] = kernel.Error(index, model_it);
+          ++tested;
+          const bool b_consistent = residuals[index] <= sprt_threshold;
+          consistent += b_consistent;
+          if (!sprt.Verify(b_consistent))
+          {
+            b_rejected = true;
+            break;
+          }
+        }
+        if (b_rejected)
+        {
+          // Update delta from the average consistency of the rejected hypotheses
+          sprt_rejected_tested += tested;
+          sprt_rejected_consistent += consistent;
+          const double delta_estimate =
+            sprt_rejected_consistent / static_cast<double>(sprt_rejected_tested);
+          if (sprt_rejected_tested > 100 &&
+              std::abs(delta_estimate - sprt.Delta()) > 0.05 * sprt.Delta())
+            sprt.Set_Parameters(sprt.Epsilon(), delta_estimate);
+          continue;
+        }
+      }
+      else
+        kernel.Errors(model_it, nfa_interface.residuals());
 
       if (!bACRansacMode)
       {
@@ -413,10 +769,11 @@ std::pair<double, double> ACRANSAC
 
       if (bACRansacMode)
       {
-        // NFA evaluation; If better than the previous: update scoring & inliers indices
+        // NFA evaluation; If better than the previous: update scoring
+        //  (the inliers indices are retrieved only when needed)
         std::pair<double, double> nfa_threshold(minNFA, 0.0);
         const bool b_better_model_found =
-          nfa_interface.ComputeNFA_and_inliers(vec_inliers, nfa_threshold);
+          nfa_interface.ComputeNFA(nfa_threshold);
 
         if (b_better_model_found)
         {
@@ -425,8 +782,21 @@ std::pair<double, double> ACRANSAC
           errorMax = nfa_threshold.second;
           if (model) *model = model_it;
 
+          if (scheduling.b_sprt)
+          {
+            // Update epsilon from the support of the best model
+            const std::vector<double> & residuals = nfa_interface.best_residuals();
+            const double epsilon_estimate =
+              std::count_if(residuals.cbegin(), residuals.cend(),
+                [sprt_threshold](double residual) { return residual <= sprt_threshold; })
+              / static_cast<double>(nData);
+            if (epsilon_estimate > sprt.Epsilon())
+              sprt.Set_Parameters(epsilon_estimate, sprt.Delta());
+          }
+
           if (bVerbose)
           {
+            nfa_interface.Inliers(vec_inliers);
             std::cout << "  nfa=" << minNFA
               << " inliers=" << vec_inliers.size() << "/" << nData
               << " precisionNormalized=" << errorMax
@@ -443,7 +813,7 @@ std::pair<double, double> ACRANSAC
 
     // Early exit test -> no meaningful model found so far
     //  see explanation above
-    if (!bACRansacMode && iter > nIterReserve*2)
+    if (!bACRansacMode && static_cast<int>(iter) > nIterReserve*2)
     {
       nIter = 0; // No more round will be performed
       continue;
@@ -452,7 +822,7 @@ std::pair<double, double> ACRANSAC
     // ACRANSAC optimization: draw samples among best set of inliers so far
     if (bACRansacMode && ((better && minNFA < 0) || ((iter + 1) == nIter && nIterReserve > 0)))
     {
-      if (vec_inliers.empty())
+      if (minNFA == std::numeric_limits<double>::infinity())
       {
         // No model found at all so far
         ++nIter; // Continue to look for any model, even not meaningful
@@ -461,7 +831,9 @@ std::pair<double, double> ACRANSAC
       else
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
+        nfa_interface.Inliers(vec_inliers);
         vec_index = vec_inliers;
+        b_sampling_all_data = false;
         if (nIterReserve) {
             // reduce the number of iteration
             // next iterations will be dedicated to local optimization
@@ -470,10 +842,24 @@ std::pair<double, double> ACRANSAC
         }
       }
     }
+
+    // The sampling changed: drop the rest of the batch and
+    //  rewind the random generator to the next sample
+    if (b_batch && batch_position < batch.SampleCount()
+        && (!b_sampling_all_data || bACRansacMode != batch_acransac_mode))
+    {
+      random_generator = batch_start_generator;
+      for (uint32_t k = 0; k < batch_position; ++k)
+        draw_sample(batch_acransac_mode, random_generator, batch_start_index, vec_sample);
+      batch.offsets.clear();
+      batch_position = 0;
+    }
   }
 
   if (minNFA >= 0) // no meaningful model found so far
     vec_inliers.clear();
+  else
+    nfa_interface.Inliers(vec_inliers);
 
   if (!vec_inliers.empty())
   {
@@ -486,6 +872,34 @@ std::pair<double, double> ACRANSAC
   return {errorMax, minNFA};
 }
 
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA) with the default scheduling:
+ *  uniform sampling, every hypothesis is scored on all the data.
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] bVerbose display console log
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC
+(
+  const Kernel &kernel,
+  std::vector<uint32_t> & vec_inliers,
+  const unsigned int num_max_iteration = 1024,
+  typename Kernel::Model * model = nullptr,
+  double precision = std::numeric_limits<double>::infinity(),
+  bool bVerbose = false
+)
+{
+  return ACRANSAC(kernel, vec_inliers, ACRANSAC_Scheduling(),
+    num_max_iteration, model, precision, bVerbose);
+}
+
 } // namespace robust
 } // namespace openMVG
 #endif // OPENMVG_ROBUST_ESTIMATOR_ACRANSAC_HPP
@@ -206,6 +206,165 @@ TEST(RansacLineFitter, RealisticCase) {
   EXPECT_NEAR(GTModel(1), line[1], 1e-9);
 }
 
+// Check that the PROSAC sampling and the SPRT early rejection find the same
+//  model as the default scheduling in a highly contaminated dataset.
+TEST(RansacLineFitter, ProsacSprtScheduling) {
+
+  constexpr int NbPoints = 400;
+  constexpr int NbInliers = 80;
+  const int W = 200, H = 200;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 0.5 x + 40
+  GTModel << 40.0, 0.5;
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> dW(0, W), dH(0, H), quality(0., 1.);
+  // Putative quality score (lower is better), inliers tend to be better ranked
+  std::vector<std::pair<double, uint32_t>> scores(NbPoints);
+  for (int i = 0; i < NbPoints; ++i) {
+    const double x = dW(random_generator);
+    if (i < NbInliers)
+      xy.col(i) << x, x * GTModel[1] + GTModel[0];
+    else
+      xy.col(i) << x, dH(random_generator);
+    scores[i] = {quality(random_generator) + ((i < NbInliers) ? 0. : 0.5), i};
+  }
+  std::sort(scores.begin(), scores.end());
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, W, H);
+
+  ACRANSAC_Scheduling scheduling;
+  scheduling.b_sprt = true;
+  for (const auto & score : scores)
+    scheduling.quality_order.push_back(score.second);
+
+  for (const double precision : {std::numeric_limits<double>::infinity(), 1.0})
+  {
+    std::vector<uint32_t> vec_inliers;
+    Vec2 line;
+    ACRANSAC(lineKernel, vec_inliers, scheduling, 1024, &line, precision);
+
+    EXPECT_NEAR(GTModel(0), line[0], 1e-6);
+    EXPECT_NEAR(GTModel(1), line[1], 1e-6);
+    // All the inliers are found (random points can lie on the line)
+    std::sort(vec_inliers.begin(), vec_inliers.end());
+    EXPECT_TRUE(vec_inliers.size() >= NbInliers);
+    for (uint32_t i = 0; i < NbInliers; ++i)
+      EXPECT_EQ(i, vec_inliers[i]);
+  }
+}
+
+// Check that the batch fitting of the uniform samples gives the result of the
+//  sample by sample fitting (used when ACRANSAC is run in a parallel region).
+TEST(RansacLineFitter, BatchFitting) {
+
+  constexpr int NbPoints = 400;
+  constexpr int NbInliers = 60;
+  const int W = 200, H = 200;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 0.5 x + 40
+  GTModel << 40.0, 0.5;
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> dW(0, W), dH(0, H), noise(-0.5, 0.5);
+  for (int i = 0; i < NbPoints; ++i) {
+    const double x = dW(random_generator);
+    if (i < NbInliers)
+      xy.col(i) << x, x * GTModel[1] + GTModel[0] + noise(random_generator);
+    else
+      xy.col(i) << x, dH(random_generator);
+  }
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, W, H);
+
+  for (const double precision : {std::numeric_limits<double>::infinity(), 1.0, 4.0})
+  {
+    std::vector<uint32_t> vec_inliers, vec_inliers_serial;
+    Vec2 line, line_serial;
+    const std::pair<double, double> ret =
+      ACRANSAC(lineKernel, vec_inliers, ACRANSAC_Scheduling(), 256, &line, precision);
+    std::pair<double, double> ret_serial;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel num_threads(2)
+    #pragma omp single
+#endif
+    ret_serial = ACRANSAC(lineKernel, vec_inliers_serial, ACRANSAC_Scheduling(),
+      256, &line_serial, precision);
+
+    EXPECT_EQ(ret_serial.first, ret.first);
+    EXPECT_EQ(ret_serial.second, ret.second);
+    EXPECT_EQ(line_serial[0], line[0]);
+    EXPECT_EQ(line_serial[1], line[1]);
+    CHECK(vec_inliers_serial == vec_inliers);
+  }
+}
+
+// Check that the exhaustive NFA scoring (that sorts only the residuals that
+//  can lead to a better NFA) gives the NFA of the complete residual sorting.
+TEST(ACRansacNFA, ExhaustivePartialSelection) {
+
+  constexpr int NbPoints = 1000;
+  const Mat xy = Mat::Zero(2, NbPoints);
+  using KernelType = ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2>;
+  const KernelType lineKernel(xy, 200, 200);
+
+  acransac_nfa_internal::NFA_Interface<KernelType> nfa_interface(lineKernel);
+
+  // Reference: NFA for every k of the sorted residuals
+  std::vector<float> logc_n, logc_k;
+  acransac_nfa_internal::makelogcombi(KernelType::MINIMUM_SAMPLES, NbPoints, logc_k, logc_n);
+  const double loge0 =
+    log10((double)KernelType::MAX_MODELS * (NbPoints - KernelType::MINIMUM_SAMPLES));
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> inlier_count(0, NbPoints / 2);
+  std::uniform_real_distribution<double> inlier_residual(0., 1.), outlier_residual(0., 200.);
+
+  std::pair<double, double> nfa_threshold(std::numeric_limits<double>::infinity(), 0.0);
+  int better_count = 0;
+  for (int hypothesis = 0; hypothesis < 200; ++hypothesis)
+  {
+    std::vector<double> & residuals = nfa_interface.residuals();
+    const int nb_inliers = inlier_count(random_generator);
+    for (int i = 0; i < NbPoints; ++i)
+      residuals[i] = (i % 2 == 0 && i / 2 < nb_inliers) ?
+        inlier_residual(random_generator) : outlier_residual(random_generator);
+
+    std::vector<std::pair<double, uint32_t>> sorted_residuals;
+    for (uint32_t i = 0; i < NbPoints; ++i)
+      sorted_residuals.emplace_back(residuals[i], i);
+    std::sort(sorted_residuals.begin(), sorted_residuals.end());
+    std::pair<double, uint32_t> reference_nfa(std::numeric_limits<double>::infinity(), 0);
+    for (uint32_t k = KernelType::MINIMUM_SAMPLES + 1; k <= NbPoints; ++k)
+    {
+      const double logalpha = lineKernel.logalpha0() + lineKernel.multError() *
+        log10(sorted_residuals[k-1].first + std::numeric_limits<float>::epsilon());
+      const double nfa = loge0 + logalpha * (double)(k - KernelType::MINIMUM_SAMPLES)
+        + logc_n[k] + logc_k[k];
+      if (nfa < reference_nfa.first)
+        reference_nfa = {nfa, k};
+    }
+
+    const bool b_expected_better = reference_nfa.first < nfa_threshold.first;
+    EXPECT_EQ(b_expected_better, nfa_interface.ComputeNFA(nfa_threshold));
+    if (b_expected_better)
+    {
+      ++better_count;
+      EXPECT_EQ(reference_nfa.first, nfa_threshold.first);
+      EXPECT_EQ(sorted_residuals[reference_nfa.second - 1].first, nfa_threshold.second);
+
+      std::vector<uint32_t> inliers;
+      nfa_interface.Inliers(inliers);
+      CHECK_EQUAL(reference_nfa.second, inliers.size());
+      for (size_t i = 0; i < inliers.size(); ++i)
+        EXPECT_EQ(sorted_residuals[i].second, inliers[i]);
+    }
+  }
+  EXPECT_TRUE(better_count > 1);
+}
+
 // Generate nbPoints along a line and add gaussian noise.
 // Move some point in the dataset to create outlier contamined data
 void generateLine(Mat & points, size_t nbPoints, int W, int H, float noise, float outlierRatio)
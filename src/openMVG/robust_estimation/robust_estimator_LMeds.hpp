@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_fit_batch.hpp"
 #include "openMVG/robust_estimation/robust_ransac_tools.hpp"
 
 namespace openMVG {
@@ -55,17 +56,27 @@ template <typename Kernel>
   // Random number generation
   std::mt19937 random_generator(std::mt19937::default_seed);
 
-  for (uint32_t i=0; i < N; i++)
+  // The samples are drawn sequentially and fitted by batches
+  //  (the models are evaluated in the sample order)
+  const uint32_t batch_size = 64;
+  std::vector<uint32_t> batch_samples;
+  Batch_Models<typename Kernel::Model> batch;
+  for (uint32_t i=0; i < N; i += batch_size)
   {
     // Get Samples indexes
-    UniformSample(min_samples, random_generator, &all_samples, &vec_sample);
+    const uint32_t sample_count = std::min(batch_size, N - i);
+    batch_samples.clear();
+    for (uint32_t k = 0; k < sample_count; ++k)
+    {
+      UniformSample(min_samples, random_generator, &all_samples, &vec_sample);
+      batch_samples.insert(batch_samples.end(), vec_sample.cbegin(), vec_sample.cend());
+    }
 
     // Estimate parameters: the solutions are stored in a vector
-    std::vector<typename Kernel::Model> models;
-    kernel.Fit(vec_sample, &models);
+    FitBatch(kernel, batch_samples, batch);
 
     // Now test the solutions on the whole data
-    for (const auto& model_it : models)
+    for (const auto& model_it : batch.models)
     {
       //Compute Residuals :
       for (uint32_t l = 0; l < total_samples; ++l)
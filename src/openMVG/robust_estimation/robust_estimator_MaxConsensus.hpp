@@ -9,12 +9,14 @@
 #ifndef OPENMVG_ROBUST_ESTIMATION_MAX_CONSENSUS_HPP
 #define OPENMVG_ROBUST_ESTIMATION_MAX_CONSENSUS_HPP
 
+#include <algorithm>
 #include <numeric>
 #include <limits>
 #include <random>
 #include <vector>
 
 #include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_fit_batch.hpp"
 
 namespace openMVG {
 namespace robust{
@@ -65,26 +67,36 @@ typename Kernel::Model MaxConsensus
   // Random number generator configuration
   std::mt19937 random_generator(std::mt19937::default_seed);
 
-  std::vector<uint32_t> sample;
-  for (uint32_t iteration = 0;  iteration < max_iteration; ++iteration) {
-    UniformSample(min_samples, random_generator, &all_samples, &sample);
-
-      std::vector<typename Kernel::Model> models;
-      kernel.Fit(sample, &models);
-
-      // Compute costs for each fit.
-      for (const auto& model_it : models) {
-        std::vector<uint32_t> inliers;
-        scorer.Score(kernel, model_it, all_samples, &inliers);
-
-        if (best_num_inliers < inliers.size()) {
-          best_num_inliers = inliers.size();
-          best_model = model_it;
-          if (best_inliers) {
-            best_inliers->swap(inliers);
-          }
+  // The samples are drawn sequentially and fitted by batches
+  //  (the models are evaluated in the sample order).
+  // The sampling shuffles its own index array, so the scorer always sees
+  //  the data points in the same order.
+  std::vector<uint32_t> sampling_index = all_samples;
+  const uint32_t batch_size = 64;
+  std::vector<uint32_t> sample, batch_samples;
+  Batch_Models<typename Kernel::Model> batch;
+  for (uint32_t iteration = 0;  iteration < max_iteration; iteration += batch_size) {
+    const uint32_t sample_count = std::min(batch_size, max_iteration - iteration);
+    batch_samples.clear();
+    for (uint32_t i = 0; i < sample_count; ++i) {
+      UniformSample(min_samples, random_generator, &sampling_index, &sample);
+      batch_samples.insert(batch_samples.end(), sample.cbegin(), sample.cend());
+    }
+    FitBatch(kernel, batch_samples, batch);
+
+    // Compute costs for each fit.
+    for (const auto& model_it : batch.models) {
+      std::vector<uint32_t> inliers;
+      scorer.Score(kernel, model_it, all_samples, &inliers);
+
+      if (best_num_inliers < inliers.size()) {
+        best_num_inliers = inliers.size();
+        best_model = model_it;
+        if (best_inliers) {
+          best_inliers->swap(inliers);
         }
       }
+    }
   }
   return best_model;
 }
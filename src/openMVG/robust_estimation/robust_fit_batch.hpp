@@ -0,0 +1,94 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_ROBUST_ESTIMATION_ROBUST_FIT_BATCH_HPP
+#define OPENMVG_ROBUST_ESTIMATION_ROBUST_FIT_BATCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace openMVG {
+namespace robust{
+
+/// Models fitted on a batch of minimal samples:
+///  the models of the i-th sample are models[offsets[i]] ... models[offsets[i+1]-1]
+template <typename ModelT>
+struct Batch_Models
+{
+  std::vector<ModelT> models;
+  std::vector<uint32_t> offsets;
+
+  // Models of each sample (kept to reuse their memory from batch to batch)
+  std::vector<std::vector<ModelT>> sample_models;
+
+  size_t SampleCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+/**
+* @brief Fit the models of a batch of minimal samples.
+* The minimal problems are solved concurrently, the models are stored in the
+* sample order (the result is the same as fitting the samples one by one).
+*
+* Kernel requirements:
+*  - Kernel::MINIMUM_SAMPLES
+*  - Kernel::Fit(vector<uint32_t>, vector<Kernel::Model> *) const, thread safe
+*
+* @param kernel The kernel used to fit the models
+* @param samples The concatenated indexes of the samples
+*  (MINIMUM_SAMPLES indexes per sample)
+* @param[out] batch The models of the samples
+*/
+template <typename Kernel>
+void FitBatch
+(
+  const Kernel & kernel,
+  const std::vector<uint32_t> & samples,
+  Batch_Models<typename Kernel::Model> & batch
+)
+{
+  const int min_samples = Kernel::MINIMUM_SAMPLES;
+  const int sample_count = samples.size() / min_samples;
+
+  if (batch.sample_models.size() < static_cast<size_t>(sample_count))
+    batch.sample_models.resize(sample_count);
+
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<uint32_t> sample(min_samples);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < sample_count; ++i)
+    {
+      std::copy(samples.cbegin() + i * min_samples,
+                samples.cbegin() + (i + 1) * min_samples,
+                sample.begin());
+      batch.sample_models[i].clear();
+      kernel.Fit(sample, &batch.sample_models[i]);
+    }
+  }
+
+  // Concatenate the models in the sample order
+  batch.models.clear();
+  batch.offsets.resize(sample_count + 1);
+  batch.offsets[0] = 0;
+  for (int i = 0; i < sample_count; ++i)
+  {
+    batch.models.insert(batch.models.end(),
+      batch.sample_models[i].cbegin(), batch.sample_models[i].cend());
+    batch.offsets[i + 1] = batch.models.size();
+  }
+}
+
+} // namespace robust
+} // namespace openMVG
+
+#endif // OPENMVG_ROBUST_ESTIMATION_ROBUST_FIT_BATCH_HPP
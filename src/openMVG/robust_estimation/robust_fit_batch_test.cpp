@@ -0,0 +1,81 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/robust_estimation/rand_sampling.hpp"
+#include "openMVG/robust_estimation/robust_estimator_lineKernel_test.hpp"
+#include "openMVG/robust_estimation/robust_fit_batch.hpp"
+
+#include "testing/testing.h"
+
+#include <numeric>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::robust;
+
+// Kernel with a varying number of models per sample (0, 1 or 2)
+struct VaryingModelCountKernel {
+  using Model = uint32_t;
+  enum { MINIMUM_SAMPLES = 2 };
+
+  void Fit(const std::vector<uint32_t> &samples, std::vector<uint32_t> *models) const {
+    for (uint32_t i = 0; i < samples[0] % 3; ++i)
+      models->push_back(samples[0] * 100 + samples[1] * 10 + i);
+  }
+};
+
+// Return true if the batch fits match the sequential fits
+template <typename Kernel>
+bool SameAsSequentialFit(const Kernel & kernel, const uint32_t data_count)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::vector<uint32_t> all_samples(data_count), sample, batch_samples;
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+
+  Batch_Models<typename Kernel::Model> batch;
+  for (const uint32_t sample_count : {100, 37, 0, 64})
+  {
+    // Sequential fits
+    std::vector<typename Kernel::Model> models;
+    std::vector<uint32_t> offsets(1, 0);
+    batch_samples.clear();
+    for (uint32_t i = 0; i < sample_count; ++i)
+    {
+      UniformSample(Kernel::MINIMUM_SAMPLES, random_generator, &all_samples, &sample);
+      batch_samples.insert(batch_samples.end(), sample.cbegin(), sample.cend());
+      kernel.Fit(sample, &models);
+      offsets.push_back(models.size());
+    }
+
+    FitBatch(kernel, batch_samples, batch);
+    if (batch.SampleCount() != sample_count || offsets != batch.offsets
+        || models.size() != batch.models.size())
+      return false;
+    for (size_t i = 0; i < models.size(); ++i)
+      if (models[i] != batch.models[i])
+        return false;
+  }
+  return true;
+}
+
+TEST(FitBatch, LineKernel) {
+  Mat2X xy(2, 20);
+  for (int i = 0; i < xy.cols(); ++i)
+    xy.col(i) << i, 2. * i + 1. + ((i % 4 == 0) ? 3. : 0.);
+
+  EXPECT_TRUE(SameAsSequentialFit(LineKernel(xy), xy.cols()));
+}
+
+TEST(FitBatch, VaryingModelCount) {
+  EXPECT_TRUE(SameAsSequentialFit(VaryingModelCountKernel(), 50));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -30,6 +30,7 @@
 #ifndef OPENMVG_ROBUST_RANSAC_TOOLS_HPP
 #define OPENMVG_ROBUST_RANSAC_TOOLS_HPP
 
+#include <algorithm>
 #include <cmath>
 
 namespace openMVG {
@@ -56,6 +57,75 @@ inline size_t IterationsRequired(
     std::log(1.0 - std::pow(inlier_ratio, static_cast<int>(min_samples))));
 }
 
+/// Sequential Probability Ratio Test (SPRT) of a model hypothesis.
+/// "Optimal Randomized RANSAC"
+///  Ondrej Chum, Jiri Matas. PAMI 2008.
+///
+/// The data are verified one by one: the hypothesis is rejected as soon as the
+/// likelihood ratio of being a bad model exceeds the decision threshold A.
+///  - epsilon: probability that a datum is consistent with a good model,
+///  - delta: probability that a datum is consistent with a bad model.
+class SPRT_Test
+{
+public:
+  /// \param epsilon Probability that a datum is consistent with a good model
+  /// \param delta Probability that a datum is consistent with a bad model
+  /// \param model_cost Time to fit a sample, in datum verification unit (t_M)
+  /// \param models_per_sample Average number of models per sample (m_S)
+  SPRT_Test
+  (
+    double epsilon,
+    double delta,
+    double model_cost = 200.0,
+    double models_per_sample = 1.0
+  ):
+    model_cost_(model_cost),
+    models_per_sample_(models_per_sample)
+  {
+    Set_Parameters(epsilon, delta);
+  }
+
+  /// Update epsilon and delta (and the decision threshold)
+  void Set_Parameters(double epsilon, double delta)
+  {
+    delta_ = std::min(std::max(delta, 1e-6), 0.5);
+    epsilon_ = std::min(std::max(epsilon, 1.5 * delta_), 1.0 - 1e-6);
+    ratio_consistent_ = delta_ / epsilon_;
+    ratio_inconsistent_ = (1.0 - delta_) / (1.0 - epsilon_);
+
+    // Optimal decision threshold: A = t_M * C / m_S + 1 + log(A)
+    const double C =
+      (1.0 - delta_) * std::log((1.0 - delta_) / (1.0 - epsilon_))
+      + delta_ * std::log(delta_ / epsilon_);
+    const double K = model_cost_ * C / models_per_sample_ + 1.0;
+    A_ = K;
+    for (int i = 0; i < 10; ++i)
+      A_ = K + std::log(A_);
+  }
+
+  /// Start the verification of a new hypothesis
+  void Reset() { lambda_ = 1.0; }
+
+  /// Account for the verification of a datum.
+  /// Return false if the hypothesis is rejected.
+  bool Verify(bool b_consistent)
+  {
+    lambda_ *= b_consistent ? ratio_consistent_ : ratio_inconsistent_;
+    return lambda_ <= A_;
+  }
+
+  double Epsilon() const { return epsilon_; }
+  double Delta() const { return delta_; }
+  double A() const { return A_; }
+
+private:
+  double model_cost_, models_per_sample_;
+  double epsilon_, delta_;
+  double ratio_consistent_, ratio_inconsistent_;
+  double A_;
+  double lambda_ = 1.0;
+};
+
 } // namespace robust
 } // namespace openMVG
 
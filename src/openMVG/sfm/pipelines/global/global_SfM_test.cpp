@@ -242,6 +242,107 @@ TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingSoftL1) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+TEST(GLOBAL_SFM, RelativePoseStore) {
+
+  const int nviews = 6;
+  const int npoints = 64;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfM_Data sfm_data_2 = sfm_data;
+  sfm_data_2.poses.clear();
+  sfm_data_2.structure.clear();
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  // First run: the store is filled with the estimated relative motions
+  Relative_Pose_Store relative_pose_store;
+  {
+    GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(sfm_data_2, "./");
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.SetRelativePoseStore(&relative_pose_store);
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.SetRotationAveragingMethod(ROTATION_AVERAGING_L2);
+    sfmEngine.SetTranslationAveragingMethod(TRANSLATION_AVERAGING_L1);
+    EXPECT_TRUE (sfmEngine.Process());
+  }
+  EXPECT_EQ(matches_provider->pairWise_matches_.size(), relative_pose_store.size());
+
+  // Save & reload the store
+  const std::string sStore_filename = "relative_pose_store.bin";
+  EXPECT_TRUE(relative_pose_store.Save(sStore_filename));
+  Relative_Pose_Store relative_pose_store_reloaded;
+  EXPECT_TRUE(relative_pose_store_reloaded.Load(sStore_filename));
+  EXPECT_EQ(relative_pose_store.size(), relative_pose_store_reloaded.size());
+  for (const auto & pairwise_matches : matches_provider->pairWise_matches_)
+  {
+    Relative_Pose_Entry entry, entry_reloaded;
+    EXPECT_TRUE(relative_pose_store.Get(
+      pairwise_matches.first, pairwise_matches.second, entry));
+    EXPECT_TRUE(relative_pose_store_reloaded.Get(
+      pairwise_matches.first, pairwise_matches.second, entry_reloaded));
+    EXPECT_TRUE(entry.is_valid && entry.is_refined);
+    EXPECT_NEAR(entry.found_residual_precision, entry_reloaded.found_residual_precision, 1e-8);
+    EXPECT_MATRIX_NEAR(entry.refined_pose.rotation(),
+      entry_reloaded.refined_pose.rotation(), 1e-8);
+    // An entry computed on other matches (even of the same size) is outdated
+    matching::IndMatches other_matches = pairwise_matches.second;
+    std::swap(other_matches.front().j_, other_matches.back().j_);
+    EXPECT_FALSE(relative_pose_store_reloaded.Get(
+      pairwise_matches.first, other_matches, entry_reloaded));
+    // The stored motion does not depend on the tolerance: each engine filters
+    //  the inliers with its own tolerance (global: Square(2.5), sequential: Square(4.0))
+    const View
+      * view_I = sfm_data.GetViews().at(pairwise_matches.first.first).get(),
+      * view_J = sfm_data.GetViews().at(pairwise_matches.first.second).get();
+    const cameras::IntrinsicBase
+      * cam_I = sfm_data.GetIntrinsics().at(view_I->id_intrinsic).get(),
+      * cam_J = sfm_data.GetIntrinsics().at(view_J->id_intrinsic).get();
+    std::vector<uint32_t> vec_inliers_global, vec_inliers_sequential;
+    double median_angle_global, median_angle_sequential;
+    EXPECT_TRUE(Relative_Pose_Inliers(cam_I, cam_J, *feats_provider,
+      pairwise_matches.first, pairwise_matches.second, entry_reloaded,
+      Square(2.5), vec_inliers_global, median_angle_global));
+    EXPECT_TRUE(Relative_Pose_Inliers(cam_I, cam_J, *feats_provider,
+      pairwise_matches.first, pairwise_matches.second, entry_reloaded,
+      Square(4.0), vec_inliers_sequential, median_angle_sequential));
+    EXPECT_TRUE(vec_inliers_global.size() <= vec_inliers_sequential.size());
+  }
+  stlplus::file_delete(sStore_filename);
+
+  // Second run: the relative motions are read from the store
+  {
+    GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(sfm_data_2, "./");
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.SetRelativePoseStore(&relative_pose_store_reloaded);
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.SetRotationAveragingMethod(ROTATION_AVERAGING_L2);
+    sfmEngine.SetTranslationAveragingMethod(TRANSLATION_AVERAGING_L1);
+    EXPECT_TRUE (sfmEngine.Process());
+
+    const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+    std::cout << "RMSE residual: " << dResidual << std::endl;
+    EXPECT_TRUE( dResidual < 0.5);
+    EXPECT_EQ( nviews, sfmEngine.Get_SfM_Data().GetPoses().size());
+    EXPECT_EQ( npoints, sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
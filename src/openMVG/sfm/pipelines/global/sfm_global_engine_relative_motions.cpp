@@ -18,6 +18,7 @@
 #include "openMVG/sfm/pipelines/global/GlobalSfM_rotation_averaging.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
+#include "openMVG/sfm/pipelines/sfm_relative_pose_store.hpp"
 #include "openMVG/sfm/pipelines/sfm_robust_model_estimation.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
@@ -27,6 +28,7 @@
 #include "openMVG/sfm/sfm_data_transform.hpp"
 #include "openMVG/sfm/sfm_filters.hpp"
 #include "openMVG/stl/stl.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 #include "openMVG/tracks/tracks.hpp"
 #include "openMVG/types.hpp"
@@ -54,7 +56,8 @@ GlobalSfMReconstructionEngine_RelativeMotions::GlobalSfMReconstructionEngine_Rel
   const SfM_Data & sfm_data,
   const std::string & soutDirectory,
   const std::string & sloggingFile)
-  : ReconstructionEngine(sfm_data, soutDirectory), sLogging_file_(sloggingFile)
+  : ReconstructionEngine(sfm_data, soutDirectory), sLogging_file_(sloggingFile),
+    relative_pose_store_(nullptr)
 {
 
   if (!sLogging_file_.empty())
@@ -95,6 +98,11 @@ void GlobalSfMReconstructionEngine_RelativeMotions::SetMatchesProvider(Matches_P
   matches_provider_ = provider;
 }
 
+void GlobalSfMReconstructionEngine_RelativeMotions::SetRelativePoseStore(Relative_Pose_Store * store)
+{
+  relative_pose_store_ = store;
+}
+
 void GlobalSfMReconstructionEngine_RelativeMotions::SetRotationAveragingMethod
 (
   ERotationAveragingMethod eRotationAveragingMethod
@@ -183,6 +191,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Compute_Global_Rotations
   Hash_Map<IndexT, Mat3> & global_rotations
 )
 {
+  OPENMVG_PROFILE_ZONE("rotation_averaging");
   if (relatives_R.empty())
     return false;
   // Log statistics about the relative rotation graph
@@ -294,6 +303,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Compute_Global_Translations
   matching::PairWiseMatches & tripletWise_matches
 )
 {
+  OPENMVG_PROFILE_ZONE("translation_averaging");
   // Translation averaging (compute translations & update them to a global common coordinates system)
   GlobalSfM_Translation_AveragingSolver translation_averaging_solver;
   const bool bTranslationAveraging = translation_averaging_solver.Run(
@@ -322,6 +332,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Compute_Initial_Structure
 {
   // Build tracks from selected triplets (Union of all the validated triplet tracks (_tripletWise_matches))
   {
+    OPENMVG_PROFILE_ZONE("track_building");
     using namespace openMVG::tracks;
     TracksBuilder tracksBuilder;
 #if defined USE_ALL_VALID_MATCHES // not used by default
@@ -646,6 +657,7 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
   rotation_averaging::RelativeRotations & vec_relatives_R
 )
 {
+  OPENMVG_PROFILE_ZONE("relative_motions");
   //
   // Build the Relative pose graph from matches:
   //
@@ -713,28 +725,34 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
         * cam_I = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic).get(),
         * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
 
-      // Compute for each feature the un-distorted camera coordinates
       const matching::IndMatches & matches = matches_provider_->pairWise_matches_.at(pairIterator);
-      size_t number_matches = matches.size();
-      Mat2X x1(2, number_matches), x2(2, number_matches);
-      number_matches = 0;
-      for (const auto & match : matches)
+
+      // Reuse the stored relative motion (if any) or robustly estimate it
+      Relative_Pose_Entry relative_pose_entry;
+      if (!relative_pose_store_ ||
+          !relative_pose_store_->Get(pairIterator, matches, relative_pose_entry))
       {
-        x1.col(number_matches) = cam_I->get_ud_pixel(features_provider_->feats_per_view[I][match.i_].coords().cast<double>());
-        x2.col(number_matches++) = cam_J->get_ud_pixel(features_provider_->feats_per_view[J][match.j_].coords().cast<double>());
+        Compute_Relative_Pose_Entry(cam_I, cam_J, *features_provider_,
+                                    pairIterator, matches, 256, relative_pose_entry);
+        if (relative_pose_store_)
+        {
+          relative_pose_store_->Set(pairIterator, relative_pose_entry);
+        }
       }
-
-      RelativePose_Info relativePose_info;
-      relativePose_info.initial_residual_tolerance = Square(2.5);
-      if (!robustRelativePose(cam_I, cam_J,
-                              x1, x2, relativePose_info,
-                              {cam_I->w(), cam_I->h()},
-                              {cam_J->w(), cam_J->h()},
-                              256))
+      // Validate the motion against this engine residual tolerance
+      const double initial_residual_tolerance = Square(2.5);
+      std::vector<uint32_t> vec_inliers;
+      double median_angle;
+      if (!Relative_Pose_Inliers(cam_I, cam_J, *features_provider_,
+                                 pairIterator, matches, relative_pose_entry,
+                                 initial_residual_tolerance, vec_inliers, median_angle))
       {
         continue;
       }
-      const bool bRefine_using_BA = true;
+      Pose3 relative_pose = relative_pose_entry.is_refined ?
+        relative_pose_entry.refined_pose : relative_pose_entry.relative_pose;
+
+      const bool bRefine_using_BA = !relative_pose_entry.is_refined;
       if (bRefine_using_BA)
       {
         // Refine the defined scene
@@ -746,14 +764,14 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
 
         // Init poses
         const Pose3 & Pose_I = tiny_scene.poses[view_I->id_pose] = Pose3(Mat3::Identity(), Vec3::Zero());
-        const Pose3 & Pose_J = tiny_scene.poses[view_J->id_pose] = relativePose_info.relativePose;
+        const Pose3 & Pose_J = tiny_scene.poses[view_J->id_pose] = relative_pose;
 
         // Init structure
         const Mat34
           P1 = cam_I->get_projective_equivalent(Pose_I),
           P2 = cam_J->get_projective_equivalent(Pose_J);
         Landmarks & landmarks = tiny_scene.structure;
-        for (Mat::Index k = 0; k < x1.cols(); ++k)
+        for (size_t k = 0; k < matches.size(); ++k)
         {
           const Vec2
             x1_ = features_provider_->feats_per_view[I][matches[k].i_].coords().cast<double>(),
@@ -790,7 +808,14 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
           Vec3 trel;
           RelativeCameraMotion(R1, t1, R2, t2, &Rrel, &trel);
           // Update found relative pose
-          relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
+          relative_pose = Pose3(Rrel, -Rrel.transpose() * trel);
+
+          if (relative_pose_store_)
+          {
+            relative_pose_entry.refined_pose = relative_pose;
+            relative_pose_entry.is_refined = true;
+            relative_pose_store_->Set(pairIterator, relative_pose_entry);
+          }
         }
       }
 #ifdef OPENMVG_USE_OPENMP
@@ -801,7 +826,7 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
         using namespace openMVG::rotation_averaging;
           vec_relatives_R.emplace_back(
             relative_pose_pair.first, relative_pose_pair.second,
-            relativePose_info.relativePose.rotation(),
+            relative_pose.rotation(),
             1.f);
       }
     }
@@ -20,6 +20,7 @@ namespace htmlDocument { class htmlDocumentStream; }
 namespace openMVG { namespace matching { struct PairWiseMatches; } }
 namespace openMVG { namespace sfm { struct Features_Provider; } }
 namespace openMVG { namespace sfm { struct Matches_Provider; } }
+namespace openMVG { namespace sfm { class Relative_Pose_Store; } }
 namespace openMVG { namespace sfm { struct SfM_Data; } }
 
 namespace openMVG{
@@ -40,6 +41,8 @@ public:
 
   void SetFeaturesProvider(Features_Provider * provider);
   void SetMatchesProvider(Matches_Provider * provider);
+  /// Optional relative motion store (read & filled by Compute_Relative_Rotations)
+  void SetRelativePoseStore(Relative_Pose_Store * store);
 
   void SetRotationAveragingMethod(ERotationAveragingMethod eRotationAveragingMethod);
   void SetTranslationAveragingMethod(ETranslationAveragingMethod eTranslation_averaging_method_);
@@ -92,6 +95,7 @@ private:
   //-- Data provider
   Features_Provider  * features_provider_;
   Matches_Provider  * matches_provider_;
+  Relative_Pose_Store * relative_pose_store_;
 };
 
 } // namespace sfm
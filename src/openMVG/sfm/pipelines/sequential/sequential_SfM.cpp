@@ -8,11 +8,13 @@
 
 
 #include "openMVG/sfm/pipelines/sequential/sequential_SfM.hpp"
+#include "openMVG/sfm/pipelines/sequential/sequential_SfM_checkpoint.hpp"
 #include "openMVG/geometry/pose3.hpp"
 #include "openMVG/multiview/triangulation.hpp"
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
+#include "openMVG/sfm/pipelines/sfm_relative_pose_store.hpp"
 #include "openMVG/sfm/pipelines/localization/SfM_Localizer.hpp"
 #include "openMVG/sfm/pipelines/sfm_robust_model_estimation.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
@@ -21,12 +23,14 @@
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/stl/stl.hpp"
+#include "openMVG/system/profiler.hpp"
 
 #include "third_party/histogram/histogram.hpp"
 #include "third_party/htmlDoc/htmlDoc.hpp"
 #include "third_party/progress/progress.hpp"
 
 #include <ceres/types.h>
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <utility>
@@ -42,6 +46,22 @@ using namespace openMVG::cameras;
 using namespace openMVG::geometry;
 using namespace openMVG::matching;
 
+/// Pose estimated for a view against the current scene (not yet added to the scene)
+struct SequentialSfMReconstructionEngine::Resection_Candidate
+{
+  uint32_t view_index = 0;
+  openMVG::tracks::STLMAPTracks map_tracksCommon; // Tracks observed by the view
+  size_t putative_count = 0;                      // #2D/3D associations used for the resection
+  bool b_resection = false;                       // Robust resection status
+  bool b_refined = false;                         // Pose refinement status
+  Image_Localizer_Match_Data resection_data;
+  geometry::Pose3 pose;
+  std::shared_ptr<cameras::IntrinsicBase> optional_intrinsic;
+  bool b_new_intrinsic = false;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 SequentialSfMReconstructionEngine::SequentialSfMReconstructionEngine(
   const SfM_Data & sfm_data,
   const std::string & soutDirectory,
@@ -49,7 +69,12 @@ SequentialSfMReconstructionEngine::SequentialSfMReconstructionEngine(
   : ReconstructionEngine(sfm_data, soutDirectory),
     sLogging_file_(sloggingFile),
     initial_pair_(0,0),
-    cam_type_(EINTRINSIC(PINHOLE_CAMERA_RADIAL3))
+    cam_type_(EINTRINSIC(PINHOLE_CAMERA_RADIAL3)),
+    relative_pose_store_(nullptr),
+    checkpoint_period_(1),
+    b_checkpoint_tracks_saved_(false),
+    b_resumed_(false),
+    resumed_resection_group_index_(0)
 {
   if (!sLogging_file_.empty())
   {
@@ -73,6 +98,8 @@ SequentialSfMReconstructionEngine::SequentialSfMReconstructionEngine(
 
 SequentialSfMReconstructionEngine::~SequentialSfMReconstructionEngine()
 {
+  if (checkpoint_writer_)
+    checkpoint_writer_->Wait();
   if (!sLogging_file_.empty())
   {
     // Save the reconstruction Log
@@ -91,45 +118,163 @@ void SequentialSfMReconstructionEngine::SetMatchesProvider(Matches_Provider * pr
   matches_provider_ = provider;
 }
 
+void SequentialSfMReconstructionEngine::SetRelativePoseStore(Relative_Pose_Store * store)
+{
+  relative_pose_store_ = store;
+}
+
+void SequentialSfMReconstructionEngine::SetCheckpoint
+(
+  const std::string & filename,
+  unsigned int resection_group_period
+)
+{
+  sCheckpoint_file_ = filename;
+  b_checkpoint_tracks_saved_ = false;
+  checkpoint_period_ = std::max(1u, resection_group_period);
+}
+
+bool SequentialSfMReconstructionEngine::ResumeFromCheckpoint(const std::string & filename)
+{
+  Sequential_SfM_Checkpoint checkpoint;
+  if (!Load_Checkpoint(checkpoint, filename))
+  {
+    std::cerr << "Cannot load the checkpoint: " << filename << std::endl;
+    return false;
+  }
+  openMVG::tracks::STLMAPTracks map_tracks;
+  if (!Load_Checkpoint_Tracks(map_tracks, filename))
+  {
+    std::cerr << "Cannot load the checkpoint tracks: "
+      << Checkpoint_Tracks_Filename(filename) << std::endl;
+    return false;
+  }
+  // The checkpoint must correspond to the current scene
+  if (checkpoint.sfm_data.GetViews().size() != sfm_data_.GetViews().size() ||
+      !std::all_of(sfm_data_.GetViews().cbegin(), sfm_data_.GetViews().cend(),
+        [&checkpoint](const Views::value_type & view_it)
+        {
+          return checkpoint.sfm_data.GetViews().count(view_it.first) != 0;
+        }))
+  {
+    std::cerr << "The checkpoint does not correspond to the input scene." << std::endl;
+    return false;
+  }
+
+  sfm_data_ = std::move(checkpoint.sfm_data);
+  initial_pair_ = checkpoint.initial_pair;
+  set_remaining_view_id_ = std::move(checkpoint.remaining_view_ids);
+  map_ACThreshold_ = std::move(checkpoint.map_ACThreshold);
+  map_tracks_ = std::move(map_tracks);
+  shared_track_visibility_helper_.reset(
+    new openMVG::tracks::SharedTrackVisibilityHelper(map_tracks_));
+  resumed_resection_group_index_ = checkpoint.resection_group_index;
+  b_resumed_ = true;
+
+  std::cout << "\n" << "Resume from checkpoint: " << filename << "\n"
+    << " #Camera calibrated: " << sfm_data_.GetPoses().size()
+    << " #Remaining views: " << set_remaining_view_id_.size()
+    << " #Tracks, #3D points: " << map_tracks_.size()
+    << ", " << sfm_data_.GetLandmarks().size() << std::endl;
+  return true;
+}
+
+void SequentialSfMReconstructionEngine::SaveCheckpoint(size_t resection_group_index)
+{
+  if (sCheckpoint_file_.empty())
+    return;
+
+  // The tracks do not change during the resection loop: write them once
+  if (!b_checkpoint_tracks_saved_)
+  {
+    if (!Save_Checkpoint_Tracks(map_tracks_, sCheckpoint_file_))
+    {
+      std::cerr << "The checkpoint tracks could not be saved." << std::endl;
+      return;
+    }
+    b_checkpoint_tracks_saved_ = true;
+  }
+
+  // Deep copy of the changing state, the write is done in a background thread
+  std::unique_ptr<Sequential_SfM_Checkpoint> checkpoint(new Sequential_SfM_Checkpoint);
+  checkpoint->sfm_data = Snapshot_SfM_Data(sfm_data_);
+  checkpoint->initial_pair = initial_pair_;
+  checkpoint->resection_group_index = resection_group_index;
+  checkpoint->remaining_view_ids = set_remaining_view_id_;
+  checkpoint->map_ACThreshold = map_ACThreshold_;
+
+  if (!checkpoint_writer_)
+    checkpoint_writer_.reset(new Checkpoint_Writer);
+  checkpoint_writer_->Write(std::move(checkpoint), sCheckpoint_file_);
+}
+
 bool SequentialSfMReconstructionEngine::Process() {
 
   //-------------------
   //-- Incremental reconstruction
   //-------------------
 
-  if (!InitLandmarkTracks())
-    return false;
-
-  // Initial pair choice
-  if (initial_pair_ == Pair(0,0))
+  size_t resectionGroupIndex = 0;
+  if (b_resumed_)
+  {
+    // Tracks, initial pair and already reconstructed views come from the checkpoint
+    resectionGroupIndex = resumed_resection_group_index_;
+  }
+  else
   {
-    if (!AutomaticInitialPairChoice(initial_pair_))
+    if (!InitLandmarkTracks())
+      return false;
+
+    // Initial pair choice
+    if (initial_pair_ == Pair(0,0))
     {
-      // Cannot find a valid initial pair, try to set it by hand?
-      if (!ChooseInitialPair(initial_pair_))
+      if (!AutomaticInitialPairChoice(initial_pair_))
       {
-        return false;
+        // Cannot find a valid initial pair, try to set it by hand?
+        if (!ChooseInitialPair(initial_pair_))
+        {
+          return false;
+        }
       }
     }
-  }
-  // Else a starting pair was already initialized before
+    // Else a starting pair was already initialized before
 
-  // Initial pair Essential Matrix and [R|t] estimation.
-  if (!MakeInitialPair3D(initial_pair_))
-    return false;
+    // Initial pair Essential Matrix and [R|t] estimation.
+    if (!MakeInitialPair3D(initial_pair_))
+      return false;
+
+    SaveCheckpoint(resectionGroupIndex);
+  }
 
   // Compute robust Resection of remaining images
   // - group of images will be selected and resection + scene completion will be tried
-  size_t resectionGroupIndex = 0;
   std::vector<uint32_t> vec_possible_resection_indexes;
   while (FindImagesWithPossibleResection(vec_possible_resection_indexes))
   {
     bool bImageAdded = false;
+    // Robust pose estimation of the candidates against the current scene.
+    // The scene is read only here, so the candidates are processed in parallel.
+    std::vector<Resection_Candidate, Eigen::aligned_allocator<Resection_Candidate>>
+      candidates(vec_possible_resection_indexes.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+      candidates[i].view_index = vec_possible_resection_indexes[i];
+      shared_track_visibility_helper_->GetTracksInImages(
+        {candidates[i].view_index}, candidates[i].map_tracksCommon);
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(candidates.size()); ++i)
+    {
+      ComputeResection(candidates[i]);
+    }
     // Add images to the 3D reconstruction
-    for (const auto & iter : vec_possible_resection_indexes)
+    // (serialized in the candidate order to keep a deterministic result)
+    for (const Resection_Candidate & candidate : candidates)
     {
-      bImageAdded |= Resection(iter);
-      set_remaining_view_id_.erase(iter);
+      bImageAdded |= CommitResection(candidate);
+      set_remaining_view_id_.erase(candidate.view_index);
     }
 
     if (bImageAdded)
@@ -148,6 +293,12 @@ bool SequentialSfMReconstructionEngine::Process() {
       eraseUnstablePosesAndObservations(sfm_data_);
     }
     ++resectionGroupIndex;
+    if (resectionGroupIndex % checkpoint_period_ == 0)
+      SaveCheckpoint(resectionGroupIndex);
+  }
+  if (checkpoint_writer_ && !checkpoint_writer_->Wait())
+  {
+    std::cerr << "The last checkpoint could not be saved." << std::endl;
   }
   // Ensure there is no remaining outliers
   if (badTrackRejector(4.0, 0))
@@ -292,6 +443,7 @@ bool SequentialSfMReconstructionEngine::ChooseInitialPair(Pair & initialPairInde
 
 bool SequentialSfMReconstructionEngine::InitLandmarkTracks()
 {
+  OPENMVG_PROFILE_ZONE("track_building");
   // Compute tracks from matches
   tracks::TracksBuilder tracksBuilder;
 
@@ -395,7 +547,39 @@ bool SequentialSfMReconstructionEngine::AutomaticInitialPairChoice(Pair & initia
         const auto
           cam_I = iterIntrinsic_I->second.get(),
           cam_J = iterIntrinsic_J->second.get();
-        if (cam_I && cam_J)
+        if (cam_I && cam_J && relative_pose_store_)
+        {
+          // Score the pair from the relative motion of its putative pairwise
+          //  matches (rather than its common tracks), so that the stored motion
+          //  is shared with the global engine.
+          const matching::IndMatches & matches = match_pair.second;
+          const IntrinsicBase
+            * cam_first = (current_pair.first == I) ? cam_I : cam_J,
+            * cam_second = (current_pair.first == I) ? cam_J : cam_I;
+          Relative_Pose_Entry relative_pose_entry;
+          if (!relative_pose_store_->Get(current_pair, matches, relative_pose_entry))
+          {
+            Compute_Relative_Pose_Entry(cam_first, cam_second, *features_provider_,
+                                        current_pair, matches, 256, relative_pose_entry);
+            relative_pose_store_->Set(current_pair, relative_pose_entry);
+          }
+          const double initial_residual_tolerance = Square(4.0);
+          std::vector<uint32_t> vec_inliers;
+          double median_angle;
+          if (Relative_Pose_Inliers(cam_first, cam_second, *features_provider_,
+                                    current_pair, matches, relative_pose_entry,
+                                    initial_residual_tolerance, vec_inliers, median_angle) &&
+              vec_inliers.size() > iMin_inliers_count &&
+              median_angle > fRequired_min_angle &&
+              median_angle < fLimit_max_angle)
+          {
+  #ifdef OPENMVG_USE_OPENMP
+            #pragma omp critical
+  #endif
+            scoring_per_pair.emplace_back(median_angle, current_pair);
+          }
+        }
+        else if (cam_I && cam_J)
         {
           openMVG::tracks::STLMAPTracks map_tracksCommon;
           shared_track_visibility_helper_->GetTracksInImages({I, J}, map_tracksCommon);
@@ -870,14 +1054,19 @@ bool SequentialSfMReconstructionEngine::FindImagesWithPossibleResection(
  * F. Update the observations into the global scene structure
  * G. Triangulate new possible 2D tracks
  */
-bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
+bool SequentialSfMReconstructionEngine::ComputeResection
+(
+  Resection_Candidate & candidate
+) const
 {
+  OPENMVG_PROFILE_ZONE("resection");
   using namespace tracks;
 
+  const uint32_t viewIndex = candidate.view_index;
+  const openMVG::tracks::STLMAPTracks & map_tracksCommon = candidate.map_tracksCommon;
+
   // A. Compute 2D/3D matches
   // A1. list tracks ids used by the view
-  openMVG::tracks::STLMAPTracks map_tracksCommon;
-  shared_track_visibility_helper_->GetTracksInImages({viewIndex}, map_tracksCommon);
   std::set<uint32_t> set_tracksIds;
   TracksUtilsMap::GetTracksIdVector(map_tracksCommon, &set_tracksIds);
 
@@ -896,11 +1085,6 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
   if (set_trackIdForResection.empty())
   {
     // No match. The image has no connection with already reconstructed points.
-    std::cout << std::endl
-      << "-------------------------------" << "\n"
-      << "-- Resection of camera index: " << viewIndex << "\n"
-      << "-- Resection status: " << "FAILED" << "\n"
-      << "-------------------------------" << std::endl;
     return false;
   }
 
@@ -911,15 +1095,16 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
     set_trackIdForResection,
     viewIndex,
     &vec_featIdForResection);
+  candidate.putative_count = vec_featIdForResection.size();
 
   // Localize the image inside the SfM reconstruction
-  Image_Localizer_Match_Data resection_data;
+  Image_Localizer_Match_Data & resection_data = candidate.resection_data;
   resection_data.pt2D.resize(2, set_trackIdForResection.size());
   resection_data.pt3D.resize(3, set_trackIdForResection.size());
 
   // B. Look if the intrinsic data is known or not
   const View * view_I = sfm_data_.GetViews().at(viewIndex).get();
-  std::shared_ptr<cameras::IntrinsicBase> optional_intrinsic;
+  std::shared_ptr<cameras::IntrinsicBase> & optional_intrinsic = candidate.optional_intrinsic;
   if (sfm_data_.GetIntrinsics().count(view_I->id_intrinsic))
   {
     optional_intrinsic = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic);
@@ -942,12 +1127,8 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
   }
 
   // C. Do the resectioning: compute the camera pose
-  std::cout << std::endl
-    << "-------------------------------" << std::endl
-    << "-- Robust Resection of view: " << viewIndex << std::endl;
-
-  geometry::Pose3 pose;
-  const bool bResection = sfm::SfM_Localizer::Localize
+  geometry::Pose3 & pose = candidate.pose;
+  candidate.b_resection = sfm::SfM_Localizer::Localize
   (
     optional_intrinsic ? resection::SolverType::P3P_KE_CVPR17 : resection::SolverType::DLT_6POINTS,
     {view_I->ui_width, view_I->ui_height},
@@ -957,36 +1138,13 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
   );
   resection_data.pt2D = std::move(pt2D_original); // restore original image domain points
 
-  if (!sLogging_file_.empty())
-  {
-    using namespace htmlDocument;
-    std::ostringstream os;
-    os << "Resection of Image index: <" << viewIndex << "> image: "
-      << view_I->s_Img_path <<"<br> \n";
-    html_doc_stream_->pushInfo(htmlMarkup("h1",os.str()));
-
-    os.str("");
-    os << std::endl
-      << "-------------------------------" << "<br>"
-      << "-- Robust Resection of camera index: <" << viewIndex << "> image: "
-      <<  view_I->s_Img_path <<"<br>"
-      << "-- Threshold: " << resection_data.error_max << "<br>"
-      << "-- Resection status: " << (bResection ? "OK" : "FAILED") << "<br>"
-      << "-- Nb points used for Resection: " << vec_featIdForResection.size() << "<br>"
-      << "-- Nb points validated by robust estimation: " << resection_data.vec_inliers.size() << "<br>"
-      << "-- % points validated: "
-      << resection_data.vec_inliers.size()/static_cast<float>(vec_featIdForResection.size()) << "<br>"
-      << "-------------------------------" << "<br>";
-    html_doc_stream_->pushInfo(os.str());
-  }
-
-  if (!bResection)
+  if (!candidate.b_resection)
     return false;
 
   // D. Refine the pose of the found camera.
   // We use a local scene with only the 3D points and the new camera.
   {
-    const bool b_new_intrinsic = (optional_intrinsic == nullptr);
+    const bool b_new_intrinsic = candidate.b_new_intrinsic = (optional_intrinsic == nullptr);
     // A valid pose has been found (try to refine it):
     // If no valid intrinsic as input:
     //  init a new one from the projection matrix decomposition
@@ -1051,20 +1209,74 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
     }
     const bool b_refine_pose = true;
     const bool b_refine_intrinsics = false;
-    if (!sfm::SfM_Localizer::RefinePose(
-        optional_intrinsic.get(), pose,
-        resection_data, b_refine_pose, b_refine_intrinsics))
-    {
-      return false;
-    }
+    candidate.b_refined = sfm::SfM_Localizer::RefinePose(
+      optional_intrinsic.get(), pose,
+      resection_data, b_refine_pose, b_refine_intrinsics);
+  }
+  return candidate.b_refined;
+}
+
+bool SequentialSfMReconstructionEngine::CommitResection
+(
+  const Resection_Candidate & candidate
+)
+{
+  const uint32_t viewIndex = candidate.view_index;
+  const openMVG::tracks::STLMAPTracks & map_tracksCommon = candidate.map_tracksCommon;
+  const Image_Localizer_Match_Data & resection_data = candidate.resection_data;
 
+  if (candidate.putative_count == 0)
+  {
+    // No match. The image has no connection with already reconstructed points.
+    std::cout << std::endl
+      << "-------------------------------" << "\n"
+      << "-- Resection of camera index: " << viewIndex << "\n"
+      << "-- Resection status: " << "FAILED" << "\n"
+      << "-------------------------------" << std::endl;
+    return false;
+  }
+
+  std::cout << std::endl
+    << "-------------------------------" << std::endl
+    << "-- Robust Resection of view: " << viewIndex << std::endl
+    << "-- Resection status: " << (candidate.b_resection ? "OK" : "FAILED") << std::endl;
+
+  if (!sLogging_file_.empty())
+  {
+    const View * view_I = sfm_data_.GetViews().at(viewIndex).get();
+    using namespace htmlDocument;
+    std::ostringstream os;
+    os << "Resection of Image index: <" << viewIndex << "> image: "
+      << view_I->s_Img_path <<"<br> \n";
+    html_doc_stream_->pushInfo(htmlMarkup("h1",os.str()));
+
+    os.str("");
+    os << std::endl
+      << "-------------------------------" << "<br>"
+      << "-- Robust Resection of camera index: <" << viewIndex << "> image: "
+      <<  view_I->s_Img_path <<"<br>"
+      << "-- Threshold: " << resection_data.error_max << "<br>"
+      << "-- Resection status: " << (candidate.b_resection ? "OK" : "FAILED") << "<br>"
+      << "-- Nb points used for Resection: " << candidate.putative_count << "<br>"
+      << "-- Nb points validated by robust estimation: " << resection_data.vec_inliers.size() << "<br>"
+      << "-- % points validated: "
+      << resection_data.vec_inliers.size()/static_cast<float>(candidate.putative_count) << "<br>"
+      << "-------------------------------" << "<br>";
+    html_doc_stream_->pushInfo(os.str());
+  }
+
+  if (!candidate.b_resection || !candidate.b_refined)
+    return false;
+
+  {
+    const View * view_I = sfm_data_.GetViews().at(viewIndex).get();
     // E. Update the global scene with:
     // - the new found camera pose
-    sfm_data_.poses[view_I->id_pose] = pose;
+    sfm_data_.poses[view_I->id_pose] = candidate.pose;
     // - track the view's AContrario robust estimation found threshold
     map_ACThreshold_.insert({viewIndex, resection_data.error_max});
     // - intrinsic parameters (if the view has no intrinsic group add a new one)
-    if (b_new_intrinsic)
+    if (candidate.b_new_intrinsic)
     {
       // Since the view have not yet an intrinsic group before, create a new one
       IndexT new_intrinsic_id = 0;
@@ -1079,7 +1291,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
         new_intrinsic_id = (*existing_intrinsicId.rbegin())+1;
       }
       sfm_data_.views.at(viewIndex)->id_intrinsic = new_intrinsic_id;
-      sfm_data_.intrinsics[new_intrinsic_id] = optional_intrinsic;
+      sfm_data_.intrinsics[new_intrinsic_id] = candidate.optional_intrinsic;
     }
   }
 
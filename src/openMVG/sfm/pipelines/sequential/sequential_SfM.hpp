@@ -25,6 +25,8 @@ namespace sfm {
 
 struct Features_Provider;
 struct Matches_Provider;
+class Relative_Pose_Store;
+class Checkpoint_Writer;
 
 /// Sequential SfM Pipeline Reconstruction Engine.
 class SequentialSfMReconstructionEngine : public ReconstructionEngine
@@ -40,6 +42,20 @@ public:
 
   void SetFeaturesProvider(Features_Provider * provider);
   void SetMatchesProvider(Matches_Provider * provider);
+  /// Optional relative motion store (read & filled by AutomaticInitialPairChoice)
+  void SetRelativePoseStore(Relative_Pose_Store * store);
+
+  /**
+   * Save the engine state in a checkpoint file after the initial pair and
+   * then every `resection_group_period` resection groups.
+   * The checkpoints are written asynchronously and the tracks are saved once
+   * (see Checkpoint_Tracks_Filename).
+   */
+  void SetCheckpoint(const std::string & filename, unsigned int resection_group_period = 1);
+
+  /// Restore the engine state from a checkpoint file.
+  /// Process() will then continue the resection loop (tracks and initial pair are not recomputed).
+  bool ResumeFromCheckpoint(const std::string & filename);
 
   virtual bool Process() override;
 
@@ -82,8 +98,14 @@ private:
   /// List the images that the greatest number of matches to the current 3D reconstruction.
   bool FindImagesWithPossibleResection(std::vector<uint32_t> & vec_possible_indexes);
 
-  /// Add a single Image to the scene and triangulate new possible tracks.
-  bool Resection(const uint32_t imageIndex);
+  /// Pose of a view estimated during a resection round
+  struct Resection_Candidate;
+
+  /// Robust pose estimation of a view against the current scene (the scene is not modified).
+  bool ComputeResection(Resection_Candidate & candidate) const;
+
+  /// Add a view with a computed pose to the scene and triangulate new possible tracks.
+  bool CommitResection(const Resection_Candidate & candidate);
 
   /// Bundle adjustment to refine Structure; Motion and Intrinsics
   bool BundleAdjustment();
@@ -91,6 +113,9 @@ private:
   /// Discard track with too large residual error
   bool badTrackRejector(double dPrecision, size_t count = 0);
 
+  /// Start the asynchronous save of the current engine state
+  void SaveCheckpoint(size_t resection_group_index);
+
   //----
   //-- Data
   //----
@@ -106,6 +131,7 @@ private:
   //-- Data provider
   Features_Provider  * features_provider_;
   Matches_Provider  * matches_provider_;
+  Relative_Pose_Store * relative_pose_store_;
 
   // Temporary data
   openMVG::tracks::STLMAPTracks map_tracks_; // putative landmark tracks (visibility per 3D point)
@@ -116,6 +142,14 @@ private:
   Hash_Map<IndexT, double> map_ACThreshold_; // Per camera confidence (A contrario estimated threshold error)
 
   std::set<uint32_t> set_remaining_view_id_;     // Remaining camera index that can be used for resection
+
+  // Checkpoint
+  std::string sCheckpoint_file_;
+  unsigned int checkpoint_period_;
+  bool b_checkpoint_tracks_saved_; // The tracks are saved once (they do not change)
+  std::unique_ptr<Checkpoint_Writer> checkpoint_writer_;
+  bool b_resumed_;
+  size_t resumed_resection_group_index_;
 };
 
 } // namespace sfm
@@ -0,0 +1,299 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// The <cereal/archives> headers are special and must be included first.
+#include <cereal/archives/portable_binary.hpp>
+
+#include "openMVG/sfm/pipelines/sequential/sequential_SfM_checkpoint.hpp"
+
+#include "openMVG/cameras/cameras_io.hpp"
+#include "openMVG/geometry/pose3_io.hpp"
+#include "openMVG/sfm/sfm_landmark_io.hpp"
+#include "openMVG/sfm/sfm_view_io.hpp"
+#include "openMVG/sfm/sfm_view_priors.hpp"
+#include "openMVG/sfm/sfm_view_priors_io.hpp"
+#include "openMVG/system/profiler.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <cereal/types/map.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+// Increase it if the serialized content change
+const std::string kCheckpointVersion = "0.2";
+
+template <class Archive>
+void Serialize_Checkpoint
+(
+  Archive & archive,
+  Sequential_SfM_Checkpoint & checkpoint,
+  std::string & version
+)
+{
+  archive(cereal::make_nvp("checkpoint_version", version));
+  if (version != kCheckpointVersion)
+    return;
+  archive(cereal::make_nvp("resection_group_index", checkpoint.resection_group_index),
+          cereal::make_nvp("initial_pair", checkpoint.initial_pair),
+          cereal::make_nvp("remaining_view_ids", checkpoint.remaining_view_ids),
+          cereal::make_nvp("ac_thresholds", checkpoint.map_ACThreshold));
+  // SfM_Data (same layout as the sfm_data serialization)
+  SfM_Data & sfm_data = checkpoint.sfm_data;
+  archive(cereal::make_nvp("root_path", sfm_data.s_root_path),
+          cereal::make_nvp("views", sfm_data.views),
+          cereal::make_nvp("intrinsics", sfm_data.intrinsics),
+          cereal::make_nvp("extrinsics", sfm_data.poses),
+          cereal::make_nvp("structure", sfm_data.structure),
+          cereal::make_nvp("control_points", sfm_data.control_points));
+}
+
+template <class Archive>
+void Serialize_Tracks
+(
+  Archive & archive,
+  tracks::STLMAPTracks & map_tracks,
+  std::string & version
+)
+{
+  archive(cereal::make_nvp("checkpoint_version", version));
+  if (version != kCheckpointVersion)
+    return;
+  archive(cereal::make_nvp("tracks", map_tracks));
+}
+
+/// Write a portable binary file with the given serialization function.
+/// The data are first written to "filename.tmp" and then renamed.
+template <typename T, typename SerializeFunctor>
+bool Save_Portable_Binary
+(
+  const T & data,
+  const std::string & filename,
+  SerializeFunctor serialize
+)
+{
+  const std::string temporary_filename = filename + ".tmp";
+  {
+    std::ofstream stream(temporary_filename.c_str(), std::ios::out | std::ios::binary);
+    if (!stream.is_open())
+    {
+      std::cerr << "Cannot open the checkpoint file: " << temporary_filename << std::endl;
+      return false;
+    }
+    {
+      cereal::PortableBinaryOutputArchive archive(stream);
+      std::string version = kCheckpointVersion;
+      // The serialization functions are shared by the input and output
+      // archives, so they use a non const object.
+      serialize(archive, const_cast<T&>(data), version);
+    }
+    stream.flush();
+    if (!stream.good())
+    {
+      std::cerr << "Cannot write the checkpoint file: " << temporary_filename << std::endl;
+      return false;
+    }
+  }
+  // Replace the previous file
+  if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0)
+  {
+    // Some platforms do not allow to rename over an existing file:
+    // move the previous file aside, and delete it only once the new
+    // one is in place (restore it if the new one cannot be moved)
+    const std::string previous_filename = filename + ".previous";
+    stlplus::file_delete(previous_filename);
+    const bool b_previous_moved =
+      std::rename(filename.c_str(), previous_filename.c_str()) == 0;
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0)
+    {
+      if (b_previous_moved)
+        std::rename(previous_filename.c_str(), filename.c_str());
+      std::cerr << "Cannot rename the checkpoint file: " << temporary_filename << std::endl;
+      return false;
+    }
+    if (b_previous_moved)
+      stlplus::file_delete(previous_filename);
+  }
+  return true;
+}
+
+/// Read a portable binary file written by Save_Portable_Binary
+template <typename T, typename SerializeFunctor>
+bool Load_Portable_Binary
+(
+  T & data,
+  const std::string & filename,
+  SerializeFunctor serialize
+)
+{
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+  try
+  {
+    cereal::PortableBinaryInputArchive archive(stream);
+    std::string version;
+    serialize(archive, data, version);
+    if (version != kCheckpointVersion)
+    {
+      std::cerr << "Unsupported checkpoint version: " << version << std::endl;
+      return false;
+    }
+  }
+  catch (const cereal::Exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool Save_Checkpoint
+(
+  const Sequential_SfM_Checkpoint & checkpoint,
+  const std::string & filename
+)
+{
+  OPENMVG_PROFILE_ZONE("checkpoint_save");
+  return Save_Portable_Binary(checkpoint, filename,
+    Serialize_Checkpoint<cereal::PortableBinaryOutputArchive>);
+}
+
+bool Load_Checkpoint
+(
+  Sequential_SfM_Checkpoint & checkpoint,
+  const std::string & filename
+)
+{
+  return Load_Portable_Binary(checkpoint, filename,
+    Serialize_Checkpoint<cereal::PortableBinaryInputArchive>);
+}
+
+std::string Checkpoint_Tracks_Filename(const std::string & checkpoint_filename)
+{
+  return checkpoint_filename + ".tracks";
+}
+
+bool Save_Checkpoint_Tracks
+(
+  const tracks::STLMAPTracks & map_tracks,
+  const std::string & checkpoint_filename
+)
+{
+  return Save_Portable_Binary(map_tracks, Checkpoint_Tracks_Filename(checkpoint_filename),
+    Serialize_Tracks<cereal::PortableBinaryOutputArchive>);
+}
+
+bool Load_Checkpoint_Tracks
+(
+  tracks::STLMAPTracks & map_tracks,
+  const std::string & checkpoint_filename
+)
+{
+  return Load_Portable_Binary(map_tracks, Checkpoint_Tracks_Filename(checkpoint_filename),
+    Serialize_Tracks<cereal::PortableBinaryInputArchive>);
+}
+
+Checkpoint_Writer::~Checkpoint_Writer()
+{
+  Wait();
+}
+
+void Checkpoint_Writer::Write
+(
+  std::unique_ptr<Sequential_SfM_Checkpoint> checkpoint,
+  const std::string & filename
+)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Replace the checkpoint waiting for the running write (if any)
+  queued_checkpoint_ = std::move(checkpoint);
+  queued_filename_ = filename;
+  if (b_writing_)
+    return;
+  // The previous worker is done: collect its status and start a new one
+  if (pending_write_.valid() && !pending_write_.get())
+    b_write_failed_ = true;
+  b_writing_ = true;
+  pending_write_ = std::async(std::launch::async, [this]
+  {
+    return Write_Queued();
+  });
+}
+
+bool Checkpoint_Writer::Write_Queued()
+{
+  bool b_ok = true;
+  while (true)
+  {
+    std::unique_ptr<Sequential_SfM_Checkpoint> checkpoint;
+    std::string filename;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!queued_checkpoint_)
+      {
+        b_writing_ = false;
+        return b_ok;
+      }
+      checkpoint = std::move(queued_checkpoint_);
+      filename = queued_filename_;
+    }
+    b_ok = Save_Checkpoint(*checkpoint, filename) && b_ok;
+  }
+}
+
+bool Checkpoint_Writer::Wait()
+{
+  if (pending_write_.valid() && !pending_write_.get())
+    b_write_failed_ = true;
+  const bool b_ok = !b_write_failed_;
+  b_write_failed_ = false;
+  return b_ok;
+}
+
+SfM_Data Snapshot_SfM_Data(const SfM_Data & sfm_data)
+{
+  SfM_Data snapshot;
+  snapshot.s_root_path = sfm_data.s_root_path;
+  snapshot.poses = sfm_data.poses;
+  snapshot.structure = sfm_data.structure;
+  snapshot.control_points = sfm_data.control_points;
+  for (const auto & view_it : sfm_data.views)
+  {
+    const ViewPriors * prior = dynamic_cast<const ViewPriors*>(view_it.second.get());
+    if (prior)
+      snapshot.views[view_it.first] = std::make_shared<ViewPriors>(*prior);
+    else
+      snapshot.views[view_it.first] = std::make_shared<View>(*view_it.second);
+  }
+  for (const auto & intrinsic_it : sfm_data.intrinsics)
+  {
+    snapshot.intrinsics[intrinsic_it.first] =
+      std::shared_ptr<cameras::IntrinsicBase>(intrinsic_it.second->clone());
+  }
+  return snapshot;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,137 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SEQUENTIAL_SFM_CHECKPOINT_HPP
+#define OPENMVG_SFM_SEQUENTIAL_SFM_CHECKPOINT_HPP
+
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/tracks/tracks.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace openMVG {
+namespace sfm {
+
+/// Snapshot of the SequentialSfMReconstructionEngine state.
+/// With the tracks (they do not change during the resection loop, so they are
+/// saved once in a separate file, see Save_Checkpoint_Tracks), it contains
+/// everything that is required to continue the resection loop without
+/// recomputing the tracks and the initial pair.
+struct Sequential_SfM_Checkpoint
+{
+  SfM_Data sfm_data;                         // Current reconstruction
+  Pair initial_pair = {0, 0};                // Initial pair used for the seeding
+  uint64_t resection_group_index = 0;        // Next resection group index
+  std::set<uint32_t> remaining_view_ids;     // Views not yet tried for resection
+  Hash_Map<IndexT, double> map_ACThreshold;  // Per view a contrario threshold
+};
+
+/**
+* @brief Save a checkpoint to a portable binary file.
+* The data are first written to "filename.tmp" and then renamed, so an
+*  interrupted write never corrupts the last valid checkpoint.
+* @param checkpoint The state to save
+* @param filename The checkpoint file
+* @return true if the checkpoint was written
+*/
+bool Save_Checkpoint
+(
+  const Sequential_SfM_Checkpoint & checkpoint,
+  const std::string & filename
+);
+
+/**
+* @brief Load a checkpoint written by Save_Checkpoint.
+* @param[out] checkpoint The restored state
+* @param filename The checkpoint file
+* @return true if the checkpoint was read
+*/
+bool Load_Checkpoint
+(
+  Sequential_SfM_Checkpoint & checkpoint,
+  const std::string & filename
+);
+
+/// Name of the tracks file associated to a checkpoint file
+std::string Checkpoint_Tracks_Filename(const std::string & checkpoint_filename);
+
+/**
+* @brief Save the tracks of a checkpoint to a portable binary file
+*  (see Checkpoint_Tracks_Filename).
+* @param map_tracks The putative landmark tracks
+* @param checkpoint_filename The checkpoint file
+* @return true if the tracks were written
+*/
+bool Save_Checkpoint_Tracks
+(
+  const tracks::STLMAPTracks & map_tracks,
+  const std::string & checkpoint_filename
+);
+
+/**
+* @brief Load the tracks written by Save_Checkpoint_Tracks.
+* @param[out] map_tracks The putative landmark tracks
+* @param checkpoint_filename The checkpoint file
+* @return true if the tracks were read
+*/
+bool Load_Checkpoint_Tracks
+(
+  tracks::STLMAPTracks & map_tracks,
+  const std::string & checkpoint_filename
+);
+
+/**
+* @brief Write checkpoints in a background thread.
+* Write never blocks: while a checkpoint is being written, the new request is
+*  queued, replacing the previously queued one (only the latest state is
+*  worth writing). The checkpoint must be a deep copy of the engine state
+*  (see Snapshot_SfM_Data) since the engine keeps on modifying its own data.
+* Write and Wait must be called from the same thread.
+*/
+class Checkpoint_Writer
+{
+public:
+  ~Checkpoint_Writer();
+
+  /// Start (or queue) the asynchronous write of a checkpoint
+  void Write
+  (
+    std::unique_ptr<Sequential_SfM_Checkpoint> checkpoint,
+    const std::string & filename
+  );
+
+  /// Wait for the pending writes (if any).
+  /// Return false if a write failed since the last call.
+  bool Wait();
+
+private:
+  /// Worker: write the queued checkpoints until the queue is empty
+  bool Write_Queued();
+
+  std::mutex mutex_; // Protect the queued checkpoint & the worker state
+  std::unique_ptr<Sequential_SfM_Checkpoint> queued_checkpoint_;
+  std::string queued_filename_;
+  bool b_writing_ = false;      // True while the worker is running
+  bool b_write_failed_ = false; // A write failed since the last Wait
+  std::future<bool> pending_write_;
+};
+
+/// Return a copy of the scene that does not share the intrinsics objects
+/// (they are modified in place by the bundle adjustment).
+SfM_Data Snapshot_SfM_Data(const SfM_Data & sfm_data);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SEQUENTIAL_SFM_CHECKPOINT_HPP
@@ -19,6 +19,7 @@
 //-----------------
 
 #include "openMVG/sfm/pipelines/pipelines_test.hpp"
+#include "openMVG/sfm/pipelines/sequential/sequential_SfM_checkpoint.hpp"
 #include "openMVG/sfm/sfm.hpp"
 
 #include "testing/testing.h"
@@ -26,6 +27,7 @@
 #include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <iterator>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -151,6 +153,93 @@ TEST(SEQUENTIAL_SFM, Partially_Known_Intrinsics) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+// Test that an interrupted reconstruction can be resumed from a checkpoint
+TEST(SEQUENTIAL_SFM, Checkpoint_Resume) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfM_Data sfm_data_2 = sfm_data;
+  sfm_data_2.poses.clear();
+  sfm_data_2.structure.clear();
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  const std::string sCheckpoint = stlplus::create_filespec("./", "sequential_checkpoint.bin");
+  Views::const_iterator iter_view_0 = sfm_data_2.GetViews().begin();
+  Views::const_iterator iter_view_1 = std::next(iter_view_0);
+
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data_2, "./");
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.setInitialPair({iter_view_0->second->id_view,
+                              iter_view_1->second->id_view});
+    sfmEngine.SetCheckpoint(sCheckpoint);
+    EXPECT_TRUE(sfmEngine.Process());
+  }
+
+  // The last checkpoint contains the final state of the resection loop
+  Sequential_SfM_Checkpoint checkpoint;
+  EXPECT_TRUE(Load_Checkpoint(checkpoint, sCheckpoint));
+  EXPECT_EQ(static_cast<std::size_t>(nviews), checkpoint.sfm_data.GetViews().size());
+  EXPECT_EQ(static_cast<std::size_t>(nviews), checkpoint.sfm_data.GetPoses().size());
+  EXPECT_TRUE(checkpoint.remaining_view_ids.empty());
+  EXPECT_TRUE(checkpoint.resection_group_index > 0);
+  // The tracks are saved once in their own file
+  openMVG::tracks::STLMAPTracks map_tracks;
+  EXPECT_TRUE(Load_Checkpoint_Tracks(map_tracks, sCheckpoint));
+  EXPECT_EQ(static_cast<std::size_t>(npoints), map_tracks.size());
+
+  // Simulate an interruption after the initial pair: keep only its two poses
+  // and the observations seen by them
+  for (const auto & view_it : checkpoint.sfm_data.GetViews())
+  {
+    const IndexT id_pose = view_it.second->id_pose;
+    if (id_pose != iter_view_0->second->id_pose &&
+        id_pose != iter_view_1->second->id_pose)
+    {
+      checkpoint.remaining_view_ids.insert(view_it.first);
+      checkpoint.sfm_data.poses.erase(id_pose);
+    }
+  }
+  eraseObservationsWithMissingPoses(checkpoint.sfm_data);
+  checkpoint.resection_group_index = 0;
+  EXPECT_TRUE(Save_Checkpoint(checkpoint, sCheckpoint));
+
+  // Resume: the remaining views are localized without recomputing the tracks
+  SequentialSfMReconstructionEngine sfmEngine(sfm_data_2, "./");
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+  EXPECT_TRUE(sfmEngine.ResumeFromCheckpoint(sCheckpoint));
+  EXPECT_TRUE(sfmEngine.Process());
+
+  const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+  std::cout << "RMSE residual: " << dResidual << std::endl;
+  EXPECT_TRUE( dResidual < 0.5);
+  EXPECT_TRUE( sfmEngine.Get_SfM_Data().GetPoses().size() == nviews);
+  EXPECT_TRUE( sfmEngine.Get_SfM_Data().GetLandmarks().size() == npoints);
+
+  stlplus::file_delete(sCheckpoint);
+  stlplus::file_delete(Checkpoint_Tracks_Filename(sCheckpoint));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -12,6 +12,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "openMVG/features/image_describer.hpp"
 #include "openMVG/features/regions_factory.hpp"
@@ -85,6 +86,12 @@ public:
     return ret;
   }
 
+  /// Hint the views whose regions will be requested next, in their request order
+  /// (nothing to do when all the regions are kept in memory)
+  virtual void prefetch(const std::vector<IndexT> & view_ids) const
+  {
+  }
+
   // Load Regions related to a provided SfM_Data View container
   virtual bool load(
     const SfM_Data & sfm_data,
@@ -11,63 +11,140 @@
 
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 
+#include <array>
 #include <atomic>
-#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openMVG {
 namespace sfm {
 
 /// Regions provider Cache
-/// Store only a given count of regions in memory
+/// Load the regions on demand and keep in memory only a bounded amount of them
+///  (bounded by an element count and/or a byte size).
+/// - The cache is split in shards (by view id) that are locked independently,
+///   and the files are read outside of the locks: the regions of different
+///   views are loaded in parallel.
+/// - A view is loaded only once: the concurrent requests of a view that is
+///   being loaded wait on the same loading future.
+/// - The least recently used regions that are no longer used externally are
+///   evicted first.
+/// - prefetch() loads the regions of the views that will be requested next in
+///   a background thread.
 struct Regions_Provider_Cache : public Regions_Provider
 {
 public:
 
+  /**
+  * @brief Constructor
+  * @param max_cache_size Maximal number of regions kept in memory (0: unbounded)
+  * @param max_cache_bytes Maximal size of the regions kept in memory in bytes
+  *  (0: unbounded)
+  */
   explicit Regions_Provider_Cache
   (
-    const unsigned int max_cache_size
+    const unsigned int max_cache_size,
+    const std::size_t max_cache_bytes = 0
   ): Regions_Provider(),
-     max_cache_size_(max_cache_size)
+     max_cache_size_(max_cache_size),
+     max_cache_bytes_(max_cache_bytes)
   {
   }
 
+  ~Regions_Provider_Cache() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      b_stop_prefetch_ = true;
+      prefetch_queue_.clear();
+    }
+    prefetch_condition_.notify_all();
+    if (prefetch_thread_.joinable())
+      prefetch_thread_.join();
+  }
+
   std::shared_ptr<features::Regions> get(const IndexT x) const override
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = cache_.find(x);
-    std::shared_ptr<features::Regions> ret;
+    Shard & shard = shards_[x % shards_.size()];
 
-    if (it == end(cache_))
+    // Find the view in the cache or register its loading future
+    std::promise<std::shared_ptr<features::Regions>> promise;
+    Regions_Future regions;
+    bool b_load = false;
     {
-      // Load the ressource link to this ID
-      const std::string id =
-        stlplus::create_filespec(feat_directory_, map_id_string_.at(x));
-      const std::string featFile = id + ".feat";
-      const std::string descFile = id + ".desc";
-      ret.reset(region_type_->EmptyClone());
-      if (ret->Load(featFile, descFile))
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.entries.find(x);
+      if (it == end(shard.entries))
+      {
+        Cache_Entry & entry = shard.entries[x];
+        entry.regions = promise.get_future().share();
+        entry.last_use = ++use_tick_;
+        regions = entry.regions;
+        ++cache_count_;
+        b_load = true;
+      }
+      else
       {
-        cache_[x] = ret;
+        it->second.last_use = ++use_tick_;
+        regions = it->second.regions;
       }
-      // else -> Invalid ressource -> an empty smart poiter is returned
     }
-    else
+
+    if (b_load)
     {
-      ret = it->second;
+      // Load the ressource link to this ID (outside of any lock)
+      std::shared_ptr<features::Regions> loaded = loadRegions(x);
+      promise.set_value(loaded);
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (loaded)
+        {
+          Cache_Entry & entry = shard.entries[x];
+          entry.bytes = loaded->MemorySize();
+          entry.b_loaded = true;
+          cache_bytes_ += entry.bytes;
+        }
+        else
+        {
+          // Invalid ressource -> an empty smart pointer is returned
+          //  and the view is not kept in the cache
+          shard.entries.erase(x);
+          --cache_count_;
+        }
+      }
     }
     // If the cache is too large:
     //  - try to prune elements that are no longer used
-    if (size() > max_cache_size_)
+    //  (the returned regions are referenced, so they are kept)
+    std::shared_ptr<features::Regions> ret = regions.get();
+    if (isFull())
     {
-      prune(true); // Prune only one cached object
+      prune();
     }
     return ret;
   }
 
+  /// Load in a background thread the regions of the provided views
+  /// (a new call replaces the views that are not loaded yet).
+  /// The prefetching stops while the cache is full.
+  void prefetch(const std::vector<IndexT> & view_ids) const override
+  {
+    {
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      prefetch_queue_.assign(view_ids.begin(), view_ids.end());
+      if (!prefetch_thread_.joinable())
+        prefetch_thread_ = std::thread(&Regions_Provider_Cache::prefetchLoop, this);
+    }
+    prefetch_condition_.notify_one();
+  }
+
   // Initialize the regions_provider_cache
   bool load
   (
@@ -77,7 +154,12 @@ public:
     C_Progress *
   ) override
   {
-    std::cout << "Initialization of the Regions_Provider_Cache. #Elements in the cache: "<< max_cache_size_ << std::endl;
+    std::cout << "Initialization of the Regions_Provider_Cache."
+      << " #Elements in the cache: "
+      << (max_cache_size_ == 0 ? std::string("unlimited") : std::to_string(max_cache_size_))
+      << ", cache size (bytes): "
+      << (max_cache_bytes_ == 0 ? std::string("unlimited") : std::to_string(max_cache_bytes_))
+      << std::endl;
 
     feat_directory_ = feat_directory;
     region_type_.reset(region_type->EmptyClone());
@@ -93,41 +175,138 @@ public:
     return true;
   }
 
+  /// Number of regions currently in the cache (loaded or being loaded)
+  std::size_t size() const { return cache_count_; }
+
+  /// Size in bytes of the regions currently loaded in the cache
+  std::size_t memorySize() const { return cache_bytes_; }
+
 private:
 
-  mutable std::mutex mutex_; // To deal with multithread concurrent access
+  using Regions_Future = std::shared_future<std::shared_ptr<features::Regions>>;
+
+  struct Cache_Entry
+  {
+    Regions_Future regions;
+    std::size_t bytes = 0;
+    bool b_loaded = false;    // false while the regions are being loaded
+    uint64_t last_use = 0;    // Access tick (for the LRU eviction)
+  };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    std::map<IndexT, Cache_Entry> entries;
+  };
+
+  mutable std::array<Shard, 16> shards_;
+  mutable std::atomic<uint64_t> use_tick_{0};
+  mutable std::atomic<std::size_t> cache_count_{0};
+  mutable std::atomic<std::size_t> cache_bytes_{0};
 
   std::string feat_directory_; // The regions file directory
   std::map<openMVG::IndexT, std::string> map_id_string_; // association of the view id & its basename
   const unsigned int max_cache_size_;
+  const std::size_t max_cache_bytes_;
+
+  // Prefetching
+  mutable std::mutex prefetch_mutex_;
+  mutable std::condition_variable prefetch_condition_;
+  mutable std::deque<IndexT> prefetch_queue_;
+  mutable std::thread prefetch_thread_;
+  mutable bool b_stop_prefetch_ = false;
 
 private:
 
-  /// @brief Prune smart_ptr that are only referenced into the cache (not longer used externally)
+  /// Read the regions of a view (nullptr on failure)
+  std::shared_ptr<features::Regions> loadRegions(const IndexT x) const
+  {
+    const auto it = map_id_string_.find(x);
+    if (it == map_id_string_.end())
+      return nullptr;
+    const std::string id = stlplus::create_filespec(feat_directory_, it->second);
+    std::shared_ptr<features::Regions> regions(region_type_->EmptyClone());
+    if (!regions->Load(id + ".feat", id + ".desc"))
+      return nullptr;
+    return regions;
+  }
+
+  bool isFull() const
+  {
+    return (max_cache_size_ > 0 && cache_count_ > max_cache_size_)
+      || (max_cache_bytes_ > 0 && cache_bytes_ > max_cache_bytes_);
+  }
+
+  /// @brief Evict the least recently used regions that are only referenced
+  ///  into the cache (not longer used externally) until the cache fits its budget
   /// @return the number of removed elements
-  std::size_t prune(bool bPruneOnlyOne = false) const
+  std::size_t prune() const
   {
     std::size_t count = 0;
-    for (auto it = begin(cache_); it != end(cache_);)
+    while (isFull())
     {
-      if (it->second.use_count() == 1)
+      // Find the least recently used candidate
+      Shard * candidate_shard = nullptr;
+      IndexT candidate_id = UndefinedIndexT;
+      uint64_t candidate_use = std::numeric_limits<uint64_t>::max();
+      for (Shard & shard : shards_)
       {
-        cache_.erase(it++);
-        ++count;
-        if (bPruneOnlyOne)
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto & entry_it : shard.entries)
         {
-          break;
+          if (entry_it.second.last_use < candidate_use && isUnused(entry_it.second))
+          {
+            candidate_shard = &shard;
+            candidate_id = entry_it.first;
+            candidate_use = entry_it.second.last_use;
+          }
         }
       }
-      else
+      if (!candidate_shard)
+        break; // All the cached regions are in use
+
+      // Evict it if it was not used meanwhile
+      std::lock_guard<std::mutex> lock(candidate_shard->mutex);
+      const auto it = candidate_shard->entries.find(candidate_id);
+      if (it != end(candidate_shard->entries)
+          && it->second.last_use == candidate_use
+          && isUnused(it->second))
       {
-        ++it;
+        cache_bytes_ -= it->second.bytes;
+        --cache_count_;
+        candidate_shard->entries.erase(it);
+        ++count;
       }
     }
     return count;
   }
 
-  std::size_t size() const { return cache_.size(); }
+  /// Return true if the entry is loaded and no longer used externally
+  static bool isUnused(const Cache_Entry & entry)
+  {
+    return entry.b_loaded && entry.regions.get().use_count() == 1;
+  }
+
+  /// Background loading of the prefetched views
+  void prefetchLoop() const
+  {
+    while (true)
+    {
+      IndexT view_id;
+      {
+        std::unique_lock<std::mutex> lock(prefetch_mutex_);
+        prefetch_condition_.wait(lock, [&]{ return b_stop_prefetch_ || !prefetch_queue_.empty(); });
+        if (b_stop_prefetch_)
+          return;
+        view_id = prefetch_queue_.front();
+        prefetch_queue_.pop_front();
+      }
+      // Do not evict some regions to load the ones that are not requested yet
+      if (isFull() || (max_cache_size_ > 0 && cache_count_ >= max_cache_size_))
+        continue;
+      get(view_id);
+    }
+  }
 
 }; // Regions_Provider_Cache
 
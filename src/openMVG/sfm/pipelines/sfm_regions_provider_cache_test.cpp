@@ -0,0 +1,134 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/sfm/pipelines/sfm_regions_provider_cache.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include "testing/testing.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::features;
+using namespace openMVG::sfm;
+
+// Write the regions of viewsCount views (view i has i+1 regions)
+SfM_Data create_test_regions(IndexT viewsCount, const std::string & sDir)
+{
+  stlplus::folder_create(sDir);
+  SfM_Data sfm_data;
+  for (IndexT i = 0; i < viewsCount; ++i)
+  {
+    const std::string basename = std::to_string(i);
+    sfm_data.views[i] = std::make_shared<View>(basename + ".jpg", i, 0, i, 100, 100);
+
+    SIFT_Regions regions;
+    for (IndexT j = 0; j <= i; ++j)
+    {
+      regions.Features().emplace_back(j, i, 1.f, 0.f);
+      SIFT_Regions::DescriptorT desc;
+      desc.fill(static_cast<unsigned char>(i));
+      regions.Descriptors().push_back(desc);
+    }
+    regions.Save(
+      stlplus::create_filespec(sDir, basename, ".feat"),
+      stlplus::create_filespec(sDir, basename, ".desc"));
+  }
+  return sfm_data;
+}
+
+TEST(Regions_Provider_Cache, ConcurrentGet)
+{
+  const std::string sDir = "regions_cache_concurrent";
+  const IndexT viewsCount = 8;
+  const SfM_Data sfm_data = create_test_regions(viewsCount, sDir);
+
+  std::unique_ptr<Regions> region_type(new SIFT_Regions);
+  Regions_Provider_Cache regions_provider(viewsCount);
+  EXPECT_TRUE(regions_provider.load(sfm_data, sDir, region_type, nullptr));
+
+  // Concurrent requests of the same views share a single instance
+  std::vector<std::shared_ptr<Regions>> results(4 * viewsCount);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]{
+      for (IndexT i = 0; i < viewsCount; ++i)
+        results[t * viewsCount + i] = regions_provider.get(i);
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+
+  for (IndexT i = 0; i < viewsCount; ++i)
+  {
+    for (size_t t = 0; t < 4; ++t)
+    {
+      EXPECT_TRUE(results[t * viewsCount + i] != nullptr);
+      EXPECT_TRUE(results[t * viewsCount + i] == results[i]);
+    }
+    EXPECT_EQ(i + 1, results[i]->RegionCount());
+  }
+  EXPECT_EQ(viewsCount, regions_provider.size());
+
+  // Invalid resource
+  EXPECT_TRUE(regions_provider.get(viewsCount) == nullptr);
+  EXPECT_EQ(viewsCount, regions_provider.size());
+
+  stlplus::folder_delete(sDir, true);
+}
+
+TEST(Regions_Provider_Cache, ByteBudgetEviction)
+{
+  const std::string sDir = "regions_cache_eviction";
+  const IndexT viewsCount = 8;
+  const SfM_Data sfm_data = create_test_regions(viewsCount, sDir);
+
+  // Budget for the regions of the two last views
+  size_t budget = 0;
+  {
+    std::unique_ptr<Regions> region_type(new SIFT_Regions);
+    Regions_Provider_Cache unbounded_provider(0);
+    unbounded_provider.load(sfm_data, sDir, region_type, nullptr);
+    budget = unbounded_provider.get(viewsCount - 1)->MemorySize()
+      + unbounded_provider.get(viewsCount - 2)->MemorySize();
+  }
+
+  std::unique_ptr<Regions> region_type(new SIFT_Regions);
+  Regions_Provider_Cache regions_provider(0, budget);
+  regions_provider.load(sfm_data, sDir, region_type, nullptr);
+
+  // The regions in use are never evicted
+  std::vector<std::shared_ptr<Regions>> in_use;
+  for (IndexT i = 0; i < viewsCount; ++i)
+    in_use.push_back(regions_provider.get(i));
+  EXPECT_EQ(viewsCount, regions_provider.size());
+  in_use.clear();
+
+  // The least recently used regions are evicted first
+  for (IndexT i = 0; i < viewsCount; ++i)
+    regions_provider.get(i);
+  EXPECT_TRUE(regions_provider.memorySize() <= budget);
+  EXPECT_EQ(2, regions_provider.size());
+  EXPECT_EQ(viewsCount, regions_provider.get(viewsCount - 1)->RegionCount());
+
+  // Prefetching stops when the cache is full
+  regions_provider.prefetch({0, 1, 2});
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(regions_provider.memorySize() <= budget);
+
+  stlplus::folder_delete(sDir, true);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,262 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// The <cereal/archives> headers are special and must be included first.
+#include <cereal/archives/portable_binary.hpp>
+
+#include "openMVG/sfm/pipelines/sfm_relative_pose_store.hpp"
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/features/feature.hpp"
+#include "openMVG/geometry/pose3_io.hpp"
+#include "openMVG/multiview/essential.hpp"
+#include "openMVG/multiview/solver_essential_eight_point.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
+#include "openMVG/sfm/pipelines/sfm_robust_model_estimation.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include <cereal/types/map.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+template <class Archive>
+void openMVG::sfm::Relative_Pose_Entry::serialize( Archive & ar )
+{
+  ar(is_valid,
+     relative_pose,
+     refined_pose,
+     is_refined,
+     putative_count,
+     matches_hash,
+     found_residual_precision);
+}
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+
+uint64_t Hash_Matches(const matching::IndMatches & matches)
+{
+  // 64 bit FNV-1a hash of the little endian bytes of the match count & indices
+  uint64_t hash = 14695981039346656037ULL;
+  const auto hash_value = [&hash](const uint64_t value, const int byte_count)
+  {
+    for (int i = 0; i < byte_count; ++i)
+    {
+      hash ^= (value >> (8 * i)) & 0xFF;
+      hash *= 1099511628211ULL;
+    }
+  };
+  hash_value(matches.size(), 8);
+  for (const matching::IndMatch & match : matches)
+  {
+    hash_value(match.i_, 4);
+    hash_value(match.j_, 4);
+  }
+  return hash;
+}
+
+bool Relative_Pose_Store::Get
+(
+  const Pair & pair,
+  const matching::IndMatches & matches,
+  Relative_Pose_Entry & entry
+) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = entries_.find(pair);
+  if (it == entries_.end() ||
+      it->second.putative_count != matches.size() ||
+      it->second.matches_hash != Hash_Matches(matches))
+  {
+    return false;
+  }
+  entry = it->second;
+  return true;
+}
+
+void Relative_Pose_Store::Set
+(
+  const Pair & pair,
+  const Relative_Pose_Entry & entry
+)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[pair] = entry;
+}
+
+std::size_t Relative_Pose_Store::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+bool Relative_Pose_Store::Load(const std::string & filename)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+  try
+  {
+    cereal::PortableBinaryInputArchive archive(stream);
+    archive(cereal::make_nvp("relative_poses", entries_));
+  }
+  catch (const cereal::Exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    entries_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool Relative_Pose_Store::Save(const std::string & filename) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+  {
+    cereal::PortableBinaryOutputArchive archive(stream);
+    archive(cereal::make_nvp("relative_poses", entries_));
+  }
+  return stream.good();
+}
+
+bool Compute_Relative_Pose_Entry
+(
+  const IntrinsicBase * cam_I,
+  const IntrinsicBase * cam_J,
+  const Features_Provider & features_provider,
+  const Pair & pair,
+  const matching::IndMatches & matches,
+  const std::size_t max_iteration_count,
+  Relative_Pose_Entry & entry
+)
+{
+  entry = Relative_Pose_Entry();
+  entry.putative_count = matches.size();
+  entry.matches_hash = Hash_Matches(matches);
+
+  if (!cam_I || !cam_J)
+    return false;
+
+  const features::PointFeatures
+    & feats_I = features_provider.feats_per_view.at(pair.first),
+    & feats_J = features_provider.feats_per_view.at(pair.second);
+
+  // Compute for each feature the un-distorted camera coordinates
+  Mat x1(2, matches.size()), x2(2, matches.size());
+  for (size_t k = 0; k < matches.size(); ++k)
+  {
+    x1.col(k) = cam_I->get_ud_pixel(feats_I[matches[k].i_].coords().cast<double>());
+    x2.col(k) = cam_J->get_ud_pixel(feats_J[matches[k].j_].coords().cast<double>());
+  }
+
+  // No residual upper bound: the AContrario threshold is kept in the entry
+  RelativePose_Info relativePose_info;
+  if (!robustRelativePose(cam_I, cam_J,
+                          x1, x2, relativePose_info,
+                          {cam_I->w(), cam_I->h()},
+                          {cam_J->w(), cam_J->h()},
+                          max_iteration_count))
+  {
+    return false;
+  }
+
+  entry.is_valid = true;
+  entry.relative_pose = relativePose_info.relativePose;
+  entry.found_residual_precision = relativePose_info.found_residual_precision;
+  return true;
+}
+
+bool Relative_Pose_Inliers
+(
+  const IntrinsicBase * cam_I,
+  const IntrinsicBase * cam_J,
+  const Features_Provider & features_provider,
+  const Pair & pair,
+  const matching::IndMatches & matches,
+  const Relative_Pose_Entry & entry,
+  const double residual_tolerance,
+  std::vector<uint32_t> & vec_inliers,
+  double & median_angle
+)
+{
+  vec_inliers.clear();
+  median_angle = 0.0;
+  if (!entry.is_valid || !cam_I || !cam_J)
+    return false;
+
+  const features::PointFeatures
+    & feats_I = features_provider.feats_per_view.at(pair.first),
+    & feats_J = features_provider.feats_per_view.at(pair.second);
+
+  const Pose3 pose_I(Mat3::Identity(), Vec3::Zero());
+  const Pose3 & pose_J = entry.relative_pose;
+  Mat3 E;
+  EssentialFromRt(pose_I.rotation(), pose_I.translation(),
+                  pose_J.rotation(), pose_J.translation(), &E);
+
+  // Use the residual of the robust estimation (see robustRelativePose)
+  const bool b_pinhole = isPinhole(cam_I->getType()) && isPinhole(cam_J->getType());
+  const double threshold = std::min(entry.found_residual_precision, residual_tolerance);
+  Mat3 F;
+  if (b_pinhole)
+  {
+    FundamentalFromEssential(E,
+      dynamic_cast<const Pinhole_Intrinsic*>(cam_I)->K(),
+      dynamic_cast<const Pinhole_Intrinsic*>(cam_J)->K(), &F);
+  }
+
+  std::vector<float> vec_angles;
+  for (size_t k = 0; k < matches.size(); ++k)
+  {
+    const Vec2
+      x1 = cam_I->get_ud_pixel(feats_I[matches[k].i_].coords().cast<double>()),
+      x2 = cam_J->get_ud_pixel(feats_J[matches[k].j_].coords().cast<double>());
+    const double residual = b_pinhole ?
+      fundamental::kernel::EpipolarDistanceError::Error(F, x1, x2) :
+      R2D(AngularError::Error(E, (*cam_I)(x1), (*cam_J)(x2)));
+    if (residual <= threshold)
+    {
+      vec_inliers.push_back(k);
+      vec_angles.push_back(AngleBetweenRay(pose_I, cam_I, pose_J, cam_J, x1, x2));
+    }
+  }
+  if (!vec_angles.empty())
+  {
+    const size_t median_index = vec_angles.size() / 2;
+    std::nth_element(
+      vec_angles.begin(),
+      vec_angles.begin() + median_index,
+      vec_angles.end());
+    median_angle = vec_angles[median_index];
+  }
+
+  // Minimal sample size of the 5 point (pinhole) or 8 point solver
+  const size_t minimum_samples = b_pinhole ? 5 : 8;
+  return vec_inliers.size() >= 2.5 * minimum_samples;
+}
+
+} // namespace sfm
+} // namespace openMVG
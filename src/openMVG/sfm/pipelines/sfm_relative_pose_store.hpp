@@ -0,0 +1,163 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_RELATIVE_POSE_STORE_HPP
+#define OPENMVG_SFM_SFM_RELATIVE_POSE_STORE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/types.hpp"
+
+namespace openMVG { namespace cameras { struct IntrinsicBase; } }
+namespace openMVG { namespace sfm { struct Features_Provider; } }
+
+namespace openMVG {
+namespace sfm {
+
+/// Result of a two-view relative motion estimation for a pair of views.
+/// The estimation is run on the putative pairwise matches of the pair without
+/// residual upper bound, so the entry does not depend on the residual tolerance
+/// of the SfM engine that computed it: the engines list the inliers for their
+/// own tolerance with Relative_Pose_Inliers.
+/// Failed estimations are stored too, so they are not tried again.
+/// An entry is up to date only for the matches it was computed on (see matches_hash).
+struct Relative_Pose_Entry
+{
+  bool is_valid;                   // False if the robust estimation failed
+  geometry::Pose3 relative_pose;   // Robustly estimated pose of J relative to I
+  geometry::Pose3 refined_pose;    // Two-view BA refined pose of J relative to I
+  bool is_refined;                 // True if refined_pose is valid
+  uint32_t putative_count;         // #matches used for the estimation
+  uint64_t matches_hash;           // Hash of the match indices used for the estimation
+  // AContrario threshold of the estimation: squared epipolar distance (pixels)
+  //  for pinhole cameras, angular error (degree) otherwise
+  double found_residual_precision;
+
+  Relative_Pose_Entry()
+    :is_valid(false),
+    is_refined(false),
+    putative_count(0),
+    matches_hash(0),
+    found_residual_precision(std::numeric_limits<double>::infinity())
+  {}
+
+  template <class Archive>
+  void serialize( Archive & ar );
+};
+
+/// Hash of the feature indices of a set of pairwise matches.
+/// A FNV-1a hash is used so the stored values do not depend on the platform.
+uint64_t Hash_Matches(const matching::IndMatches & matches);
+
+/// Pair indexed persistent store of relative motions.
+/// It allows to share the two-view estimations between the SfM engines
+/// and between successive runs on the same matches.
+/// Thread safe: Get/Set can be called concurrently.
+class Relative_Pose_Store
+{
+public:
+
+  /**
+  * @brief Retrieve a stored relative motion.
+  * @param[in] pair the view pair
+  * @param[in] matches the current putative matches of the pair. An entry that
+  *  was computed on other matches is considered as outdated.
+  * @param[out] entry the stored relative motion
+  * @return true if an up to date entry exists. The stored estimation can be
+  *  a failed one (see Relative_Pose_Entry::is_valid).
+  */
+  bool Get
+  (
+    const Pair & pair,
+    const matching::IndMatches & matches,
+    Relative_Pose_Entry & entry
+  ) const;
+
+  /// Add or replace the relative motion of a pair
+  void Set(const Pair & pair, const Relative_Pose_Entry & entry);
+
+  std::size_t size() const;
+
+  /// Load the store from a binary file (.bin)
+  bool Load(const std::string & filename);
+
+  /// Save the store to a binary file (.bin)
+  bool Save(const std::string & filename) const;
+
+private:
+  std::map<Pair, Relative_Pose_Entry> entries_;
+  mutable std::mutex mutex_; // To deal with multithread concurrent access
+};
+
+/**
+* @brief Robustly estimate the relative motion of a view pair from its
+*  putative pairwise matches (without residual upper bound).
+*
+* @param[in] cam_I camera I intrinsics
+* @param[in] cam_J camera J intrinsics
+* @param[in] features_provider features of the views
+* @param[in] pair the view pair (I,J)
+* @param[in] matches the putative pairwise matches of (I,J)
+* @param[in] max_iteration_count max iteration count of the robust estimation
+* @param[out] entry the estimated relative motion
+* @return true if the relative motion is valid
+*/
+bool Compute_Relative_Pose_Entry
+(
+  const cameras::IntrinsicBase * cam_I,
+  const cameras::IntrinsicBase * cam_J,
+  const Features_Provider & features_provider,
+  const Pair & pair,
+  const matching::IndMatches & matches,
+  const std::size_t max_iteration_count,
+  Relative_Pose_Entry & entry
+);
+
+/**
+* @brief List the inliers of a relative motion for a residual tolerance.
+* A match is an inlier if its residual to the estimated relative motion is
+*  below both the AContrario threshold of the entry and the tolerance.
+*
+* @param[in] cam_I camera I intrinsics
+* @param[in] cam_J camera J intrinsics
+* @param[in] features_provider features of the views
+* @param[in] pair the view pair (I,J)
+* @param[in] matches the putative pairwise matches the entry was computed on
+* @param[in] entry a valid relative motion
+* @param[in] residual_tolerance upper bound of the residual (same unit as
+*  Relative_Pose_Entry::found_residual_precision)
+* @param[out] vec_inliers the inlier indices in matches
+* @param[out] median_angle median triangulation angle of the inliers (degree)
+* @return true if the inliers support the relative motion (as many inliers as
+*  required by robustRelativePose)
+*/
+bool Relative_Pose_Inliers
+(
+  const cameras::IntrinsicBase * cam_I,
+  const cameras::IntrinsicBase * cam_J,
+  const Features_Provider & features_provider,
+  const Pair & pair,
+  const matching::IndMatches & matches,
+  const Relative_Pose_Entry & entry,
+  const double residual_tolerance,
+  std::vector<uint32_t> & vec_inliers,
+  double & median_angle
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_RELATIVE_POSE_STORE_HPP
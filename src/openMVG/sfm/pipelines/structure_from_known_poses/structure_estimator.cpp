@@ -31,12 +31,6 @@ using namespace openMVG::features;
 using namespace openMVG::geometry;
 using namespace openMVG::matching;
 
-/// Camera pair epipole (Projection of camera center 2 in the image plane 1)
-inline Vec3 epipole_from_P(const Mat34& P1, const Pose3& P2)
-{
-  return P1 * P2.center().homogeneous();
-}
-
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 /// Use the camera intrinsics in order to get undistorted pixel coordinates
 template<typename MatT >
@@ -142,18 +136,14 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
           vec_corresponding_indexes
         );
     #else
-      const Vec3 epipole2  = epipole_from_P(P_R, poseL);
-
-      geometry_aware::GuidedMatching_Fundamental_Fast
+      geometry_aware::GuidedMatching_Fundamental_Grid
         <openMVG::fundamental::kernel::EpipolarDistanceError>
         (
           F_lr,
-          epipole2,
           iterIntrinsicL->second.get(),
           *regionsL.get(),
           iterIntrinsicR->second.get(),
           *regionsR.get(),
-          iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
           Square(thresholdF), Square(0.8),
           vec_corresponding_indexes
         );
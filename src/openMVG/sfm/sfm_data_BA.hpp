@@ -10,6 +10,9 @@
 #define OPENMVG_SFM_SFM_DATA_BA_HPP
 
 #include "openMVG/cameras/Camera_Common.hpp"
+#include "openMVG/types.hpp"
+
+#include <set>
 
 namespace openMVG {
 namespace sfm {
@@ -53,6 +56,8 @@ struct Optimize_Options
   Structure_Parameter_Type structure_opt;
   Control_Point_Parameter control_point_opt;
   bool use_motion_priors_opt;
+  // Poses held constant whatever extrinsics_opt (i.e. the oldest keyframes of a sliding window)
+  std::set<IndexT> constant_pose_ids;
 
   Optimize_Options
   (
@@ -23,6 +23,7 @@
 #include "openMVG/sfm/sfm_data_BA_ceres_camera_functor.hpp"
 #include "openMVG/sfm/sfm_data_transform.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/types.hpp"
 
 #include <ceres/rotation.h>
@@ -119,7 +120,8 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
   bPerIterationLogging_(false),
   nb_threads_(1),
   parameter_tolerance_(1e-8), //~= numeric_limits<float>::epsilon()
-  bUse_loss_function_(true)
+  bUse_loss_function_(true),
+  max_num_iterations_(100)
 {
   #ifdef OPENMVG_USE_OPENMP
     nb_threads_ = omp_get_max_threads();
@@ -175,6 +177,7 @@ bool Bundle_Adjustment_Ceres::Adjust
   const Optimize_Options & options
 )
 {
+  OPENMVG_PROFILE_ZONE("bundle_adjustment");
   //----------
   // Add camera parameters
   // - intrinsics
@@ -264,7 +267,8 @@ bool Bundle_Adjustment_Ceres::Adjust
 
     double * parameter_block = &map_poses.at(indexPose)[0];
     problem.AddParameterBlock(parameter_block, 6);
-    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE)
+    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE
+        || options.constant_pose_ids.count(indexPose))
     {
       // set the whole parameter block as constant for best performance
       problem.SetParameterBlockConstant(parameter_block);
@@ -462,7 +466,7 @@ bool Bundle_Adjustment_Ceres::Adjust
   // Configure a BA engine and run it
   //  Make Ceres automatically detect the bundle structure.
   ceres::Solver::Options ceres_config_options;
-  ceres_config_options.max_num_iterations = 100;
+  ceres_config_options.max_num_iterations = ceres_options_.max_num_iterations_;
   ceres_config_options.preconditioner_type =
     static_cast<ceres::PreconditionerType>(ceres_options_.preconditioner_type_);
   ceres_config_options.linear_solver_type =
@@ -8,9 +8,13 @@
 
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
-#include "openMVG/stl/stl.hpp"
+#include "openMVG/sfm/sfm_landmark_columns.hpp"
 #include "openMVG/tracks/union_find.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
 #include <utility>
 
 namespace openMVG {
@@ -43,63 +47,48 @@ IndexT RemoveOutliers_PixelResidualError
   const unsigned int minTrackLength
 )
 {
-  IndexT outlier_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
-  {
-    Observations & obs = iterTracks->second.obs;
-    Observations::iterator itObs = obs.begin();
-    while (itObs != obs.end())
+  const Landmarks_Columns columns(sfm_data.structure);
+  const Landmarks_Selection selection = Select_Observations(columns,
+    [&](IndexT landmark_index, uint64_t obs_index)
     {
-      const View * view = sfm_data.views.at(itObs->first).get();
+      const View * view = sfm_data.views.at(columns.view_ids[obs_index]).get();
       const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view);
       const cameras::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->id_intrinsic).get();
-      const Vec2 residual = intrinsic->residual(pose(iterTracks->second.X), itObs->second.x);
-      if (residual.norm() > dThresholdPixel)
-      {
-        ++outlier_count;
-        itObs = obs.erase(itObs);
-      }
-      else
-        ++itObs;
-    }
-    if (obs.empty() || obs.size() < minTrackLength)
-      iterTracks = sfm_data.structure.erase(iterTracks);
-    else
-      ++iterTracks;
-  }
-  return outlier_count;
+      const Vec2 residual = intrinsic->residual(pose(columns.X[landmark_index]), columns.x[obs_index]);
+      return residual.norm() <= dThresholdPixel;
+    },
+    std::max(1u, minTrackLength));
+  Erase_Unselected(columns, selection, sfm_data.structure);
+  return selection.removed_observations;
 }
 
 void CalculateResidualError(SfM_Data &sfm_data,
                             double &meanError, double &stddevError)
 {
    meanError = stddevError = 0.0;
-   std::size_t count = 0;
 
-   Landmarks::iterator iterTracks = sfm_data.structure.begin();
-   while (iterTracks != sfm_data.structure.end())
+   const Landmarks_Columns columns(sfm_data.structure);
+   const std::size_t count = columns.ObservationCount();
+   double sum = 0.0, sum_squared = 0.0;
+#ifdef OPENMVG_USE_OPENMP
+   #pragma omp parallel for schedule(dynamic, 256) reduction(+:sum, sum_squared)
+#endif
+   for (int i = 0; i < static_cast<int>(columns.LandmarkCount()); ++i)
    {
-     Observations & obs = iterTracks->second.obs;
-     Observations::iterator itObs = obs.begin();
-     while (itObs != obs.end())
+     for (uint64_t j = columns.track_offsets[i]; j < columns.track_offsets[i + 1]; ++j)
      {
-       const View * view = sfm_data.views.at(itObs->first).get();
+       const View * view = sfm_data.views.at(columns.view_ids[j]).get();
        const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view);
        const cameras::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->id_intrinsic).get();
-       double residual = intrinsic->residual(pose(iterTracks->second.X), itObs->second.x).norm();
+       const double residual = intrinsic->residual(pose(columns.X[i]), columns.x[j]).norm();
 
-       meanError += residual;
-       stddevError += residual*residual;
-       count++;
-
-       ++itObs;
+       sum += residual;
+       sum_squared += residual*residual;
      }
-     ++iterTracks;
    }
 
-   meanError /= count;
-   stddevError = std::sqrt(stddevError / count - meanError*meanError);
+   meanError = sum / count;
+   stddevError = std::sqrt(sum_squared / count - meanError*meanError);
 }
 
 void DecoupleViews(SfM_Data &sfm_data)
@@ -141,42 +130,35 @@ IndexT RemoveOutliers_AngleError
   const double dMinAcceptedAngle
 )
 {
-  IndexT removedTrack_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
-  {
-    Observations & obs = iterTracks->second.obs;
-    double max_angle = 0.0;
-    for (Observations::const_iterator itObs1 = obs.begin();
-      itObs1 != obs.end(); ++itObs1)
+  const Landmarks_Columns columns(sfm_data.structure);
+  const Landmarks_Selection selection = Select_Landmarks(columns,
+    [&](IndexT landmark_index)
     {
-      const View * view1 = sfm_data.views.at(itObs1->first).get();
-      const geometry::Pose3 pose1 = sfm_data.GetPoseOrDie(view1);
-      const cameras::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->id_intrinsic).get();
-
-      Observations::const_iterator itObs2 = itObs1;
-      ++itObs2;
-      for (; itObs2 != obs.end(); ++itObs2)
+      const uint64_t track_begin = columns.track_offsets[landmark_index];
+      const uint64_t track_end = columns.track_offsets[landmark_index + 1];
+      double max_angle = 0.0;
+      for (uint64_t obs1 = track_begin; obs1 < track_end; ++obs1)
       {
-        const View * view2 = sfm_data.views.at(itObs2->first).get();
-        const geometry::Pose3 pose2 = sfm_data.GetPoseOrDie(view2);
-        const cameras::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->id_intrinsic).get();
-
-        const double angle = AngleBetweenRay(
-          pose1, intrinsic1, pose2, intrinsic2,
-          itObs1->second.x, itObs2->second.x);
-        max_angle = std::max(angle, max_angle);
+        const View * view1 = sfm_data.views.at(columns.view_ids[obs1]).get();
+        const geometry::Pose3 pose1 = sfm_data.GetPoseOrDie(view1);
+        const cameras::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->id_intrinsic).get();
+
+        for (uint64_t obs2 = obs1 + 1; obs2 < track_end; ++obs2)
+        {
+          const View * view2 = sfm_data.views.at(columns.view_ids[obs2]).get();
+          const geometry::Pose3 pose2 = sfm_data.GetPoseOrDie(view2);
+          const cameras::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->id_intrinsic).get();
+
+          const double angle = AngleBetweenRay(
+            pose1, intrinsic1, pose2, intrinsic2,
+            columns.x[obs1], columns.x[obs2]);
+          max_angle = std::max(angle, max_angle);
+        }
       }
-    }
-    if (max_angle < dMinAcceptedAngle)
-    {
-      iterTracks = sfm_data.structure.erase(iterTracks);
-      ++removedTrack_count;
-    }
-    else
-      ++iterTracks;
-  }
-  return removedTrack_count;
+      return max_angle >= dMinAcceptedAngle;
+    });
+  Erase_Unselected(columns, selection, sfm_data.structure);
+  return selection.removed_landmarks;
 }
 
 bool eraseMissingPoses
@@ -225,37 +207,24 @@ bool eraseObservationsWithMissingPoses
   const IndexT min_points_per_landmark
 )
 {
-  IndexT removed_elements = 0;
-
-  std::set<IndexT> pose_Index;
-  std::transform(sfm_data.poses.cbegin(), sfm_data.poses.cend(),
-    std::inserter(pose_Index, pose_Index.begin()), stl::RetrieveKey());
+  // Tell for each view if its pose is defined
+  Hash_Map<IndexT, bool> view_has_pose;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    view_has_pose[view_it.first] = sfm_data.poses.count(view_it.second->id_pose) > 0;
+  }
 
   // For each landmark:
   //  - Check if we need to keep the observations & the track
-  Landmarks::iterator itLandmarks = sfm_data.structure.begin();
-  while (itLandmarks != sfm_data.structure.end())
-  {
-    Observations & obs = itLandmarks->second.obs;
-    Observations::iterator itObs = obs.begin();
-    while (itObs != obs.end())
+  const Landmarks_Columns columns(sfm_data.structure);
+  const Landmarks_Selection selection = Select_Observations(columns,
+    [&](IndexT, uint64_t obs_index)
     {
-      const IndexT ViewId = itObs->first;
-      const View * v = sfm_data.GetViews().at(ViewId).get();
-      if (pose_Index.count(v->id_pose) == 0)
-      {
-        itObs = obs.erase(itObs);
-        ++removed_elements;
-      }
-      else
-        ++itObs;
-    }
-    if (obs.empty() || obs.size() < min_points_per_landmark)
-      itLandmarks = sfm_data.structure.erase(itLandmarks);
-    else
-      ++itLandmarks;
-  }
-  return removed_elements > 0;
+      return view_has_pose.at(columns.view_ids[obs_index]);
+    },
+    std::max<IndexT>(1, min_points_per_landmark));
+  Erase_Unselected(columns, selection, sfm_data.structure);
+  return selection.removed_observations > 0;
 }
 
 /// Remove unstable content from analysis of the sfm_data structure
@@ -286,6 +255,54 @@ bool eraseUnstablePosesAndObservations
   return remove_iteration > 0;
 }
 
+/// Implement a statistical Structure filter that remove 3D points that have
+/// a depth that is too large (threshold computed as factor * median ~= X84)
+double DepthCleaning
+(
+  SfM_Data & sfm_data,
+  const double k_factor,
+  const IndexT k_min_point_per_pose,
+  const IndexT k_min_track_length
+)
+{
+  // For each observation compute the camera/point depth
+  const Landmarks_Columns columns(sfm_data.structure);
+  const std::vector<double> depths = Compute_Observation_Depths(sfm_data, columns);
+
+  // Compute the depth threshold for each view: factor * medianDepth
+  Hash_Map<IndexT, double> map_median_depth = Compute_Per_View_Median(columns, depths);
+  double min_median_value = std::numeric_limits<double>::max();
+  for (auto & median_it : map_median_depth)
+  {
+    min_median_value = std::min(min_median_value, median_it.second);
+    median_it.second *= k_factor;
+  }
+
+  // Delete invalid observations
+  // (the observations of the views with no pose are removed but not counted)
+  IndexT undefined_pose_count = 0;
+  for (const double depth : depths)
+    undefined_pose_count += std::isnan(depth);
+  const Landmarks_Selection selection = Select_Observations(columns,
+    [&](IndexT, uint64_t obs_index)
+    {
+      const double depth = depths[obs_index];
+      if (!(depth > 0))
+        return false;
+      const auto it = map_median_depth.find(columns.view_ids[obs_index]);
+      return it != map_median_depth.end() && depth < it->second;
+    });
+  Erase_Unselected(columns, selection, sfm_data.structure);
+  std::cout << "#point depth filter: "
+    << selection.removed_observations - undefined_pose_count
+    << " measurements removed" << std::endl;
+
+  // Remove orphans
+  eraseUnstablePosesAndObservations(sfm_data, k_min_point_per_pose, k_min_track_length);
+
+  return min_median_value;
+}
+
 /// Tell if the sfm_data structure is one CC or not
 bool IsTracksOneCC
 (
@@ -91,6 +91,23 @@ bool eraseUnstablePosesAndObservations
   const IndexT min_points_per_landmark = 2
 );
 
+/**
+* @brief Implement a statistical Structure filter that remove 3D points that have:
+* - a depth that is too large (threshold computed as factor * median ~= X84)
+* @param sfm_data The sfm scene to filter (inplace filtering)
+* @param k_factor The factor applied to the median depth per view
+* @param k_min_point_per_pose Keep only poses that have at least this amount of points
+* @param k_min_track_length Keep only tracks that have at least this length
+* @return The min_median_value observed for all the view
+*/
+double DepthCleaning
+(
+  SfM_Data & sfm_data,
+  const double k_factor = 5.2,             // 5.2 * median ~= X84
+  const IndexT k_min_point_per_pose = 12,  // 6 min
+  const IndexT k_min_track_length = 2      // 2 min
+);
+
 /// Tell if the sfm_data structure is one CC or not
 bool IsTracksOneCC
 (
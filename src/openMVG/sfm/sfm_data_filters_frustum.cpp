@@ -9,12 +9,14 @@
 #include "openMVG/sfm/sfm_data_filters_frustum.hpp"
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/aabb_tree.hpp"
 #include "openMVG/geometry/pose3.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/stl/stl.hpp"
 
 #include "third_party/progress/progress_display.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
@@ -94,32 +96,45 @@ const
   std::transform(z_near_z_far_perView.cbegin(), z_near_z_far_perView.cend(),
     std::back_inserter(viewIds), stl::RetrieveKey());
 
+  // Broad phase: list the view pairs with overlapping frustum bounding boxes
+  std::vector<AABB> boxes;
+  boxes.reserve(viewIds.size());
+  for (const IndexT view_id : viewIds)
+    boxes.push_back(frustum_perView.at(view_id).bounding_box());
+  const std::vector<std::pair<uint32_t, uint32_t>> candidate_pairs =
+    AABB_Tree(boxes).overlapping_pairs();
+
   C_Progress_display my_progress_bar(
-    viewIds.size() * (viewIds.size()-1)/2,
+    candidate_pairs.size(),
     std::cout, "\nCompute frustum intersection\n");
 
-  // Exhaustive comparison (use the fact that the intersect function is symmetric)
+  // Exact intersection test of the candidate pairs
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel
 #endif
-  for (int i = 0; i < (int)viewIds.size(); ++i)
   {
-    // Prepare vector of intersecting objects (within loop to keep it
-    // thread-safe)
+    // Prepare vector of intersecting objects (within the parallel section to
+    // keep it thread-safe)
     std::vector<HalfPlaneObject> objects = bounding_volume;
-    objects.insert(objects.end(),
-                   { frustum_perView.at(viewIds[i]), HalfPlaneObject() });
+    objects.insert(objects.end(), { HalfPlaneObject(), HalfPlaneObject() });
 
-    for (size_t j = i+1; j < viewIds.size(); ++j)
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int k = 0; k < static_cast<int>(candidate_pairs.size()); ++k)
     {
-      objects.back() = frustum_perView.at(viewIds[j]);
+      const IndexT
+        view_i = viewIds[candidate_pairs[k].first],
+        view_j = viewIds[candidate_pairs[k].second];
+      objects[objects.size() - 2] = frustum_perView.at(view_i);
+      objects.back() = frustum_perView.at(view_j);
       if (intersect(objects))
       {
 #ifdef OPENMVG_USE_OPENMP
         #pragma omp critical
 #endif
         {
-          pairs.insert({viewIds[i], viewIds[j]});
+          pairs.insert({std::min(view_i, view_j), std::max(view_i, view_j)});
         }
       }
       // Progress bar update
@@ -9,6 +9,7 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/sfm/sfm_landmark_columns.hpp"
 
 #include "testing/testing.h"
 
@@ -164,6 +165,120 @@ TEST(SFM_DATA_FILTERS, eraseUnstablePosesAndObservations)
   EXPECT_EQ(0, sfm_data.structure.count(5));
 }
 
+TEST(SFM_DATA_FILTERS, LandmarksColumns)
+{
+  Landmarks landmarks;
+  for (IndexT i = 0; i < 5; ++i)
+  {
+    landmarks[i * 10].X = Vec3(i, 2 * i, 3 * i);
+    // Track of length i + 1
+    for (IndexT j = 0; j <= i; ++j)
+      landmarks[i * 10].obs[j] = Observation(Vec2(i, j), i * 100 + j);
+  }
+
+  // Snapshot and rebuild
+  Landmarks_Columns columns(landmarks);
+  EXPECT_EQ(5, columns.LandmarkCount());
+  EXPECT_EQ(15, columns.ObservationCount());
+  Landmarks rebuilt;
+  columns.ToLandmarks(rebuilt);
+  EXPECT_EQ(landmarks.size(), rebuilt.size());
+  EXPECT_EQ(3, rebuilt.at(20).obs.size());
+  EXPECT_EQ(201, rebuilt.at(20).obs.at(1).id_feat);
+  EXPECT_MATRIX_NEAR(Vec2(2, 1), rebuilt.at(20).obs.at(1).x, 1e-15);
+
+  // Remove the observations of the view 0 and the tracks shorter than 2
+  const Landmarks_Selection selection = Select_Observations(columns,
+    [&](IndexT, uint64_t obs_index) { return columns.view_ids[obs_index] != 0; }, 2);
+  EXPECT_EQ(5, selection.removed_observations);
+  EXPECT_EQ(2, selection.removed_landmarks); // Landmarks 0 and 10
+
+  Landmarks filtered = landmarks;
+  Erase_Unselected(columns, selection, filtered);
+  Compact(columns, selection);
+  EXPECT_EQ(3, filtered.size());
+  EXPECT_EQ(3, columns.LandmarkCount());
+  EXPECT_EQ(9, columns.ObservationCount());
+  Landmarks compacted;
+  columns.ToLandmarks(compacted);
+  EXPECT_EQ(filtered.size(), compacted.size());
+  for (const auto & landmark_it : filtered)
+  {
+    EXPECT_EQ(0, landmark_it.second.obs.count(0));
+    EXPECT_EQ(landmark_it.second.obs.size(), compacted.at(landmark_it.first).obs.size());
+  }
+
+  // Landmark predicate
+  const Landmarks_Selection landmark_selection = Select_Landmarks(columns,
+    [&](IndexT landmark_index) { return columns.X[landmark_index](0) > 2.5; });
+  EXPECT_EQ(1, landmark_selection.removed_landmarks);
+}
+
+TEST(SFM_DATA_FILTERS, ViewCovisibility)
+{
+  // Landmark i is seen by the views [0, i]: the views a < b share 5 - b landmarks
+  Landmarks landmarks;
+  for (IndexT i = 0; i < 5; ++i)
+  {
+    for (IndexT j = 0; j <= i; ++j)
+      landmarks[i].obs[j * 2] = Observation(Vec2(i, j), j);
+  }
+
+  const View_Covisibility covisibility =
+    Compute_View_Covisibility(Landmarks_Columns(landmarks));
+  EXPECT_EQ(5, covisibility.ViewCount());
+  EXPECT_EQ(20, covisibility.neighbour_ids.size());
+  for (size_t i = 0; i < covisibility.ViewCount(); ++i)
+  {
+    EXPECT_EQ(i * 2, covisibility.view_ids[i]);
+    EXPECT_EQ(4, covisibility.offsets[i + 1] - covisibility.offsets[i]);
+    for (uint64_t k = covisibility.offsets[i]; k < covisibility.offsets[i + 1]; ++k)
+    {
+      const IndexT neighbour = covisibility.neighbour_ids[k] / 2;
+      EXPECT_TRUE(neighbour != i);
+      if (k > covisibility.offsets[i])
+        EXPECT_TRUE(covisibility.neighbour_ids[k - 1] < covisibility.neighbour_ids[k]);
+      EXPECT_EQ(5 - std::max<IndexT>(i, neighbour), covisibility.shared_counts[k]);
+    }
+  }
+}
+
+TEST(SFM_DATA_FILTERS, DepthCleaning)
+{
+  // Init a scene with 3 Views & poses (identity poses: depth = Z)
+  SfM_Data sfm_data;
+  init_scene(sfm_data, 3);
+
+  // Landmarks with depth 1..10 seen by the views 0 and 1
+  for (IndexT i = 0; i < 10; ++i)
+  {
+    sfm_data.structure[i].X = Vec3(0, 0, i + 1);
+    sfm_data.structure[i].obs[0] = Observation(Vec2(10, 20), i);
+    sfm_data.structure[i].obs[1] = Observation(Vec2(10, 20), i);
+  }
+  // A far point and a point behind the cameras
+  sfm_data.structure[10].X = Vec3(0, 0, 1000);
+  sfm_data.structure[10].obs[0] = Observation(Vec2(10, 20), 10);
+  sfm_data.structure[10].obs[1] = Observation(Vec2(10, 20), 10);
+  sfm_data.structure[11].X = Vec3(0, 0, -1);
+  sfm_data.structure[11].obs[0] = Observation(Vec2(10, 20), 11);
+  sfm_data.structure[11].obs[1] = Observation(Vec2(10, 20), 11);
+
+  // Median depth (of the positive depths) is the 6th value
+  const Landmarks_Columns columns(sfm_data.structure);
+  const Hash_Map<IndexT, double> medians =
+    Compute_Per_View_Median(columns, Compute_Observation_Depths(sfm_data, columns));
+  EXPECT_EQ(2, medians.size());
+  EXPECT_NEAR(6.0, medians.at(0), 1e-15);
+
+  const double min_median_depth = DepthCleaning(sfm_data, 5.2, 1, 2);
+  EXPECT_NEAR(6.0, min_median_depth, 1e-15);
+  EXPECT_EQ(10, sfm_data.structure.size());
+  EXPECT_EQ(0, sfm_data.structure.count(10));
+  EXPECT_EQ(0, sfm_data.structure.count(11));
+  // The pose 2 has no observation
+  EXPECT_EQ(2, sfm_data.poses.size());
+}
 
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
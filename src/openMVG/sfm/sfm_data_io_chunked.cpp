@@ -0,0 +1,440 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// The <cereal/archives> headers are special and must be included first.
+#include <cereal/archives/portable_binary.hpp>
+
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
+
+#include "openMVG/cameras/cameras_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_view_io.hpp"
+#include "openMVG/sfm/sfm_view_priors_io.hpp"
+#include "openMVG/system/profiler.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_map.hpp>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+// File layout:
+//  - magic "OMVGSFMC", uint32 version, uint32 endianness marker
+//  - uint32 section count
+//  - table of contents: per section {uint32 id, uint32 encoding, uint64 offset, uint64 size}
+//  - the section payloads
+const char kMagic[8] = {'O', 'M', 'V', 'G', 'S', 'F', 'M', 'C'};
+const uint32_t kVersion = 1;
+const uint32_t kEndiannessMarker = 0x01020304;
+
+enum Chunk_Section : uint32_t
+{
+  SECTION_ROOT_PATH = 0,
+  SECTION_VIEWS = 1,
+  SECTION_INTRINSICS = 2,
+  SECTION_EXTRINSICS = 3,
+  SECTION_STRUCTURE = 4,
+  SECTION_CONTROL_POINTS = 5
+};
+
+// Payload encoding (raw only for now, the field allows to add compressed sections)
+const uint32_t kEncodingRaw = 0;
+
+struct Chunk_Entry
+{
+  uint32_t id = 0;
+  uint32_t encoding = kEncodingRaw;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+template <typename T>
+void Write_Value(std::ostream & stream, const T & value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool Read_Value(std::istream & stream, T & value)
+{
+  return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+void Write_Array(std::ostream & stream, const std::vector<T> & array)
+{
+  if (!array.empty())
+    stream.write(reinterpret_cast<const char*>(array.data()), sizeof(T) * array.size());
+}
+
+template <typename T>
+bool Read_Array(std::istream & stream, std::vector<T> & array, uint64_t count)
+{
+  array.resize(count);
+  if (count == 0)
+    return true;
+  return static_cast<bool>(
+    stream.read(reinterpret_cast<char*>(array.data()), sizeof(T) * count));
+}
+
+void Write_Entry(std::ostream & stream, const Chunk_Entry & entry)
+{
+  Write_Value(stream, entry.id);
+  Write_Value(stream, entry.encoding);
+  Write_Value(stream, entry.offset);
+  Write_Value(stream, entry.size);
+}
+
+bool Read_Entry(std::istream & stream, Chunk_Entry & entry)
+{
+  return Read_Value(stream, entry.id) && Read_Value(stream, entry.encoding)
+    && Read_Value(stream, entry.offset) && Read_Value(stream, entry.size);
+}
+
+// Size of the file header for a given number of sections
+uint64_t Header_Size(uint32_t section_count)
+{
+  return sizeof(kMagic) + 3 * sizeof(uint32_t)
+    + section_count * (2 * sizeof(uint32_t) + 2 * sizeof(uint64_t));
+}
+
+//--
+// Sections serialization
+//--
+
+template <typename T>
+void Write_Cereal(std::ostream & stream, const T & value)
+{
+  cereal::PortableBinaryOutputArchive archive(stream);
+  archive(value);
+}
+
+template <typename T>
+bool Read_Cereal(std::istream & stream, T & value)
+{
+  try
+  {
+    cereal::PortableBinaryInputArchive archive(stream);
+    archive(value);
+  }
+  catch (const cereal::Exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Poses: count, ids, rotations (9 doubles, column major), centers (3 doubles)
+void Write_Poses(std::ostream & stream, const Poses & poses)
+{
+  std::vector<uint32_t> ids;
+  std::vector<double> rotations, centers;
+  ids.reserve(poses.size());
+  rotations.reserve(poses.size() * 9);
+  centers.reserve(poses.size() * 3);
+  for (const auto & pose_it : poses)
+  {
+    ids.push_back(pose_it.first);
+    const Mat3 & R = pose_it.second.rotation();
+    rotations.insert(rotations.end(), R.data(), R.data() + 9);
+    const Vec3 & C = pose_it.second.center();
+    centers.insert(centers.end(), C.data(), C.data() + 3);
+  }
+  Write_Value(stream, static_cast<uint64_t>(ids.size()));
+  Write_Array(stream, ids);
+  Write_Array(stream, rotations);
+  Write_Array(stream, centers);
+}
+
+bool Read_Poses(std::istream & stream, Poses & poses)
+{
+  uint64_t count = 0;
+  std::vector<uint32_t> ids;
+  std::vector<double> rotations, centers;
+  if (!Read_Value(stream, count) ||
+      !Read_Array(stream, ids, count) ||
+      !Read_Array(stream, rotations, count * 9) ||
+      !Read_Array(stream, centers, count * 3))
+    return false;
+
+  poses.clear();
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    poses[ids[i]] = geometry::Pose3(
+      Eigen::Map<const Mat3>(&rotations[i * 9]),
+      Eigen::Map<const Vec3>(&centers[i * 3]));
+  }
+  return true;
+}
+
+// Landmarks: count, ids, positions (3 doubles), observation counts,
+//  then the observation view ids, feature ids and coordinates (2 doubles)
+void Write_Landmarks(std::ostream & stream, const Landmarks & landmarks)
+{
+  std::vector<uint32_t> ids, obs_counts, obs_view_ids, obs_feat_ids;
+  std::vector<double> positions, obs_coords;
+  ids.reserve(landmarks.size());
+  obs_counts.reserve(landmarks.size());
+  positions.reserve(landmarks.size() * 3);
+  for (const auto & landmark_it : landmarks)
+  {
+    ids.push_back(landmark_it.first);
+    const Landmark & landmark = landmark_it.second;
+    positions.insert(positions.end(), landmark.X.data(), landmark.X.data() + 3);
+    obs_counts.push_back(static_cast<uint32_t>(landmark.obs.size()));
+    for (const auto & obs_it : landmark.obs)
+    {
+      obs_view_ids.push_back(obs_it.first);
+      obs_feat_ids.push_back(obs_it.second.id_feat);
+      obs_coords.push_back(obs_it.second.x(0));
+      obs_coords.push_back(obs_it.second.x(1));
+    }
+  }
+  Write_Value(stream, static_cast<uint64_t>(ids.size()));
+  Write_Value(stream, static_cast<uint64_t>(obs_view_ids.size()));
+  Write_Array(stream, ids);
+  Write_Array(stream, positions);
+  Write_Array(stream, obs_counts);
+  Write_Array(stream, obs_view_ids);
+  Write_Array(stream, obs_feat_ids);
+  Write_Array(stream, obs_coords);
+}
+
+bool Read_Landmarks(std::istream & stream, Landmarks & landmarks)
+{
+  uint64_t count = 0, obs_total = 0;
+  std::vector<uint32_t> ids, obs_counts, obs_view_ids, obs_feat_ids;
+  std::vector<double> positions, obs_coords;
+  if (!Read_Value(stream, count) ||
+      !Read_Value(stream, obs_total) ||
+      !Read_Array(stream, ids, count) ||
+      !Read_Array(stream, positions, count * 3) ||
+      !Read_Array(stream, obs_counts, count) ||
+      !Read_Array(stream, obs_view_ids, obs_total) ||
+      !Read_Array(stream, obs_feat_ids, obs_total) ||
+      !Read_Array(stream, obs_coords, obs_total * 2))
+    return false;
+
+  landmarks.clear();
+  uint64_t obs_index = 0;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    if (obs_index + obs_counts[i] > obs_total)
+      return false;
+    Landmark & landmark = landmarks[ids[i]];
+    landmark.X = Eigen::Map<const Vec3>(&positions[i * 3]);
+    for (uint32_t j = 0; j < obs_counts[i]; ++j, ++obs_index)
+    {
+      landmark.obs[obs_view_ids[obs_index]] = Observation(
+        Vec2(obs_coords[obs_index * 2], obs_coords[obs_index * 2 + 1]),
+        obs_feat_ids[obs_index]);
+    }
+  }
+  return obs_index == obs_total;
+}
+
+} // namespace
+
+bool Load_Chunked
+(
+  SfM_Data & data,
+  const std::string & filename,
+  ESfM_Data flags_part
+)
+{
+  OPENMVG_PROFILE_ZONE("sfm_data_load_chunked");
+
+  // List which part of the file must be considered
+  const bool b_views = (flags_part & VIEWS) == VIEWS;
+  const bool b_intrinsics = (flags_part & INTRINSICS) == INTRINSICS;
+  const bool b_extrinsics = (flags_part & EXTRINSICS) == EXTRINSICS;
+  const bool b_structure = (flags_part & STRUCTURE) == STRUCTURE;
+  const bool b_control_point = (flags_part & CONTROL_POINTS) == CONTROL_POINTS;
+
+  std::ifstream stream(filename.c_str(), std::ios::binary | std::ios::in);
+  if (!stream.is_open())
+    return false;
+
+  // Header
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0, endianness = 0, section_count = 0;
+  if (!stream.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !Read_Value(stream, version) ||
+      !Read_Value(stream, endianness) ||
+      !Read_Value(stream, section_count))
+  {
+    std::cerr << "Invalid chunked sfm_data file: " << filename << std::endl;
+    return false;
+  }
+  if (version > kVersion)
+  {
+    std::cerr << "Unsupported chunked sfm_data version: " << version << std::endl;
+    return false;
+  }
+  if (endianness != kEndiannessMarker)
+  {
+    std::cerr << "The chunked sfm_data file was written on a platform with a different endianness."
+      << std::endl;
+    return false;
+  }
+
+  // Table of contents
+  std::vector<Chunk_Entry> entries(section_count);
+  for (Chunk_Entry & entry : entries)
+  {
+    if (!Read_Entry(stream, entry))
+    {
+      std::cerr << "Invalid chunked sfm_data table of contents." << std::endl;
+      return false;
+    }
+  }
+
+  // Read the requested sections only
+  for (const Chunk_Entry & entry : entries)
+  {
+    const bool b_requested =
+      entry.id == SECTION_ROOT_PATH ||
+      (entry.id == SECTION_VIEWS && b_views) ||
+      (entry.id == SECTION_INTRINSICS && b_intrinsics) ||
+      (entry.id == SECTION_EXTRINSICS && b_extrinsics) ||
+      (entry.id == SECTION_STRUCTURE && b_structure) ||
+      (entry.id == SECTION_CONTROL_POINTS && b_control_point);
+    if (!b_requested)
+      continue;
+
+    if (entry.encoding != kEncodingRaw)
+    {
+      std::cerr << "Unsupported chunked sfm_data section encoding: " << entry.encoding << std::endl;
+      return false;
+    }
+
+    stream.seekg(entry.offset);
+    bool b_ok = static_cast<bool>(stream);
+    switch (entry.id)
+    {
+      case SECTION_ROOT_PATH:
+        b_ok = b_ok && Read_Cereal(stream, data.s_root_path);
+      break;
+      case SECTION_VIEWS:
+        b_ok = b_ok && Read_Cereal(stream, data.views);
+      break;
+      case SECTION_INTRINSICS:
+        b_ok = b_ok && Read_Cereal(stream, data.intrinsics);
+      break;
+      case SECTION_EXTRINSICS:
+        b_ok = b_ok && Read_Poses(stream, data.poses);
+      break;
+      case SECTION_STRUCTURE:
+        b_ok = b_ok && Read_Landmarks(stream, data.structure);
+      break;
+      case SECTION_CONTROL_POINTS:
+        b_ok = b_ok && Read_Landmarks(stream, data.control_points);
+      break;
+    }
+    // Check that the section was entirely read
+    if (!b_ok ||
+        static_cast<uint64_t>(stream.tellg()) != entry.offset + entry.size)
+    {
+      std::cerr << "Invalid chunked sfm_data section: " << entry.id << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Save_Chunked
+(
+  const SfM_Data & data,
+  const std::string & filename,
+  ESfM_Data flags_part
+)
+{
+  OPENMVG_PROFILE_ZONE("sfm_data_save_chunked");
+
+  // List which part of the file must be considered
+  std::vector<uint32_t> sections = {SECTION_ROOT_PATH};
+  if ((flags_part & VIEWS) == VIEWS)
+    sections.push_back(SECTION_VIEWS);
+  if ((flags_part & INTRINSICS) == INTRINSICS)
+    sections.push_back(SECTION_INTRINSICS);
+  if ((flags_part & EXTRINSICS) == EXTRINSICS)
+    sections.push_back(SECTION_EXTRINSICS);
+  if ((flags_part & STRUCTURE) == STRUCTURE)
+    sections.push_back(SECTION_STRUCTURE);
+  if ((flags_part & CONTROL_POINTS) == CONTROL_POINTS)
+    sections.push_back(SECTION_CONTROL_POINTS);
+
+  std::ofstream stream(filename.c_str(), std::ios::binary | std::ios::out);
+  if (!stream.is_open())
+    return false;
+
+  // Header (the table of contents is written once the section sizes are known)
+  const uint32_t section_count = static_cast<uint32_t>(sections.size());
+  stream.write(kMagic, sizeof(kMagic));
+  Write_Value(stream, kVersion);
+  Write_Value(stream, kEndiannessMarker);
+  Write_Value(stream, section_count);
+  std::vector<Chunk_Entry> entries(section_count);
+  for (const Chunk_Entry & entry : entries)
+    Write_Entry(stream, entry);
+
+  // Sections
+  uint64_t offset = Header_Size(section_count);
+  for (uint32_t i = 0; i < section_count; ++i)
+  {
+    switch (sections[i])
+    {
+      case SECTION_ROOT_PATH:
+        Write_Cereal(stream, data.s_root_path);
+      break;
+      case SECTION_VIEWS:
+        Write_Cereal(stream, data.views);
+      break;
+      case SECTION_INTRINSICS:
+        Write_Cereal(stream, data.intrinsics);
+      break;
+      case SECTION_EXTRINSICS:
+        Write_Poses(stream, data.poses);
+      break;
+      case SECTION_STRUCTURE:
+        Write_Landmarks(stream, data.structure);
+      break;
+      case SECTION_CONTROL_POINTS:
+        Write_Landmarks(stream, data.control_points);
+      break;
+    }
+    const uint64_t end = static_cast<uint64_t>(stream.tellp());
+    entries[i].id = sections[i];
+    entries[i].offset = offset;
+    entries[i].size = end - offset;
+    offset = end;
+  }
+
+  // Table of contents
+  stream.seekp(Header_Size(0));
+  for (const Chunk_Entry & entry : entries)
+    Write_Entry(stream, entry);
+
+  stream.close();
+  return !stream.fail();
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,55 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+#define OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+
+#include <string>
+
+#include "openMVG/sfm/sfm_data_io.hpp"
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* Chunked binary SfM_Data container (.sfmc)
+*
+* The file starts with a table of contents that gives, for each section
+* (root path, views, intrinsics, extrinsics, structure, control points),
+* its offset and size. Loading seeks to the requested sections only, so
+* reading the views or the poses of a large scene does not parse its
+* structure.
+*
+* - Views and intrinsics are polymorphic and stored as cereal portable binary.
+* - Poses, structure and control points are stored as flat columns
+*   (ids, positions, observation counts, observation view/feature ids and
+*   coordinates) that are read with a few bulk reads.
+*/
+
+/// Load a SfM_Data SfM scene from a chunked binary file (only the requested sections are read)
+bool Load_Chunked
+(
+  SfM_Data & data,
+  const std::string & filename,
+  ESfM_Data flags_part
+);
+
+/// Save a SfM_Data SfM scene to a chunked binary file
+bool Save_Chunked
+(
+  const SfM_Data & data,
+  const std::string & filename,
+  ESfM_Data flags_part
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
@@ -63,7 +63,7 @@ SfM_Data create_test_scene(IndexT viewsCount, bool bSharedIntrinsic)
 
 TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
 
-  const std::vector<std::string> ext_Type = {"json", "bin", "xml"};
+  const std::vector<std::string> ext_Type = {"json", "bin", "xml", "sfmc"};
 
   for (size_t i=0; i < ext_Type.size(); ++i)
   {
@@ -164,6 +164,55 @@ TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
   }
 }
 
+TEST(SfM_Data_IO, SAVE_LOAD_CHUNKED) {
+
+  const std::string filename = "SAVE_LOAD_CHUNKED.sfmc";
+  SfM_Data sfm_data = create_test_scene(3, false);
+  sfm_data.poses[1] = Pose3(RotationAroundZ(0.5), Vec3(1,2,3));
+  sfm_data.control_points[7].X = Vec3(-1,-2,-3);
+  sfm_data.control_points[7].obs[2] = Observation( Vec2(5,6), UndefinedIndexT);
+  EXPECT_TRUE( Save(sfm_data, filename, ALL) );
+
+  // LOAD (all the sections)
+  {
+    SfM_Data sfm_data_load;
+    EXPECT_TRUE( Load(sfm_data_load, filename, ALL) );
+    EXPECT_EQ( sfm_data.s_root_path, sfm_data_load.s_root_path );
+    EXPECT_EQ( sfm_data.views.size(), sfm_data_load.views.size() );
+    EXPECT_EQ( sfm_data.intrinsics.size(), sfm_data_load.intrinsics.size() );
+    EXPECT_EQ( sfm_data.poses.size(), sfm_data_load.poses.size() );
+    EXPECT_MATRIX_NEAR( sfm_data.poses[1].rotation(), sfm_data_load.poses[1].rotation(), 1e-15 );
+    EXPECT_MATRIX_NEAR( sfm_data.poses[1].center(), sfm_data_load.poses[1].center(), 1e-15 );
+    EXPECT_EQ( 1, sfm_data_load.structure.size() );
+    EXPECT_MATRIX_NEAR( sfm_data.structure[0].X, sfm_data_load.structure[0].X, 1e-15 );
+    EXPECT_EQ( 2, sfm_data_load.structure[0].obs.size() );
+    EXPECT_EQ( 1, sfm_data_load.structure[0].obs[1].id_feat );
+    EXPECT_MATRIX_NEAR( Vec2(30,10), sfm_data_load.structure[0].obs[1].x, 1e-15 );
+    EXPECT_EQ( 1, sfm_data_load.control_points.size() );
+    EXPECT_MATRIX_NEAR( Vec3(-1,-2,-3), sfm_data_load.control_points[7].X, 1e-15 );
+    EXPECT_EQ( UndefinedIndexT, sfm_data_load.control_points[7].obs[2].id_feat );
+  }
+
+  // LOAD (only a subpart: STRUCTURE, the other sections are skipped)
+  {
+    SfM_Data sfm_data_load;
+    EXPECT_TRUE( Load(sfm_data_load, filename, STRUCTURE) );
+    EXPECT_EQ( 0, sfm_data_load.views.size() );
+    EXPECT_EQ( 0, sfm_data_load.intrinsics.size() );
+    EXPECT_EQ( 0, sfm_data_load.poses.size() );
+    EXPECT_EQ( 1, sfm_data_load.structure.size() );
+  }
+
+  // SAVE (only a subpart: EXTRINSICS) then LOAD everything
+  {
+    EXPECT_TRUE( Save(sfm_data, filename, EXTRINSICS) );
+    SfM_Data sfm_data_load;
+    EXPECT_TRUE( Load(sfm_data_load, filename, ESfM_Data(EXTRINSICS | STRUCTURE)) );
+    EXPECT_EQ( sfm_data.poses.size(), sfm_data_load.poses.size() );
+    EXPECT_EQ( 0, sfm_data_load.structure.size() );
+  }
+}
+
 TEST(SfM_Data_IO, SAVE_PLY) {
 
   // SAVE as PLY
@@ -12,6 +12,8 @@
 
 #include "openMVG/geometry/Similarity3_Kernel.hpp"
 
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
@@ -85,18 +87,19 @@ void ApplySimilarity
   bool transform_priors
 )
 {
-  // Transform the landmark positions
+  // Affine form of the similarity: X' = A * X + b
+  const Mat3 A = sim.scale_ * sim.pose_.rotation();
+  const Vec3 b = - A * sim.pose_.center();
+  const Mat3 Rt = sim.pose_.rotation().transpose();
+
+  // List the positions to transform, so they can be updated in parallel
+  std::vector<Vec3 *> positions;
+  positions.reserve(sfm_data.structure.size()
+    + (transform_priors ? sfm_data.control_points.size() + sfm_data.views.size() : 0));
   for (auto & iterLandMark : sfm_data.structure)
   {
-    iterLandMark.second.X = sim(iterLandMark.second.X);
-  }
-
-  // Transform the camera positions
-  for (auto & iterPose : sfm_data.poses)
-  {
-    iterPose.second = sim(iterPose.second);
+    positions.push_back(&iterLandMark.second.X);
   }
-
   if (transform_priors)
   {
     for (auto & iterView : sfm_data.views)
@@ -104,16 +107,44 @@ void ApplySimilarity
       // Transform the camera position priors
       if (sfm::ViewPriors * prior = dynamic_cast<sfm::ViewPriors*>(iterView.second.get()))
       {
-        prior->pose_center_ = sim(prior->pose_center_);
+        positions.push_back(&prior->pose_center_);
       }
     }
 
     // Transform the control points
     for (auto & iterControlPoint : sfm_data.control_points)
     {
-      iterControlPoint.second.X = sim(iterControlPoint.second.X);
+      positions.push_back(&iterControlPoint.second.X);
     }
   }
+
+  std::vector<geometry::Pose3 *> poses;
+  poses.reserve(sfm_data.poses.size());
+  for (auto & iterPose : sfm_data.poses)
+  {
+    poses.push_back(&iterPose.second);
+  }
+
+  // Transform the landmark (and prior) positions
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int>(positions.size()); ++i)
+  {
+    Vec3 & X = *positions[i];
+    X = A * X + b;
+  }
+
+  // Transform the camera poses
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int i = 0; i < static_cast<int>(poses.size()); ++i)
+  {
+    geometry::Pose3 & pose = *poses[i];
+    pose.rotation() = pose.rotation() * Rt;
+    pose.center() = A * pose.center() + b;
+  }
 }
 
 } // namespace sfm
@@ -15,6 +15,7 @@
 #include "openMVG/robust_estimation/rand_sampling.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/system/profiler.hpp"
 
 #include "third_party/progress/progress_display.hpp"
 
@@ -90,6 +91,7 @@ void SfM_Data_Structure_Computation_Blind::triangulate
 )
 const
 {
+  OPENMVG_PROFILE_ZONE("triangulation");
   std::deque<IndexT> rejectedId;
   std::unique_ptr<C_Progress> my_progress_bar;
   if (bConsole_verbose_)
@@ -174,6 +176,7 @@ void SfM_Data_Structure_Computation_Robust::triangulate
 )
 const
 {
+  OPENMVG_PROFILE_ZONE("triangulation");
   robust_triangulation(sfm_data);
 }
 
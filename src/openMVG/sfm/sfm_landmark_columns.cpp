@@ -0,0 +1,313 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_landmark_columns.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+Landmarks_Columns::Landmarks_Columns(const Landmarks & landmarks)
+{
+  size_t observation_count = 0;
+  for (const auto & landmark_it : landmarks)
+    observation_count += landmark_it.second.obs.size();
+
+  landmark_ids.reserve(landmarks.size());
+  X.reserve(landmarks.size());
+  track_offsets.reserve(landmarks.size() + 1);
+  view_ids.reserve(observation_count);
+  feat_ids.reserve(observation_count);
+  x.reserve(observation_count);
+
+  track_offsets.push_back(0);
+  for (const auto & landmark_it : landmarks)
+  {
+    landmark_ids.push_back(landmark_it.first);
+    X.push_back(landmark_it.second.X);
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      view_ids.push_back(obs_it.first);
+      feat_ids.push_back(obs_it.second.id_feat);
+      x.push_back(obs_it.second.x);
+    }
+    track_offsets.push_back(view_ids.size());
+  }
+}
+
+void Landmarks_Columns::ToLandmarks(Landmarks & landmarks) const
+{
+  landmarks.clear();
+  for (size_t i = 0; i < LandmarkCount(); ++i)
+  {
+    Landmark & landmark = landmarks[landmark_ids[i]];
+    landmark.X = X[i];
+    for (uint64_t j = track_offsets[i]; j < track_offsets[i + 1]; ++j)
+      landmark.obs[view_ids[j]] = Observation(x[j], feat_ids[j]);
+  }
+}
+
+void Compact
+(
+  Landmarks_Columns & columns,
+  const Landmarks_Selection & selection
+)
+{
+  size_t landmark_count = 0;
+  uint64_t observation_count = 0;
+  for (size_t i = 0; i < columns.LandmarkCount(); ++i)
+  {
+    if (!selection.keep_landmarks[i])
+      continue;
+    const uint64_t track_begin = columns.track_offsets[i];
+    const uint64_t track_end = columns.track_offsets[i + 1];
+    // Write position <= read position, so the compaction can be done in place
+    columns.landmark_ids[landmark_count] = columns.landmark_ids[i];
+    columns.X[landmark_count] = columns.X[i];
+    columns.track_offsets[landmark_count] = observation_count;
+    for (uint64_t j = track_begin; j < track_end; ++j)
+    {
+      if (!selection.keep_observations[j])
+        continue;
+      columns.view_ids[observation_count] = columns.view_ids[j];
+      columns.feat_ids[observation_count] = columns.feat_ids[j];
+      columns.x[observation_count] = columns.x[j];
+      ++observation_count;
+    }
+    ++landmark_count;
+  }
+  columns.landmark_ids.resize(landmark_count);
+  columns.X.resize(landmark_count);
+  columns.track_offsets.resize(landmark_count + 1);
+  columns.track_offsets[landmark_count] = observation_count;
+  columns.view_ids.resize(observation_count);
+  columns.feat_ids.resize(observation_count);
+  columns.x.resize(observation_count);
+}
+
+void Erase_Unselected
+(
+  const Landmarks_Columns & columns,
+  const Landmarks_Selection & selection,
+  Landmarks & landmarks
+)
+{
+  for (size_t i = 0; i < columns.LandmarkCount(); ++i)
+  {
+    if (!selection.keep_landmarks[i])
+    {
+      landmarks.erase(columns.landmark_ids[i]);
+      continue;
+    }
+    Observations * obs = nullptr;
+    for (uint64_t j = columns.track_offsets[i]; j < columns.track_offsets[i + 1]; ++j)
+    {
+      if (selection.keep_observations[j])
+        continue;
+      if (!obs)
+        obs = &landmarks.at(columns.landmark_ids[i]).obs;
+      obs->erase(columns.view_ids[j]);
+    }
+  }
+}
+
+std::vector<double> Compute_Observation_Depths
+(
+  const SfM_Data & sfm_data,
+  const Landmarks_Columns & columns
+)
+{
+  // Pose of each view (nullptr if the view has no valid pose and intrinsic)
+  Hash_Map<IndexT, const geometry::Pose3 *> view_poses;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const View * view = view_it.second.get();
+    view_poses[view_it.first] = sfm_data.IsPoseAndIntrinsicDefined(view)
+      ? &sfm_data.GetPoses().at(view->id_pose) : nullptr;
+  }
+
+  std::vector<double> depths(columns.ObservationCount());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int i = 0; i < static_cast<int>(columns.LandmarkCount()); ++i)
+  {
+    for (uint64_t j = columns.track_offsets[i]; j < columns.track_offsets[i + 1]; ++j)
+    {
+      const geometry::Pose3 * pose = view_poses.at(columns.view_ids[j]);
+      depths[j] = pose
+        ? pose->depth(columns.X[i])
+        : std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+  return depths;
+}
+
+Hash_Map<IndexT, double> Compute_Per_View_Median
+(
+  const Landmarks_Columns & columns,
+  const std::vector<double> & values
+)
+{
+  // Bucket the valid values per view (counting sort on a contiguous view index)
+  Hash_Map<IndexT, IndexT> view_index;
+  std::vector<IndexT> bucket_view_ids;
+  std::vector<uint64_t> bucket_offsets(1, 0);
+  std::vector<IndexT> observation_bucket(columns.ObservationCount(), UndefinedIndexT);
+  for (size_t j = 0; j < columns.ObservationCount(); ++j)
+  {
+    if (!(values[j] > 0))
+      continue;
+    const auto it = view_index.find(columns.view_ids[j]);
+    IndexT bucket;
+    if (it == view_index.end())
+    {
+      bucket = static_cast<IndexT>(bucket_view_ids.size());
+      view_index[columns.view_ids[j]] = bucket;
+      bucket_view_ids.push_back(columns.view_ids[j]);
+      bucket_offsets.push_back(0);
+    }
+    else
+      bucket = it->second;
+    observation_bucket[j] = bucket;
+    ++bucket_offsets[bucket + 1];
+  }
+  for (size_t i = 1; i < bucket_offsets.size(); ++i)
+    bucket_offsets[i] += bucket_offsets[i - 1];
+
+  std::vector<double> bucketed_values(bucket_offsets.back());
+  {
+    std::vector<uint64_t> fill_position(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (size_t j = 0; j < columns.ObservationCount(); ++j)
+    {
+      if (observation_bucket[j] != UndefinedIndexT)
+        bucketed_values[fill_position[observation_bucket[j]]++] = values[j];
+    }
+  }
+
+  // Median of each bucket
+  std::vector<double> medians(bucket_view_ids.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(bucket_view_ids.size()); ++i)
+  {
+    const auto begin = bucketed_values.begin() + bucket_offsets[i];
+    const auto end = bucketed_values.begin() + bucket_offsets[i + 1];
+    const auto median = begin + (end - begin) / 2;
+    std::nth_element(begin, median, end);
+    medians[i] = *median;
+  }
+
+  Hash_Map<IndexT, double> view_medians;
+  for (size_t i = 0; i < bucket_view_ids.size(); ++i)
+    view_medians[bucket_view_ids[i]] = medians[i];
+  return view_medians;
+}
+
+View_Covisibility Compute_View_Covisibility
+(
+  const Landmarks_Columns & columns
+)
+{
+  View_Covisibility covisibility;
+
+  // Contiguous index of the observed views
+  covisibility.view_ids = columns.view_ids;
+  std::sort(covisibility.view_ids.begin(), covisibility.view_ids.end());
+  covisibility.view_ids.erase(
+    std::unique(covisibility.view_ids.begin(), covisibility.view_ids.end()),
+    covisibility.view_ids.end());
+  const size_t view_count = covisibility.view_ids.size();
+
+  std::vector<IndexT> observation_views(columns.ObservationCount());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int j = 0; j < static_cast<int>(columns.ObservationCount()); ++j)
+  {
+    observation_views[j] = static_cast<IndexT>(
+      std::lower_bound(covisibility.view_ids.begin(), covisibility.view_ids.end(),
+        columns.view_ids[j]) - covisibility.view_ids.begin());
+  }
+
+  // Inverted index: the landmarks observed by each view (counting sort)
+  std::vector<uint64_t> view_offsets(view_count + 1, 0);
+  for (const IndexT view : observation_views)
+    ++view_offsets[view + 1];
+  for (size_t i = 1; i < view_offsets.size(); ++i)
+    view_offsets[i] += view_offsets[i - 1];
+  std::vector<IndexT> view_landmarks(columns.ObservationCount());
+  {
+    std::vector<uint64_t> fill_position(view_offsets.begin(), view_offsets.end() - 1);
+    for (size_t i = 0; i < columns.LandmarkCount(); ++i)
+    {
+      for (uint64_t j = columns.track_offsets[i]; j < columns.track_offsets[i + 1]; ++j)
+        view_landmarks[fill_position[observation_views[j]]++] = static_cast<IndexT>(i);
+    }
+  }
+
+  // Accumulate the rows in parallel
+  std::vector<std::vector<std::pair<IndexT, IndexT>>> rows(view_count);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<IndexT> counts(view_count, 0);
+    std::vector<IndexT> touched;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int v = 0; v < static_cast<int>(view_count); ++v)
+    {
+      touched.clear();
+      for (uint64_t k = view_offsets[v]; k < view_offsets[v + 1]; ++k)
+      {
+        const IndexT landmark = view_landmarks[k];
+        for (uint64_t j = columns.track_offsets[landmark]; j < columns.track_offsets[landmark + 1]; ++j)
+        {
+          const IndexT neighbour = observation_views[j];
+          if (neighbour == static_cast<IndexT>(v))
+            continue;
+          if (counts[neighbour]++ == 0)
+            touched.push_back(neighbour);
+        }
+      }
+      std::sort(touched.begin(), touched.end());
+      rows[v].reserve(touched.size());
+      for (const IndexT neighbour : touched)
+      {
+        rows[v].emplace_back(neighbour, counts[neighbour]);
+        counts[neighbour] = 0;
+      }
+    }
+  }
+
+  // Concatenate the rows
+  covisibility.offsets.resize(view_count + 1, 0);
+  for (size_t v = 0; v < view_count; ++v)
+    covisibility.offsets[v + 1] = covisibility.offsets[v] + rows[v].size();
+  covisibility.neighbour_ids.reserve(covisibility.offsets.back());
+  covisibility.shared_counts.reserve(covisibility.offsets.back());
+  for (auto & row : rows)
+  {
+    for (const auto & neighbour : row)
+    {
+      covisibility.neighbour_ids.push_back(covisibility.view_ids[neighbour.first]);
+      covisibility.shared_counts.push_back(neighbour.second);
+    }
+    std::vector<std::pair<IndexT, IndexT>>().swap(row);
+  }
+  return covisibility;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,227 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_LANDMARK_COLUMNS_HPP
+#define OPENMVG_SFM_SFM_LANDMARK_COLUMNS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/types.hpp"
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Columnar snapshot of a Landmarks collection.
+*
+* The landmarks are stored in flat arrays (ids and positions) and their
+* observations in contiguous ranges of flat arrays (view ids, feature ids and
+* coordinates): the observations of the i-th landmark are in
+* [track_offsets[i], track_offsets[i+1]).
+* This layout allows to run the per observation computations in parallel and
+* without any hash map lookup on the landmarks.
+*/
+struct Landmarks_Columns
+{
+  // Per landmark
+  std::vector<IndexT> landmark_ids;
+  std::vector<Vec3> X;
+  std::vector<uint64_t> track_offsets; // Size: landmark count + 1
+
+  // Per observation
+  std::vector<IndexT> view_ids;
+  std::vector<IndexT> feat_ids;
+  std::vector<Vec2> x;
+
+  Landmarks_Columns() = default;
+
+  /// Build the snapshot of a landmark collection
+  explicit Landmarks_Columns(const Landmarks & landmarks);
+
+  size_t LandmarkCount() const { return landmark_ids.size(); }
+  size_t ObservationCount() const { return view_ids.size(); }
+
+  /// Rebuild a landmark collection from the snapshot
+  void ToLandmarks(Landmarks & landmarks) const;
+};
+
+/// Observations and landmarks kept by a filtering predicate
+struct Landmarks_Selection
+{
+  std::vector<uint8_t> keep_observations; // Per observation
+  std::vector<uint8_t> keep_landmarks;    // Per landmark
+  IndexT removed_observations = 0;        // Observations rejected by the predicate
+  IndexT removed_landmarks = 0;
+};
+
+/**
+* @brief Evaluate an observation predicate in parallel.
+* @param columns The landmarks snapshot
+* @param keep Predicate keep(landmark_index, observation_index) -> bool
+* @param min_track_length The landmarks that keep less observations are removed
+*  (0 keeps all the landmarks, even with no observation left)
+* @return The selection
+*/
+template <typename ObservationPredicate>
+Landmarks_Selection Select_Observations
+(
+  const Landmarks_Columns & columns,
+  const ObservationPredicate & keep,
+  const IndexT min_track_length = 0
+)
+{
+  Landmarks_Selection selection;
+  selection.keep_observations.resize(columns.ObservationCount());
+  selection.keep_landmarks.resize(columns.LandmarkCount());
+  const uint64_t min_kept = (min_track_length == 0) ? 0 : std::max<IndexT>(1, min_track_length);
+
+  IndexT removed_observations = 0, removed_landmarks = 0;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256) reduction(+:removed_observations, removed_landmarks)
+#endif
+  for (int i = 0; i < static_cast<int>(columns.LandmarkCount()); ++i)
+  {
+    uint64_t kept = 0;
+    for (uint64_t j = columns.track_offsets[i]; j < columns.track_offsets[i + 1]; ++j)
+    {
+      const bool b_keep = keep(static_cast<IndexT>(i), j);
+      selection.keep_observations[j] = b_keep;
+      kept += b_keep;
+    }
+    removed_observations += static_cast<IndexT>(
+      columns.track_offsets[i + 1] - columns.track_offsets[i] - kept);
+    selection.keep_landmarks[i] = kept >= min_kept;
+    removed_landmarks += (kept < min_kept);
+  }
+  selection.removed_observations = removed_observations;
+  selection.removed_landmarks = removed_landmarks;
+  return selection;
+}
+
+/**
+* @brief Evaluate a landmark predicate in parallel.
+* The observations of the removed landmarks are removed too
+*  (they are not counted in removed_observations).
+* @param columns The landmarks snapshot
+* @param keep Predicate keep(landmark_index) -> bool
+* @return The selection
+*/
+template <typename LandmarkPredicate>
+Landmarks_Selection Select_Landmarks
+(
+  const Landmarks_Columns & columns,
+  const LandmarkPredicate & keep
+)
+{
+  Landmarks_Selection selection;
+  selection.keep_observations.resize(columns.ObservationCount());
+  selection.keep_landmarks.resize(columns.LandmarkCount());
+
+  IndexT removed_landmarks = 0;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64) reduction(+:removed_landmarks)
+#endif
+  for (int i = 0; i < static_cast<int>(columns.LandmarkCount()); ++i)
+  {
+    const bool b_keep = keep(static_cast<IndexT>(i));
+    selection.keep_landmarks[i] = b_keep;
+    std::fill(selection.keep_observations.begin() + columns.track_offsets[i],
+              selection.keep_observations.begin() + columns.track_offsets[i + 1],
+              static_cast<uint8_t>(b_keep));
+    removed_landmarks += !b_keep;
+  }
+  selection.removed_landmarks = removed_landmarks;
+  return selection;
+}
+
+/// Remove from the snapshot the observations and landmarks that are not selected
+void Compact
+(
+  Landmarks_Columns & columns,
+  const Landmarks_Selection & selection
+);
+
+/**
+* @brief Erase from a landmark collection the observations and landmarks that
+*  are not selected (only the removed elements are touched).
+* @param columns The snapshot used to compute the selection
+* @param selection The selection
+* @param[in,out] landmarks The landmark collection the snapshot was built from
+*/
+void Erase_Unselected
+(
+  const Landmarks_Columns & columns,
+  const Landmarks_Selection & selection,
+  Landmarks & landmarks
+);
+
+/**
+* @brief Compute in parallel the depth of the landmarks for each observation
+* @return The per observation depth (NaN if the view has no valid pose and intrinsic)
+*/
+std::vector<double> Compute_Observation_Depths
+(
+  const SfM_Data & sfm_data,
+  const Landmarks_Columns & columns
+);
+
+/**
+* @brief Compute the per view median of the positive observation values
+*  (the median is the sorted[n/2] value, as in minMaxMeanMedian).
+* The values are bucketed per view and the medians are computed in parallel
+*  with nth_element.
+* @param columns The landmarks snapshot
+* @param values The per observation values (non positive and NaN values are ignored)
+* @return The median of each view that has at least one valid value
+*/
+Hash_Map<IndexT, double> Compute_Per_View_Median
+(
+  const Landmarks_Columns & columns,
+  const std::vector<double> & values
+);
+
+/**
+* @brief Sparse view co-visibility graph: number of landmarks shared by each
+*  pair of views, stored in compressed rows.
+* The neighbours of view_ids[i] are in [offsets[i], offsets[i+1]) of
+*  neighbour_ids (sorted) and shared_counts.
+* Only the views that have at least one observation are listed (sorted).
+*/
+struct View_Covisibility
+{
+  std::vector<IndexT> view_ids;
+  std::vector<uint64_t> offsets; // Size: view count + 1
+  std::vector<IndexT> neighbour_ids;
+  std::vector<IndexT> shared_counts;
+
+  size_t ViewCount() const { return view_ids.size(); }
+};
+
+/**
+* @brief Compute in parallel the co-visibility graph of the views.
+* Each row is accumulated in a dense per thread counter array from a view to
+*  landmark inverted index, so every co-observation costs a single increment
+*  (no per pair tree or set insertion).
+* @param columns The landmarks snapshot
+* @return The co-visibility graph
+*/
+View_Covisibility Compute_View_Covisibility
+(
+  const Landmarks_Columns & columns
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_LANDMARK_COLUMNS_HPP
@@ -0,0 +1,256 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/system/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace openMVG {
+namespace system {
+namespace profiling {
+
+namespace {
+
+int64_t SteadyClockMicroseconds()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Escape a string to be used as a JSON value
+std::string JsonEscape(const char * str)
+{
+  std::string escaped;
+  for (const char * c = str; *c != '\0'; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      escaped += '\\';
+    escaped += *c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+Profiler & Profiler::Instance()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler()
+  : enabled_(false),
+    origin_(SteadyClockMicroseconds())
+{
+}
+
+void Profiler::Enable(bool enable)
+{
+  enabled_.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::Clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & buffer : buffers_)
+  {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    buffer->zones.clear();
+    buffer->counters.clear();
+  }
+}
+
+int64_t Profiler::Now() const
+{
+  return SteadyClockMicroseconds() - origin_;
+}
+
+Profiler::Thread_Buffer & Profiler::GetThreadBuffer()
+{
+  // The buffers are owned by the profiler, so the recorded events
+  // remain available once the threads are finished.
+  static thread_local Thread_Buffer * thread_buffer = nullptr;
+  if (!thread_buffer)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.emplace_back(new Thread_Buffer);
+    thread_buffer = buffers_.back().get();
+    thread_buffer->thread_id = static_cast<int>(buffers_.size()) - 1;
+  }
+  return *thread_buffer;
+}
+
+void Profiler::AddZone(const char * name, int64_t start, int64_t end)
+{
+  Thread_Buffer & buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.zones.push_back({name, start, end});
+}
+
+void Profiler::AddCounter(const char * name, int64_t value)
+{
+  Thread_Buffer & buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.counters.push_back({name, Now(), value});
+}
+
+bool Profiler::ExportChromeTrace(const std::string & filename) const
+{
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open())
+  {
+    return false;
+  }
+
+  std::vector<Counter_Event> counters;
+  bool first = true;
+  stream << "{\"traceEvents\":[";
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & buffer : buffers_)
+    {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      stream << (first ? "\n" : ",\n")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->thread_id
+        << ",\"args\":{\"name\":\"thread " << buffer->thread_id << "\"}}";
+      first = false;
+      for (const Zone_Event & zone : buffer->zones)
+      {
+        stream << ",\n{\"name\":\"" << JsonEscape(zone.name)
+          << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_id
+          << ",\"ts\":" << zone.start
+          << ",\"dur\":" << (zone.end - zone.start) << "}";
+      }
+      counters.insert(counters.end(), buffer->counters.cbegin(), buffer->counters.cend());
+    }
+  }
+
+  // Counters are displayed as cumulated values along the time
+  std::stable_sort(counters.begin(), counters.end(),
+    [](const Counter_Event & a, const Counter_Event & b) { return a.time < b.time; });
+  std::map<std::string, int64_t> counter_totals;
+  for (const Counter_Event & counter : counters)
+  {
+    const int64_t total = (counter_totals[counter.name] += counter.value);
+    stream << (first ? "\n" : ",\n")
+      << "{\"name\":\"" << JsonEscape(counter.name)
+      << "\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << counter.time
+      << ",\"args\":{\"value\":" << total << "}}";
+    first = false;
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return stream.good();
+}
+
+std::string Profiler::Summary() const
+{
+  struct Zone_Statistics
+  {
+    size_t count = 0;
+    int64_t total = 0;
+    int64_t max = 0;
+  };
+  std::map<std::string, Zone_Statistics> zone_statistics;
+  std::map<std::string, int64_t> counter_totals;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & buffer : buffers_)
+    {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+      // Rebuild the zone hierarchy of the thread:
+      // a zone is a child of the enclosing zones that are still open.
+      std::vector<Zone_Event> zones = buffer->zones;
+      std::sort(zones.begin(), zones.end(),
+        [](const Zone_Event & a, const Zone_Event & b)
+        {
+          return (a.start != b.start) ? a.start < b.start : a.end > b.end;
+        });
+      std::vector<std::pair<int64_t, std::string>> stack; // (end, path)
+      for (const Zone_Event & zone : zones)
+      {
+        while (!stack.empty() && stack.back().first <= zone.start)
+          stack.pop_back();
+        const std::string path = stack.empty() ?
+          std::string(zone.name) : stack.back().second + "/" + zone.name;
+        Zone_Statistics & stats = zone_statistics[path];
+        ++stats.count;
+        stats.total += zone.end - zone.start;
+        stats.max = std::max(stats.max, zone.end - zone.start);
+        stack.emplace_back(zone.end, path);
+      }
+
+      for (const Counter_Event & counter : buffer->counters)
+        counter_totals[counter.name] += counter.value;
+    }
+  }
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3)
+    << "\n-------------------------------\n"
+    << "-- Profiling summary (ms):\n"
+    << std::setw(12) << "total" << std::setw(10) << "count"
+    << std::setw(12) << "mean" << std::setw(12) << "max" << "  zone\n";
+  // Paths are sorted, so the children are listed just after their parent
+  for (const auto & it : zone_statistics)
+  {
+    const Zone_Statistics & stats = it.second;
+    os << std::setw(12) << stats.total / 1000.0
+      << std::setw(10) << stats.count
+      << std::setw(12) << stats.total / 1000.0 / stats.count
+      << std::setw(12) << stats.max / 1000.0
+      << "  " << it.first << "\n";
+  }
+  if (!counter_totals.empty())
+  {
+    os << "-- Counters:\n";
+    for (const auto & it : counter_totals)
+      os << std::setw(22) << it.second << "  " << it.first << "\n";
+  }
+  os << "-------------------------------\n";
+  return os.str();
+}
+
+Session::Session(const std::string & filename)
+  : filename_(filename)
+{
+  if (!filename_.empty())
+  {
+#if !defined OPENMVG_USE_PROFILING
+    std::cerr << "Profiling instrumentation is disabled in this build"
+      << " (OpenMVG_USE_PROFILING=OFF): the trace will be empty." << std::endl;
+#endif
+    Profiler::Instance().Enable(true);
+  }
+}
+
+Session::~Session()
+{
+  if (filename_.empty())
+    return;
+
+  Profiler & profiler = Profiler::Instance();
+  profiler.Enable(false);
+  std::cout << profiler.Summary() << std::endl;
+  if (!profiler.ExportChromeTrace(filename_))
+  {
+    std::cerr << "Cannot write the profiling trace: " << filename_ << std::endl;
+  }
+}
+
+} // namespace profiling
+} // namespace system
+} // namespace openMVG
@@ -0,0 +1,194 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SYSTEM_PROFILER_HPP
+#define OPENMVG_SYSTEM_PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openMVG
+{
+namespace system
+{
+/**
+* @brief Lightweight thread aware hierarchical instrumentation.
+*
+* Usage:
+*  - OPENMVG_PROFILE_ZONE("name") times the enclosing scope,
+*  - OPENMVG_PROFILE_COUNTER("name", value) accumulates a counter,
+*  - OPENMVG_PROFILE_BYTES_READ(n) and OPENMVG_PROFILE_BYTES_ALLOCATED(n)
+*    accumulate the predefined memory tallies.
+*
+* Nothing is recorded until the Profiler is enabled (a single atomic load per
+* zone). The macros compile to nothing if OPENMVG_USE_PROFILING is not defined.
+* Recorded data can be exported as a Chrome trace (chrome://tracing, Perfetto)
+* or as a summary table.
+*/
+namespace profiling
+{
+
+/// A timed scope (microseconds since the profiler origin)
+struct Zone_Event
+{
+  const char * name;
+  int64_t start;
+  int64_t end;
+};
+
+/// A counter increment (microseconds since the profiler origin)
+struct Counter_Event
+{
+  const char * name;
+  int64_t time;
+  int64_t value;
+};
+
+class Profiler
+{
+  public:
+
+    /// Return the profiler singleton
+    static Profiler & Instance();
+
+    /// Enable/Disable the recording
+    void Enable( bool enable );
+
+    bool IsEnabled() const
+    {
+      return enabled_.load( std::memory_order_relaxed );
+    }
+
+    /// Discard all the recorded events
+    void Clear();
+
+    /// Current time in microseconds since the profiler origin
+    int64_t Now() const;
+
+    /// Record a timed scope for the calling thread
+    void AddZone( const char * name, int64_t start, int64_t end );
+
+    /// Record a counter increment for the calling thread
+    void AddCounter( const char * name, int64_t value );
+
+    /**
+    * @brief Export the recorded events in the Chrome trace event JSON format
+    * @param filename Output JSON file
+    * @return true if the file was written
+    */
+    bool ExportChromeTrace( const std::string & filename ) const;
+
+    /**
+    * @brief Summary table of the recorded events.
+    * Zones are aggregated by hierarchical path (i.e "parent/child").
+    */
+    std::string Summary() const;
+
+  private:
+
+    Profiler();
+
+    struct Thread_Buffer
+    {
+      int thread_id;
+      std::vector<Zone_Event> zones;
+      std::vector<Counter_Event> counters;
+      mutable std::mutex mutex;
+    };
+
+    /// Return the buffer of the calling thread (created on first use)
+    Thread_Buffer & GetThreadBuffer();
+
+    std::atomic<bool> enabled_;
+    int64_t origin_;
+    std::vector<std::unique_ptr<Thread_Buffer>> buffers_;
+    mutable std::mutex mutex_; // Protect the buffers_ list
+};
+
+/// RAII timed scope
+class ScopedZone
+{
+  public:
+    explicit ScopedZone( const char * name )
+    : name_( name ),
+      start_( Profiler::Instance().IsEnabled() ? Profiler::Instance().Now() : -1 )
+    {
+    }
+
+    ~ScopedZone()
+    {
+      if ( start_ >= 0 )
+      {
+        Profiler & profiler = Profiler::Instance();
+        profiler.AddZone( name_, start_, profiler.Now() );
+      }
+    }
+
+    ScopedZone( const ScopedZone & ) = delete;
+    ScopedZone & operator=( const ScopedZone & ) = delete;
+
+  private:
+    const char * name_;
+    int64_t start_;
+};
+
+/// Accumulate a counter value (if the profiler is enabled)
+inline void AddCounter( const char * name, int64_t value )
+{
+  Profiler & profiler = Profiler::Instance();
+  if ( profiler.IsEnabled() )
+  {
+    profiler.AddCounter( name, value );
+  }
+}
+
+/**
+* @brief RAII profiling session used by the command line tools.
+* If a filename is provided, the profiler is enabled until the session ends;
+* the Chrome trace is then written and the summary table is displayed.
+*/
+class Session
+{
+  public:
+    explicit Session( const std::string & filename );
+    ~Session();
+
+    Session( const Session & ) = delete;
+    Session & operator=( const Session & ) = delete;
+
+  private:
+    std::string filename_;
+};
+
+} // namespace profiling
+} // namespace system
+} // namespace openMVG
+
+#if defined OPENMVG_USE_PROFILING
+#define OPENMVG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define OPENMVG_PROFILE_CONCAT(a, b) OPENMVG_PROFILE_CONCAT_IMPL(a, b)
+#define OPENMVG_PROFILE_ZONE(name) \
+  const openMVG::system::profiling::ScopedZone \
+    OPENMVG_PROFILE_CONCAT(openMVG_profile_zone_, __LINE__)(name)
+#define OPENMVG_PROFILE_COUNTER(name, value) \
+  openMVG::system::profiling::AddCounter(name, static_cast<int64_t>(value))
+#else
+#define OPENMVG_PROFILE_ZONE(name)
+#define OPENMVG_PROFILE_COUNTER(name, value)
+#endif
+
+#define OPENMVG_PROFILE_BYTES_READ(value) \
+  OPENMVG_PROFILE_COUNTER("bytes_read", value)
+#define OPENMVG_PROFILE_BYTES_ALLOCATED(value) \
+  OPENMVG_PROFILE_COUNTER("bytes_allocated", value)
+
+#endif // OPENMVG_SYSTEM_PROFILER_HPP
@@ -0,0 +1,115 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/system/profiler.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace openMVG::system::profiling;
+
+TEST(Profiler, Disabled)
+{
+  Profiler & profiler = Profiler::Instance();
+  profiler.Enable(false);
+  profiler.Clear();
+  {
+    ScopedZone zone("disabled_zone");
+    AddCounter("disabled_counter", 1);
+  }
+  const std::string summary = profiler.Summary();
+  EXPECT_EQ(std::string::npos, summary.find("disabled_zone"));
+  EXPECT_EQ(std::string::npos, summary.find("disabled_counter"));
+}
+
+TEST(Profiler, NestedZones)
+{
+  Profiler & profiler = Profiler::Instance();
+  profiler.Clear();
+  profiler.Enable(true);
+  {
+    ScopedZone parent("parent");
+    for (int i = 0; i < 3; ++i)
+    {
+      ScopedZone child("child");
+    }
+  }
+  {
+    ScopedZone child("child");
+  }
+  profiler.Enable(false);
+
+  const std::string summary = profiler.Summary();
+  EXPECT_TRUE(summary.find("  parent\n") != std::string::npos);
+  EXPECT_TRUE(summary.find("  parent/child\n") != std::string::npos);
+  // The last zone is not nested
+  EXPECT_TRUE(summary.find("  child\n") != std::string::npos);
+}
+
+TEST(Profiler, MultiThreadCounters)
+{
+  Profiler & profiler = Profiler::Instance();
+  profiler.Clear();
+  profiler.Enable(true);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([]
+    {
+      for (int j = 0; j < 10; ++j)
+      {
+        ScopedZone zone("worker");
+        AddCounter("bytes_read", 100);
+      }
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+  profiler.Enable(false);
+
+  const std::string summary = profiler.Summary();
+  EXPECT_TRUE(summary.find("4000  bytes_read") != std::string::npos);
+  EXPECT_TRUE(summary.find("  worker\n") != std::string::npos);
+}
+
+TEST(Profiler, ChromeTraceExport)
+{
+  Profiler & profiler = Profiler::Instance();
+  profiler.Clear();
+  profiler.Enable(true);
+  {
+    ScopedZone zone("exported_zone");
+    AddCounter("exported_counter", 42);
+  }
+  profiler.Enable(false);
+
+  const std::string filename = "profiler_test_trace.json";
+  EXPECT_TRUE(profiler.ExportChromeTrace(filename));
+
+  std::ifstream stream(filename.c_str());
+  const std::string content(
+    (std::istreambuf_iterator<char>(stream)),
+    std::istreambuf_iterator<char>());
+  stream.close();
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(0, content.find("{\"traceEvents\":["));
+  EXPECT_TRUE(content.find("\"name\":\"exported_zone\",\"ph\":\"X\"") != std::string::npos);
+  EXPECT_TRUE(content.find("\"name\":\"exported_counter\",\"ph\":\"C\"") != std::string::npos);
+  EXPECT_TRUE(content.find("\"args\":{\"value\":42}") != std::string::npos);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -16,16 +16,15 @@
 #include "openMVG/exif/exif_IO_EasyExif.hpp"
 #include "openMVG/geodesy/geodesy.hpp"
 
-// //- Robust estimation - LMeds (since no threshold can be defined)
-#include "openMVG/robust_estimation/robust_estimator_LMeds.hpp"
-
 #include "software/SfM/SfMPlyHelper.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 #include "third_party/cmdLine/cmdLine.h"
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <string>
+#include <vector>
 
 using namespace openMVG;
 using namespace openMVG::exif;
@@ -95,26 +94,27 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
-  // Init the EXIF reader (will be used for GPS data reading)
-  std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-  if (!exifReader)
+  // List the valid views (pose & intrinsic defined)
+  std::vector<const View *> valid_views;
+  for (const auto & view_it : sfm_data.GetViews() )
   {
-    std::cerr << "Cannot instantiate the EXIF metadata reader." << std::endl;
-    return EXIT_FAILURE;
+    if (sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()))
+      valid_views.push_back(view_it.second.get());
   }
 
-  // List corresponding poses (SfM - GPS)
-  std::vector<Vec3> vec_sfm_center, vec_gps_center;
-
-  for (const auto & view_it : sfm_data.GetViews() )
+  // Read the GPS data of the views in parallel
+  std::vector<Vec3> view_lla(valid_views.size());
+  std::vector<uint8_t> view_has_gps(valid_views.size(), 0);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(valid_views.size()); ++i)
   {
-    if (!sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()))
-      continue;
-
     const std::string view_filename =
-      stlplus::create_filespec(sfm_data.s_root_path, view_it.second->s_Img_path);
+      stlplus::create_filespec(sfm_data.s_root_path, valid_views[i]->s_Img_path);
 
     // Try to parse EXIF metada & check existence of EXIF data
+    std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
     if (! (exifReader->open( view_filename ) &&
            exifReader->doesHaveExifInfo()) )
       continue;
@@ -125,11 +125,31 @@ int main(int argc, char **argv)
          exifReader->GPSLongitude( &longitude ) &&
          exifReader->GPSAltitude( &altitude ) )
     {
-      // Add ECEF XYZ position to the GPS position array
-      vec_gps_center.push_back( lla_to_ecef( latitude, longitude, altitude ) );
-      const openMVG::geometry::Pose3 pose(sfm_data.GetPoseOrDie(view_it.second.get()));
+      view_lla[i] = Vec3(latitude, longitude, altitude);
+      view_has_gps[i] = 1;
+    }
+  }
+
+  // List corresponding poses (SfM - GPS)
+  std::vector<Vec3> vec_sfm_center, vec_gps_center;
+  {
+    std::vector<Vec3> vec_gps_lla;
+    for (size_t i = 0; i < valid_views.size(); ++i)
+    {
+      if (!view_has_gps[i])
+        continue;
+      vec_gps_lla.push_back( view_lla[i] );
+      const openMVG::geometry::Pose3 pose(sfm_data.GetPoseOrDie(valid_views[i]));
       vec_sfm_center.push_back( pose.center() );
     }
+    // Convert the GPS positions to ECEF XYZ positions
+    if (!vec_gps_lla.empty())
+    {
+      const Mat3X gps_ecef = lla_to_ecef(
+        Eigen::Map<Mat3X>(vec_gps_lla[0].data(), 3, vec_gps_lla.size()));
+      vec_gps_center.resize(vec_gps_lla.size());
+      Eigen::Map<Mat3X>(vec_gps_center[0].data(), 3, vec_gps_center.size()) = gps_ecef;
+    }
   }
 
   if ( vec_sfm_center.empty() )
@@ -163,13 +183,14 @@ int main(int argc, char **argv)
     {
       case ERegistrationType::ROBUST_RIGID_REGISTRATION:
       {
-        using namespace openMVG::robust;
         using namespace openMVG::geometry;
 
-        geometry::kernel::Similarity3_Kernel kernel(X_SfM, X_GPS);
-        const double lmeds_median = LeastMedianOfSquares
+        // Robust estimation - LMeds (since no threshold can be defined),
+        //  the hypotheses are fitted & scored in parallel
+        const double lmeds_median = geometry::kernel::Similarity3_LMeds
           (
-            kernel,
+            X_SfM,
+            X_GPS,
             &sim
           );
         std::cout << "LMeds found a model with an upper bound of: " <<  sqrt(lmeds_median) << " user units."<< std::endl;
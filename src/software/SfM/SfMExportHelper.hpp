@@ -0,0 +1,270 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_EXPORT_HELPER_H
+#define OPENMVG_SFM_EXPORT_HELPER_H
+
+#include "openMVG/cameras/Camera_undistort_image.hpp"
+#include "openMVG/cameras/Camera_undistort_map.hpp"
+#include "openMVG/image/image_converter.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/types.hpp"
+
+#include "third_party/progress/progress.hpp"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openMVG{
+namespace exportHelper{
+
+/// Bound the size of the images that are decoded at the same time
+class Image_Memory_Budget
+{
+public:
+  explicit Image_Memory_Budget(size_t budget) : budget_(budget) {}
+
+  /// Wait until the requested memory is available
+  /// (an image larger than the budget is accepted when nothing else is in use)
+  void Acquire(size_t size)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [&]{ return used_ == 0 || used_ + size <= budget_; });
+    used_ += size;
+  }
+
+  void Release(size_t size)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      used_ -= size;
+    }
+    condition_.notify_all();
+  }
+
+private:
+  const size_t budget_;
+  size_t used_ = 0;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+/// An image to export: the source image is undistorted (if requested and if
+///  the camera of the view has a distortion), copied or converted to the
+///  destination file
+struct Image_Export_Job
+{
+  IndexT view_id = UndefinedIndexT;
+  std::string src_image;
+  std::string dst_image;
+  bool b_undistort = true;
+};
+
+/// Status and size of an exported image
+struct Image_Export_Result
+{
+  bool b_ok = false;
+  int width = 0;
+  int height = 0;
+};
+
+/// Case insensitive file extension comparison
+inline bool SameExtension
+(
+  const std::string & filename1,
+  const std::string & filename2
+)
+{
+  std::string ext1 = stlplus::extension_part(filename1);
+  std::string ext2 = stlplus::extension_part(filename2);
+  std::transform(ext1.begin(), ext1.end(), ext1.begin(), ::tolower);
+  std::transform(ext2.begin(), ext2.end(), ext2.begin(), ::tolower);
+  return ext1 == ext2;
+}
+
+/**
+* @brief Precompute the undistortion maps of the intrinsics shared by several views.
+*
+* @param sfm_data The scene
+* @param view_count_per_intrinsic Number of images to undistort per intrinsic id
+* @return The undistortion maps of the distorted intrinsics used more than once
+*/
+inline std::map<IndexT, cameras::UndistortionMap> BuildUndistortionMaps
+(
+  const sfm::SfM_Data & sfm_data,
+  const std::map<IndexT, int> & view_count_per_intrinsic
+)
+{
+  std::map<IndexT, cameras::UndistortionMap> undistortion_maps;
+  for (const auto & count_it : view_count_per_intrinsic)
+  {
+    const auto intrinsic_it = sfm_data.GetIntrinsics().find(count_it.first);
+    if (count_it.second > 1 && intrinsic_it != sfm_data.GetIntrinsics().end() &&
+        intrinsic_it->second->have_disto())
+    {
+      const cameras::IntrinsicBase * cam = intrinsic_it->second.get();
+      undistortion_maps[count_it.first].Build(cam, cam->w(), cam->h());
+    }
+  }
+  return undistortion_maps;
+}
+
+/**
+* @brief Export the images of a scene in parallel.
+*
+* The images are decoded, undistorted and encoded by several threads while the
+*  size of the decoded images in flight is bounded by a memory budget.
+* The undistortion maps of the intrinsics shared by several views are
+*  computed once. An image that needs no undistortion is copied when the
+*  source and destination formats match.
+* The size of each exported image is returned, so the callers do not have to
+*  read the written files again.
+*
+* @param sfm_data The scene
+* @param jobs The images to export
+* @param memory_budget Maximal size (in bytes) of the images decoded at the same time
+* @param progress Optional progress display (incremented once per job)
+* @param on_image Optional callback on_image(job_index, image) called with
+*  each exported image (all the images are then decoded)
+* @return The per job results
+*/
+inline std::vector<Image_Export_Result> ExportImages
+(
+  const sfm::SfM_Data & sfm_data,
+  const std::vector<Image_Export_Job> & jobs,
+  size_t memory_budget,
+  C_Progress * progress = nullptr,
+  const std::function<void(size_t, const image::Image<image::RGBColor> &)> & on_image = nullptr
+)
+{
+  using namespace openMVG::cameras;
+  using namespace openMVG::image;
+
+  // Camera of each job (nullptr if the image is not undistorted)
+  std::vector<const IntrinsicBase *> job_cameras(jobs.size(), nullptr);
+  std::map<IndexT, int> job_count_per_intrinsic;
+  for (size_t i = 0; i < jobs.size(); ++i)
+  {
+    if (!jobs[i].b_undistort)
+      continue;
+    const sfm::View * view = sfm_data.GetViews().at(jobs[i].view_id).get();
+    const auto intrinsic_it = sfm_data.GetIntrinsics().find(view->id_intrinsic);
+    if (intrinsic_it != sfm_data.GetIntrinsics().end() && intrinsic_it->second->have_disto())
+    {
+      job_cameras[i] = intrinsic_it->second.get();
+      ++job_count_per_intrinsic[view->id_intrinsic];
+    }
+  }
+
+  const std::map<IndexT, UndistortionMap> undistortion_maps =
+    BuildUndistortionMaps(sfm_data, job_count_per_intrinsic);
+
+  std::vector<Image_Export_Result> results(jobs.size());
+  Image_Memory_Budget budget(memory_budget);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(jobs.size()); ++i)
+  {
+    const Image_Export_Job & job = jobs[i];
+    const sfm::View * view = sfm_data.GetViews().at(job.view_id).get();
+    const IntrinsicBase * cam = job_cameras[i];
+    Image_Export_Result & result = results[i];
+
+    const bool b_copy = !cam && SameExtension(job.src_image, job.dst_image);
+    if (b_copy && !on_image)
+    {
+      result.b_ok = stlplus::file_copy(job.src_image, job.dst_image);
+      result.width = view->ui_width;
+      result.height = view->ui_height;
+      if (result.b_ok && (result.width == 0 || result.height == 0))
+      {
+        ImageHeader header;
+        result.b_ok = ReadImageHeader(job.src_image.c_str(), &header);
+        result.width = header.width;
+        result.height = header.height;
+      }
+    }
+    else
+    {
+      // Reserve the image memory (RGB estimate) before decoding it.
+      // The image header is read if the view does not store the image size.
+      size_t width = view->ui_width, height = view->ui_height;
+      ImageHeader header;
+      if ((width == 0 || height == 0) && ReadImageHeader(job.src_image.c_str(), &header))
+      {
+        width = header.width;
+        height = header.height;
+      }
+      const size_t image_size = width * height * 3 * (cam ? 2 : 1);
+      budget.Acquire(image_size);
+
+      Image<RGBColor> image, image_ud;
+      bool b_read = ReadImage(job.src_image.c_str(), &image) != 0;
+      if (!b_read)
+      {
+        // If RGBColor reading fails, we try to read a gray image
+        Image<unsigned char> image_gray;
+        b_read = ReadImage(job.src_image.c_str(), &image_gray) != 0;
+        if (b_read)
+          ConvertPixelType(image_gray, &image);
+      }
+      if (b_read)
+      {
+        if (cam)
+        {
+          const auto map_it = undistortion_maps.find(view->id_intrinsic);
+          if (map_it == undistortion_maps.end() || !map_it->second.Apply(image, image_ud, BLACK))
+            UndistortImage(image, cam, image_ud, BLACK);
+        }
+        const Image<RGBColor> & output = cam ? image_ud : image;
+        result.b_ok = b_copy
+          ? stlplus::file_copy(job.src_image, job.dst_image)
+          : WriteImage(job.dst_image.c_str(), output) != 0;
+        result.width = output.Width();
+        result.height = output.Height();
+        if (result.b_ok && on_image)
+          on_image(i, output);
+      }
+      budget.Release(image_size);
+    }
+
+    if (!result.b_ok)
+    {
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      {
+        std::cerr << "Unable to export the image:\n"
+          << job.src_image << " -> " << job.dst_image << std::endl;
+      }
+    }
+    if (progress)
+    {
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      ++(*progress);
+    }
+  }
+  return results;
+}
+
+} // namespace exportHelper
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_EXPORT_HELPER_H
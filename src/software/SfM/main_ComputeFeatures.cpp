@@ -16,6 +16,7 @@
 #include "openMVG/features/regions_factory_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
@@ -69,6 +70,7 @@ int main(int argc, char **argv)
   std::string sImage_Describer_Method = "SIFT";
   bool bForce = false;
   std::string sFeaturePreset = "";
+  std::string sProfileFilename = "";
 #ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 0;
 #endif
@@ -81,6 +83,7 @@ int main(int argc, char **argv)
   cmd.add( make_option('u', bUpRight, "upright") );
   cmd.add( make_option('f', bForce, "force") );
   cmd.add( make_option('p', sFeaturePreset, "describerPreset") );
+  cmd.add( make_option('Z', sProfileFilename, "profile") );
 
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
@@ -107,6 +110,8 @@ int main(int argc, char **argv)
       << "   NORMAL (default),\n"
       << "   HIGH,\n"
       << "   ULTRA: !!Can take long time!!\n"
+      << "[-Z|--profile] path of a Chrome trace file (.json) to record\n"
+      << "  the profiling zones and counters (and display a summary)\n"
 #ifdef OPENMVG_USE_OPENMP
       << "[-n|--numThreads] number of parallel computations\n"
 #endif
@@ -135,6 +140,8 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  system::profiling::Session profiling_session(sProfileFilename);
+
   // Create output dir
   if (!stlplus::folder_exists(sOutDir))
   {
@@ -276,8 +283,14 @@ int main(int argc, char **argv)
       // If features or descriptors file are missing, compute them
       if (!preemptive_exit && (bForce || !stlplus::file_exists(sFeat) || !stlplus::file_exists(sDesc)))
       {
-        if (!ReadImage(sView_filename.c_str(), &imageGray))
-          continue;
+        OPENMVG_PROFILE_ZONE("feature_extraction");
+        {
+          OPENMVG_PROFILE_ZONE("image_read");
+          if (!ReadImage(sView_filename.c_str(), &imageGray))
+            continue;
+          OPENMVG_PROFILE_BYTES_READ(stlplus::file_size(sView_filename));
+          OPENMVG_PROFILE_BYTES_ALLOCATED(imageGray.Width() * imageGray.Height());
+        }
 
         //
         // Look if there is occlusion feature mask
@@ -325,7 +338,12 @@ int main(int argc, char **argv)
         }
 
         // Compute features and descriptors and export them to files
-        auto regions = image_describer->Describe(imageGray, mask);
+        std::unique_ptr<Regions> regions;
+        {
+          OPENMVG_PROFILE_ZONE("describe");
+          regions = image_describer->Describe(imageGray, mask);
+        }
+        OPENMVG_PROFILE_ZONE("regions_save");
         if (regions && !image_describer->Save(regions.get(), sFeat, sDesc)) {
           std::cerr << "Cannot save regions for images: " << sView_filename << std::endl
                     << "Stopping feature extraction." << std::endl;
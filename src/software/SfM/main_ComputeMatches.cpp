@@ -27,6 +27,7 @@
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/stl/stl.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
@@ -77,8 +78,11 @@ int main(int argc, char **argv)
   std::string sNearestMatchingMethod = "AUTO";
   bool bForce = false;
   bool bGuided_matching = false;
+  bool bProsacSprt = false;
   int imax_iteration = 2048;
   unsigned int ui_max_cache_size = 0;
+  unsigned int ui_max_cache_memory = 0;
+  std::string sProfileFilename = "";
 
   //required
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
@@ -91,8 +95,11 @@ int main(int argc, char **argv)
   cmd.add( make_option('n', sNearestMatchingMethod, "nearest_matching_method") );
   cmd.add( make_option('f', bForce, "force") );
   cmd.add( make_option('m', bGuided_matching, "guided_matching") );
+  cmd.add( make_option('P', bProsacSprt, "prosac_sprt") );
   cmd.add( make_option('I', imax_iteration, "max_iteration") );
   cmd.add( make_option('c', ui_max_cache_size, "cache_size") );
+  cmd.add( make_option('C', ui_max_cache_memory, "cache_memory") );
+  cmd.add( make_option('Z', sProfileFilename, "profile") );
 
 
   try {
@@ -131,15 +138,25 @@ int main(int argc, char **argv)
       << "    BRUTEFORCEHAMMING: BruteForce Hamming matching.\n"
       << "[-m|--guided_matching]\n"
       << "  use the found model to improve the pairwise correspondences.\n"
+      << "[-P|--prosac_sprt]\n"
+      << "  robust estimation: draw the samples by descriptor distance order (PROSAC)\n"
+      << "  and reject the bad models early (SPRT) (faster on high outlier ratios).\n"
       << "[-c|--cache_size]\n"
       << "  Use a regions cache (only cache_size regions will be stored in memory)"
-      << "  If not used, all regions will be load in memory."
+      << "  If not used, all regions will be load in memory.\n"
+      << "[-C|--cache_memory]\n"
+      << "  Use a regions cache (only cache_memory MB of regions will be stored in memory)\n"
+      << "  Can be combined with --cache_size.\n"
+      << "[-Z|--profile] path of a Chrome trace file (.json) to record\n"
+      << "  the profiling zones and counters (and display a summary)\n"
       << std::endl;
 
       std::cerr << s << std::endl;
       return EXIT_FAILURE;
   }
 
+  system::profiling::Session profiling_session(sProfileFilename);
+
   std::cout << " You called : " << "\n"
             << argv[0] << "\n"
             << "--input_file " << sSfM_Data_Filename << "\n"
@@ -152,7 +169,9 @@ int main(int argc, char **argv)
             << "--pair_list " << sPredefinedPairList << "\n"
             << "--nearest_matching_method " << sNearestMatchingMethod << "\n"
             << "--guided_matching " << bGuided_matching << "\n"
-            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << std::endl;
+            << "--prosac_sprt " << bProsacSprt << "\n"
+            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << "\n"
+            << "--cache_memory " << ((ui_max_cache_memory == 0) ? "unlimited" : std::to_string(ui_max_cache_memory)) << std::endl;
 
   EPairMode ePairmode = (iMatchingVideoMode == -1 ) ? PAIR_EXHAUSTIVE : PAIR_CONTIGUOUS;
 
@@ -233,7 +252,7 @@ int main(int argc, char **argv)
 
   // Load the corresponding view regions
   std::shared_ptr<Regions_Provider> regions_provider;
-  if (ui_max_cache_size == 0)
+  if (ui_max_cache_size == 0 && ui_max_cache_memory == 0)
   {
     // Default regions provider (load & store all regions in memory)
     regions_provider = std::make_shared<Regions_Provider>();
@@ -241,7 +260,8 @@ int main(int argc, char **argv)
   else
   {
     // Cached regions provider (load & store regions on demand)
-    regions_provider = std::make_shared<Regions_Provider_Cache>(ui_max_cache_size);
+    regions_provider = std::make_shared<Regions_Provider_Cache>(
+      ui_max_cache_size, static_cast<size_t>(ui_max_cache_memory) * 1024 * 1024);
   }
 
   // Show the progress on the command line:
@@ -416,7 +436,7 @@ int main(int argc, char **argv)
       case HOMOGRAPHY_MATRIX:
       {
         const bool bGeometric_only_guided_matching = true;
-        filter_ptr->Robust_model_estimation(GeometricFilter_HMatrix_AC(pixel_tol, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_HMatrix_AC(pixel_tol, imax_iteration, bProsacSprt),
           map_PutativesMatches, bGuided_matching,
           bGeometric_only_guided_matching ? -1.0 : d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
@@ -424,14 +444,14 @@ int main(int argc, char **argv)
       break;
       case FUNDAMENTAL_MATRIX:
       {
-        filter_ptr->Robust_model_estimation(GeometricFilter_FMatrix_AC(pixel_tol, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_FMatrix_AC(pixel_tol, imax_iteration, bProsacSprt),
           map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
       }
       break;
       case ESSENTIAL_MATRIX:
       {
-        filter_ptr->Robust_model_estimation(GeometricFilter_EMatrix_AC(pixel_tol, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_EMatrix_AC(pixel_tol, imax_iteration, bProsacSprt),
           map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
 
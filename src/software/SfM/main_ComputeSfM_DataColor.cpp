@@ -9,139 +9,188 @@
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
-#include "openMVG/stl/stl.hpp"
 #include "openMVG/types.hpp"
+#include "software/SfM/SfMExportHelper.hpp"
 #include "software/SfM/SfMPlyHelper.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <atomic>
+#include <map>
+#include <queue>
+#include <utility>
+#include <vector>
+
 using namespace openMVG;
 using namespace openMVG::image;
 using namespace openMVG::sfm;
 
+/// Assign to each landmark the view used to pick its color.
+/// The most representative view (the one that sees the most uncolored tracks)
+///  is selected first, then the counts of the remaining views are updated.
+/// The counts are kept in a lazy max-heap and a view to landmark inverted index,
+///  so the landmarks are not rescanned at each round.
+/// Return the per view list of (landmark contiguous index, observation).
+std::map<IndexT, std::vector<std::pair<IndexT, const Observation *>>>
+AssignTracksToViews
+(
+  const SfM_Data & sfm_data
+)
+{
+  // Landmarks ordered by contiguous index
+  std::vector<const Landmark *> landmarks;
+  landmarks.reserve(sfm_data.GetLandmarks().size());
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+    landmarks.push_back(&landmark_it.second);
+
+  // Inverted index: the landmarks observed by each view
+  std::map<IndexT, std::vector<IndexT>> view_to_landmarks;
+  for (IndexT i = 0; i < landmarks.size(); ++i)
+  {
+    for (const auto & obs_it : landmarks[i]->obs)
+      view_to_landmarks[obs_it.first].push_back(i);
+  }
+
+  // Number of uncolored landmarks seen by each view
+  std::map<IndexT, IndexT> view_cardinal;
+  // (cardinal, view id) max-heap, the smallest view id wins the ties
+  using Heap_Entry = std::pair<IndexT, IndexT>;
+  auto heap_less = [](const Heap_Entry & a, const Heap_Entry & b)
+  {
+    return a.first < b.first || (a.first == b.first && a.second > b.second);
+  };
+  std::priority_queue<Heap_Entry, std::vector<Heap_Entry>, decltype(heap_less)> heap(heap_less);
+  for (const auto & view_it : view_to_landmarks)
+  {
+    view_cardinal[view_it.first] = view_it.second.size();
+    heap.emplace(view_it.second.size(), view_it.first);
+  }
+
+  std::vector<bool> colored(landmarks.size(), false);
+  std::map<IndexT, std::vector<std::pair<IndexT, const Observation *>>> view_samples;
+  while (!heap.empty())
+  {
+    const Heap_Entry top = heap.top();
+    heap.pop();
+    const IndexT view_id = top.second;
+    const IndexT cardinal = view_cardinal[view_id];
+    if (cardinal == 0)
+      continue;
+    if (cardinal != top.first) // Outdated entry, reinsert it with its current count
+    {
+      heap.emplace(cardinal, view_id);
+      continue;
+    }
+    // Color with this view all the uncolored landmarks that it observes
+    std::vector<std::pair<IndexT, const Observation *>> & samples = view_samples[view_id];
+    for (const IndexT landmark_index : view_to_landmarks[view_id])
+    {
+      if (colored[landmark_index])
+        continue;
+      colored[landmark_index] = true;
+      const Observations & obs = landmarks[landmark_index]->obs;
+      samples.emplace_back(landmark_index, &obs.at(view_id));
+      for (const auto & obs_it : obs)
+        --view_cardinal[obs_it.first];
+    }
+  }
+  return view_samples;
+}
+
 /// Find the color of the SfM_Data Landmarks/structure
 bool ColorizeTracks(
   const SfM_Data & sfm_data,
   std::vector<Vec3> & vec_3dPoints,
-  std::vector<Vec3> & vec_tracksColor)
+  std::vector<Vec3> & vec_tracksColor,
+  size_t memory_budget)
 {
   // Colorize each track
-  //  Start with the most representative image
-  //    and iterate to provide a color to each 3D point
+  //  Assign each track to the most representative image
+  //    then decode the images in parallel and sample the track colors
+
+  vec_tracksColor.resize(sfm_data.GetLandmarks().size());
+  vec_3dPoints.resize(sfm_data.GetLandmarks().size());
 
+  IndexT cpt = 0;
+  for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
+    it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
   {
-    C_Progress_display my_progress_bar(sfm_data.GetLandmarks().size(),
-                                       std::cout,
-                                       "\nCompute scene structure color\n");
-
-    vec_tracksColor.resize(sfm_data.GetLandmarks().size());
-    vec_3dPoints.resize(sfm_data.GetLandmarks().size());
-
-    //Build a list of contiguous index for the trackIds
-    std::map<IndexT, IndexT> trackIds_to_contiguousIndexes;
-    IndexT cpt = 0;
-    for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
-      it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
-    {
-      trackIds_to_contiguousIndexes[it->first] = cpt;
-      vec_3dPoints[cpt] = it->second.X;
-    }
+    vec_3dPoints[cpt] = it->second.X;
+  }
 
-    // The track list that will be colored (point removed during the process)
-    std::set<IndexT> remainingTrackToColor;
-    std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-      std::inserter(remainingTrackToColor, remainingTrackToColor.begin()),
-      stl::RetrieveKey());
+  const auto view_samples = AssignTracksToViews(sfm_data);
+  // Flatten the view list for the parallel loop
+  std::vector<std::pair<IndexT, const std::vector<std::pair<IndexT, const Observation *>> *>> jobs;
+  jobs.reserve(view_samples.size());
+  for (const auto & view_it : view_samples)
+    jobs.emplace_back(view_it.first, &view_it.second);
 
-    while ( !remainingTrackToColor.empty() )
+  C_Progress_display my_progress_bar(sfm_data.GetLandmarks().size(),
+                                     std::cout,
+                                     "\nCompute scene structure color\n");
+
+  exportHelper::Image_Memory_Budget budget(memory_budget);
+  std::atomic<bool> bOk(true); // Read & written by the parallel loop
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(jobs.size()); ++i)
+  {
+    if (!bOk)
+      continue;
+
+    const View * view = sfm_data.GetViews().at(jobs[i].first).get();
+    const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
+      view->s_Img_path);
+
+    // Reserve the image memory (RGB estimate from the view size) before decoding it
+    const size_t image_size = static_cast<size_t>(view->ui_width) * view->ui_height * 3;
+    budget.Acquire(image_size);
+
+    // Decode the image once (the channel count is given by the decoder)
+    std::vector<unsigned char> pixels;
+    int w = 0, h = 0, depth = 0;
+    const bool b_image = ReadImage(sView_filename.c_str(), &pixels, &w, &h, &depth) == 1
+      && (depth == 1 || depth == 3 || depth == 4);
+    if (!b_image)
     {
-      // Find the most representative image (for the remaining 3D points)
-      //  a. Count the number of observation per view for each 3Dpoint Index
-      //  b. Sort to find the most representative view index
-
-      std::map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
-      for (std::set<IndexT>::const_iterator
-        iterT = remainingTrackToColor.begin();
-        iterT != remainingTrackToColor.end();
-        ++iterT)
+      budget.Release(image_size);
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
       {
-        const size_t trackId = *iterT;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        for (Observations::const_iterator iterObs = obs.begin();
-          iterObs != obs.end(); ++iterObs)
-        {
-          const size_t viewId = iterObs->first;
-          if (map_IndexCardinal.find(viewId) == map_IndexCardinal.end())
-            map_IndexCardinal[viewId] = 1;
-          else
-            ++map_IndexCardinal[viewId];
-        }
+        std::cerr << "Cannot open provided the image: " << sView_filename << std::endl;
       }
+      bOk = false;
+      continue;
+    }
 
-      // Find the View index that is the most represented
-      std::vector<IndexT> vec_cardinal;
-      std::transform(map_IndexCardinal.begin(),
-        map_IndexCardinal.end(),
-        std::back_inserter(vec_cardinal),
-        stl::RetrieveValue());
-      using namespace stl::indexed_sort;
-      std::vector<sort_index_packet_descend<IndexT, IndexT>> packet_vec(vec_cardinal.size());
-      sort_index_helper(packet_vec, &vec_cardinal[0], 1);
-
-      // First image index with the most of occurence
-      std::map<IndexT, IndexT>::const_iterator iterTT = map_IndexCardinal.begin();
-      std::advance(iterTT, packet_vec[0].index);
-      const size_t view_index = iterTT->first;
-      const View * view = sfm_data.GetViews().at(view_index).get();
-      const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
-        view->s_Img_path);
-      Image<RGBColor> image_rgb;
-      Image<unsigned char> image_gray;
-      const bool b_rgb_image = ReadImage(sView_filename.c_str(), &image_rgb);
-      if (!b_rgb_image) //try Gray level
-      {
-        const bool b_gray_image = ReadImage(sView_filename.c_str(), &image_gray);
-        if (!b_gray_image)
-        {
-          std::cerr << "Cannot open provided the image." << std::endl;
-          return false;
-        }
-      }
+    // Sample the track colors
+    for (const auto & sample : *jobs[i].second)
+    {
+      const Vec2 & pt = sample.second->x;
+      const int x = static_cast<int>(pt.x()), y = static_cast<int>(pt.y());
+      if (x < 0 || y < 0 || x >= w || y >= h)
+        continue;
+      const unsigned char * pixel = &pixels[(static_cast<size_t>(y) * w + x) * depth];
+      vec_tracksColor[sample.first] = (depth == 1)
+        ? Vec3(pixel[0], pixel[0], pixel[0])
+        : Vec3(pixel[0], pixel[1], pixel[2]);
+    }
+    pixels.clear();
+    pixels.shrink_to_fit();
+    budget.Release(image_size);
 
-      // Iterate through the remaining track to color
-      // - look if the current view is present to color the track
-      std::set<IndexT> set_toRemove;
-      for (std::set<IndexT>::const_iterator
-        iterT = remainingTrackToColor.begin();
-        iterT != remainingTrackToColor.end();
-        ++iterT)
-      {
-        const size_t trackId = *iterT;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        Observations::const_iterator it = obs.find(view_index);
-
-        if (it != obs.end())
-        {
-          // Color the track
-          const Vec2 & pt = it->second.x;
-          const RGBColor color = b_rgb_image ? image_rgb(pt.y(), pt.x()) : RGBColor(image_gray(pt.y(), pt.x()));
-
-          vec_tracksColor[ trackIds_to_contiguousIndexes[trackId] ] = Vec3(color.r(), color.g(), color.b());
-          set_toRemove.insert(trackId);
-          ++my_progress_bar;
-        }
-      }
-      // Remove colored track
-      for (std::set<IndexT>::const_iterator iter = set_toRemove.begin();
-        iter != set_toRemove.end(); ++iter)
-      {
-        remainingTrackToColor.erase(*iter);
-      }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    {
+      my_progress_bar += jobs[i].second->size();
     }
   }
-  return true;
+  return bOk;
 }
 
 /// Export camera poses positions as a Vec3 vector
@@ -165,9 +214,11 @@ int main(int argc, char **argv)
   std::string
     sSfM_Data_Filename_In,
     sOutputPLY_Out;
+  unsigned int iMemoryBudget = 1024;
 
   cmd.add(make_option('i', sSfM_Data_Filename_In, "input_file"));
   cmd.add(make_option('o', sOutputPLY_Out, "output_file"));
+  cmd.add(make_option('m', iMemoryBudget, "memory_budget"));
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -176,6 +227,9 @@ int main(int argc, char **argv)
       std::cerr << "Usage: " << argv[0] << '\n'
         << "[-i|--input_file] path to the input SfM_Data scene\n"
         << "[-o|--output_file] path to the output PLY file\n"
+        << "\n[Optional]\n"
+        << "[-m|--memory_budget] maximal size (in MB) of the images decoded at the same time\n"
+        << "  (default: 1024)\n"
         << std::endl;
 
       std::cerr << s << std::endl;
@@ -200,7 +254,8 @@ int main(int argc, char **argv)
 
   // Compute the scene structure color
   std::vector<Vec3> vec_3dPoints, vec_tracksColor, vec_camPosition;
-  if (ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor))
+  if (ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor,
+        static_cast<size_t>(iMemoryBudget) * 1024 * 1024))
   {
     GetCameraPositions(sfm_data, vec_camPosition);
 
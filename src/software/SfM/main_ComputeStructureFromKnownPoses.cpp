@@ -24,6 +24,7 @@
 #include "openMVG/sfm/sfm_report.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
 #include "openMVG/tracks/tracks.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 #include "openMVG/types.hpp"
 
@@ -63,6 +64,8 @@ int main(int argc, char **argv)
   std::string sOutFile = "";
   double dMax_reprojection_error = 4.0;
   unsigned int ui_max_cache_size = 0;
+  unsigned int ui_max_cache_memory = 0;
+  std::string sProfileFilename = "";
 
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
   cmd.add( make_option('m', sMatchesDir, "match_dir") );
@@ -72,7 +75,9 @@ int main(int argc, char **argv)
   cmd.add( make_switch('b', "bundle_adjustment"));
   cmd.add( make_option('r', dMax_reprojection_error, "residual_threshold"));
   cmd.add( make_option('c', ui_max_cache_size, "cache_size") );
+  cmd.add( make_option('C', ui_max_cache_memory, "cache_memory") );
   cmd.add( make_switch('d', "direct_triangulation"));
+  cmd.add( make_option('Z', sProfileFilename, "profile") );
 
   try {
     if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -100,6 +105,11 @@ int main(int argc, char **argv)
         << "[-c|--cache_size]\n"
     << "  Use a regions cache (only cache_size regions will be stored in memory)\n"
     << "  If not used, all regions will be load in memory.\n"
+    << "[-C|--cache_memory]\n"
+    << "  Use a regions cache (only cache_memory MB of regions will be stored in memory)\n"
+    << "  Can be combined with --cache_size.\n"
+    << "[-Z|--profile] path of a Chrome trace file (.json) to record\n"
+    << "  the profiling zones and counters (and display a summary)\n"
 
     << std::endl;
 
@@ -107,6 +117,8 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  system::profiling::Session profiling_session(sProfileFilename);
+
   // Load input SfM_Data scene
   SfM_Data sfm_data;
   if (!Load(sfm_data, sSfM_Data_Filename, ESfM_Data(VIEWS|INTRINSICS|EXTRINSICS))) {
@@ -128,7 +140,7 @@ int main(int argc, char **argv)
 
   // Prepare the Regions provider
   std::shared_ptr<Regions_Provider> regions_provider;
-  if (ui_max_cache_size == 0)
+  if (ui_max_cache_size == 0 && ui_max_cache_memory == 0)
   {
     // Default regions provider (load & store all regions in memory)
     regions_provider = std::make_shared<Regions_Provider>();
@@ -136,7 +148,8 @@ int main(int argc, char **argv)
   else
   {
     // Cached regions provider (load & store regions on demand)
-    regions_provider = std::make_shared<Regions_Provider_Cache>(ui_max_cache_size);
+    regions_provider = std::make_shared<Regions_Provider_Cache>(
+      ui_max_cache_size, static_cast<size_t>(ui_max_cache_memory) * 1024 * 1024);
   }
 
   // Show the progress on the command line:
@@ -7,16 +7,20 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_undistort_image.hpp"
+#include "openMVG/cameras/Camera_undistort_map.hpp"
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/system/timer.hpp"
 
+#include "software/SfM/SfMExportHelper.hpp"
+
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
 #include <cstdlib>
+#include <map>
 #include <string>
 
 #ifdef OPENMVG_USE_OPENMP
@@ -89,6 +93,13 @@ int main(int argc, char *argv[]) {
     Image<uint8_t> image_gray, image_gray_ud;
     C_Progress_display my_progress_bar( sfm_data.GetViews().size(), std::cout, "\n- EXTRACT UNDISTORTED IMAGES -\n" );
 
+    // Precompute the undistortion maps of the intrinsics shared by several views
+    std::map<IndexT, int> view_count_per_intrinsic;
+    for (const auto & view_it : sfm_data.GetViews())
+      ++view_count_per_intrinsic[view_it.second->id_intrinsic];
+    const std::map<IndexT, UndistortionMap> undistortion_maps =
+      exportHelper::BuildUndistortionMaps(sfm_data, view_count_per_intrinsic);
+
     #ifdef OPENMVG_USE_OPENMP
     const unsigned int nb_max_thread = omp_get_max_threads();
     #endif
@@ -127,7 +138,9 @@ int main(int argc, char *argv[]) {
         // undistort the image and save it
         if (ReadImage( srcImage.c_str(), &image))
         {
-          UndistortImage(image, cam, image_ud, BLACK);
+          const auto map_it = undistortion_maps.find(view->id_intrinsic);
+          if (map_it == undistortion_maps.end() || !map_it->second.Apply(image, image_ud, BLACK))
+            UndistortImage(image, cam, image_ud, BLACK);
           const bool bRes = WriteImage(dstImage.c_str(), image_ud);
 #ifdef OPENMVG_USE_OPENMP
           #pragma omp critical
@@ -137,7 +150,9 @@ int main(int argc, char *argv[]) {
         else // If RGBColor reading fails, we try to read a gray image
         if (ReadImage( srcImage.c_str(), &image_gray))
         {
-          UndistortImage(image_gray, cam, image_gray_ud, BLACK);
+          const auto map_it = undistortion_maps.find(view->id_intrinsic);
+          if (map_it == undistortion_maps.end() || !map_it->second.Apply(image_gray, image_gray_ud, BLACK))
+            UndistortImage(image_gray, cam, image_gray_ud, BLACK);
           const bool bRes = WriteImage(dstImage.c_str(), image_gray_ud);
 #ifdef OPENMVG_USE_OPENMP
           #pragma omp critical
@@ -13,9 +13,11 @@
 #include "openMVG/sfm/pipelines/global/sfm_global_engine_relative_motions.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
+#include "openMVG/sfm/pipelines/sfm_relative_pose_store.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_report.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
@@ -49,6 +51,8 @@ int main(int argc, char **argv)
   std::string sSfM_Data_Filename;
   std::string sMatchesDir, sMatchFilename;
   std::string sOutDir = "";
+  std::string sRelativePoseStoreFilename = "";
+  std::string sProfileFilename = "";
   int iRotationAveragingMethod = int (ROTATION_AVERAGING_L2);
   int iTranslationAveragingMethod = int (TRANSLATION_AVERAGING_SOFTL1);
   std::string sIntrinsic_refinement_options = "ADJUST_ALL";
@@ -64,6 +68,8 @@ int main(int argc, char **argv)
   cmd.add( make_option('f', sIntrinsic_refinement_options, "refineIntrinsics") );
   cmd.add( make_switch('P', "prior_usage") );
   cmd.add( make_switch('D', "decouple") );
+  cmd.add( make_option('S', sRelativePoseStoreFilename, "relative_pose_store") );
+  cmd.add( make_option('Z', sProfileFilename, "profile") );
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -97,12 +103,18 @@ int main(int argc, char **argv)
     << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions)\n"
     << "[-D|--decouple] Give separate intrinsics to each view before final adjustment.\n"
     << "[-M|--match_file] path to the match file to use.\n"
+    << "[-S|--relative_pose_store] path to a relative motion store (.bin).\n"
+    << "\t Loaded if it exists, completed with the newly estimated relative motions and saved.\n"
+    << "[-Z|--profile] path of a Chrome trace file (.json) to record\n"
+    << "  the profiling zones and counters (and display a summary)\n"
     << std::endl;
 
     std::cerr << s << std::endl;
     return EXIT_FAILURE;
   }
 
+  system::profiling::Session profiling_session(sProfileFilename);
+
   if (iRotationAveragingMethod < ROTATION_AVERAGING_L1 ||
       iRotationAveragingMethod > ROTATION_AVERAGING_L2 )  {
     std::cerr << "\n Rotation averaging method is invalid" << std::endl;
@@ -190,6 +202,22 @@ int main(int argc, char **argv)
   sfmEngine.SetFeaturesProvider(feats_provider.get());
   sfmEngine.SetMatchesProvider(matches_provider.get());
 
+  // Configure the optional relative motion store
+  Relative_Pose_Store relative_pose_store;
+  if (!sRelativePoseStoreFilename.empty())
+  {
+    if (stlplus::file_exists(sRelativePoseStoreFilename) &&
+        !relative_pose_store.Load(sRelativePoseStoreFilename))
+    {
+      std::cerr << "\nCannot read the relative motion store: "
+        << sRelativePoseStoreFilename << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Relative motion store: #relative motions: "
+      << relative_pose_store.size() << std::endl;
+    sfmEngine.SetRelativePoseStore(&relative_pose_store);
+  }
+
   // Configure reconstruction parameters
   sfmEngine.Set_Intrinsics_Refinement_Type(intrinsic_refinement_options);
   b_use_motion_priors = cmd.used('P');
@@ -203,7 +231,17 @@ int main(int argc, char **argv)
   sfmEngine.SetTranslationAveragingMethod(
     ETranslationAveragingMethod(iTranslationAveragingMethod));
 
-  if (sfmEngine.Process())
+  const bool b_process = sfmEngine.Process();
+
+  // Save the relative motions (even on failure, they can be reused by another run)
+  if (!sRelativePoseStoreFilename.empty() &&
+      !relative_pose_store.Save(sRelativePoseStoreFilename))
+  {
+    std::cerr << "\nCannot save the relative motion store: "
+      << sRelativePoseStoreFilename << std::endl;
+  }
+
+  if (b_process)
   {
     std::cout << std::endl << " Total Ac-Global-Sfm took (s): " << timer.elapsed() << std::endl;
 
@@ -11,10 +11,12 @@
 #include "openMVG/sfm/pipelines/sequential/sequential_SfM.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
+#include "openMVG/sfm/pipelines/sfm_relative_pose_store.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_report.hpp"
 #include "openMVG/sfm/sfm_view.hpp"
+#include "openMVG/system/profiler.hpp"
 #include "openMVG/system/timer.hpp"
 #include "openMVG/types.hpp"
 
@@ -78,6 +80,10 @@ int main(int argc, char **argv)
   std::string sSfM_Data_Filename;
   std::string sMatchesDir, sMatchFilename;
   std::string sOutDir = "";
+  std::string sRelativePoseStoreFilename = "";
+  std::string sProfileFilename = "";
+  std::string sCheckpointFilename = "";
+  unsigned int iCheckpointPeriod = 1;
   std::pair<std::string,std::string> initialPairString("","");
   std::string sIntrinsic_refinement_options = "ADJUST_ALL";
   int i_User_camera_model = PINHOLE_CAMERA_RADIAL3;
@@ -92,6 +98,11 @@ int main(int argc, char **argv)
   cmd.add( make_option('c', i_User_camera_model, "camera_model") );
   cmd.add( make_option('f', sIntrinsic_refinement_options, "refineIntrinsics") );
   cmd.add( make_switch('P', "prior_usage") );
+  cmd.add( make_option('S', sRelativePoseStoreFilename, "relative_pose_store") );
+  cmd.add( make_option('Z', sProfileFilename, "profile") );
+  cmd.add( make_option('C', sCheckpointFilename, "checkpoint") );
+  cmd.add( make_option('p', iCheckpointPeriod, "checkpoint_period") );
+  cmd.add( make_switch('R', "resume") );
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -125,12 +136,23 @@ int main(int argc, char **argv)
       <<      "\t\t-> refine the principal point position & the distortion coefficient(s) (if any)\n"
     << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions) (default: false)\n"
     << "[-M|--match_file] path to the match file to use.\n"
+    << "[-S|--relative_pose_store] path to a relative motion store (.bin).\n"
+    << "\t Loaded if it exists, completed with the newly estimated relative motions and saved.\n"
+    << "[-Z|--profile] path of a Chrome trace file (.json) to record\n"
+    << "  the profiling zones and counters (and display a summary)\n"
+    << "[-C|--checkpoint] path of a checkpoint file (.bin) where the engine state\n"
+    << "  is saved (in background) after the initial pair and the resection groups.\n"
+    << "  The tracks are saved once next to it (.bin.tracks).\n"
+    << "[-p|--checkpoint_period] save a checkpoint every N resection groups (default: 1)\n"
+    << "[-R|--resume] restart from the checkpoint file (if it exists)\n"
     << std::endl;
 
     std::cerr << s << std::endl;
     return EXIT_FAILURE;
   }
 
+  system::profiling::Session profiling_session(sProfileFilename);
+
   if ( !isValid(openMVG::cameras::EINTRINSIC(i_User_camera_model)) )  {
     std::cerr << "\n Invalid camera type" << std::endl;
     return EXIT_FAILURE;
@@ -211,6 +233,22 @@ int main(int argc, char **argv)
   sfmEngine.SetFeaturesProvider(feats_provider.get());
   sfmEngine.SetMatchesProvider(matches_provider.get());
 
+  // Configure the optional relative motion store
+  Relative_Pose_Store relative_pose_store;
+  if (!sRelativePoseStoreFilename.empty())
+  {
+    if (stlplus::file_exists(sRelativePoseStoreFilename) &&
+        !relative_pose_store.Load(sRelativePoseStoreFilename))
+    {
+      std::cerr << "\nCannot read the relative motion store: "
+        << sRelativePoseStoreFilename << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Relative motion store: #relative motions: "
+      << relative_pose_store.size() << std::endl;
+    sfmEngine.SetRelativePoseStore(&relative_pose_store);
+  }
+
   // Configure reconstruction parameters
   sfmEngine.Set_Intrinsics_Refinement_Type(intrinsic_refinement_options);
   sfmEngine.SetUnknownCameraType(EINTRINSIC(i_User_camera_model));
@@ -230,7 +268,37 @@ int main(int argc, char **argv)
     sfmEngine.setInitialPair(initialPairIndex);
   }
 
-  if (sfmEngine.Process())
+  // Configure the checkpoints
+  if (!sCheckpointFilename.empty())
+  {
+    if (cmd.used('R') && stlplus::file_exists(sCheckpointFilename))
+    {
+      if (!sfmEngine.ResumeFromCheckpoint(sCheckpointFilename))
+      {
+        std::cerr << "\nCannot resume from the checkpoint: "
+          << sCheckpointFilename << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    sfmEngine.SetCheckpoint(sCheckpointFilename, iCheckpointPeriod);
+  }
+  else if (cmd.used('R'))
+  {
+    std::cerr << "\nThe resume option requires a checkpoint file (-C)." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const bool b_process = sfmEngine.Process();
+
+  // Save the relative motions (even on failure, they can be reused by another run)
+  if (!sRelativePoseStoreFilename.empty() &&
+      !relative_pose_store.Save(sRelativePoseStoreFilename))
+  {
+    std::cerr << "\nCannot save the relative motion store: "
+      << sRelativePoseStoreFilename << std::endl;
+  }
+
+  if (b_process)
   {
     std::cout << std::endl << " Total Ac-Sfm took (s): " << timer.elapsed() << std::endl;
 
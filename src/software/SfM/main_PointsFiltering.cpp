@@ -18,105 +18,6 @@
 #include <memory>
 #include <string>
 
-namespace openMVG {
-namespace sfm {
-
-using namespace openMVG::cameras;
-using namespace openMVG::geometry;
-
-/**
-* @brief Implement a statistical Structure filter that remove 3D points that have:
-* - a depth that is too large (threshold computed as factor * median ~= X84)
-* @param sfm_data The sfm scene to filter (inplace filtering)
-* @param k_factor The factor applied to the median depth per view
-* @param k_min_point_per_pose Keep only poses that have at least this amount of points
-* @param k_min_track_length Keep only tracks that have at least this length
-* @return The min_median_value observed for all the view
-*/
-double DepthCleaning
-(
-  SfM_Data & sfm_data,
-  const double k_factor =  5.2,    //5.2 * median ~= X84,
-  const IndexT k_min_point_per_pose = 12,  // 6 min
-  const IndexT k_min_track_length = 2      // 2 min
-)
-{
-  using DepthAccumulatorT = std::vector<double>;
-  std::map<IndexT, DepthAccumulatorT > map_depth_accumulator;
-
-  // For each landmark accumulate the camera/point depth info for each view
-  for (const auto & landmark_it : sfm_data.structure)
-  {
-    const Observations & obs = landmark_it.second.obs;
-    for (const auto & obs_it : obs)
-    {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (sfm_data.IsPoseAndIntrinsicDefined(view))
-      {
-        const Pose3 pose = sfm_data.GetPoseOrDie(view);
-        const double depth = pose.depth(landmark_it.second.X);
-        if (depth > 0)
-        {
-          map_depth_accumulator[view->id_view].push_back(depth);
-        }
-      }
-    }
-  }
-
-  double min_median_value = std::numeric_limits<double>::max();
-  std::map<IndexT, double > map_median_depth;
-  for (const auto & iter : sfm_data.GetViews())
-  {
-    const View * v = iter.second.get();
-    const IndexT view_id = v->id_view;
-    if (map_depth_accumulator.count(view_id) == 0)
-      continue;
-    // Compute median from the depth distribution
-    const auto & acc = map_depth_accumulator.at(view_id);
-    double min, max, mean, median;
-    if (minMaxMeanMedian(acc.begin(), acc.end(), min, max, mean, median))
-    {
-
-      min_median_value = std::min(min_median_value, median);
-      // Compute depth threshold for each view: factor * medianDepth
-      map_median_depth[view_id] = k_factor * median;
-    }
-  }
-  map_depth_accumulator.clear();
-
-  // Delete invalid observations
-  size_t cpt = 0;
-  for (auto & landmark_it : sfm_data.structure)
-  {
-    Observations obs;
-    for (auto & obs_it : landmark_it.second.obs)
-    {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (sfm_data.IsPoseAndIntrinsicDefined(view))
-      {
-        const Pose3 pose = sfm_data.GetPoseOrDie(view);
-        const double depth = pose.depth(landmark_it.second.X);
-        if ( depth > 0
-            && map_median_depth.count(view->id_view)
-            && depth < map_median_depth[view->id_view])
-          obs.insert(obs_it);
-        else
-          ++cpt;
-      }
-    }
-    landmark_it.second.obs.swap(obs);
-  }
-  std::cout << "#point depth filter: " << cpt << " measurements removed" <<std::endl;
-
-  // Remove orphans
-  eraseUnstablePosesAndObservations(sfm_data, k_min_point_per_pose, k_min_track_length);
-
-  return min_median_value;
-}
-
-} // namespace sfm
-} // namespace openMVG
-
 using namespace openMVG;
 using namespace openMVG::sfm;
 
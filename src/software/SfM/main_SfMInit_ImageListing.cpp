@@ -25,8 +25,10 @@
 
 #include <fstream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -61,43 +63,29 @@ bool checkIntrinsicStringValidity(const std::string & Kmatrix, double & focal, d
   return true;
 }
 
-std::pair<bool, Vec3> checkGPS
+/// Read the GPS coordinates (latitude, longitude, altitude) of an image
+bool checkGPS
 (
-  const std::string & filename,
-  const int & GPS_to_XYZ_method = 0
+  const Exif_IO & exifReader,
+  Vec3 * lla
 )
 {
-  std::pair<bool, Vec3> val(false, Vec3::Zero());
-  std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-  if (exifReader)
-  {
-    // Try to parse EXIF metada & check existence of EXIF data
-    if ( exifReader->open( filename ) && exifReader->doesHaveExifInfo() )
-    {
-      // Check existence of GPS coordinates
-      double latitude, longitude, altitude;
-      if ( exifReader->GPSLatitude( &latitude ) &&
-           exifReader->GPSLongitude( &longitude ) &&
-           exifReader->GPSAltitude( &altitude ) )
-      {
-        // Add ECEF or UTM XYZ position to the GPS position array
-        val.first = true;
-        switch (GPS_to_XYZ_method)
-        {
-          case 1:
-            val.second = lla_to_utm( latitude, longitude, altitude );
-            break;
-          case 0:
-          default:
-            val.second = lla_to_ecef( latitude, longitude, altitude );
-            break;
-        }
-      }
-    }
-  }
-  return val;
+  // Check existence of EXIF data & GPS coordinates
+  return exifReader.doesHaveExifInfo() &&
+         exifReader.GPSLatitude( &(*lla)(0) ) &&
+         exifReader.GPSLongitude( &(*lla)(1) ) &&
+         exifReader.GPSAltitude( &(*lla)(2) );
 }
 
+/// Image properties collected by the (parallel) image listing
+struct Image_Listing_Info
+{
+  bool b_usable = false; // the image is listed in the sfm_data
+  std::string error_report;
+  double width = -1, height = -1, focal = -1, ppx = -1, ppy = -1;
+  bool b_gps = false;
+  Vec3 gps_lla = Vec3::Zero();
+};
 
 /// Check string of prior weights
 std::pair<bool, Vec3> checkPriorWeightsString
@@ -277,66 +265,83 @@ int main(int argc, char **argv)
   Views & views = sfm_data.views;
   Intrinsics & intrinsics = sfm_data.intrinsics;
 
-  C_Progress_display my_progress_bar( vec_image.size(),
-      std::cout, "\n- Image listing -\n" );
-  std::ostringstream error_report_stream;
-  for ( std::vector<std::string>::const_iterator iter_image = vec_image.begin();
-    iter_image != vec_image.end();
-    ++iter_image, ++my_progress_bar )
+  // Read the image headers & meta data in parallel
+  // (the view ids are assigned afterwards in the sorted image order)
+  std::vector<Image_Listing_Info> image_infos(vec_image.size());
   {
-    // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
-    width = height = ppx = ppy = focal = -1.0;
-
-    const std::string sImageFilename = stlplus::create_filespec( sImageDir, *iter_image );
-    const std::string sImFilenamePart = stlplus::filename_part(sImageFilename);
-
-    // Test if the image format is supported:
-    if (openMVG::image::GetFormat(sImageFilename.c_str()) == openMVG::image::Unknown)
-    {
-      error_report_stream
-          << sImFilenamePart << ": Unkown image file format." << "\n";
-      continue; // image cannot be opened
-    }
-
-    if (sImFilenamePart.find("mask.png") != std::string::npos
-       || sImFilenamePart.find("_mask.png") != std::string::npos)
+    C_Progress_display my_progress_bar( vec_image.size(),
+        std::cout, "\n- Image listing -\n" );
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(vec_image.size()); ++i)
     {
-      error_report_stream
-          << sImFilenamePart << " is a mask image" << "\n";
-      continue;
-    }
-
-    ImageHeader imgHeader;
-    if (!openMVG::image::ReadImageHeader(sImageFilename.c_str(), &imgHeader))
-      continue; // image cannot be read
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      ++my_progress_bar;
+      Image_Listing_Info & info = image_infos[i];
+      std::ostringstream error_report_stream;
+
+      const std::string sImageFilename = stlplus::create_filespec( sImageDir, vec_image[i] );
+      const std::string sImFilenamePart = stlplus::filename_part(sImageFilename);
+
+      // Test if the image format is supported:
+      if (openMVG::image::GetFormat(sImageFilename.c_str()) == openMVG::image::Unknown)
+      {
+        error_report_stream
+            << sImFilenamePart << ": Unkown image file format." << "\n";
+        info.error_report = error_report_stream.str();
+        continue; // image cannot be opened
+      }
 
-    width = imgHeader.width;
-    height = imgHeader.height;
-    ppx = width / 2.0;
-    ppy = height / 2.0;
+      if (sImFilenamePart.find("mask.png") != std::string::npos
+         || sImFilenamePart.find("_mask.png") != std::string::npos)
+      {
+        error_report_stream
+            << sImFilenamePart << " is a mask image" << "\n";
+        info.error_report = error_report_stream.str();
+        continue;
+      }
 
+      ImageHeader imgHeader;
+      if (!openMVG::image::ReadImageHeader(sImageFilename.c_str(), &imgHeader))
+        continue; // image cannot be read
+
+      // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
+      info.b_usable = true;
+      double & width = info.width, & height = info.height,
+        & focal = info.focal, & ppx = info.ppx, & ppy = info.ppy;
+      width = imgHeader.width;
+      height = imgHeader.height;
+      ppx = width / 2.0;
+      ppy = height / 2.0;
+
+      // Consider the case where the focal is provided manually
+      if (sKmatrix.size() > 0) // Known user calibration K matrix
+      {
+        if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
+          focal = -1.0;
+      }
+      else // User provided focal length value
+        if (focal_pixels != -1 )
+          focal = focal_pixels;
 
-    // Consider the case where the focal is provided manually
-    if (sKmatrix.size() > 0) // Known user calibration K matrix
-    {
-      if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
-        focal = -1.0;
-    }
-    else // User provided focal length value
-      if (focal_pixels != -1 )
-        focal = focal_pixels;
+      // The EXIF data are needed for the focal (if not manually provided or
+      // wrongly provided) or the GPS pose prior
+      if (focal != -1 && !cmd.used('P'))
+        continue;
 
-    // If not manually provided or wrongly provided
-    if (focal == -1)
-    {
       std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
       exifReader->open( sImageFilename );
 
+      info.b_gps = checkGPS(*exifReader, &info.gps_lla);
+
       const bool bHaveValidExifMetadata =
         exifReader->doesHaveExifInfo()
         && !exifReader->getModel().empty();
 
-      if (bHaveValidExifMetadata) // If image contains meta data
+      if (focal == -1 && bHaveValidExifMetadata) // If image contains meta data
       {
         const std::string sCamModel = exifReader->getModel();
 
@@ -366,7 +371,50 @@ int main(int argc, char **argv)
           }
         }
       }
+      info.error_report = error_report_stream.str();
+    }
+  }
+
+  // Convert the GPS coordinates of all the images at once
+  std::vector<size_t> gps_images;
+  for (size_t i = 0; i < image_infos.size(); ++i)
+  {
+    if (image_infos[i].b_usable && image_infos[i].b_gps)
+      gps_images.push_back(i);
+  }
+  Mat3X gps_xyz(3, gps_images.size());
+  {
+    Mat3X gps_lla(3, gps_images.size());
+    for (size_t i = 0; i < gps_images.size(); ++i)
+      gps_lla.col(i) = image_infos[gps_images[i]].gps_lla;
+    switch (i_GPS_XYZ_method)
+    {
+      case 1:
+        gps_xyz = lla_to_utm( gps_lla );
+        break;
+      case 0:
+      default:
+        gps_xyz = lla_to_ecef( gps_lla );
+        break;
     }
+  }
+
+  // Create the views & intrinsics in the sorted image order
+  std::ostringstream error_report_stream;
+  for (size_t i = 0, i_gps = 0; i < vec_image.size(); ++i)
+  {
+    const Image_Listing_Info & info = image_infos[i];
+    error_report_stream << info.error_report;
+    if (!info.b_usable)
+      continue;
+
+    const std::vector<std::string>::const_iterator iter_image = vec_image.begin() + i;
+    width = info.width;
+    height = info.height;
+    focal = info.focal;
+    ppx = info.ppx;
+    ppy = info.ppy;
+
     // Build intrinsic parameter related to the view
     std::shared_ptr<IntrinsicBase> intrinsic;
 
@@ -418,7 +466,12 @@ int main(int argc, char **argv)
     }
 
     // Build the view corresponding to the image
-    const std::pair<bool, Vec3> gps_info = checkGPS(sImageFilename, i_GPS_XYZ_method);
+    std::pair<bool, Vec3> gps_info(false, Vec3::Zero());
+    if (info.b_gps)
+    {
+      gps_info.first = true;
+      gps_info.second = gps_xyz.col(i_gps++);
+    }
     if (gps_info.first && cmd.used('P'))
     {
       ViewPriors v(*iter_image, views.size(), views.size(), views.size(), width, height);
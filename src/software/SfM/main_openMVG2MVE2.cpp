@@ -11,12 +11,12 @@
  */
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/features/feature.hpp"
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/image/image_resampling.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "software/SfM/SfMExportHelper.hpp"
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -30,9 +30,9 @@ using namespace openMVG::features;
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 #include <cstdlib>
 #include <cmath>
-#include <iterator>
+#include <fstream>
 #include <iomanip>
-#include <atomic>
+#include <vector>
 
 /// Naive image bilinear resampling of an image for thumbnail generation
 template <typename ImageT>
@@ -58,10 +58,11 @@ create_thumbnail
 
 bool exportToMVE2Format(
   const SfM_Data & sfm_data,
-  const std::string & sOutDirectory // Output MVE2 files directory
+  const std::string & sOutDirectory, // Output MVE2 files directory
+  const size_t memory_budget
   )
 {
-  std::atomic<bool> bOk(true);
+  bool bOk = true;
   // Create basis directory structure
   if (!stlplus::is_folder(sOutDirectory))
   {
@@ -144,7 +145,7 @@ bool exportToMVE2Format(
     }
     out.close();
 
-    // Export (calibrated) views as undistorted images in parallel
+    // Export (calibrated) views as undistorted images
     std::cout << "Exporting views..." << std::endl;
 
     // Create 'views' subdirectory
@@ -157,16 +158,17 @@ bool exportToMVE2Format(
 
     C_Progress_display my_progress_bar(views.size());
 
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < static_cast<int>(views.size()); ++i)
+    // Write the view directories and meta data, and list the images to export
+    std::vector<exportHelper::Image_Export_Job> jobs;
+    std::vector<std::string> thumbnails;
+    for (const auto & views_it : views)
     {
-      if (!bOk) continue;
-      auto views_it = views.begin();
-      std::advance(views_it, i);
-      const View * view = views_it->second.get();
-
+      const View * view = views_it.second.get();
       if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-          continue;
+      {
+        ++my_progress_bar;
+        continue;
+      }
 
       // Create current view subdirectory 'view_xxxx.mve'
       std::ostringstream padding;
@@ -182,51 +184,18 @@ bool exportToMVE2Format(
       if (!stlplus::folder_exists(sOutViewIteratorDirectory))
         stlplus::folder_create(sOutViewIteratorDirectory);
 
-      Image<RGBColor> image, image_ud, thumbnail;
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->have_disto())
-      {
-        // Undistort and save the image
-        if (!ReadImage(srcImage.c_str(), &image))
-        {
-          std::cerr
-            << "Unable to read the input image as a RGB image:\n"
-            << srcImage << std::endl;
-          bOk = false;
-          continue;
-        }
-        UndistortImage(image, cam, image_ud, BLACK);
-        if (!WriteImage(dstImage.c_str(), image_ud))
-        {
-          std::cerr
-            << "Unable to write the output image as a RGB image:\n"
-            << dstImage << std::endl;
-          bOk = false;
-          continue;
-        }
-      }
-      else // (no distortion)
-      {
-        // If extensions match, copy the PNG image
-        if (stlplus::extension_part(srcImage) == "PNG" ||
-            stlplus::extension_part(srcImage) == "png")
-        {
-          stlplus::file_copy(srcImage, dstImage);
-        }
-        else
-        {
-          if (!ReadImage( srcImage.c_str(), &image) ||
-              !WriteImage( dstImage.c_str(), image))
-          {
-            std::cerr << "Unable to read and write the image" << std::endl;
-            bOk = false;
-            continue;
-          }
-        }
-      }
+      // Undistort (or convert to PNG) the image and save a thumbnail image "thumbnail.png", 50x50 pixels
+      exportHelper::Image_Export_Job job;
+      job.view_id = view->id_view;
+      job.src_image = srcImage;
+      job.dst_image = dstImage;
+      jobs.push_back(job);
+      thumbnails.push_back(
+        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "thumbnail","png"));
 
       // Prepare to write an MVE 'meta.ini' file for the current view
+      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
+      const IntrinsicBase * cam = iterIntrinsic->second.get();
       const Pose3 & pose = sfm_data.GetPoseOrDie(view);
       const Pinhole_Intrinsic * pinhole_cam = static_cast<const Pinhole_Intrinsic *>(cam);
       const Mat3 & rotation = pose.rotation();
@@ -240,41 +209,41 @@ bool exportToMVE2Format(
 
       // For each camera, write to bundle: focal length, radial distortion[0-1],
       // rotation matrix[0-8], translation vector[0-2]
-      std::ostringstream fileOut;
-      fileOut
-        << "# MVE view meta data is stored in INI-file syntax." << fileOut.widen('\n')
-        << "# This file is generated, formatting will get lost." << fileOut.widen('\n')
-        << fileOut.widen('\n')
-        << "[camera]" << fileOut.widen('\n')
-        << "focal_length = " << flen << fileOut.widen('\n')
-        << "pixel_aspect = " << pixelAspect << fileOut.widen('\n')
-        << "principal_point = " << ppX << " " << ppY << fileOut.widen('\n')
-        << "rotation = " << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << " "
-        << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << " "
-        << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << fileOut.widen('\n')
-        << "translation = " << translation[0] << " " << translation[1] << " "
-        << translation[2] << " " << fileOut.widen('\n')
-        << fileOut.widen('\n')
-        << "[view]" << fileOut.widen('\n')
-        << "id = " << view->id_view << fileOut.widen('\n')
-        << "name = " << stlplus::filename_part(srcImage.c_str()) << fileOut.widen('\n');
-
       // To do:  trim any extra separator(s) from openMVG name we receive, e.g.:
       // '/home/insight/openMVG_KevinCain/openMVG_Build/software/SfM/ImageDataset_SceauxCastle/images//100_7100.JPG'
       std::ofstream file(
         stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory),
         "meta","ini").c_str());
-      file << fileOut.str();
+      file
+        << "# MVE view meta data is stored in INI-file syntax." << file.widen('\n')
+        << "# This file is generated, formatting will get lost." << file.widen('\n')
+        << file.widen('\n')
+        << "[camera]" << file.widen('\n')
+        << "focal_length = " << flen << file.widen('\n')
+        << "pixel_aspect = " << pixelAspect << file.widen('\n')
+        << "principal_point = " << ppX << " " << ppY << file.widen('\n')
+        << "rotation = " << rotation(0, 0) << " " << rotation(0, 1) << " " << rotation(0, 2) << " "
+        << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << " "
+        << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << file.widen('\n')
+        << "translation = " << translation[0] << " " << translation[1] << " "
+        << translation[2] << " " << file.widen('\n')
+        << file.widen('\n')
+        << "[view]" << file.widen('\n')
+        << "id = " << view->id_view << file.widen('\n')
+        << "name = " << stlplus::filename_part(srcImage.c_str()) << file.widen('\n');
       file.close();
-
-      // Save a thumbnail image "thumbnail.png", 50x50 pixels
-      thumbnail = create_thumbnail(image, 50, 50);
-      const std::string dstThumbnailImage =
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "thumbnail","png");
-      WriteImage(dstThumbnailImage.c_str(), thumbnail);
-
-      ++my_progress_bar;
     }
+
+    // Export the images in parallel (the thumbnails are computed from the exported images)
+    const std::vector<exportHelper::Image_Export_Result> image_results =
+      exportHelper::ExportImages(sfm_data, jobs, memory_budget, &my_progress_bar,
+        [&](size_t job_index, const Image<RGBColor> & image)
+        {
+          const Image<RGBColor> thumbnail = create_thumbnail(image, 50, 50);
+          WriteImage(thumbnails[job_index].c_str(), thumbnail);
+        });
+    for (const auto & result : image_results)
+      bOk &= result.b_ok;
   }
   return bOk;
 }
@@ -285,8 +254,10 @@ int main(int argc, char *argv[])
   CmdLine cmd;
   std::string sSfM_Data_Filename;
   std::string sOutDir = "";
+  int iMemoryBudget = 1024;
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
+  cmd.add( make_option('m', iMemoryBudget, "memory_budget") );
   std::cout << "Note:  this program writes output in MVE file format.\n";
 
   try {
@@ -296,6 +267,7 @@ int main(int argc, char *argv[])
       std::cerr << "Usage: " << argv[0] << '\n'
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outdir] path\n"
+      << "[-m|--memory_budget] maximal size (in MB) of the images decoded at the same time\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -314,7 +286,8 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  if (exportToMVE2Format(sfm_data, stlplus::folder_append_separator(sOutDir) + "MVE"))
+  if (exportToMVE2Format(sfm_data, stlplus::folder_append_separator(sOutDir) + "MVE",
+    static_cast<size_t>(std::max(iMemoryBudget, 1)) << 20))
     return EXIT_SUCCESS;
   else
     return EXIT_FAILURE;
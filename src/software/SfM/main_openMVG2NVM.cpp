@@ -7,18 +7,19 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/features/feature.hpp"
-#include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "software/SfM/SfMExportHelper.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <cstdlib>
+#include <vector>
 
 #ifdef OPENMVG_USE_OPENMP
 #include <omp.h>
@@ -36,10 +37,12 @@ using namespace openMVG::features;
 * @param sfm_data Structure from Motion file
 * @param sOutDirectory Output directory
 * @param filename Name of the file to create
+* @param memory_budget Maximal size (in bytes) of the images decoded at the same time
 */
 bool CreateNVMFile( const SfM_Data & sfm_data ,
                     const std::string & sOutDirectory ,
-                    const std::string & filename )
+                    const std::string & filename ,
+                    const size_t memory_budget )
 {
   const std::string sOutViewsDirectory = stlplus::folder_append_separator( sOutDirectory ) + "views";
   if ( !stlplus::folder_exists( sOutViewsDirectory ) )
@@ -56,7 +59,7 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
     std::cerr << "Cannot write file" << filename << std::endl;
     return false;
   }
-  file << "NVM_V3" << std::endl;
+  file << "NVM_V3" << '\n';
 
   // we reindex the poses to ensure a contiguous pose list.
   Hash_Map<IndexT, IndexT> map_viewIdToContiguous;
@@ -77,23 +80,20 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
   // Number of cameras
   // For each camera : File_name Focal Qw Qx Qy Qz Cx Cy Cz D0 0
 
-  file << nb_cam << std::endl;
+  file << nb_cam << '\n';
 
   // Export undistorted images
   {
     C_Progress_display my_progress_bar( sfm_data.GetViews().size(), std::cout, "\n- EXPORT UNDISTORTED IMAGES -\n" );
-    Image<RGBColor> image, image_ud;
-  #ifdef OPENMVG_USE_OPENMP
-      #pragma omp parallel for schedule(dynamic) private(image, image_ud)
-  #endif
-    for (int i = 0; i < static_cast<int>(sfm_data.views.size()); ++i)
+    std::vector<exportHelper::Image_Export_Job> jobs;
+    jobs.reserve( map_viewIdToContiguous.size() );
+    for (const auto & view_it : sfm_data.GetViews())
     {
-      Views::const_iterator iterViews = sfm_data.views.begin();
-      std::advance(iterViews, i);
-      const View * view = iterViews->second.get();
+      const View * view = view_it.second.get();
 
       if ( !sfm_data.IsPoseAndIntrinsicDefined( view ) )
       {
+        ++my_progress_bar;
         continue;
       }
 
@@ -104,44 +104,28 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
         stlplus::folder_append_separator(sOutViewsDirectory) +
         stlplus::folder_append_separator(sAbsoluteOutputDir);
 
-      const std::string dstImage = stlplus::create_filespec( sFullOutputDir, "undistorted", "png");
-      const std::string srcImage = stlplus::create_filespec( sfm_data.s_root_path, view->s_Img_path );
-
-      #ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-      #endif
       // Create output dir if not present
       if ( !stlplus::folder_exists( sFullOutputDir ) )
       {
         stlplus::folder_create( sFullOutputDir );
       }
 
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find( view->id_intrinsic );
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
+      exportHelper::Image_Export_Job job;
+      job.view_id = view->id_view;
+      job.src_image = stlplus::create_filespec( sfm_data.s_root_path, view->s_Img_path );
+      job.dst_image = stlplus::create_filespec( sFullOutputDir, "undistorted", "png");
+      jobs.push_back( job );
+    }
 
-      // Remove distortion
-      if ( cam->have_disto() )
-      {
-        // Undistort and save the image
-        ReadImage( srcImage.c_str(), &image );
-        UndistortImage( image, cam, image_ud, BLACK );
-        WriteImage( dstImage.c_str(), image_ud );
-      }
-      else // (no distortion)
+    // Remove distortion (or convert to PNG) in parallel
+    const std::vector<exportHelper::Image_Export_Result> image_results =
+      exportHelper::ExportImages( sfm_data, jobs, memory_budget, &my_progress_bar );
+    for (const auto & result : image_results)
+    {
+      if ( !result.b_ok )
       {
-        // If extensions match, copy the PNG image
-        if ( stlplus::extension_part( srcImage ) == "PNG" ||
-             stlplus::extension_part( srcImage ) == "png" )
-        {
-          stlplus::file_copy( srcImage, dstImage );
-        }
-        else
-        {
-          ReadImage( srcImage.c_str(), &image );
-          WriteImage( dstImage.c_str(), image );
-        }
+        return false;
       }
-      ++my_progress_bar;
     }
   }
 
@@ -193,7 +177,7 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
          << Cy << " "
          << Cz << " "
          << d0 << " "
-         << 0 << std::endl;
+         << 0 << '\n';
     }
   }
 
@@ -203,7 +187,7 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
   // mesurements : Img_idx Feat_idx X Y
   const Landmarks & landmarks = sfm_data.GetLandmarks();
   const size_t featureCount = landmarks.size();
-  file << featureCount << std::endl;
+  file << featureCount << '\n';
   C_Progress_display my_progress_bar( featureCount, std::cout, "\n- EXPORT LANDMARKS DATA -\n" );
   for ( Landmarks::const_iterator iterLandmarks = landmarks.begin();
         iterLandmarks != landmarks.end(); ++iterLandmarks, ++my_progress_bar )
@@ -230,15 +214,16 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
   // EOF indicator
   file << "0";
 
-  return true;
+  return file.good();
 }
 
 /**
 * @brief Main function used to export a NVM file
 * @param sfm_data Structure from Motion file to export
 * @param sOutDirectory Output directory
+* @param memory_budget Maximal size (in bytes) of the images decoded at the same time
 */
-bool exportToNVM( const SfM_Data & sfm_data , const std::string & sOutDirectory  )
+bool exportToNVM( const SfM_Data & sfm_data , const std::string & sOutDirectory , const size_t memory_budget )
 {
   // Create output directory
   bool bOk = false;
@@ -259,7 +244,7 @@ bool exportToNVM( const SfM_Data & sfm_data , const std::string & sOutDirectory
     return false;
   }
   const std::string sFilename = stlplus::create_filespec( sOutDirectory , "scene.nvm" );
-  if ( ! CreateNVMFile( sfm_data , sOutDirectory , sFilename ) )
+  if ( ! CreateNVMFile( sfm_data , sOutDirectory , sFilename , memory_budget ) )
   {
     std::cerr << "There was an error exporting project" << std::endl;
     return false;
@@ -273,12 +258,14 @@ int main( int argc , char ** argv )
   CmdLine cmd;
   std::string sSfM_Data_Filename;
   std::string sOutDir = "";
+  int iMemoryBudget = 1024;
 #ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 1;
 #endif
 
   cmd.add( make_option( 'i', sSfM_Data_Filename, "sfmdata" ) );
   cmd.add( make_option( 'o', sOutDir, "outdir" ) );
+  cmd.add( make_option( 'm', iMemoryBudget, "memory_budget" ) );
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
 #endif
@@ -297,6 +284,7 @@ int main( int argc , char ** argv )
     std::cerr << "Usage: " << argv[0] << '\n'
               << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
               << "[-o|--outdir] path where the scene.nvm will be saved\n"
+              << "[-m|--memory_budget] maximal size (in MB) of the images decoded at the same time\n"
 #ifdef OPENMVG_USE_OPENMP
               << "[-n|--numThreads] number of thread(s)\n"
 #endif
@@ -330,7 +318,7 @@ int main( int argc , char ** argv )
     return EXIT_FAILURE;
   }
 
-  if ( ! exportToNVM( sfm_data , sOutDir ) )
+  if ( ! exportToNVM( sfm_data , sOutDir , static_cast<size_t>( std::max( iMemoryBudget, 1 ) ) << 20 ) )
   {
     std::cerr << "There was an error during export of the file" << std::endl;
     exit( EXIT_FAILURE );
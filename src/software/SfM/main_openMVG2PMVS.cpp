@@ -7,25 +7,26 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/geometry/pose3.hpp"
-#include "openMVG/image/image_io.hpp"
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/sfm/sfm_landmark_columns.hpp"
 #include "openMVG/sfm/sfm_view.hpp"
 #include "openMVG/types.hpp"
+#include "software/SfM/SfMExportHelper.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
-#include <iterator>
 #include <iomanip>
 #include <fstream>
+#include <vector>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -39,6 +40,7 @@ bool exportToPMVSFormat(
   const std::string & sOutDirectory,  //Output PMVS files directory
   const int downsampling_factor,
   const int CPU_core_count,
+  const size_t memory_budget,
   const bool b_VisData = true
   )
 {
@@ -101,50 +103,28 @@ bool exportToPMVSFormat(
     }
 
     // Export (calibrated) views as undistorted images
-    Image<RGBColor> image, image_ud;
-    const Views & views = sfm_data.GetViews();
-    #pragma omp parallel for private(image, image_ud)
-    for (int i = 0; i < static_cast<int>(views.size()); ++i)
+    std::vector<exportHelper::Image_Export_Job> jobs;
+    jobs.reserve(map_viewIdToContiguous.size());
+    for (const auto & view_it : sfm_data.GetViews())
     {
-      ++my_progress_bar;
-      auto view_it = views.begin();
-      std::advance(view_it, i);
-      const View * view = view_it->second.get();
+      const View * view = view_it.second.get();
       if (!sfm_data.IsPoseAndIntrinsicDefined(view))
         continue;
 
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
-
-      // We have a valid view with a corresponding camera & pose
-      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
       std::ostringstream os;
-      os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous[view->id_view];
-      const std::string dstImage = stlplus::create_filespec(
+      os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous.at(view->id_view);
+      exportHelper::Image_Export_Job job;
+      job.view_id = view->id_view;
+      job.src_image = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
+      job.dst_image = stlplus::create_filespec(
         stlplus::folder_append_separator(sOutDirectory) + "visualize", os.str(),"jpg");
-
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->have_disto())
-      {
-        // undistort the image and save it
-        ReadImage( srcImage.c_str(), &image);
-        UndistortImage(image, cam, image_ud, BLACK);
-        WriteImage(dstImage.c_str(), image_ud);
-      }
-      else // (no distortion)
-      {
-        // copy the image if extension match
-        if (stlplus::extension_part(srcImage) == "JPG" ||
-          stlplus::extension_part(srcImage) == "jpg")
-        {
-          stlplus::file_copy(srcImage, dstImage);
-        }
-        else
-        {
-          ReadImage( srcImage.c_str(), &image);
-          WriteImage( dstImage.c_str(), image);
-        }
-      }
+      jobs.push_back(job);
     }
+    const std::vector<exportHelper::Image_Export_Result> image_results =
+      exportHelper::ExportImages(sfm_data, jobs, memory_budget, &my_progress_bar);
+    my_progress_bar += sfm_data.GetViews().size() - jobs.size();
+    for (const auto & result : image_results)
+      bOk &= result.b_ok;
 
     //pmvs_options.txt
     std::ostringstream os;
@@ -165,47 +145,45 @@ bool exportToPMVSFormat(
 
     if (b_VisData)
     {
-      std::map<IndexT, std::set<IndexT>> view_shared;
-      // From the structure observations, list the putatives pairs (symmetric)
-      for (Landmarks::const_iterator itL = sfm_data.GetLandmarks().begin();
-        itL != sfm_data.GetLandmarks().end(); ++itL)
+      // From the structure observations, list the views that share some landmarks
+      const View_Covisibility covisibility =
+        Compute_View_Covisibility(Landmarks_Columns(sfm_data.GetLandmarks()));
+
+      // Neighbours of each exported view, in contiguous index
+      std::vector<std::vector<IndexT>> view_shared(map_viewIdToContiguous.size());
+      for (size_t i = 0; i < covisibility.ViewCount(); ++i)
       {
-        const Landmark & landmark = itL->second;
-        const Observations & obs = landmark.obs;
-        for (Observations::const_iterator itOb = obs.begin();
-          itOb != obs.end(); ++itOb)
+        const auto it = map_viewIdToContiguous.find(covisibility.view_ids[i]);
+        if (it == map_viewIdToContiguous.end())
+          continue;
+        std::vector<IndexT> & setView = view_shared[it->second];
+        for (uint64_t k = covisibility.offsets[i]; k < covisibility.offsets[i + 1]; ++k)
         {
-          const IndexT viewId = itOb->first;
-          Observations::const_iterator itOb2 = itOb;
-          ++itOb2;
-          for (; itOb2 != obs.end(); ++itOb2)
-          {
-            const IndexT viewId2 = itOb2->first;
-            view_shared[map_viewIdToContiguous[viewId]].insert(map_viewIdToContiguous[viewId2]);
-            view_shared[map_viewIdToContiguous[viewId2]].insert(map_viewIdToContiguous[viewId]);
-          }
+          const auto itV = map_viewIdToContiguous.find(covisibility.neighbour_ids[k]);
+          if (itV != map_viewIdToContiguous.end())
+            setView.push_back(itV->second);
         }
+        std::sort(setView.begin(), setView.end());
       }
-      // Export the vis.dat file
-      std::ostringstream osVisData;
-      osVisData
+      const size_t nb_shared = std::count_if(view_shared.begin(), view_shared.end(),
+        [](const std::vector<IndexT> & setView) { return !setView.empty(); });
+
+      // Export the vis.dat file (view shared visibility)
+      std::ofstream file(stlplus::create_filespec(sOutDirectory, "vis", "dat").c_str());
+      file
         << "VISDATA" << os.widen('\n')
-        << view_shared.size() << os.widen('\n'); // #images
-      // Export view shared visibility
-      for (std::map<IndexT, std::set<IndexT>>::const_iterator it = view_shared.begin();
-        it != view_shared.end(); ++it)
+        << nb_shared << os.widen('\n'); // #images
+      for (size_t i = 0; i < view_shared.size(); ++i)
       {
-        const std::set<IndexT> & setView = it->second;
-        osVisData << it->first << ' ' << setView.size();
-        for (std::set<IndexT>::const_iterator itV = setView.begin();
-          itV != setView.end(); ++itV)
-        {
-          osVisData << ' ' << *itV;
-        }
-        osVisData << os.widen('\n');
+        const std::vector<IndexT> & setView = view_shared[i];
+        if (setView.empty())
+          continue;
+        file << i << ' ' << setView.size();
+        for (const IndexT itV : setView)
+          file << ' ' << itV;
+        file << os.widen('\n');
       }
-      std::ofstream file(stlplus::create_filespec(sOutDirectory, "vis", "dat").c_str());
-      file << osVisData.str();
+      bOk &= file.good();
       file.close();
     }
 
@@ -323,12 +301,14 @@ int main(int argc, char *argv[]) {
   int resolution = 1;
   int CPU = 8;
   bool bVisData = true;
+  int iMemoryBudget = 1024;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
   cmd.add( make_option('r', resolution, "resolution") );
   cmd.add( make_option('c', CPU, "CPU") );
   cmd.add( make_option('v', bVisData, "useVisData") );
+  cmd.add( make_option('m', iMemoryBudget, "memory_budget") );
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -339,7 +319,8 @@ int main(int argc, char *argv[]) {
       << "[-o|--outdir path]\n"
       << "[-r|--resolution] divide image coefficient\n"
       << "[-c|--nb core]\n"
-      << "[-v|--useVisData] use visibility information."
+      << "[-v|--useVisData] use visibility information.\n"
+      << "[-m|--memory_budget] maximal size (in MB) of the images decoded at the same time\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -362,6 +343,7 @@ int main(int argc, char *argv[]) {
       stlplus::folder_append_separator(sOutDir) + "PMVS",
       resolution,
       CPU,
+      static_cast<size_t>(std::max(iMemoryBudget, 1)) << 20,
       bVisData);
 
     exportToBundlerFormat(sfm_data,
@@ -7,10 +7,9 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
-#include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "software/SfM/SfMExportHelper.hpp"
 
 #define _USE_EIGEN
 #include "InterfaceMVS.h"
@@ -25,13 +24,17 @@ using namespace openMVG::geometry;
 using namespace openMVG::image;
 using namespace openMVG::sfm;
 
+#include <algorithm>
 #include <cstdlib>
+#include <map>
 #include <string>
+#include <vector>
 
 bool exportToOpenMVS(
   const SfM_Data & sfm_data,
   const std::string & sOutFile,
-  const std::string & sOutDir
+  const std::string & sOutDir,
+  const size_t memory_budget
   )
 {
   // Create undistorted images directory structure
@@ -50,8 +53,6 @@ bool exportToOpenMVS(
   size_t nPoses(0);
   const uint32_t nViews((uint32_t)sfm_data.GetViews().size());
 
-  C_Progress_display my_progress_bar(nViews);
-
   // OpenMVG can have not contiguous index, use a map to create the required OpenMVS contiguous ID index
   std::map<openMVG::IndexT, uint32_t> map_intrinsic, map_view;
 
@@ -76,6 +77,8 @@ bool exportToOpenMVS(
   }
 
   // define images & poses
+  std::vector<exportHelper::Image_Export_Job> jobs;
+  jobs.reserve(nViews);
   scene.images.reserve(nViews);
   for (const auto& view : sfm_data.GetViews())
   {
@@ -89,42 +92,43 @@ bool exportToOpenMVS(
     if (!stlplus::is_file(srcImage))
     {
       std::cout << "Cannot read the corresponding image: " << srcImage << std::endl;
-      return EXIT_FAILURE;
+      return false;
     }
-    if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()) && stlplus::is_file(srcImage))
+    exportHelper::Image_Export_Job job;
+    job.view_id = view.first;
+    job.src_image = srcImage;
+    job.dst_image = image.name;
+    if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
     {
       MVS::Interface::Platform::Pose pose;
       image.poseID = platform.poses.size();
       const openMVG::geometry::Pose3 poseMVG(sfm_data.GetPoseOrDie(view.second.get()));
       pose.R = poseMVG.rotation();
       pose.C = poseMVG.center();
-      // export undistorted images
-      const openMVG::cameras::IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view.second->id_intrinsic).get();
-      if (cam->have_disto())
-      {
-        // undistort image and save it
-        Image<openMVG::image::RGBColor> imageRGB, imageRGB_ud;
-        ReadImage(srcImage.c_str(), &imageRGB);
-        UndistortImage(imageRGB, cam, imageRGB_ud, BLACK);
-        WriteImage(image.name.c_str(), imageRGB_ud);
-      }
-      else
-      {
-        // just copy image
-        stlplus::file_copy(srcImage, image.name);
-      }
       platform.poses.push_back(pose);
       ++nPoses;
+      // export undistorted images
+      job.b_undistort = true;
     }
     else
     {
       // image have not valid pose, so set an undefined pose
       image.poseID = NO_ID;
       // just copy the image
-      stlplus::file_copy(srcImage, image.name);
+      job.b_undistort = false;
     }
+    jobs.push_back(job);
     scene.images.emplace_back(image);
-    ++my_progress_bar;
+  }
+
+  // export the images (in parallel, the image sizes are kept for the intrinsics normalization)
+  C_Progress_display my_progress_bar(nViews, std::cout, "\n- EXPORT UNDISTORTED IMAGES -\n");
+  const std::vector<exportHelper::Image_Export_Result> image_results =
+    exportHelper::ExportImages(sfm_data, jobs, memory_budget, &my_progress_bar);
+  if (std::any_of(image_results.begin(), image_results.end(),
+    [](const exportHelper::Image_Export_Result & result) { return !result.b_ok; }))
+  {
+    return false;
   }
 
   // define structure
@@ -158,30 +162,26 @@ bool exportToOpenMVS(
   }
 
   // normalize camera intrinsics
+  // (using the size of the first calibrated image of each platform)
+  std::vector<size_t> platform_image(scene.platforms.size(), scene.images.size());
+  for (size_t i = 0; i < scene.images.size(); ++i)
+  {
+    const MVS::Interface::Image& image = scene.images[i];
+    if (image.poseID != NO_ID && platform_image[image.platformID] == scene.images.size())
+      platform_image[image.platformID] = i;
+  }
   for (size_t p=0; p<scene.platforms.size(); ++p)
   {
     MVS::Interface::Platform& platform = scene.platforms[p];
     for (size_t c=0; c<platform.cameras.size(); ++c) {
       MVS::Interface::Platform::Camera& camera = platform.cameras[c];
-      // find one image using this camera
-      MVS::Interface::Image* pImage(nullptr);
-      for (MVS::Interface::Image& image: scene.images)
-      {
-        if (image.platformID == p && image.cameraID == c && image.poseID != NO_ID)
-        {
-          pImage = &image;
-          break;
-        }
-      }
-      if (pImage == nullptr)
+      if (platform_image[p] == scene.images.size())
       {
         std::cerr << "error: no image using camera " << c << " of platform " << p << std::endl;
         continue;
       }
-      // read image meta-data
-      ImageHeader imageHeader;
-      ReadImageHeader(pImage->name.c_str(), &imageHeader);
-      const double fScale(1.0/std::max(imageHeader.width, imageHeader.height));
+      const exportHelper::Image_Export_Result & image_size = image_results[platform_image[p]];
+      const double fScale(1.0/std::max(image_size.width, image_size.height));
       camera.K(0, 0) *= fScale;
       camera.K(1, 1) *= fScale;
       camera.K(0, 2) *= fScale;
@@ -212,10 +212,12 @@ int main(int argc, char *argv[])
   std::string sSfM_Data_Filename;
   std::string sOutFile = "scene.mvs";
   std::string sOutDir = "undistorted_images";
+  int iMemoryBudget = 1024;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutFile, "outfile") );
   cmd.add( make_option('d', sOutDir, "outdir") );
+  cmd.add( make_option('m', iMemoryBudget, "memory_budget") );
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -225,6 +227,7 @@ int main(int argc, char *argv[])
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outfile] OpenMVS scene file\n"
       << "[-d|--outdir] undistorted images path\n"
+      << "[-m|--memory_budget] maximal size (in MB) of the images decoded at the same time\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -246,7 +249,8 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir))
+  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir,
+    static_cast<size_t>(std::max(iMemoryBudget, 1)) << 20))
   {
     std::cerr << std::endl
       << "The output openMVS scene file cannot be written" << std::endl;
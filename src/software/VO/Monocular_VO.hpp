@@ -10,6 +10,7 @@
 #define MONOCULAR_VO_HPP
 
 #include <deque>
+#include <map>
 #include <set>
 #include <numeric>
 
@@ -187,6 +188,18 @@ struct VO_Monocular
     }
     return bTrackerStatus;
   }
+
+  /// Position of the landmarks observed in the last processed frame (per landmark id)
+  std::map<uint32_t, Vec2> lastFrameObservations() const
+  {
+    std::map<uint32_t, Vec2> observations;
+    if (!landmarkListPerFrame_.empty())
+    {
+      for (const uint32_t landmark_id : landmarkListPerFrame_.back())
+        observations[landmark_id] = landmark_[landmark_id].obs_.back().pos_.cast<double>();
+    }
+    return observations;
+  }
 };
 
 } // namespace VO
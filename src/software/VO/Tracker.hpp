@@ -14,8 +14,11 @@
 #include <openMVG/features/fast/fast_detector.hpp>
 #include <openMVG/features/feature.hpp>
 #include <openMVG/features/feature_container.hpp>
+#include <openMVG/features/feature_grid.hpp>
 #include "openMVG/matching/metric.hpp"
 
+#include <limits>
+#include <numeric>
 #include <random>
 #include <vector>
 
@@ -28,6 +31,19 @@ struct Tracker_fast_dipole : public Abstract_Tracker
 {
   // data for tracking
   image::Image<unsigned char> _prev_img;
+  // mean displacement of the tracked points between the two last frames
+  Vec2f _prev_motion = Vec2f::Zero();
+  // maximal distance of a tracked point to its predicted position (<= 0: exhaustive search)
+  float _search_radius = 0.f;
+
+  // dipole descriptors are stored with a zero padding to 24 values
+  //  (a multiple of 8, so the L2 metric can use its vectorized code path)
+  static const size_t DESCRIPTOR_STRIDE = 24;
+
+  explicit Tracker_fast_dipole(const float search_radius = 0.f)
+    : _search_radius(search_radius)
+  {
+  }
 
   /// Try to track current point set in the provided image
   /// return false when tracking failed (=> to send frame to relocalization)
@@ -44,19 +60,32 @@ struct Tracker_fast_dipole : public Abstract_Tracker
       const features::PointFeatures & _prevPts = pt_to_track;
 
       //-- Compute descriptors for the previous tracked point and perform matching
-      std::vector<float> prev_descriptors(20*pt_to_track.size());
-      for (size_t i=0; i < pt_to_track.size(); ++i)
-      {
-        features::PickASDipole(_prev_img, _prevPts[i].x(), _prevPts[i].y(), 10.5f, 0.0f, &prev_descriptors[i*20]);
-      }
+      std::vector<float> prev_descriptors(DESCRIPTOR_STRIDE*pt_to_track.size(), 0.f);
+      features::PickASDipoles(_prev_img, _prevPts, 10.5f, 0.0f, prev_descriptors.data(), DESCRIPTOR_STRIDE);
 
       features::PointFeatures current_feats;
       features::FastCornerDetector fastCornerDetector(9, 5);
       fastCornerDetector.detect(ima, current_feats);
-      std::vector<float> current_descriptors(20*current_feats.size());
-      for (size_t i=0; i < current_feats.size(); ++i)
+
+      // In the motion bounded mode, the new corners are bucketed in a grid and
+      //  their descriptors are stored in the grid order (the candidates of a
+      //  search window are then contiguous in memory)
+      const bool b_motion_bounded = _search_radius > 0.f;
+      features::Feature_Grid grid;
+      if (b_motion_bounded)
+        grid.Build(current_feats, _search_radius);
+      std::vector<float> current_descriptors(DESCRIPTOR_STRIDE*current_feats.size(), 0.f);
+      if (b_motion_bounded)
+      {
+        features::PointFeatures grid_feats;
+        grid_feats.reserve(current_feats.size());
+        for (const uint32_t i : grid.Order())
+          grid_feats.push_back(current_feats[i]);
+        features::PickASDipoles(ima, grid_feats, 10.5f, 0.0f, current_descriptors.data(), DESCRIPTOR_STRIDE);
+      }
+      else
       {
-        features::PickASDipole(ima, current_feats[i].x(), current_feats[i].y(), 10.5f, 0.0f, &current_descriptors[i*20]);
+        features::PickASDipoles(ima, current_feats, 10.5f, 0.0f, current_descriptors.data(), DESCRIPTOR_STRIDE);
       }
 
       // Compute the matches
@@ -66,25 +95,43 @@ struct Tracker_fast_dipole : public Abstract_Tracker
         #endif
         for (int i=0; i < (int)pt_to_track.size(); ++i)
         {
-          size_t best_idx = std::numeric_limits<size_t>::infinity();
+          size_t best_idx = std::numeric_limits<size_t>::max();
 
           typedef openMVG::matching::L2<float> metricT;
           metricT metric;
           metricT::ResultType best_distance = 30;//std::numeric_limits<double>::infinity();
-          for (size_t j=0; j < current_feats.size(); ++j)
+          const float * prev_descriptor = &prev_descriptors[i*DESCRIPTOR_STRIDE];
+          // Compare with the k-th stored descriptor (the j-th corner)
+          const auto compare = [&](const size_t k, const size_t j)
           {
-            // Spatial filter
-            //if ((pt_to_track[i].coords() - current_feats[j].coords()).norm() > 50)
-            //  continue; // Too much distance between the feat, it is not necessary to compute the descriptor distance
-
-            metricT::ResultType distance = metric(&prev_descriptors[i*20], &current_descriptors[j*20], 20);
+            const metricT::ResultType distance =
+              metric(prev_descriptor, &current_descriptors[k*DESCRIPTOR_STRIDE], DESCRIPTOR_STRIDE);
             if (distance < best_distance)
             {
               best_idx = j;
               best_distance = distance;
             }
+          };
+
+          if (b_motion_bounded)
+          {
+            // Spatial filter: only the corners around the predicted position are compared
+            const Vec2f predicted = pt_to_track[i].coords() + _prev_motion;
+            const float squared_radius = _search_radius * _search_radius;
+            grid.ForEachInRadius(predicted.x(), predicted.y(), _search_radius,
+              [&](const uint32_t k, const uint32_t j)
+              {
+                if ((current_feats[j].coords() - predicted).squaredNorm() <= squared_radius)
+                  compare(k, j);
+              });
+          }
+          else
+          {
+            for (size_t j=0; j < current_feats.size(); ++j)
+              compare(j, j);
           }
-          if (best_idx != std::numeric_limits<size_t>::infinity())
+
+          if (best_idx != std::numeric_limits<size_t>::max())
           {
             pt_tracked[i].coords() << current_feats[best_idx].x(), current_feats[best_idx].y();
             status[i] = true;
@@ -95,6 +142,19 @@ struct Tracker_fast_dipole : public Abstract_Tracker
           }
         }
       }
+
+      // Update the motion prediction
+      Vec2f motion = Vec2f::Zero();
+      size_t tracked_count = 0;
+      for (size_t i=0; i < pt_to_track.size(); ++i)
+      {
+        if (status[i])
+        {
+          motion += pt_tracked[i].coords() - pt_to_track[i].coords();
+          ++tracked_count;
+        }
+      }
+      _prev_motion = (tracked_count > 0) ? Vec2f(motion / tracked_count) : Vec2f::Zero();
     }
     // swap frame for the next tracking iteration
     _prev_img = ima;
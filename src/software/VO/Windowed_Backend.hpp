@@ -0,0 +1,458 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef WINDOWED_BACKEND_VO_HPP
+#define WINDOWED_BACKEND_VO_HPP
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/multiview/triangulation.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/sfm/pipelines/localization/SfM_Localizer.hpp"
+#include "openMVG/sfm/pipelines/sfm_robust_model_estimation.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openMVG  {
+namespace VO  {
+
+/// Keyframe selection & windowed optimization parameters
+struct Windowed_Backend_Params
+{
+  // Number of keyframes refined by the windowed bundle adjustment
+  //  (the older keyframes observing the window landmarks are held constant)
+  uint32_t window_size = 5;
+  // A frame becomes a keyframe if the median displacement (in pixels) of the
+  //  landmarks it shares with the last keyframe exceeds this value...
+  double min_keyframe_parallax = 20.0;
+  // ... or if it tracks less than this ratio of the last keyframe landmarks
+  double min_tracked_ratio = 0.6;
+  // Minimal number of landmarks to initialize the map or to localize a keyframe
+  uint32_t min_tracks = 30;
+  // Triangulation & outlier rejection threshold (in pixels)
+  double max_reprojection_error = 4.0;
+  // Minimal triangulation angle (in degrees)
+  double min_triangulation_angle = 2.0;
+  // Bound the per keyframe optimization cost
+  int max_ba_iterations = 10;
+};
+
+/// Keyframe based pose & structure estimation for the Monocular VO front end:
+/// - a keyframe is selected when the tracked landmarks moved enough or when
+///   too many landmarks of the last keyframe were lost,
+/// - the map is initialized from the two first keyframes (relative pose),
+/// - the next keyframes are localized with SfM_Localizer (resection from the
+///   2D-3D correspondences), new landmarks are triangulated and the last
+///   window_size keyframes and their landmarks are refined by a bundle
+///   adjustment, the older keyframes being held constant.
+/// The SfM_Data (keyframes, poses and landmarks) grows incrementally and the
+/// per keyframe cost is bounded by the window size.
+class VO_Windowed_Backend
+{
+public:
+
+  VO_Windowed_Backend
+  (
+    const std::shared_ptr<cameras::IntrinsicBase> & intrinsic,
+    const Windowed_Backend_Params & params = Windowed_Backend_Params()
+  ): params_(params)
+  {
+    sfm_data_.intrinsics[0] = intrinsic;
+  }
+
+  /**
+  * @brief Process a frame
+  * @param frameId Frame index
+  * @param image_name Frame image name (used for the SfM_Data view)
+  * @param observations Position of the landmarks tracked in the frame (per landmark id)
+  * @return true if the frame was added as a keyframe
+  *  (false if the frame restarts a failed map initialization)
+  */
+  bool AddFrame
+  (
+    const size_t frameId,
+    const std::string & image_name,
+    const std::map<uint32_t, Vec2> & observations
+  )
+  {
+    if (b_lost_ || observations.empty())
+      return false;
+
+    if (!keyframes_.empty() && !IsKeyframe(observations))
+      return false;
+
+    Keyframe keyframe;
+    keyframe.view_id = next_view_id_++;
+    keyframe.frame_id = frameId;
+    keyframe.observations = observations;
+
+    if (!b_initialized_)
+    {
+      if (keyframes_.empty())
+      {
+        keyframes_.push_back(std::move(keyframe));
+        keyframe_names_.push_back(image_name);
+        return true;
+      }
+      if (!Initialize(keyframe, image_name))
+      {
+        // Restart the initialization from this frame
+        keyframes_.clear();
+        keyframe_names_.clear();
+        keyframes_.push_back(std::move(keyframe));
+        keyframe_names_.push_back(image_name);
+        return false;
+      }
+      return true;
+    }
+
+    if (!Localize(keyframe, image_name))
+    {
+      std::cerr << "VO backend: keyframe localization failed, the tracking is lost." << std::endl;
+      b_lost_ = true;
+      return false;
+    }
+    Triangulate(keyframe);
+    keyframes_.push_back(std::move(keyframe));
+    while (keyframes_.size() > params_.window_size)
+    {
+      // Forget the 2D observations of the keyframes out of the window
+      RemoveFromWindow(keyframes_.front());
+      keyframes_.pop_front();
+    }
+    OptimizeWindow();
+    return true;
+  }
+
+  bool IsInitialized() const { return b_initialized_; }
+  bool IsLost() const { return b_lost_; }
+
+  /// View ids of the keyframes of the window (from the oldest to the newest)
+  std::vector<IndexT> GetWindowViewIds() const
+  {
+    std::vector<IndexT> view_ids;
+    for (const Keyframe & keyframe : keyframes_)
+      view_ids.push_back(keyframe.view_id);
+    return view_ids;
+  }
+
+  /// The reconstruction (one view & pose per keyframe)
+  const sfm::SfM_Data & GetSfM_Data() const { return sfm_data_; }
+
+private:
+
+  struct Keyframe
+  {
+    IndexT view_id;
+    size_t frame_id;
+    std::map<uint32_t, Vec2> observations;
+  };
+
+  Windowed_Backend_Params params_;
+  sfm::SfM_Data sfm_data_;
+  std::deque<Keyframe> keyframes_; // The keyframes of the window
+  // Landmarks seen by the window: #window keyframes observing them (per landmark id)
+  std::map<uint32_t, uint32_t> window_landmarks_;
+  std::vector<std::string> keyframe_names_; // Names of the keyframes waiting for the initialization
+  IndexT next_view_id_ = 0;
+  bool b_initialized_ = false;
+  bool b_lost_ = false;
+
+private:
+
+  const cameras::IntrinsicBase * Intrinsic() const
+  {
+    return sfm_data_.intrinsics.at(0).get();
+  }
+
+  /// Keyframe selection policy
+  bool IsKeyframe(const std::map<uint32_t, Vec2> & observations) const
+  {
+    const Keyframe & last_keyframe = keyframes_.back();
+    std::vector<double> displacements;
+    for (const auto & obs_it : observations)
+    {
+      const auto last_it = last_keyframe.observations.find(obs_it.first);
+      if (last_it != last_keyframe.observations.end())
+        displacements.push_back((obs_it.second - last_it->second).norm());
+    }
+    // No landmark in common with the last keyframe: the initialization is
+    //  restarted or, once initialized, the localization fails (tracking lost)
+    if (displacements.empty())
+      return true;
+    std::nth_element(displacements.begin(),
+      displacements.begin() + displacements.size() / 2, displacements.end());
+    const double median_parallax = displacements[displacements.size() / 2];
+    if (!b_initialized_)
+      return median_parallax > params_.min_keyframe_parallax;
+    return median_parallax > params_.min_keyframe_parallax
+      || displacements.size() < params_.min_tracked_ratio * last_keyframe.observations.size();
+  }
+
+  void AddView(const Keyframe & keyframe, const std::string & image_name, const geometry::Pose3 & pose)
+  {
+    const cameras::IntrinsicBase * cam = Intrinsic();
+    sfm_data_.views[keyframe.view_id] = std::make_shared<sfm::View>(
+      image_name, keyframe.view_id, 0, keyframe.view_id, cam->w(), cam->h());
+    sfm_data_.poses[keyframe.view_id] = pose;
+  }
+
+  /// Add (or update) the observation of a landmark by a window keyframe
+  void AddObservation(const uint32_t landmark_id, const IndexT view_id, const Vec2 & x)
+  {
+    sfm::Landmark & landmark = sfm_data_.structure.at(landmark_id);
+    if (!landmark.obs.count(view_id))
+      ++window_landmarks_[landmark_id];
+    landmark.obs[view_id] = sfm::Observation(x, landmark_id);
+  }
+
+  /// Update the window landmarks for a keyframe leaving the window
+  void RemoveFromWindow(const Keyframe & keyframe)
+  {
+    for (const auto & obs_it : keyframe.observations)
+    {
+      const auto window_it = window_landmarks_.find(obs_it.first);
+      if (window_it != window_landmarks_.end()
+          && sfm_data_.structure.at(obs_it.first).obs.count(keyframe.view_id)
+          && --window_it->second == 0)
+        window_landmarks_.erase(window_it);
+    }
+  }
+
+  /// Initialize the map from the relative pose of the first keyframe and the new one
+  bool Initialize(Keyframe & keyframe, const std::string & image_name)
+  {
+    const Keyframe & first_keyframe = keyframes_.front();
+    std::vector<uint32_t> landmark_ids;
+    for (const auto & obs_it : keyframe.observations)
+    {
+      if (first_keyframe.observations.count(obs_it.first))
+        landmark_ids.push_back(obs_it.first);
+    }
+    if (landmark_ids.size() < params_.min_tracks)
+      return false;
+
+    const cameras::IntrinsicBase * cam = Intrinsic();
+    Mat x1(2, landmark_ids.size()), x2(2, landmark_ids.size());
+    for (size_t i = 0; i < landmark_ids.size(); ++i)
+    {
+      x1.col(i) = cam->get_ud_pixel(first_keyframe.observations.at(landmark_ids[i]));
+      x2.col(i) = cam->get_ud_pixel(keyframe.observations.at(landmark_ids[i]));
+    }
+    sfm::RelativePose_Info relativePose_info;
+    const std::pair<size_t, size_t> image_size(cam->w(), cam->h());
+    if (!sfm::robustRelativePose(cam, cam, x1, x2, relativePose_info, image_size, image_size, 256)
+        || relativePose_info.vec_inliers.size() < params_.min_tracks)
+      return false;
+
+    AddView(first_keyframe, keyframe_names_.front(), geometry::Pose3());
+    AddView(keyframe, image_name, relativePose_info.relativePose);
+    for (const uint32_t inlier_idx : relativePose_info.vec_inliers)
+    {
+      const uint32_t landmark_id = landmark_ids[inlier_idx];
+      TriangulateLandmark(landmark_id,
+        first_keyframe.view_id, first_keyframe.observations.at(landmark_id),
+        keyframe.view_id, keyframe.observations.at(landmark_id));
+    }
+    keyframes_.push_back(std::move(keyframe));
+    keyframe_names_.clear();
+    b_initialized_ = true;
+    OptimizeWindow();
+    std::cout << "VO backend: map initialized with " << sfm_data_.structure.size() << " landmarks." << std::endl;
+    return true;
+  }
+
+  /// Localize a keyframe with the already triangulated landmarks
+  bool Localize(const Keyframe & keyframe, const std::string & image_name)
+  {
+    const cameras::IntrinsicBase * cam = Intrinsic();
+    std::vector<uint32_t> landmark_ids;
+    for (const auto & obs_it : keyframe.observations)
+    {
+      if (sfm_data_.structure.count(obs_it.first))
+        landmark_ids.push_back(obs_it.first);
+    }
+    if (landmark_ids.size() < params_.min_tracks)
+      return false;
+
+    sfm::Image_Localizer_Match_Data resection_data;
+    resection_data.pt3D.resize(3, landmark_ids.size());
+    resection_data.pt2D.resize(2, landmark_ids.size());
+    Mat2X pt2D_original(2, landmark_ids.size());
+    for (size_t i = 0; i < landmark_ids.size(); ++i)
+    {
+      resection_data.pt3D.col(i) = sfm_data_.structure.at(landmark_ids[i]).X;
+      resection_data.pt2D.col(i) = pt2D_original.col(i) = keyframe.observations.at(landmark_ids[i]);
+      if (cam->have_disto())
+        resection_data.pt2D.col(i) = cam->get_ud_pixel(resection_data.pt2D.col(i));
+    }
+    resection_data.error_max = params_.max_reprojection_error;
+
+    geometry::Pose3 pose;
+    if (!sfm::SfM_Localizer::Localize(resection::SolverType::P3P_KE_CVPR17,
+          {cam->w(), cam->h()}, cam, resection_data, pose))
+      return false;
+    resection_data.pt2D = std::move(pt2D_original);
+    if (!sfm::SfM_Localizer::RefinePose(
+          sfm_data_.intrinsics.at(0).get(), pose, resection_data, true, false))
+      return false;
+
+    AddView(keyframe, image_name, pose);
+    for (const uint32_t inlier_idx : resection_data.vec_inliers)
+    {
+      const uint32_t landmark_id = landmark_ids[inlier_idx];
+      AddObservation(landmark_id, keyframe.view_id, keyframe.observations.at(landmark_id));
+    }
+    return true;
+  }
+
+  /// Triangulate the new landmarks of a keyframe with the keyframes of the window
+  void Triangulate(const Keyframe & keyframe)
+  {
+    for (const auto & obs_it : keyframe.observations)
+    {
+      const uint32_t landmark_id = obs_it.first;
+      if (sfm_data_.structure.count(landmark_id))
+        continue;
+      // Use the oldest keyframe of the window (widest baseline) observing the landmark
+      for (const Keyframe & other : keyframes_)
+      {
+        const auto other_it = other.observations.find(landmark_id);
+        if (other_it != other.observations.end()
+            && TriangulateLandmark(landmark_id, other.view_id, other_it->second,
+                 keyframe.view_id, obs_it.second))
+        {
+          // Add the observations of the other keyframes of the window
+          for (const Keyframe & window_keyframe : keyframes_)
+          {
+            const auto window_it = window_keyframe.observations.find(landmark_id);
+            if (window_it != window_keyframe.observations.end())
+              AddObservation(landmark_id, window_keyframe.view_id, window_it->second);
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  /// Triangulate a landmark from two views (rejected if the triangulation is ill conditioned)
+  bool TriangulateLandmark
+  (
+    const uint32_t landmark_id,
+    const IndexT view_I, const Vec2 & xI,
+    const IndexT view_J, const Vec2 & xJ
+  )
+  {
+    const cameras::IntrinsicBase * cam = Intrinsic();
+    const geometry::Pose3 & pose_I = sfm_data_.poses.at(view_I);
+    const geometry::Pose3 & pose_J = sfm_data_.poses.at(view_J);
+    const Vec2 xI_ud = cam->get_ud_pixel(xI), xJ_ud = cam->get_ud_pixel(xJ);
+    Vec3 X;
+    TriangulateDLT(pose_I.asMatrix(), (*cam)(xI_ud), pose_J.asMatrix(), (*cam)(xJ_ud), &X);
+    if (cameras::AngleBetweenRay(pose_I, cam, pose_J, cam, xI, xJ) < params_.min_triangulation_angle
+        || !cameras::CheiralityTest((*cam)(xI_ud), pose_I, (*cam)(xJ_ud), pose_J, X)
+        || cam->residual(pose_I(X), xI).norm() > params_.max_reprojection_error
+        || cam->residual(pose_J(X), xJ).norm() > params_.max_reprojection_error)
+      return false;
+    sfm_data_.structure[landmark_id].X = X;
+    AddObservation(landmark_id, view_I, xI);
+    AddObservation(landmark_id, view_J, xJ);
+    return true;
+  }
+
+  /// Refine the window keyframes and their landmarks (the other keyframes are held constant)
+  void OptimizeWindow()
+  {
+    std::set<IndexT> window_views;
+    for (const Keyframe & keyframe : keyframes_)
+      window_views.insert(keyframe.view_id);
+
+    // Local scene: the landmarks seen by the window and all the keyframes observing them
+    sfm::SfM_Data local_scene;
+    local_scene.intrinsics = sfm_data_.intrinsics;
+    for (const auto & window_landmark_it : window_landmarks_)
+    {
+      const sfm::Landmark & landmark =
+        local_scene.structure[window_landmark_it.first] =
+        sfm_data_.structure.at(window_landmark_it.first);
+      for (const auto & obs_it : landmark.obs)
+      {
+        if (!local_scene.views.count(obs_it.first))
+        {
+          local_scene.views[obs_it.first] = sfm_data_.views.at(obs_it.first);
+          local_scene.poses[obs_it.first] = sfm_data_.poses.at(obs_it.first);
+        }
+      }
+    }
+    if (local_scene.structure.empty())
+      return;
+
+    sfm::Optimize_Options options(
+      cameras::Intrinsic_Parameter_Type::NONE,
+      sfm::Extrinsic_Parameter_Type::ADJUST_ALL,
+      sfm::Structure_Parameter_Type::ADJUST_ALL);
+    for (const auto & pose_it : local_scene.poses)
+    {
+      if (!window_views.count(pose_it.first))
+        options.constant_pose_ids.insert(pose_it.first);
+    }
+    // Fix the gauge (including the monocular scale) with at least two poses:
+    //  add the oldest keyframes of the window if needed
+    for (auto view_it = window_views.begin();
+         options.constant_pose_ids.size() < 2 && view_it != window_views.end(); ++view_it)
+      options.constant_pose_ids.insert(*view_it);
+
+    sfm::Bundle_Adjustment_Ceres::BA_Ceres_options ba_options(false, true);
+    ba_options.max_num_iterations_ = params_.max_ba_iterations;
+    sfm::Bundle_Adjustment_Ceres bundle_adjustment_obj(ba_options);
+    if (!bundle_adjustment_obj.Adjust(local_scene, options))
+      return;
+
+    // Update the map and reject the outlier observations of the window
+    const cameras::IntrinsicBase * cam = Intrinsic();
+    for (const IndexT view_id : window_views)
+      sfm_data_.poses.at(view_id) = local_scene.poses.at(view_id);
+    for (const auto & landmark_it : local_scene.structure)
+    {
+      sfm::Landmark & landmark = sfm_data_.structure.at(landmark_it.first);
+      landmark.X = landmark_it.second.X;
+      for (auto obs_it = landmark.obs.begin(); obs_it != landmark.obs.end();)
+      {
+        const geometry::Pose3 & pose = sfm_data_.poses.at(obs_it->first);
+        if (window_views.count(obs_it->first)
+            && (pose.depth(landmark.X) < 0
+                || cam->residual(pose(landmark.X), obs_it->second.x).norm() > params_.max_reprojection_error))
+        {
+          obs_it = landmark.obs.erase(obs_it);
+          --window_landmarks_.at(landmark_it.first);
+        }
+        else
+          ++obs_it;
+      }
+      if (landmark.obs.size() < 2 || window_landmarks_.at(landmark_it.first) == 0)
+      {
+        window_landmarks_.erase(landmark_it.first);
+        if (landmark.obs.size() < 2)
+          sfm_data_.structure.erase(landmark_it.first);
+      }
+    }
+  }
+};
+
+} // namespace VO
+} // namespace openMVG
+
+#endif // WINDOWED_BACKEND_VO_HPP
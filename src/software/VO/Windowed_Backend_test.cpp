@@ -0,0 +1,165 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create synthetic tracks: landmarks seen by a camera moving sideways
+// - Feed the tracks frame by frame to the windowed VO backend
+// - Assert that:
+//   - the map is initialized once the parallax is large enough,
+//   - the keyframes are added to the SfM_Data and the window is bounded,
+//   - a frame without any landmark in common with the last keyframe
+//     restarts the initialization or marks the tracking as lost.
+//-----------------
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "software/VO/Windowed_Backend.hpp"
+
+#include "testing/testing.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::VO;
+
+namespace {
+
+const int image_width = 640, image_height = 480;
+
+std::shared_ptr<Pinhole_Intrinsic> Synthetic_Intrinsic()
+{
+  return std::make_shared<Pinhole_Intrinsic>(
+    image_width, image_height, 500.0, image_width / 2.0, image_height / 2.0);
+}
+
+// Random landmarks in front of the camera path
+std::vector<Vec3> Synthetic_Landmarks(const int nb_landmarks)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> x_dist(-6.0, 10.0), y_dist(-4.0, 4.0), z_dist(8.0, 16.0);
+  std::vector<Vec3> landmarks(nb_landmarks);
+  for (Vec3 & X : landmarks)
+    X << x_dist(random_generator), y_dist(random_generator), z_dist(random_generator);
+  return landmarks;
+}
+
+// Tracks of the frame: the visible landmarks for a camera translated along the X axis
+std::map<uint32_t, Vec2> Synthetic_Frame_Observations
+(
+  const std::vector<Vec3> & landmarks,
+  const IntrinsicBase & cam,
+  const int frame_id,
+  const uint32_t landmark_id_offset = 0
+)
+{
+  const geometry::Pose3 pose(Mat3::Identity(), Vec3(0.1 * frame_id, 0.0, 0.0));
+  std::map<uint32_t, Vec2> observations;
+  for (size_t i = 0; i < landmarks.size(); ++i)
+  {
+    const Vec3 X = pose(landmarks[i]);
+    const Vec2 x = cam.project(X);
+    if (x(0) >= 0 && x(0) < image_width && x(1) >= 0 && x(1) < image_height)
+      observations[landmark_id_offset + i] = x;
+  }
+  return observations;
+}
+
+} // namespace
+
+TEST(VO_Windowed_Backend, Keyframe_Selection_And_Window)
+{
+  const std::shared_ptr<Pinhole_Intrinsic> intrinsic = Synthetic_Intrinsic();
+  const std::vector<Vec3> landmarks = Synthetic_Landmarks(400);
+
+  Windowed_Backend_Params params;
+  params.window_size = 3;
+  VO_Windowed_Backend backend(intrinsic, params);
+
+  // The first frame is the first keyframe
+  EXPECT_TRUE(backend.AddFrame(0, "0", Synthetic_Frame_Observations(landmarks, *intrinsic, 0)));
+  EXPECT_FALSE(backend.IsInitialized());
+
+  // A frame with a small parallax is not a keyframe
+  EXPECT_FALSE(backend.AddFrame(1, "1", Synthetic_Frame_Observations(landmarks, *intrinsic, 1)));
+  EXPECT_FALSE(backend.IsInitialized());
+
+  int nb_keyframes = 1;
+  for (int frame_id = 2; frame_id < 40; ++frame_id)
+  {
+    if (backend.AddFrame(frame_id, std::to_string(frame_id),
+          Synthetic_Frame_Observations(landmarks, *intrinsic, frame_id)))
+      ++nb_keyframes;
+  }
+  EXPECT_TRUE(backend.IsInitialized());
+  EXPECT_FALSE(backend.IsLost());
+  // Several keyframes were selected, but not all the frames
+  EXPECT_TRUE(nb_keyframes > static_cast<int>(params.window_size));
+  EXPECT_TRUE(nb_keyframes < 40);
+
+  // Each keyframe has a view and a pose, and the window keeps the newest keyframes
+  const sfm::SfM_Data & sfm_data = backend.GetSfM_Data();
+  EXPECT_EQ(static_cast<size_t>(nb_keyframes), sfm_data.GetViews().size());
+  EXPECT_EQ(static_cast<size_t>(nb_keyframes), sfm_data.GetPoses().size());
+  EXPECT_TRUE(sfm_data.GetLandmarks().size() >= params.min_tracks);
+
+  const std::vector<IndexT> window_view_ids = backend.GetWindowViewIds();
+  EXPECT_EQ(static_cast<size_t>(params.window_size), window_view_ids.size());
+  for (size_t i = 0; i < window_view_ids.size(); ++i)
+  {
+    EXPECT_EQ(static_cast<IndexT>(nb_keyframes - window_view_ids.size() + i), window_view_ids[i]);
+  }
+}
+
+TEST(VO_Windowed_Backend, No_Common_Landmarks)
+{
+  const std::shared_ptr<Pinhole_Intrinsic> intrinsic = Synthetic_Intrinsic();
+  const std::vector<Vec3> landmarks = Synthetic_Landmarks(400);
+
+  // Before the initialization: the initialization restarts from the new frame
+  {
+    VO_Windowed_Backend backend(intrinsic);
+    EXPECT_TRUE(backend.AddFrame(0, "0", Synthetic_Frame_Observations(landmarks, *intrinsic, 0)));
+    EXPECT_FALSE(backend.AddFrame(1, "1", Synthetic_Frame_Observations(landmarks, *intrinsic, 1, 10000)));
+    EXPECT_FALSE(backend.IsInitialized());
+    EXPECT_FALSE(backend.IsLost());
+    EXPECT_EQ(static_cast<size_t>(1), backend.GetWindowViewIds().size());
+  }
+
+  // Once initialized: the keyframe cannot be localized and the tracking is lost
+  {
+    VO_Windowed_Backend backend(intrinsic);
+    int frame_id = 0;
+    for (; frame_id < 40 && !backend.IsInitialized(); ++frame_id)
+    {
+      backend.AddFrame(frame_id, std::to_string(frame_id),
+        Synthetic_Frame_Observations(landmarks, *intrinsic, frame_id));
+    }
+    EXPECT_TRUE(backend.IsInitialized());
+    const size_t nb_views = backend.GetSfM_Data().GetViews().size();
+
+    EXPECT_FALSE(backend.AddFrame(frame_id, std::to_string(frame_id),
+      Synthetic_Frame_Observations(landmarks, *intrinsic, frame_id, 10000)));
+    EXPECT_TRUE(backend.IsLost());
+    EXPECT_EQ(nb_views, backend.GetSfM_Data().GetViews().size());
+
+    // The next frames are ignored
+    ++frame_id;
+    EXPECT_FALSE(backend.AddFrame(frame_id, std::to_string(frame_id),
+      Synthetic_Frame_Observations(landmarks, *intrinsic, frame_id)));
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -6,12 +6,16 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/features/feature.hpp"
+#include "openMVG/system/timer.hpp"
 
 #include "software/VO/CGlWindow.hpp"
 #include "software/VO/Monocular_VO.hpp"
 #include "software/VO/Tracker.hpp"
+#include "software/VO/Windowed_Backend.hpp"
 #if defined HAVE_OPENCV
 #include "software/VO/Tracker_opencv_klt.hpp"
 #endif
@@ -19,6 +23,7 @@
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 
@@ -33,9 +38,18 @@ int main(int argc, char **argv)
 
   std::string sImaDirectory = "";
   unsigned int uTracker = 0;
+  float fSearchRadius = 0.f;
+  double dFocal = 0.0;
+  unsigned int uWindowSize = 5;
+  std::string sOutFile = "";
 
   cmd.add( make_option('i', sImaDirectory, "imadir") );
   cmd.add( make_option('t', uTracker, "tracker") );
+  cmd.add( make_option('r', fSearchRadius, "search_radius") );
+  cmd.add( make_option('f', dFocal, "focal") );
+  cmd.add( make_option('w', uWindowSize, "window_size") );
+  cmd.add( make_option('o', sOutFile, "output_file") );
+  cmd.add( make_switch('v', "verbose") );
 
   try {
     if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -48,6 +62,15 @@ int main(int argc, char **argv)
 #if defined HAVE_OPENCV
     << "\t 1 image based Tracking -> use OpenCV Pyramidal KLT Tracking\n"
 #endif
+    << "[-r|--search_radius] maximal displacement (in pixels) of a feature\n"
+    << "\t around its predicted position between two frames (Fast + Dipole tracker).\n"
+    << "\t 0 (default): exhaustive search.\n"
+    << "[-f|--focal] camera focal length (in pixels) to estimate the keyframe poses\n"
+    << "\t and the structure (0 (default): tracking only)\n"
+    << "[-w|--window_size] number of keyframes refined by the windowed bundle adjustment (5 by default)\n"
+    << "[-o|--output_file] file where the keyframe reconstruction will be stored\n"
+    << "\t (i.e. path/sfm_data.bin)\n"
+    << "[-v|--verbose] display the latency of each frame\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -56,7 +79,14 @@ int main(int argc, char **argv)
 
    std::cout << " You called : " <<std::endl
             << argv[0] << std::endl
-            << "--imageDirectory " << sImaDirectory << std::endl;
+            << "--imageDirectory " << sImaDirectory << std::endl
+            << "--search_radius " << fSearchRadius << std::endl
+            << "--focal " << dFocal << std::endl
+            << "--window_size " << uWindowSize << std::endl
+            << "--output_file " << sOutFile << std::endl
+            << "--verbose " << cmd.used('v') << std::endl;
+
+  const bool bVerbose = cmd.used('v');
 
   if (sImaDirectory.empty() || !stlplus::is_folder(sImaDirectory))
   {
@@ -106,7 +136,7 @@ int main(int argc, char **argv)
   switch (uTracker)
   {
     case 0:
-      tracker_ptr.reset(new Tracker_fast_dipole);
+      tracker_ptr.reset(new Tracker_fast_dipole(fSearchRadius));
     break;
 #if defined HAVE_OPENCV
     case 1:
@@ -126,6 +156,13 @@ int main(int argc, char **argv)
   // Initialize the monocular tracking framework
   VO_Monocular monocular_vo(tracker_ptr.get(), 1500);
 
+  // Optional pose & structure estimation backend (created with the first frame size)
+  std::unique_ptr<VO_Windowed_Backend> backend_ptr;
+
+  // Per frame latency of the feature tracking & VO
+  double latency_sum = 0., latency_max = 0.;
+  size_t latency_count = 0;
+
   size_t frameId = 0;
   for (std::vector<std::string>::const_iterator iterFile = vec_image.begin();
     iterFile != vec_image.end(); ++iterFile, ++frameId)
@@ -170,7 +207,35 @@ int main(int argc, char **argv)
       //    . track features
       //    . if some tracks are cut, detect and insert new features
       //--
+      const system::Timer frame_timer;
       monocular_vo.nextFrame(currentImage, frameId);
+      if (dFocal > 0.0)
+      {
+        if (!backend_ptr)
+        {
+          Windowed_Backend_Params params;
+          params.window_size = std::max(2u, uWindowSize);
+          backend_ptr.reset(new VO_Windowed_Backend(
+            std::make_shared<cameras::Pinhole_Intrinsic>(
+              currentImage.Width(), currentImage.Height(), dFocal,
+              currentImage.Width() / 2.0, currentImage.Height() / 2.0),
+            params));
+        }
+        if (backend_ptr->AddFrame(frameId, *iterFile, monocular_vo.lastFrameObservations()))
+        {
+          std::cout << "Keyframe #" << backend_ptr->GetSfM_Data().GetViews().size()
+            << " (" << backend_ptr->GetSfM_Data().GetLandmarks().size() << " landmarks)" << std::endl;
+        }
+      }
+      const double latency = frame_timer.elapsedMs();
+      latency_sum += latency;
+      latency_max = std::max(latency_max, latency);
+      ++latency_count;
+      if (bVerbose)
+      {
+        std::cout << "Frame #" << frameId << ": " << latency << " ms, "
+          << monocular_vo.landmarkListPerFrame_.back().size() << " observed landmarks" << std::endl;
+      }
 
       //--
       // Draw feature trajectories
@@ -237,6 +302,20 @@ int main(int argc, char **argv)
     }
   }
 
+  if (latency_count > 0)
+  {
+    std::cout << "\nPer frame latency (ms): mean " << latency_sum / latency_count
+      << ", max " << latency_max << " (" << latency_count << " frames)" << std::endl;
+  }
+
+  if (backend_ptr && !sOutFile.empty())
+  {
+    if (!sfm::Save(backend_ptr->GetSfM_Data(), sOutFile, sfm::ESfM_Data(sfm::ALL)))
+    {
+      std::cerr << "Cannot save the keyframe reconstruction: " << sOutFile << std::endl;
+    }
+  }
+
   glfwTerminate();
   return 0;
 }
@@ -33,6 +33,7 @@
 
 #include "third_party/progress/progress_display.hpp"
 
+#include <array>
 #include <numeric>
 #include <iomanip>
 #include <iterator>
@@ -40,6 +41,9 @@
 #include <functional>
 #include <sstream>
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace openMVG{
 
@@ -199,16 +203,75 @@ bool ColorHarmonizationEngineGlobal::Process()
   double minvalue = 0.0;
   double maxvalue = 255.0;
 
+  // The selection masks are computed for all the edges in parallel and stored as runs of pixels.
+  // The histograms are then computed image per image: each image is decoded once and its
+  // histograms are accumulated for all its edges.
+  using MaskRuns = color_harmonization::commonDataByPair::MaskRuns;
+  std::vector<std::array<MaskRuns, 2>> vec_maskRuns(_map_Matches.size());
+
   // For each edge computes the selection masks and histograms (for the RGB channels)
-  std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
-  map_relativeHistograms[0].resize(_map_Matches.size());
-  map_relativeHistograms[1].resize(_map_Matches.size());
-  map_relativeHistograms[2].resize(_map_Matches.size());
+  std::vector<std::vector<relativeColorHistogramEdge>> map_relativeHistograms(3,
+    std::vector<relativeColorHistogramEdge>(_map_Matches.size()));
 
-  for (size_t i = 0; i < _map_Matches.size(); ++i)
+  // The edges of an image are consecutive: its pyramid of scale images is built once for them
+#ifdef OPENMVG_USE_OPENMP
+  ImageScaleCache scaleCache(2 * omp_get_max_threads());
+#else
+  ImageScaleCache scaleCache(4);
+#endif
+
+  // The edges incident to each image: (edge index, 0 if the image is I else 1)
+  std::map<size_t, std::vector<std::pair<size_t, int>>> map_imageEdges;
+  std::vector<matching::PairWiseMatches::const_iterator> vec_edges;
+  enum EHistogramSelectionMethod
   {
-    matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
-    std::advance(iter, i);
+      eHistogramHarmonizeFullFrame     = 0,
+      eHistogramHarmonizeMatchedPoints = 1,
+      eHistogramHarmonizeVLDSegment    = 2,
+  };
+  // The features and camera indexes of the edge images are retrieved before
+  //  the parallel loop (a missing entry cannot throw from the parallel region)
+  const bool bUseFeatures =
+    _selectionMethod == eHistogramHarmonizeMatchedPoints ||
+    _selectionMethod == eHistogramHarmonizeVLDSegment;
+  const std::vector<features::SIOPointFeature> vec_noFeats;
+  std::vector<std::pair<const std::vector<features::SIOPointFeature> *,
+    const std::vector<features::SIOPointFeature> *>> vec_edgeFeats;
+  std::vector<std::pair<size_t, size_t>> vec_edgeCameraIndexes;
+  for (matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
+    iter != _map_Matches.end(); ++iter)
+  {
+    const size_t I = iter->first.first;
+    const size_t J = iter->first.second;
+    const auto feats_I = _map_feats.find(I), feats_J = _map_feats.find(J);
+    if (bUseFeatures && (feats_I == _map_feats.end() || feats_J == _map_feats.end()))
+    {
+      std::cerr << "Missing features for the edge: " << I << "-" << J << std::endl;
+      return false;
+    }
+    const auto camera_I = map_cameraNodeToCameraIndex.find(I),
+      camera_J = map_cameraNodeToCameraIndex.find(J);
+    if (camera_I == map_cameraNodeToCameraIndex.end() || camera_J == map_cameraNodeToCameraIndex.end())
+    {
+      std::cerr << "Missing camera index for the edge: " << I << "-" << J << std::endl;
+      return false;
+    }
+    vec_edgeFeats.emplace_back(
+      feats_I != _map_feats.end() ? &feats_I->second : &vec_noFeats,
+      feats_J != _map_feats.end() ? &feats_J->second : &vec_noFeats);
+    vec_edgeCameraIndexes.emplace_back(camera_I->second, camera_J->second);
+    map_imageEdges[I].emplace_back(vec_edges.size(), 0);
+    map_imageEdges[J].emplace_back(vec_edges.size(), 1);
+    vec_edges.push_back(iter);
+  }
+
+  bool bSelectionOk = true;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_edges.size()); ++i)
+  {
+    matching::PairWiseMatches::const_iterator iter = vec_edges[i];
 
     const size_t I = iter->first.first;
     const size_t J = iter->first.second;
@@ -218,9 +281,14 @@ bool ColorHarmonizationEngineGlobal::Process()
     //-- Edges names:
     std::pair<std::string, std::string> p_imaNames;
     p_imaNames = make_pair( _vec_fileNames[ I ], _vec_fileNames[ J ] );
-    std::cout << "Current edge : "
-      << stlplus::filename_part(p_imaNames.first) << "\t"
-      << stlplus::filename_part(p_imaNames.second) << std::endl;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    {
+      std::cout << "Current edge : "
+        << stlplus::filename_part(p_imaNames.first) << "\t"
+        << stlplus::filename_part(p_imaNames.second) << std::endl;
+    }
 
     //-- Compute the masks from the data selection:
     Image< unsigned char > maskI ( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second );
@@ -228,13 +296,6 @@ bool ColorHarmonizationEngineGlobal::Process()
 
     switch (_selectionMethod)
     {
-      enum EHistogramSelectionMethod
-      {
-          eHistogramHarmonizeFullFrame     = 0,
-          eHistogramHarmonizeMatchedPoints = 1,
-          eHistogramHarmonizeVLDSegment    = 2,
-      };
-
       case eHistogramHarmonizeFullFrame:
       {
         color_harmonization::commonDataByPair_FullFrame  dataSelector(
@@ -250,8 +311,8 @@ bool ColorHarmonizationEngineGlobal::Process()
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ],
+          *vec_edgeFeats[i].first,
+          *vec_edgeFeats[i].second,
           circleSize);
         dataSelector.computeMask( maskI, maskJ );
       }
@@ -262,15 +323,21 @@ bool ColorHarmonizationEngineGlobal::Process()
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ]);
+          *vec_edgeFeats[i].first,
+          *vec_edgeFeats[i].second,
+          &scaleCache);
 
         dataSelector.computeMask( maskI, maskJ );
       }
       break;
       default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        {
+          std::cout << "Selection method unsupported" << std::endl;
+          bSelectionOk = false;
+        }
     }
 
     //-- Export the masks
@@ -292,37 +359,61 @@ bool ColorHarmonizationEngineGlobal::Process()
       WriteImage( out_filename_J.c_str(), maskJ );
     }
 
-    //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    ReadImage( p_imaNames.first.c_str(), &imageI );
-    ReadImage( p_imaNames.second.c_str(), &imageJ );
-
-    Histogram< double > histoI( minvalue, maxvalue, bin);
-    Histogram< double > histoJ( minvalue, maxvalue, bin);
-
-    int channelIndex = 0; // RED channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 1; // GREEN channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 2; // BLUE channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
+    color_harmonization::commonDataByPair::computeMaskRuns( maskI, vec_maskRuns[i][0] );
+    color_harmonization::commonDataByPair::computeMaskRuns( maskJ, vec_maskRuns[i][1] );
+    for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      map_relativeHistograms[channelIndex][i].I = vec_edgeCameraIndexes[i].first;
+      map_relativeHistograms[channelIndex][i].J = vec_edgeCameraIndexes[i].second;
+    }
   }
+  if (!bSelectionOk)
+    return false;
+
+  //-- Compute the histograms (each image is decoded once)
+  std::vector<std::map<size_t, std::vector<std::pair<size_t, int>>>::const_iterator> vec_imageEdges;
+  for (auto iter = map_imageEdges.cbegin(); iter != map_imageEdges.cend(); ++iter)
+    vec_imageEdges.push_back(iter);
+
+  bool bReadOk = true;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int k = 0; k < static_cast<int>(vec_imageEdges.size()); ++k)
+  {
+    const size_t imaNum = vec_imageEdges[k]->first;
+    Image< RGBColor > image;
+    if (!ReadImage( _vec_fileNames[ imaNum ].c_str(), &image ))
+    {
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      {
+        std::cerr << "Unable to read the image: " << _vec_fileNames[ imaNum ] << std::endl;
+        bReadOk = false;
+      }
+      continue;
+    }
+
+    for (const auto & edge_side : vec_imageEdges[k]->second)
+    {
+      const size_t i = edge_side.first;
+      Histogram< double > histos[3] = {
+        Histogram< double >( minvalue, maxvalue, bin),
+        Histogram< double >( minvalue, maxvalue, bin),
+        Histogram< double >( minvalue, maxvalue, bin)};
+      color_harmonization::commonDataByPair::computeHistos(
+        histos, vec_maskRuns[i][edge_side.second], image );
+      for (int channelIndex = 0; channelIndex < 3; ++channelIndex) // RED, GREEN, BLUE channels
+      {
+        relativeColorHistogramEdge & edge = map_relativeHistograms[channelIndex][i];
+        (edge_side.second == 0 ? edge.histoI : edge.histoJ) = histos[channelIndex].GetHist();
+      }
+    }
+  }
+  if (!bReadOk)
+    return false;
+  vec_maskRuns.clear();
 
   std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
   //-- Solve for the gains and offsets:
@@ -331,45 +422,35 @@ bool ColorHarmonizationEngineGlobal::Process()
 
   using namespace openMVG::linearProgramming;
 
-  std::vector<double> vec_solution_r(_vec_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_g(_vec_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_b(_vec_fileNames.size() * 2 + 1);
-
   openMVG::system::Timer timer;
 
-  // Red channel
+  // The three channels are independent linear programs: they are stacked in
+  //  one block diagonal linear program that is solved once
+  ConstraintBuilder_GainOffset_Channels cstBuilder(map_relativeHistograms, vec_indexToFix);
+  const size_t nbChannelParams = cstBuilder.ChannelParameterCount();
+  std::vector<double> vec_stackedSolution(3 * nbChannelParams);
   {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_r.size());
-
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[0], vec_indexToFix);
+    OSI_CLP_SolverWrapper lpSolver(vec_stackedSolution.size());
     LP_Constraints_Sparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_r);
+    if (!cstBuilder.Build(constraint) || !lpSolver.setup(constraint) ||
+        !lpSolver.solve() || !lpSolver.getSolution(vec_stackedSolution))
+    {
+      std::cerr << "Unable to solve the color harmonization linear program." << std::endl;
+      return false;
+    }
   }
-  // Green channel
-  {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_g.size());
 
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[1], vec_indexToFix);
-    LP_Constraints_Sparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_g);
-  }
-  // Blue channel
+  // Solutions for the red, green and blue channels
+  std::vector<double> vec_solution[3];
+  for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
   {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_b.size());
-
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[2], vec_indexToFix);
-    LP_Constraints_Sparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_b);
+    vec_solution[channelIndex].assign(
+      vec_stackedSolution.begin() + channelIndex * nbChannelParams,
+      vec_stackedSolution.begin() + (channelIndex + 1) * nbChannelParams);
   }
+  const std::vector<double> & vec_solution_r = vec_solution[0];
+  const std::vector<double> & vec_solution_g = vec_solution[1];
+  const std::vector<double> & vec_solution_b = vec_solution[2];
 
   std::cout << std::endl
     << " ColorHarmonization solving on a graph with: " << _map_Matches.size() << " edges took (s): "
@@ -392,16 +473,22 @@ bool ColorHarmonizationEngineGlobal::Process()
   std::cout << "\n\nThere is :\n" << set_indeximage.size() << " images to transform." << std::endl;
 
   //-> convert solution to gain offset and creation of the LUT per image
-  C_Progress_display my_progress_bar( set_indeximage.size() );
-  for (std::set<size_t>::const_iterator iterSet = set_indeximage.begin();
-    iterSet != set_indeximage.end(); ++iterSet, ++my_progress_bar)
+  const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
+    vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
+  if ( !stlplus::folder_exists( out_folder ) )
+    stlplus::folder_create( out_folder );
+
+  const std::vector<size_t> vec_indexImage(set_indeximage.begin(), set_indeximage.end());
+  C_Progress_display my_progress_bar( vec_indexImage.size() );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int nodeIndex = 0; nodeIndex < static_cast<int>(vec_indexImage.size()); ++nodeIndex)
   {
-    const size_t imaNum = *iterSet;
+    const size_t imaNum = vec_indexImage[nodeIndex];
     using Vec256 = Eigen::Matrix<double, 256, 1>;
     std::vector< Vec256 > vec_map_lut(3);
 
-    const size_t nodeIndex = std::distance(set_indeximage.begin(), iterSet);
-
     const  double g_r = vec_solution_r[nodeIndex*2];
     const  double offset_r = vec_solution_r[nodeIndex*2+1];
     const  double g_g = vec_solution_g[nodeIndex*2];
@@ -419,9 +506,6 @@ bool ColorHarmonizationEngineGlobal::Process()
     Image< RGBColor > image_c;
     ReadImage( _vec_fileNames[ imaNum ].c_str(), &image_c );
 
-#ifdef OPENMVG_USE_OPENMP
-#pragma omp parallel for
-#endif
     for (int j = 0; j < image_c.Height(); ++j)
     {
       for (int i = 0; i < image_c.Width(); ++i)
@@ -432,13 +516,13 @@ bool ColorHarmonizationEngineGlobal::Process()
       }
     }
 
-    const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
-      vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
-    if ( !stlplus::folder_exists( out_folder ) )
-      stlplus::folder_create( out_folder );
     const std::string out_filename = stlplus::create_filespec( out_folder, stlplus::filename_part(_vec_fileNames[ imaNum ]) );
 
     WriteImage( out_filename.c_str(), image_c );
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    ++my_progress_bar;
   }
   return true;
 }